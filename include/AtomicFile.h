@@ -0,0 +1,42 @@
+/// @file
+/// This class writes a file under a temporary name and renames it
+/// into place once it is complete.
+
+#ifndef ATOMIC_FILE_H_ /**< Protect file from double include. */
+#define ATOMIC_FILE_H_
+
+#include <cstdio>
+#include <string>
+
+/**
+ * A file that only appears under its name once it is completely
+ * written, so other processes reading or mapping it never see a
+ * partly written one.
+ *
+ * The file is written to a temporary name in the same directory, made
+ * from the name and the process ID, and renamed over the name by
+ * commit(). If commit() is not called, or the write failed, the
+ * temporary file is removed and any file already under the name is
+ * left as it was.
+ */
+class AtomicFile {
+public:
+    AtomicFile(const std::string &file_name);
+    ~AtomicFile();
+
+    /** Open the temporary file for writing. */
+    FILE *open();
+
+    /** Close the temporary file and rename it into place. */
+    int commit(bool ok);
+
+private:
+    AtomicFile(const AtomicFile &);
+    AtomicFile &operator=(const AtomicFile &);
+
+    std::string d_file_name; /**< Name the file is renamed to. */
+    std::string d_tmp_name; /**< Name the file is written under. */
+    FILE *d_fp; /**< The temporary file, NULL if not open. */
+};
+
+#endif /* ATOMIC_FILE_H_ */
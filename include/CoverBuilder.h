@@ -0,0 +1,63 @@
+/// @file
+/// This class builds the STARE cover of a grid from the indices of
+/// its points.
+
+#ifndef COVER_BUILDER_H_ /**< Protect file from double include. */
+#define COVER_BUILDER_H_
+
+#include <cstddef>
+#include <vector>
+
+class GeoGrid;
+class StareIntervalSet;
+
+/**
+ * Build a STARE cover from per-point STARE indices.
+ *
+ * The indices are truncated to the cover level, so each point gives
+ * the trixel at that level it lies in. Points are added in batches,
+ * such as whole grids or blocks of rows; duplicates of the point
+ * before are dropped as they are added, which takes out most of them
+ * since neighboring points share trixels. When the cover is wanted
+ * the trixels are radix sorted on their location bits at the cover
+ * level only, and duplicates removed, and the result coalesced into a
+ * StareIntervalSet. Runs of consecutive trixels become intervals, and
+ * runs that are exactly one coarser trixel (all its children) become
+ * that trixel.
+ *
+ * The cover holds every trixel at the cover level that has a point in
+ * it, and no others, so it is exact for the points; it is also the
+ * cover of the pixels as long as the cover level is no finer than the
+ * pixel resolution. Building it costs about a pass over the points.
+ *
+ * Points that are not valid lat/lons are left out.
+ */
+class CoverBuilder {
+public:
+    CoverBuilder(int level, int num_threads);
+
+    int level() const { return d_level; } /**< Cover level, -1 if not yet set. */
+    void set_level(int level);
+
+    /** Add the trixels of n points. */
+    void add(const double *lat, const unsigned long long *index, size_t n);
+
+    /** Add the trixels of every point of a grid. */
+    void add(const GeoGrid &grid);
+
+    /** Get the cover as a set of trixels. */
+    void trixels(StareIntervalSet &set);
+
+    /** Get the cover, in STARE_SpatialIntervals form. */
+    void intervals(std::vector<unsigned long long> &cover);
+
+private:
+    void compact();
+
+    int d_level; /**< Cover level. */
+    int d_num_threads; /**< Threads to use. */
+    std::vector<unsigned long long> d_trixels; /**< Trixels added, sorted up to d_num_sorted. */
+    size_t d_num_sorted; /**< Length of the sorted, unique part of d_trixels. */
+};
+
+#endif /* COVER_BUILDER_H_ */
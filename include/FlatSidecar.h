@@ -0,0 +1,108 @@
+/// @file
+/// This class reads and writes sidecar files in a flat binary format
+/// that is mapped into memory and read without a copy.
+
+#ifndef FLAT_SIDECAR_H_ /**< Protect file from double include. */
+#define FLAT_SIDECAR_H_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+class SidecarLayout;
+
+#define SSC_FLAT_VERSION 1 /**< Version of the flat sidecar format written. */
+#define SSC_FLAT_ALIGN 64 /**< Alignment in bytes of each array in a flat sidecar. */
+
+#define SSC_FLAT_INDEX 0 /**< A STARE index. */
+#define SSC_FLAT_LATITUDE 1 /**< The latitudes of a STARE index. */
+#define SSC_FLAT_LONGITUDE 2 /**< The longitudes of a STARE index. */
+#define SSC_FLAT_COVER 3 /**< A STARE cover. */
+
+/**
+ * An array of a flat sidecar: a view of the values in the mapped
+ * file, or of values to be written.
+ */
+struct FlatArray {
+    int kind; /**< What the array holds, such as SSC_FLAT_INDEX. */
+    std::string name; /**< Name of the index or cover, such as "1km". */
+    std::string variables; /**< Variables an index applies to, as in the netCDF sidecar. */
+    int level; /**< Level of a cover, or -1 if not recorded. */
+    size_t num_i; /**< Rows, or values of a cover. */
+    size_t num_j; /**< Columns, 1 for a cover. */
+    const void *data; /**< The values. */
+
+    size_t size() const { return num_i * num_j; } /**< Number of values. */
+
+    /** STARE values, of an index or cover. */
+    const unsigned long long *values() const { return (const unsigned long long *) data; }
+
+    /** Lat/lons in degrees, of a latitude or longitude. */
+    const double *geo() const { return (const double *) data; }
+};
+
+/**
+ * A sidecar file in a flat binary format.
+ *
+ * Opening a netCDF sidecar parses the HDF5 metadata, and reading an
+ * index decompresses its chunks into a buffer and copies them to the
+ * caller. A server that answers a request with a few arrays spends
+ * most of its time there. A flat sidecar holds the same arrays
+ * uncompressed, each at an offset aligned to SSC_FLAT_ALIGN bytes,
+ * after a small header that lists them. The file is mapped into
+ * memory, and each array is a view of the mapping, so opening it
+ * costs a system call and reading an array only the pages touched.
+ *
+ * The file starts with an eight byte magic string and the format
+ * version; a reader refuses other versions, and files written on a
+ * machine of the other byte order. STARE indices and covers are 64-bit
+ * unsigned integers, and lat/lons doubles, in native byte order.
+ *
+ * Flat sidecars are made from netCDF sidecars, and back, with
+ * fromNetcdf() and toNetcdf(), or the convert_sidecar utility. The
+ * netCDF sidecar stays the format to keep and exchange; a flat sidecar
+ * is a copy for fast reads, about the size of the uncompressed data.
+ *
+ * An open flat sidecar is read-only, and may be shared by all threads.
+ */
+class FlatSidecar {
+public:
+    FlatSidecar();
+
+    ~FlatSidecar();
+
+    /** Map a flat sidecar file into memory. */
+    int open(const std::string &file_name);
+
+    /** Unmap the file. Arrays got before are no longer valid. */
+    void close();
+
+    size_t num_arrays() const { return d_arrays.size(); } /**< Number of arrays. */
+    const FlatArray &array(size_t k) const { return d_arrays[k]; } /**< An array. */
+
+    /** Find an array by kind and name. */
+    const FlatArray *find(int kind, const std::string &name) const;
+
+    /** Find the STARE index that applies to a data variable. */
+    const FlatArray *find_index(const std::string &var_name) const;
+
+    /** Write a flat sidecar file. */
+    static int write(const std::string &file_name, const std::vector<FlatArray> &arrays);
+
+    /** Make a flat sidecar from a netCDF sidecar. */
+    static int fromNetcdf(const std::string &nc_file, const std::string &flat_file);
+
+    /** Make a netCDF sidecar from a flat sidecar. */
+    static int toNetcdf(const std::string &flat_file, const std::string &nc_file,
+                        const SidecarLayout &layout);
+
+private:
+    FlatSidecar(const FlatSidecar &);
+    FlatSidecar &operator=(const FlatSidecar &);
+
+    void *d_map; /**< Mapped file. */
+    size_t d_map_size; /**< Size of the mapping. */
+    std::vector<FlatArray> d_arrays; /**< The arrays, views of the mapping. */
+};
+
+#endif /* FLAT_SIDECAR_H_ */
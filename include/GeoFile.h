@@ -15,11 +15,27 @@
 #include <vector>
 #include "ssc.h"
 #include "STARE.h"
+#include "GeoGrid.h"
+
+class TrixelTable;
+class CoverBuilder;
+class StareIntervalSet;
+class PerimeterWalker;
 
 using namespace std;
 
 #define MAX_NUM_INDEX 10 /**< Max number of STARE index vars in a file. */
 
+/**
+ * A cover widened to a coarser level, written to the sidecar file
+ * next to the cover it was made from.
+ */
+struct PyramidCover {
+    string name; /**< Name of the cover, such as "1km_L5". */
+    int level; /**< STARE level of the cover. */
+    vector<unsigned long long int> values; /**< The cover. */
+};
+
 /**
  * This is the base class for a data file with geolocation.
  */
@@ -27,7 +43,7 @@ class GeoFile {
 public:
     GeoFile();
 
-    ~GeoFile();
+    virtual ~GeoFile();
 
     /** Read file. */
     int readFile(const string fileName, int verbose, int quiet, int build_level);
@@ -43,25 +59,71 @@ public:
     /** Get STARE indices for data variable. */
     int get_stare_indices(const std::string varName, int ncid, vector<unsigned long long> &values);
 
+    /** Get a window of the STARE indices for a data variable, into a caller's buffer. */
+    int get_stare_indices(const std::string varName, int ncid, const size_t *start,
+                          const size_t *count, const ptrdiff_t *stride, unsigned long long *values);
+
+    /** Get a STARE cover from the sidecar file. */
+    int get_stare_cover(const std::string coverName, int ncid, StareIntervalSet &cover_set);
+
     /** Close sidecar file. */
     int close_sidecar_file(int ncid);
 
+    /** Number of threads to use when computing STARE indices. */
+    int thread_count();
+
+    /** Trixel lookup table to start index computation from. */
+    int trixel_table(int level, int build_level, const TrixelTable **table);
+
+    /** Set the resolution level of the STARE indices of a grid. */
+    int setResolution(const double *lat, const double *lon, size_t num_i, size_t num_j,
+                      size_t rows_per_scan, int build_level, unsigned long long *index);
+
+    /** Set the resolution level of the STARE indices of a GeoGrid. */
+    int setResolution(GeoGrid &grid, size_t rows_per_scan, int build_level);
+
+    /** Remember the cover, to be written to the sidecar file. */
+    void keepCover(const string &name);
+
+    /** Set the cover from the trixels of the points added to a CoverBuilder. */
+    void setCover(int verbose, const string &name, CoverBuilder &builder);
+
+    /** Set the cover from a hull of the perimeter of a swath. */
+    void setCover(int verbose, const string &name, int build_level, const PerimeterWalker &walker);
+
+    /** Set the cover from a hull of a perimeter, within the cover budget. */
+    void setCover(int verbose, const string &name, int build_level,
+                  const LatLonDegrees64ValueVector &perimeter);
+
+    /** Coarsen the cover until it has no more than max_cover_values. */
+    void fitCover(int verbose);
+
+    /** Is the cover limited by max_cover_values or max_cover_seconds? */
+    bool coverBudget() const { return max_cover_values > 0 || max_cover_seconds > 0.0; }
+
     int d_num_index; /**< Number of STARE index sets needed for this file. */
     int d_ncid; ///< id of the open netCDF4 file    
-    vector<int> geo_num_i; /**< Number of I. */
-    vector<int> geo_num_j; /**< Number of J. */
-    vector<vector<double>> geo_lat;
-    vector<vector<double>> geo_lon;
-    vector<vector<unsigned long long int>> geo_index;
+    vector<GeoGrid> geo_grid; /**< Lat/lons and STARE indices of each index set. */
 
     int num_cover; /**< Number of covers. */
     vector<vector<unsigned long long int>> geo_cover; /**< The covers. */
     vector<int> geo_num_cover_values; /**< Size of each cover. */
+    vector<int> geo_cover_level; /**< Level of each cover. */
+    vector<PyramidCover> pyramid_cover; /**< Coarser covers of each cover, from pyramid_levels. */
     vector<string> var_name[MAX_NUM_INDEX]; /**< Names of vars that use this index. */
     STARE_SpatialIntervals cover;
 
     int cover_level;
     int perimeter_stride;
+    double perimeter_tolerance; /**< Angle in degrees within which perimeter points are dropped, 0 to keep all. */
+    int num_threads; /**< Threads for indexing, 0 for the OpenMP default. */
+    string lut_dir; /**< Directory of trixel lookup tables, empty to not use them. */
+    bool fine_grids; /**< Also index geolocation interpolated to finer grids, where supported. */
+    bool exact_cover; /**< Build the cover from the point indices instead of a hull of the perimeter. */
+    bool spacing_resolution; /**< Estimate resolution levels from 2-D pixel spacing instead of with STARE. */
+    vector<int> pyramid_levels; /**< Coarser levels to also write each cover at. */
+    size_t max_cover_values; /**< Most values a cover may have, 0 for no limit. */
+    double max_cover_seconds; /**< Time budget for a hull cover, 0 for no limit. */
 
     vector<string> d_stare_index_name;
     vector<string> stare_cover_name;
@@ -0,0 +1,98 @@
+/// @file
+/// This class holds the lat/lons and STARE indices of one grid of a
+/// file with geolocation.
+
+#ifndef GEO_GRID_H_ /**< Protect file from double include. */
+#define GEO_GRID_H_
+
+#include <cstddef>
+#include <memory>
+
+/** A view of a contiguous array owned by something else. */
+template<typename T>
+class GeoSpan {
+public:
+    GeoSpan(T *data, size_t size) : d_data(data), d_size(size) {}
+
+    T *data() const { return d_data; }
+    size_t size() const { return d_size; }
+    T *begin() const { return d_data; }
+    T *end() const { return d_data + d_size; }
+    T &operator[](size_t k) const { return d_data[k]; }
+
+private:
+    T *d_data;
+    size_t d_size;
+};
+
+/**
+ * The lat/lons and STARE indices of a num_i by num_j grid, in row
+ * major order. Each field is one contiguous allocation of exactly the
+ * grid size, made when the grid is constructed and filled in place by
+ * the reader. A grid can be moved but not copied, so the geolocation
+ * of a granule is never duplicated on its way to the sidecar file.
+ */
+class GeoGrid {
+public:
+    GeoGrid() : d_num_i(0), d_num_j(0), d_rows_per_scan(0) {}
+
+    /**
+     * Allocate a grid. The values are not initialized.
+     *
+     * @param num_i Number of rows.
+     * @param num_j Number of columns.
+     * @param rows_per_scan Rows in one scan of the instrument, 0 for a
+     * grid without scans.
+     */
+    GeoGrid(size_t num_i, size_t num_j, size_t rows_per_scan = 0) :
+        d_num_i(num_i), d_num_j(num_j), d_rows_per_scan(rows_per_scan),
+        d_lat(new double[num_i * num_j]), d_lon(new double[num_i * num_j]),
+        d_index(new unsigned long long[num_i * num_j]) {}
+
+    GeoGrid(GeoGrid &&other) noexcept :
+        d_num_i(other.d_num_i), d_num_j(other.d_num_j), d_rows_per_scan(other.d_rows_per_scan),
+        d_lat(std::move(other.d_lat)), d_lon(std::move(other.d_lon)),
+        d_index(std::move(other.d_index)) {
+        other.d_num_i = other.d_num_j = 0;
+    }
+
+    GeoGrid &operator=(GeoGrid &&other) noexcept {
+        d_num_i = other.d_num_i;
+        d_num_j = other.d_num_j;
+        d_rows_per_scan = other.d_rows_per_scan;
+        d_lat = std::move(other.d_lat);
+        d_lon = std::move(other.d_lon);
+        d_index = std::move(other.d_index);
+        other.d_num_i = other.d_num_j = 0;
+        return *this;
+    }
+
+    GeoGrid(const GeoGrid &) = delete;
+    GeoGrid &operator=(const GeoGrid &) = delete;
+
+    size_t num_i() const { return d_num_i; } /**< Number of rows. */
+    size_t num_j() const { return d_num_j; } /**< Number of columns. */
+    size_t size() const { return d_num_i * d_num_j; } /**< Number of points. */
+    size_t rows_per_scan() const { return d_rows_per_scan; } /**< Rows in a scan, 0 if none. */
+
+    GeoSpan<double> lat() { return GeoSpan<double>(d_lat.get(), size()); }
+    GeoSpan<const double> lat() const { return GeoSpan<const double>(d_lat.get(), size()); }
+    GeoSpan<double> lon() { return GeoSpan<double>(d_lon.get(), size()); }
+    GeoSpan<const double> lon() const { return GeoSpan<const double>(d_lon.get(), size()); }
+    GeoSpan<unsigned long long> index() {
+        return GeoSpan<unsigned long long>(d_index.get(), size());
+    }
+    GeoSpan<const unsigned long long> index() const {
+        return GeoSpan<const unsigned long long>(d_index.get(), size());
+    }
+
+private:
+    size_t d_num_i; /**< Number of rows. */
+    size_t d_num_j; /**< Number of columns. */
+    size_t d_rows_per_scan; /**< Rows in one scan of the instrument, 0 for none. */
+    std::unique_ptr<double[]> d_lat; /**< Latitudes. */
+    std::unique_ptr<double[]> d_lon; /**< Longitudes. */
+    std::unique_ptr<unsigned long long[]> d_index; /**< STARE indices. */
+};
+
+#endif /* GEO_GRID_H_ */
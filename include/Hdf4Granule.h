@@ -0,0 +1,73 @@
+/// @file
+/// This class holds a HDF4 granule open for the whole of a read,
+/// through both the SD and the HDF-EOS swath interfaces.
+
+#ifndef HDF4_GRANULE_H_ /**< Protect file from double include. */
+#define HDF4_GRANULE_H_
+
+#include <string>
+#include <map>
+#include <mfhdf.h>
+#include <hdf.h>
+#include <HdfEosDef.h>
+
+/**
+ * A HDF4 granule, opened once for every step of a read.
+ *
+ * Finding the format of a granule, reading its GRing from the
+ * metadata, and reading its lat/lons each used to open the file
+ * themselves, with SWopen() or SDstart(), and each open parses the
+ * HDF4 metadata of the file again. For a small granule that costs
+ * more than the read. A Hdf4Granule opens the file once: with SWopen()
+ * if it is a HDF-EOS file, and the SD interface is then the one
+ * HDF-EOS opened, or with SDstart() if not. Swaths attached, the swath
+ * list, and the global attributes read are kept until the granule is
+ * closed, so each is only looked up once.
+ *
+ * Everything is detached and closed by close() or the destructor, so
+ * a read that fails part way leaves no handle open.
+ *
+ * The HDF4 library is not thread-safe, so a granule is used by one
+ * thread at a time.
+ */
+class Hdf4Granule {
+public:
+    Hdf4Granule();
+
+    ~Hdf4Granule();
+
+    /** Open a granule. */
+    int open(const std::string &file_name);
+
+    /** Detach the swaths and close the granule. */
+    int close();
+
+    bool is_open() const { return d_sd_id != -1; } /**< Is a granule open? */
+    bool is_swath() const { return d_swath_file_id != -1; } /**< Was it opened by HDF-EOS? */
+    const std::string &file_name() const { return d_file_name; } /**< Name of the granule. */
+    int32 sd_id() const { return d_sd_id; } /**< SD interface id. */
+    int32 swath_file_id() const { return d_swath_file_id; } /**< HDF-EOS file id, or -1. */
+
+    /** Get the swaths of the granule. */
+    int swath_list(int32 &num_swath, std::string &swaths);
+
+    /** Attach to a swath. */
+    int attach(const std::string &swath_name, int32 &swath_id);
+
+    /** Read a global text attribute, such as the metadata. */
+    int read_attribute(const std::string &attr_name, std::string &text);
+
+private:
+    Hdf4Granule(const Hdf4Granule &);
+    Hdf4Granule &operator=(const Hdf4Granule &);
+
+    std::string d_file_name; /**< Name of the open granule. */
+    int32 d_swath_file_id; /**< From SWopen(), or -1. */
+    int32 d_sd_id; /**< SD interface id, or -1 if not open. */
+    int32 d_num_swath; /**< Number of swaths, or -1 until asked. */
+    std::string d_swath_list; /**< Comma separated swath names. */
+    std::map<std::string, int32> d_swaths; /**< Attached swaths, by name. */
+    std::map<std::string, std::string> d_attributes; /**< Attributes read, by name. */
+};
+
+#endif /* HDF4_GRANULE_H_ */
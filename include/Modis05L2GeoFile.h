@@ -28,7 +28,11 @@ public:
 
     int readFile(const std::string fileName, int verbose, int build_level,
                  int cover_level, bool use_gring, int perimeter_stride);
+    int readFile(Hdf4Granule &granule, int verbose, int build_level,
+                 int cover_level, bool use_gring, int perimeter_stride);
 
+private:
+    int index1km(int verbose, int build_level, const TrixelTable *table);
 
 };
 
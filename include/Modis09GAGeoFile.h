@@ -25,7 +25,10 @@ class Modis09GAGeoFile : public ModisGeoFile {
 public:
     bool fileExists(const std::string &name);
 
-    int readFile(const std::string fileName, int verbose, int build_level);
+    /** Get the tile numbers of a MOD09GA file from its name. */
+    static int tileNumbers(const std::string &fileName, int &h, int &v);
+
+    int readFile(const std::string fileName, int verbose, int build_level, int cover_level);
 };
 
 #endif /* MODIS09_GA_GEO_FILE_H_ */
@@ -13,6 +13,7 @@
 #include <vector>
 #include "ssc.h"
 #include "ModisGeoFile.h"
+#include "SidecarFile.h"
 
 #ifndef MODIS09_L2_GEO_FILE_H_
 #define MODIS09_L2_GEO_FILE_H_
@@ -25,6 +26,24 @@ public:
     Modis09L2GeoFile();    
     int readFile(const std::string fileName, int verbose, int build_level,
 		 int cover_level, bool use_gring, int perimeter_stride);
+    int readFile(Hdf4Granule &granule, int verbose, int build_level,
+		 int cover_level, bool use_gring, int perimeter_stride);
+    int streamFile(const std::string fileName, int verbose, int build_level,
+                   int cover_level, bool use_gring, int perimeter_stride,
+                   size_t max_memory, SidecarFile &sf);
+    int streamFile(Hdf4Granule &granule, int verbose, int build_level,
+                   int cover_level, bool use_gring, int perimeter_stride,
+                   size_t max_memory, SidecarFile &sf);
+
+private:
+    int readCover(Hdf4Granule &granule, int verbose, int build_level, int cover_level,
+                  bool use_gring);
+    void setIndexNames();
+    int indexRows(int verbose, int build_level, const double *lats, const double *lons,
+                  int first_row, int m0, int m1, unsigned long long *geo_index_1,
+                  double *lats_500, double *lons_500, unsigned long long *geo_index_500,
+                  double *lats_250, double *lons_250, unsigned long long *geo_index_250,
+                  int &finest);
 };
 
 #endif /* MODIS09_L2_GEO_FILE_H_ */
@@ -9,6 +9,7 @@
 #define MODIS_GEO_FILE_H_
 
 #include "GeoFile.h"
+#include "Hdf4Granule.h"
 #include <mfhdf.h>
 #include <hdf.h>
 #include <HdfEosDef.h>
@@ -25,7 +26,9 @@ public:
     ~ModisGeoFile();
 
     int determineFormat(const std::string fileName, int *gf_format);
+    int determineFormat(Hdf4Granule &granule, int *gf_format);
     int getGRing(const std::string fileName, int verbose, float *gring_lat, float *gring_lon);
+    int getGRing(Hdf4Granule &granule, int verbose, float *gring_lat, float *gring_lon);
 
     // This is the name of the attribute in the HDF4 file that
     // contains the GRING info.
@@ -0,0 +1,74 @@
+/// @file
+/// This class holds a 2-D array of STARE indices packed with a
+/// lossless codec made for them.
+
+#ifndef PACKED_STARE_INDEX_H_ /**< Protect file from double include. */
+#define PACKED_STARE_INDEX_H_
+
+#include <cstddef>
+#include <vector>
+
+#define SSC_PACK_BLOCK 64 /**< Pixels packed with one bit width. */
+
+/**
+ * A 2-D array of STARE indices, such as those of a swath, packed row
+ * by row.
+ *
+ * The indices of neighboring pixels are in the same trixel down to
+ * about the level of the pixel size, so they share most of their high
+ * bits. Each row is packed as:
+ *
+ * - the level channel: the 5 bit level of every pixel, or just one
+ *   level when the whole row has it, as it usually does;
+ * - the location bits (all but the level) of the first pixel with
+ *   geolocation, in 59 bits;
+ * - the location bits of each pixel XORed with those of the pixel
+ *   before it, in blocks of SSC_PACK_BLOCK, each block packed in as
+ *   many bits as its widest value needs.
+ *
+ * A pixel of level 31, such as SSC_STARE_NO_TRIXEL, is XORed with all
+ * location bits set instead, so pixels without geolocation pack to
+ * nothing and don't break the run of their neighbors. Any 64-bit value
+ * round trips, so the codec is lossless.
+ *
+ * Rows start on a byte, and the offset of each row is kept, so any run
+ * of rows can be unpacked without the rows before it, and a run of
+ * rows is unpacked in parallel.
+ */
+class PackedStareIndex {
+public:
+    PackedStareIndex(size_t num_j = 0);
+
+    /** Pack an array of STARE indices. */
+    static PackedStareIndex pack(const unsigned long long *index, size_t num_i, size_t num_j);
+
+    /** Pack rows, appended to those packed before. */
+    void append_rows(const unsigned long long *index, size_t num_rows);
+
+    /** Unpack a run of rows. */
+    int unpack_rows(size_t start_row, size_t num_rows, unsigned long long *index) const;
+
+    /** Unpack all rows. */
+    int unpack(std::vector<unsigned long long> &index) const;
+
+    /** Use packed rows, such as those read from a sidecar file. */
+    int assign(size_t num_j, const unsigned char *bytes, size_t num_bytes,
+               const unsigned long long *offsets, size_t num_i);
+
+    size_t num_i() const { return d_offsets.size(); } /**< Number of rows. */
+    size_t num_j() const { return d_num_j; } /**< Number of columns. */
+    const std::vector<unsigned char> &bytes() const { return d_bytes; } /**< Packed rows. */
+    const std::vector<unsigned long long> &offsets() const { return d_offsets; } /**< Byte offset of each row. */
+
+    /** Bytes used, for the packed rows and their offsets. */
+    size_t size_bytes() const {
+        return d_bytes.size() + d_offsets.size() * sizeof(unsigned long long);
+    }
+
+private:
+    size_t d_num_j; /**< Number of columns. */
+    std::vector<unsigned char> d_bytes; /**< Packed rows, one after another. */
+    std::vector<unsigned long long> d_offsets; /**< Byte offset of each row. */
+};
+
+#endif /* PACKED_STARE_INDEX_H_ */
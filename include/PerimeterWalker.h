@@ -0,0 +1,54 @@
+/// @file
+/// This class walks the edge of a swath to get the perimeter for a
+/// STARE cover.
+
+#ifndef PERIMETER_WALKER_H_ /**< Protect file from double include. */
+#define PERIMETER_WALKER_H_
+
+#include <cstddef>
+#include <vector>
+#include "STARE.h"
+
+class GeoGrid;
+
+/**
+ * Walk the edge of a num_i by num_j swath, for STARE::NonConvexHull().
+ *
+ * Rows are added in order, whole or a block at a time, so a swath
+ * that is streamed can be walked without holding it; only the first
+ * and last rows and the two edge columns are kept.
+ *
+ * The perimeter takes every stride'th point of each side, and the
+ * corners, in the order the readers have always used. With a
+ * tolerance, it then drops the points that are within that angle of
+ * the great circle between the points kept on either side of them
+ * (Douglas-Peucker on the sphere, with the corners always kept), so
+ * long straight runs of the edge come down to a few points and the
+ * bends keep theirs. The hull then costs far fewer vertices for about
+ * the same cover.
+ *
+ * Points that are not valid lat/lons are left out.
+ */
+class PerimeterWalker {
+public:
+    PerimeterWalker(size_t num_i, size_t num_j, int stride, double tolerance);
+
+    /** Add rows first_row to first_row + num_rows - 1. */
+    void add_rows(const double *lat, const double *lon, size_t first_row, size_t num_rows);
+
+    /** Add every row of a grid. */
+    void add(const GeoGrid &grid);
+
+    /** Get the perimeter. */
+    void perimeter(LatLonDegrees64ValueVector &perimeter) const;
+
+private:
+    size_t d_num_i; /**< Rows in the swath. */
+    size_t d_num_j; /**< Points in each row. */
+    int d_stride; /**< Points between samples of the edge. */
+    double d_tolerance; /**< Largest angle from the perimeter, in degrees, of a dropped point. */
+    std::vector<double> d_lat[4]; /**< Lats of the first row, last column, last row and first column. */
+    std::vector<double> d_lon[4]; /**< Lons of the first row, last column, last row and first column. */
+};
+
+#endif /* PERIMETER_WALKER_H_ */
@@ -0,0 +1,58 @@
+/// @file
+/// This class interpolates MODIS geolocation from a coarse grid to a
+/// finer one, one scan at a time.
+
+#ifndef SCAN_INTERPOLATOR_H_ /**< Protect file from double include. */
+#define SCAN_INTERPOLATOR_H_
+
+#include <vector>
+
+/**
+ * Interpolate MODIS swath geolocation to a grid factor times finer.
+ *
+ * MODIS scans a swath 10 km long, 10 rows at 1 km, 20 at 500 m, 40 at
+ * 250 m, or 2 at 5 km. Successive scans overlap at the edges of the
+ * swath (the bow tie), so geolocation is only interpolated between
+ * rows of the same scan; the first and last fine rows of a scan are
+ * extrapolated from the two nearest coarse rows in it. Across track
+ * the rows are continuous.
+ *
+ * A coarse pixel covers factor by factor fine pixels, with its center
+ * halfway across them, so fine row q lies at coarse row (q - (factor -
+ * 1) / 2) / factor, and the same for columns.
+ *
+ * Longitude steps are taken the short way around, so rows that cross
+ * the antimeridian interpolate correctly. Fine points whose
+ * neighbors are not valid lat/lons get SSC_GEO_FILL. Both are done by
+ * selection rather than branches, so the loops vectorize.
+ */
+class ScanInterpolator {
+public:
+    ScanInterpolator(int num_rows, int num_cols, int rows_per_scan, int factor, int fine_cols);
+
+    int fine_rows() const { return d_num_rows * d_factor; } /**< Number of fine rows. */
+    int fine_cols() const { return d_fine_cols; } /**< Number of fine columns. */
+
+    /** Coarse column a fine column is interpolated from, with the next one. */
+    int coarse_col(int p) const { return d_col0[p]; }
+
+    /** Coarse rows needed to interpolate some fine rows. */
+    void coarse_rows(int q0, int q1, int &c0, int &c1) const;
+
+    /** Interpolate some fine rows. */
+    void interpolate(const double *lat, const double *lon, int first_row, int q0, int q1,
+                     double *fine_lat, double *fine_lon) const;
+
+private:
+    void along_track(int q, int &i0, double &t) const;
+
+    int d_num_rows; /**< Coarse rows. */
+    int d_num_cols; /**< Coarse columns. */
+    int d_rows_per_scan; /**< Coarse rows in a scan. */
+    int d_factor; /**< Fine pixels per coarse pixel, in each direction. */
+    int d_fine_cols; /**< Fine columns. */
+    std::vector<int> d_col0; /**< Coarse column each fine column starts from. */
+    std::vector<double> d_col_t; /**< Weight of the next coarse column. */
+};
+
+#endif /* SCAN_INTERPOLATOR_H_ */
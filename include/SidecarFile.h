@@ -10,7 +10,9 @@
 #include <sstream>
 #include <iostream>
 #include <iomanip>
+#include <cstddef>
 #include "ssc.h"
+#include "GeoGrid.h"
 
 #ifndef SIDECAR_FILE_H_
 #define SIDECAR_FILE_H_
@@ -28,9 +30,95 @@
 using std::vector;
 using std::string;
 
+#define SSC_CODEC_NONE 0 /**< Variables are not compressed. */
+#define SSC_CODEC_DEFLATE 1 /**< Variables are compressed with deflate (zlib). */
+#define SSC_CODEC_ZSTD 2 /**< Variables are compressed with Zstandard. */
+#define SSC_CHUNK_BYTES 262144 /**< Least size in bytes of a default chunk. */
+
+/**
+ * How the variables of a sidecar file are chunked and compressed.
+ *
+ * By default a chunk of a STARE index, or of its lat/lons, is whole
+ * rows and a whole number of scans of the instrument, the fewest
+ * scans that make at least SSC_CHUNK_BYTES. The rows of a scan, or of
+ * any run of scans, are then read from the fewest chunks, and a
+ * granule streamed a block of scans at a time fills whole chunks. A
+ * grid without scans is chunked in rows the same way. Chunks can
+ * instead be given as a number of rows and columns.
+ *
+ * Variables are shuffled and deflated at level 3 by default; they can
+ * be left uncompressed, deflated at another level, or compressed with
+ * Zstandard if netCDF-C was built with it. Zstandard is read through
+ * the HDF5 filter plugin, so readers need HDF5_PLUGIN_PATH set to
+ * where netCDF-C installed its plugins.
+ *
+ * The STARE indices can instead be packed with the codec of
+ * PackedStareIndex, which takes the indices apart as no general codec
+ * can. A packed index is a variable of bytes, with a variable of the
+ * byte offset of each row, in chunks of SSC_CHUNK_BYTES, and is read
+ * with SidecarFile::readSTAREIndex(). The lat/lons are compressed as
+ * before.
+ *
+ * The lat/lons are doubles, exact, by default. They can instead be
+ * kept as floats, and either can be quantized to a number of
+ * significant digits with netCDF-C's granular bit round, which zeroes
+ * the low mantissa bits so they compress to a fraction of the size.
+ * The precision is recorded in an attribute of each lat/lon. The
+ * STARE indices are computed from the lat/lons read from the granule,
+ * so they are the same with any precision.
+ */
+class SidecarLayout {
+public:
+    SidecarLayout();
+
+    /** Set the codec from text, such as "none", "deflate:5", "zstd" or "stare+deflate:1". */
+    int set_codec(const string &spec);
+
+    /** Set the chunks from text, such as "scan", "40" or "40x1354". */
+    int set_chunks(const string &spec);
+
+    /** Set the precision of the lat/lons from text, such as "double", "float" or "double:6". */
+    int set_geo(const string &spec);
+
+    int codec() const { return d_codec; } /**< Codec, such as SSC_CODEC_DEFLATE. */
+    int level() const { return d_level; } /**< Compression level. */
+    bool pack_index() const { return d_pack_index; } /**< Are STARE indices packed? */
+    int geo_type() const { return d_geo_type; } /**< Type of the lat/lons, NC_DOUBLE or NC_FLOAT. */
+    int geo_digits() const { return d_geo_digits; } /**< Significant digits of the lat/lons, 0 if exact. */
+
+    /** The precision of the lat/lons as text, in the form set_geo() takes. */
+    string geo_str() const;
+
+    /** Chunk shape of a STARE index. */
+    void index_chunks(size_t num_i, size_t num_j, size_t rows_per_scan, size_t chunks[2]) const;
+
+    /** Chunk length of a STARE cover. */
+    size_t cover_chunk(size_t size) const;
+
+    /** The layout as text, as the options that set it. */
+    string str() const;
+
+private:
+    int d_codec; /**< Codec. */
+    int d_level; /**< Compression level. */
+    bool d_pack_index; /**< Pack STARE indices with PackedStareIndex. */
+    size_t d_chunk_rows; /**< Rows in a chunk, 0 for whole scans. */
+    size_t d_chunk_cols; /**< Columns in a chunk, 0 for whole rows. */
+    int d_geo_type; /**< Type of the lat/lons. */
+    int d_geo_digits; /**< Significant digits kept of the lat/lons, 0 for all. */
+};
+
 class SidecarFile {
 private:
     int ncid;
+    SidecarLayout d_layout; /**< How variables are chunked and compressed. */
+    vector<int> d_lat_varid; /**< Latitude varid of each defined STARE index. */
+    vector<int> d_lon_varid; /**< Longitude varid of each defined STARE index. */
+    vector<int> d_index_varid; /**< Varid of each defined STARE index. */
+    vector<size_t> d_num_j; /**< Number of columns of each defined STARE index. */
+    vector<int> d_offsets_varid; /**< Row offsets varid of each packed STARE index, -1 if not packed. */
+    vector<size_t> d_num_rows; /**< Rows written of each defined STARE index. */
+    vector<size_t> d_num_bytes; /**< Bytes written of each packed STARE index. */
 
 public:
     int writeFile(const std::string fileName, int verbose,
@@ -53,17 +141,55 @@ public:
                         vector<size_t> &size_j, vector<string> &variables,
                         vector<int> &stare_varid, int &ncid);
 
-    int createFile(const std::string fileName, int verbose, char *institution);
+    int createFile(const std::string fileName, int verbose, const char *institution);
+
+    /** Rewrite the history attribute of a sidecar file copied from another. */
+    static int rewriteHistory(const std::string fileName);
+
+    /** Set how the variables defined after this are chunked and compressed. */
+    void setLayout(const SidecarLayout &layout) { d_layout = layout; }
 
     int writeSTAREIndex(int verbose, int build_level, int i, int j,
                         double *geo_lat, double *geo_lon, unsigned long long *stare_index,
                         vector<string> var_name, string stare_index_name);
 
+    /** Write a STARE index from a grid. */
+    int writeSTAREIndex(int verbose, int build_level, const GeoGrid &grid,
+                        vector<string> var_name, string stare_index_name);
+
+    /** Define a STARE index, to be written a block of rows at a time. */
+    int defineSTAREIndex(int verbose, int build_level, int i, int j, size_t rows_per_scan,
+                         vector<string> var_name, string stare_index_name, int &index_id);
+
+    /** Write a block of rows of a STARE index. */
+    int writeSTAREIndexRows(int index_id, size_t start_row, size_t num_rows,
+                            const double *geo_lat, const double *geo_lon,
+                            const unsigned long long *stare_index);
+
+    /** Read a block of rows of a STARE index, packed or not. */
+    static int readSTAREIndex(int ncid, int varid, size_t start_row, size_t num_rows,
+                              unsigned long long *stare_index);
+
+    /** Read a window of a STARE index, packed or not, into a caller's buffer. */
+    static int readSTAREIndex(int ncid, int varid, const size_t *start, const size_t *count,
+                              const ptrdiff_t *stride, unsigned long long *stare_index);
+
+    /** Number of rows and columns of a STARE index, packed or not. */
+    static int indexShape(int ncid, int varid, size_t *shape);
+
     int writeSTARECover(int verbose, int stare_cover_size, unsigned long long *stare_cover,
-                        string stare_cover_name);
+                        string stare_cover_name, int stare_cover_level);
 
     /** Close the file. */
     int close_file();
+
+private:
+    int compressVar(int varid);
+    int defineGeoVar(const string &name, const int *dimid, const size_t *chunks,
+                     const char *long_name, const char *units, int &varid);
+    int definePackedIndex(const string &index_name, const string &stare_index_name, size_t i,
+                          size_t j, int i_dimid, size_t chunk_rows, int &index_varid,
+                          int &offsets_varid);
 };
 
 #endif /* SIDECAR_FILE_H_ */
@@ -0,0 +1,84 @@
+/// @file
+/// This class writes the sidecar files of granules on a thread of its
+/// own, while the next granule is read and indexed.
+
+#ifndef SIDECAR_WRITER_H_ /**< Protect file from double include. */
+#define SIDECAR_WRITER_H_
+
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "SidecarFile.h"
+
+class GeoFile;
+class TileCache;
+
+/**
+ * Writes the sidecar files of a run of granules.
+ *
+ * Compressing and writing a sidecar is a large part of the time
+ * taken for a granule, and all of it is spent in one thread in netCDF
+ * and HDF5, while the other cores wait. The writer takes each indexed
+ * GeoFile through a bounded queue and writes it on a thread of its
+ * own, so granule N is written while granule N+1 is read and indexed.
+ *
+ * Each GeoFile is handed over whole: submit() takes ownership, and
+ * the writer deletes it once written. The queue holds queue_size
+ * granules, counting the one being written; with the default of 1 a
+ * granule is written while the next is indexed, and submit() waits
+ * for that write before handing the next one over, so no more than
+ * two granules are ever held. With a queue size of 0 each granule is
+ * written in submit(), as if there were no writer.
+ *
+ * Only the writer thread calls netCDF, so netCDF and HDF5 need not be
+ * thread safe. The first error stops the writer; the granules after
+ * it are dropped, and submit() and finish() return the error.
+ */
+class SidecarWriter {
+public:
+    SidecarWriter(const SidecarLayout &layout, int verbose, int build_level,
+                  const std::string &institution, int queue_size = 1,
+                  const TileCache *cache = NULL);
+
+    ~SidecarWriter();
+
+    /** Hand over a granule to be written. */
+    int submit(GeoFile *gf, const std::string &file_out, const std::string &tile_key = "");
+
+    /** Wait until every granule is written. */
+    int finish();
+
+    /** Write the STARE indices and covers of a granule to an open sidecar file. */
+    static int writeContents(GeoFile &gf, SidecarFile &sf, int verbose, int build_level,
+                             bool write_indices);
+
+private:
+    /** A granule to be written. */
+    struct Job {
+        GeoFile *gf; /**< The granule, owned by the writer. */
+        std::string file_out; /**< Name of the sidecar file. */
+        std::string tile_key; /**< Tile cache key, empty to not store it. */
+    };
+
+    int write(const Job &job);
+    void run();
+
+    SidecarLayout d_layout; /**< How variables are chunked and compressed. */
+    int d_verbose; /**< Non-zero for verbose output. */
+    int d_build_level; /**< STARE build level. */
+    std::string d_institution; /**< Institution attribute of each sidecar. */
+    size_t d_queue_size; /**< Granules held by the writer, 0 to write in submit(). */
+    const TileCache *d_cache; /**< Tile cache to store tile sidecars in, or NULL. */
+
+    std::thread d_thread; /**< The writer thread. */
+    std::mutex d_mutex; /**< Guards the members below. */
+    std::condition_variable d_cond; /**< Signals a change to the members below. */
+    std::deque<Job> d_jobs; /**< Granules waiting to be written. */
+    bool d_writing; /**< Is a granule being written? */
+    bool d_done; /**< Have all granules been handed over? */
+    int d_err; /**< First error, or 0. */
+};
+
+#endif /* SIDECAR_WRITER_H_ */
@@ -0,0 +1,63 @@
+/// @file
+/// Geolocation of the tiles of the MODIS sinusoidal grid, such as the
+/// tiles of MOD09GA.
+
+#ifndef SINUSOIDAL_GRID_H_ /**< Protect file from double include. */
+#define SINUSOIDAL_GRID_H_
+
+#include <cstddef>
+
+class GeoGrid;
+
+#define SSC_SIN_NUM_H 36 /**< Tiles around the sinusoidal grid. */
+#define SSC_SIN_NUM_V 18 /**< Tiles from pole to pole of the sinusoidal grid. */
+#define SSC_SIN_1KM 1200 /**< Pixels along each side of a tile at 1 km. */
+#define SSC_SIN_500M 2400 /**< Pixels along each side of a tile at 500 m. */
+#define SSC_SIN_250M 4800 /**< Pixels along each side of a tile at 250 m. */
+
+/**
+ * Get the bounding lat/lons of a tile of the sinusoidal grid, from
+ * the MODLAND table of tile bounds (sn_bound_10deg.txt), which is
+ * compiled in.
+ *
+ * @param h Horizontal tile number, 0 to 35.
+ * @param v Vertical tile number, 0 to 17.
+ * @param bounds Gets the least and greatest longitude, then the least
+ * and greatest latitude, in degrees.
+ *
+ * @return 0 for success, SSC_EINPUT if there is no such tile or it
+ * lies wholly off the sphere.
+ */
+int sinusoidal_tile_bounds(int h, int v, double bounds[4]);
+
+/**
+ * Compute the lat/lon of the center of each pixel of a tile of the
+ * sinusoidal grid, from the definition of the grid.
+ *
+ * The grid is the sinusoidal projection of a sphere of radius
+ * 6371007.181 m, cut into 36 by 18 square tiles 10 degrees of
+ * latitude on a side. In it y is R lat, and x is R lon cos(lat), so
+ * each row of pixels has one latitude, and longitude goes linearly
+ * across it; a row costs one cosine and a multiply-add per pixel.
+ * Pixels of tiles at the edges of the grid that are off the sphere,
+ * with longitudes past 180 degrees, get SSC_GEO_FILL.
+ *
+ * The rows are done in parallel.
+ *
+ * @param h Horizontal tile number, 0 to 35.
+ * @param v Vertical tile number, 0 to 17.
+ * @param pixels Pixels along each side of the tile, such as
+ * SSC_SIN_1KM.
+ * @param lat Gets pixels * pixels latitudes, row major, in degrees.
+ * @param lon Gets pixels * pixels longitudes, row major, in degrees.
+ * @param num_threads Threads to use.
+ *
+ * @return 0 for success, SSC_EINPUT if there is no such tile.
+ */
+int sinusoidal_tile_geolocation(int h, int v, size_t pixels, double *lat, double *lon,
+                                int num_threads);
+
+/** Compute the lat/lon of the center of each pixel of a tile, into a square GeoGrid. */
+int sinusoidal_tile_geolocation(int h, int v, GeoGrid &grid, int num_threads);
+
+#endif /* SINUSOIDAL_GRID_H_ */
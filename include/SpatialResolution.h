@@ -0,0 +1,48 @@
+/// @file
+/// Estimate the STARE resolution level of each point of a grid, with
+/// the STARE library or from the spacing of its neighbors.
+
+#ifndef SPATIAL_RESOLUTION_H_ /**< Protect file from double include. */
+#define SPATIAL_RESOLUTION_H_
+
+#include <cstddef>
+
+class GeoGrid;
+
+/**
+ * Set the resolution level of the STARE indices of a grid from its
+ * 2-D pixel spacing.
+ *
+ * The level of a point is that of the smallest trixel no smaller than
+ * the largest step to a neighbor: the points before and after it in
+ * its row, and above and below it in its scan. The edge of a level L
+ * trixel is about 90 / 2^L degrees of arc (level 10 ~ 10 km). Swath
+ * scans overlap at the edges (the bow tie), so rows of other scans
+ * are not neighbors; pass num_i as rows_per_scan for a grid with no
+ * scans. Points that are not valid lat/lons, or have no valid
+ * neighbors, keep the level they have.
+ *
+ * The rows are done in parallel, in blocks.
+ *
+ * @return the finest level of any point, or 0 if there is none.
+ */
+int estimate_resolution(const double *lat, const double *lon, size_t num_i, size_t num_j,
+                        size_t rows_per_scan, unsigned long long *index, int num_threads);
+
+/** Set the resolution level of the STARE indices of a GeoGrid. */
+int estimate_resolution(GeoGrid &grid, size_t rows_per_scan, int num_threads);
+
+/**
+ * Set the resolution level of the STARE indices of a grid with
+ * STARE::adaptSpatialResolutionEstimatesInPlace(), one row at a time,
+ * as the readers have always done. Runs of SSC_STARE_NO_TRIXEL split a
+ * row; a point with no neighbor in its run keeps the level it has.
+ *
+ * The rows are done in parallel.
+ *
+ * @return the finest level of any point, or 0 if there is none.
+ */
+int adapt_resolution(unsigned long long *index, size_t num_i, size_t num_j, int level,
+                     int build_level, int num_threads);
+
+#endif /* SPATIAL_RESOLUTION_H_ */
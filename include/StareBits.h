@@ -0,0 +1,95 @@
+/// @file
+/// Helpers for the bit layout of a STARE spatial index.
+///
+/// A STARE spatial index is a 64-bit value. The top two bits are
+/// zero. The next three bits (61-59) select one of the eight root
+/// trixels of the octahedron. Below that each level from 1 to 27 adds
+/// a two bit child number, level 1 in bits 58-57 down to level 27 in
+/// bits 6-5. The low five bits hold the resolution level.
+
+#ifndef STARE_BITS_H_ /**< Protect file from double include. */
+#define STARE_BITS_H_
+
+#define SSC_STARE_MAX_LEVEL 27   /**< Deepest level of the index. */
+#define SSC_STARE_LEVEL_MASK 31ULL /**< Bits holding the resolution level. */
+#define SSC_STARE_FACE_SHIFT 59  /**< Position of the root trixel number. */
+#define SSC_STARE_NUM_FACES 8    /**< Number of root trixels. */
+#define SSC_STARE_LOCATION_BITS 0x3fffffffffffffe0ULL /**< All location bits. */
+#define SSC_STARE_NO_TRIXEL 0xffffffffffffffffULL /**< Not a trixel; top bits are never set. */
+
+/** Shift of the two bit child number added at level (1 to 27). */
+static inline int
+stare_digit_shift(int level) {
+    return SSC_STARE_FACE_SHIFT - 2 * level;
+}
+
+/** Mask for the location bits that identify a trixel at level. */
+static inline unsigned long long
+stare_location_mask(int level) {
+    return SSC_STARE_LOCATION_BITS & ~((1ULL << stare_digit_shift(level)) - 1);
+}
+
+/** Resolution level of an index. */
+static inline int
+stare_level(unsigned long long id) {
+    return (int) (id & SSC_STARE_LEVEL_MASK);
+}
+
+/** Root trixel (0-7) of an index. */
+static inline int
+stare_face(unsigned long long id) {
+    return (int) ((id >> SSC_STARE_FACE_SHIFT) & 7);
+}
+
+/** Child number (0-3) of an index at level (1 to 27). */
+static inline int
+stare_digit(unsigned long long id, int level) {
+    return (int) ((id >> stare_digit_shift(level)) & 3);
+}
+
+/** Replace the resolution level of an index. */
+static inline unsigned long long
+stare_set_level(unsigned long long id, int level) {
+    return (id & ~SSC_STARE_LEVEL_MASK) | (unsigned long long) level;
+}
+
+/** The trixel at level that contains id. */
+static inline unsigned long long
+stare_truncate(unsigned long long id, int level) {
+    return (id & stare_location_mask(level)) | (unsigned long long) level;
+}
+
+/**
+ * The STARE terminator of id: all location bits below its level and
+ * the level bits set to one. An index followed by a terminator is an
+ * interval in STARE_SpatialIntervals.
+ */
+static inline unsigned long long
+stare_terminator(unsigned long long id) {
+    return id | ((1ULL << stare_digit_shift(stare_level(id))) - 1);
+}
+
+/** True if id is a terminator. */
+static inline bool
+stare_is_terminator(unsigned long long id) {
+    return (id & SSC_STARE_LEVEL_MASK) == SSC_STARE_LEVEL_MASK;
+}
+
+/**
+ * Deepest level at which a and b are in the same trixel, or -1 if
+ * they are in different root trixels.
+ */
+static inline int
+stare_common_level(unsigned long long a, unsigned long long b) {
+    unsigned long long x = (a ^ b) & SSC_STARE_LOCATION_BITS;
+    int h;
+
+    if (!x)
+        return SSC_STARE_MAX_LEVEL;
+    h = 63 - __builtin_clzll(x);
+    if (h >= SSC_STARE_FACE_SHIFT)
+        return -1;
+    return (SSC_STARE_FACE_SHIFT - 1 - h) / 2;
+}
+
+#endif /* STARE_BITS_H_ */
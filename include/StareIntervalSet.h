@@ -0,0 +1,85 @@
+/// @file
+/// This class holds a set of STARE trixels as sorted intervals, with
+/// set algebra and fast containment tests.
+
+#ifndef STARE_INTERVAL_SET_H_ /**< Protect file from double include. */
+#define STARE_INTERVAL_SET_H_
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * A set of STARE trixels, such as a cover.
+ *
+ * Every trixel is a range of level 27 trixels, which are numbered in
+ * order by their location bits. The set is kept as sorted, disjoint
+ * ranges [lo, hi) of those numbers, with ranges that touch merged, so
+ * each set has one form however it was made. The starts and ends are
+ * held in separate arrays, so a search only touches the starts.
+ *
+ * Sets are made from, and turned back into, the STARE_SpatialIntervals
+ * form the STARE library and sidecar files use: a list of trixels,
+ * where a trixel followed by a terminator stands for all trixels from
+ * one to the other. A set can also be packed as deltas between range
+ * ends, in variable length bytes, which for a cover is a few bytes a
+ * range.
+ *
+ * Union, intersection and difference are linear merges of the ranges.
+ * Containment uses a binary search without branches; the batch form
+ * steps all queries through the search together, so it vectorizes.
+ */
+class StareIntervalSet {
+public:
+    StareIntervalSet() {}
+
+    /** Make a set from STARE_SpatialIntervals, in any order. */
+    static StareIntervalSet from_intervals(const unsigned long long *values, size_t n);
+
+    /** Make a set from STARE_SpatialIntervals, in any order. */
+    static StareIntervalSet from_intervals(const std::vector<unsigned long long> &values) {
+        return from_intervals(values.data(), values.size());
+    }
+
+    /** Get the set as STARE_SpatialIntervals. */
+    void intervals(std::vector<unsigned long long> &values, int level = 27) const;
+
+    size_t size() const { return d_lo.size(); } /**< Number of ranges. */
+    bool empty() const { return d_lo.empty(); } /**< Is the set empty? */
+    unsigned long long count() const; /**< Number of level 27 trixels in the set. */
+
+    /** Is all of the trixel of id in the set? */
+    bool contains(unsigned long long id) const;
+
+    /** Is any of the trixel of id in the set? */
+    bool intersects(unsigned long long id) const;
+
+    /** Is all of the trixel of each id in the set? */
+    void contains(const unsigned long long *ids, size_t n, unsigned char *out) const;
+
+    StareIntervalSet unite(const StareIntervalSet &other) const; /**< Union. */
+    StareIntervalSet intersect(const StareIntervalSet &other) const; /**< Intersection. */
+    StareIntervalSet subtract(const StareIntervalSet &other) const; /**< Difference. */
+
+    /** The trixels at a coarser level that meet the set. */
+    StareIntervalSet coarsen(int level) const;
+
+    /** Pack the set as variable length deltas. */
+    void compress(std::vector<unsigned char> &bytes) const;
+
+    /** Unpack a set packed by compress(). */
+    int decompress(const unsigned char *bytes, size_t n);
+
+    bool operator==(const StareIntervalSet &other) const {
+        return d_lo == other.d_lo && d_hi == other.d_hi;
+    }
+    bool operator!=(const StareIntervalSet &other) const { return !(*this == other); }
+
+private:
+    void add(unsigned long long lo, unsigned long long hi);
+    size_t upper(unsigned long long p) const;
+
+    std::vector<unsigned long long> d_lo; /**< Start of each range. */
+    std::vector<unsigned long long> d_hi; /**< One past the end of each range. */
+};
+
+#endif /* STARE_INTERVAL_SET_H_ */
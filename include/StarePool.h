@@ -0,0 +1,38 @@
+/// @file
+/// This class keeps a process-wide pool of STARE objects, so that
+/// readers do not have to construct new ones for every granule.
+
+#ifndef STARE_POOL_H_ /**< Protect file from double include. */
+#define STARE_POOL_H_
+
+#include "STARE.h"
+
+/**
+ * A pool of STARE objects, keyed by (level, build_level).
+ *
+ * Constructing a STARE object builds its lookup tree down to
+ * build_level, which is the expensive part of setting one up. The
+ * pool constructs an object the first time a key is asked for and
+ * hands the same object out for the rest of the process.
+ *
+ * One object per key is shared by all threads. Point lookups do not
+ * change a STARE object once the spatial index of each resolution
+ * level has been built, so get() builds them all, under a lock,
+ * before it hands a new object out. Anything a caller needs to
+ * change per point, such as the path of a TrixelIndexer, belongs to
+ * the caller's thread. tst_stare_pool checks that lookups from many
+ * threads on the shared object match the same lookups made serially.
+ */
+class StarePool {
+public:
+    /** Get the shared STARE object for this key. */
+    static STARE &get(int level, int build_level);
+
+    /** Number of STARE objects the pool has constructed. */
+    static int num_constructed();
+
+    /** Drop all the STARE objects. */
+    static void clear();
+};
+
+#endif /* STARE_POOL_H_ */
@@ -0,0 +1,47 @@
+/// @file
+/// This class keeps the sidecar files of fixed grid tiles, so a tile
+/// is only indexed once.
+
+#ifndef TILE_CACHE_H_ /**< Protect file from double include. */
+#define TILE_CACHE_H_
+
+#include <string>
+
+/**
+ * A directory of sidecar files for the tiles of a fixed grid, such as
+ * the MODIS sinusoidal grid of MOD09GA.
+ *
+ * The geolocation of a tile is the same on every day, so its STARE
+ * indices and covers are too. The first sidecar made for a tile is
+ * stored under a key made from everything its contents depend on: the
+ * tile (h, v), the resolutions indexed, the build level, the other
+ * settings, and the version of this package. A sidecar for the same
+ * key is then a copy of the stored file instead of a recomputation.
+ *
+ * Files are stored under a temporary name and renamed into place, so
+ * other processes sharing the directory never see a partly written
+ * one. Sidecars are copied out rather than linked, so overwriting a
+ * sidecar can never change the stored file.
+ */
+class TileCache {
+public:
+    TileCache(const std::string &dir);
+
+    /** Key of a tile sidecar. */
+    static std::string key(const std::string &product, int h, int v, const std::string &resolution,
+                           int build_level, const std::string &settings);
+
+    /** Name of the file stored for a key. */
+    std::string file_name(const std::string &key) const;
+
+    /** Copy the sidecar stored for a key to a file. */
+    int fetch(const std::string &key, const std::string &file_out) const;
+
+    /** Store a sidecar for a key. */
+    int store(const std::string &key, const std::string &file_in) const;
+
+private:
+    std::string d_dir; /**< Cache directory. */
+};
+
+#endif /* TILE_CACHE_H_ */
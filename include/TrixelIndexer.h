@@ -0,0 +1,129 @@
+/// @file
+/// This class computes STARE indices for arrays of lat/lon points.
+
+#ifndef TRIXEL_INDEXER_H_ /**< Protect file from double include. */
+#define TRIXEL_INDEXER_H_
+
+#include <cstddef>
+#include "STARE.h"
+#include "StareBits.h"
+
+/** Number of values TrixelIndexer::geometry() fills in. */
+#define SSC_TRIXEL_GEOMETRY_SIZE (1 + SSC_STARE_NUM_FACES * 9)
+
+class TrixelTable;
+struct RootTrixels;
+
+/** A point on the unit sphere. */
+struct TrixelVector {
+    double x, y, z;
+};
+
+/**
+ * The trixels containing a point, from its root trixel down to some
+ * level, with their vertices. The edge midpoints and the edge normals
+ * of the children tested on the way down are kept so a nearby point
+ * can be checked against the same path cheaply.
+ */
+struct TrixelPath {
+    int depth; /**< Deepest level held, -1 if the path is empty. */
+    int child[SSC_STARE_MAX_LEVEL + 1]; /**< Root face at level 0, child 0-3 below. */
+    unsigned long long prefix[SSC_STARE_MAX_LEVEL + 1]; /**< Location bits at each level. */
+    TrixelVector v[SSC_STARE_MAX_LEVEL + 1][3]; /**< Vertices at each level. */
+    TrixelVector w[SSC_STARE_MAX_LEVEL][3]; /**< Edge midpoints at each level above depth. */
+    TrixelVector n[SSC_STARE_MAX_LEVEL][4][3]; /**< Edge normals of the children of each level. */
+    int num_normals[SSC_STARE_MAX_LEVEL][4]; /**< How many of those normals are set. */
+};
+
+/**
+ * Compute STARE indices for arrays of lat/lon points.
+ *
+ * The points are first converted to unit vectors in bulk, with a
+ * kernel that is compiled for AVX-512, AVX2 and plain x86-64 and
+ * picked at run time. Each vector is then located by walking down the
+ * trixel tree the way HTM does, starting from the root trixel vertices
+ * that the STARE library reports.
+ *
+ * Near level 27 the trixels are so small that which child HTM picks
+ * depends on the tolerance and order of its tests, not just on where
+ * the point is, so the walk repeats HTM's arithmetic step for step:
+ * the same tolerance, and vertices and edge normals computed the same
+ * way. Only the point vectors differ from the library's, by a bounded
+ * amount, and any test that bound makes too close to call sends the
+ * point to STARE::ValueFromLatLonDegrees(). Every index is therefore
+ * the one the library would give. The first TrixelIndexer in a
+ * process also checks the walk against the library on a set of test
+ * points; if any differ, all points go to the library, as they do
+ * when the resolution differs from the search level.
+ *
+ * Neighboring points in a swath row nearly always share most of their
+ * trixels. By default each point starts from the path of the point
+ * before it: the levels of that path that HTM would also pick for the
+ * new point are kept, found by repeating the saved tests of each
+ * level, and only the rest is walked. The results are the same as
+ * walking from the root.
+ *
+ * With a TrixelTable set, each point instead starts from the trixel
+ * the table gives for its lat/lon cell, and the previous point's path
+ * is only used below that.
+ *
+ * refine() takes a hint for each point, such as the trixel of the
+ * coarser pixel it was interpolated from, so finer grids can be
+ * indexed down from a coarser one.
+ *
+ * A TrixelIndexer is not thread safe; use one per thread.
+ */
+class TrixelIndexer {
+public:
+    TrixelIndexer(int level, int build_level);
+
+    /** Compute STARE indices for n points. */
+    void index(const double *lat, const double *lon, size_t n, int resolution,
+               unsigned long long *out);
+
+    /** Compute STARE indices for n points, starting from trixels they are likely in. */
+    void refine(const double *lat, const double *lon, const unsigned long long *hint, size_t n,
+                int resolution, unsigned long long *out);
+
+    /** Compute the STARE index of one point. */
+    unsigned long long index(double lat, double lon, int resolution);
+
+    /** Convert lat/lon degrees to unit vectors. */
+    static void latlon_to_vectors(const double *lat, const double *lon, size_t n,
+                                  double *x, double *y, double *z);
+
+    /** True if the trixel walk agrees with the STARE library. */
+    static bool geometry_ok();
+
+    /** Deepest trixel the walk reaches for every point of a lat/lon cell. */
+    static unsigned long long cell_trixel(double lat0, double lat1, double lon0, double lon1,
+                                          int max_level);
+
+    /** Tolerance and root trixel vertices used by the walk. */
+    static void geometry(double *geometry);
+
+    /** Start points from the trixels in a lookup table, NULL for none. */
+    void set_table(const TrixelTable *table) { d_table = table; }
+
+    /** Start each point from the previous point's trixels, or from the root. */
+    void set_seeded(bool seeded) { d_seeded = seeded; }
+
+    /** Number of points handed to the STARE library so far. */
+    size_t num_fallback() const { return d_num_fallback; }
+
+private:
+    bool locate(const TrixelVector &p, TrixelPath &path, int from);
+    int start_level(const RootTrixels &roots, const TrixelVector &p, double lat, double lon,
+                    unsigned long long hint);
+    void index_points(const double *lat, const double *lon, const unsigned long long *hint,
+                      size_t n, int resolution, unsigned long long *out);
+
+    STARE &d_stare; /**< Pool STARE object, for points near edges. */
+    int d_level; /**< Search level. */
+    size_t d_num_fallback; /**< Points handed to the library. */
+    bool d_seeded; /**< Start from the previous point's path. */
+    const TrixelTable *d_table; /**< Lookup table of start trixels, or NULL. */
+    TrixelPath d_path; /**< Path of the last point located. */
+};
+
+#endif /* TRIXEL_INDEXER_H_ */
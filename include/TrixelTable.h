@@ -0,0 +1,59 @@
+/// @file
+/// This class holds a lookup table from lat/lon cells to the trixels
+/// where STARE index computation can start.
+
+#ifndef TRIXEL_TABLE_H_ /**< Protect file from double include. */
+#define TRIXEL_TABLE_H_
+
+#include <string>
+#include <cstddef>
+
+#define SSC_TRIXEL_TABLE_CELL 0.1 /**< Size of a table cell, in degrees. */
+
+/**
+ * A lookup table from lat/lon cells to trixels.
+ *
+ * The globe is cut into cells of SSC_TRIXEL_TABLE_CELL degrees. Each
+ * cell holds the deepest trixel that HTM's walk, and so the STARE
+ * library, reaches for every point of the cell, with room for rounding
+ * in the point vectors, so the walk in TrixelIndexer can start there
+ * instead of at the root without changing any index. Cells that
+ * straddle root trixels hold SSC_STARE_NO_TRIXEL.
+ *
+ * A table is built once for each (level, build_level) and kept as a
+ * file in a table directory, which later runs, in this process or
+ * others, map into memory instead of building it again. The file
+ * records the geometry the walk used; if that no longer matches, the
+ * table is built again.
+ *
+ * Tables are read-only once made, and may be shared by all threads.
+ */
+class TrixelTable {
+public:
+    ~TrixelTable();
+
+    /** Get the table for (level, build_level) from a table directory. */
+    static int get(const std::string &dir, int level, int build_level, const TrixelTable **table);
+
+    /** Start trixel for a point. */
+    unsigned long long lookup(double lat, double lon) const;
+
+    /** Name of the table file. */
+    const std::string &file_name() const { return d_file_name; }
+
+private:
+    TrixelTable();
+
+    int map(const std::string &file_name, int level, int build_level, bool &stale);
+    static int build(const std::string &file_name, int level, int build_level);
+
+    std::string d_file_name; /**< Table file. */
+    void *d_map; /**< Mapped file. */
+    size_t d_map_size; /**< Size of the mapping. */
+    const unsigned long long *d_cell; /**< Trixel of each cell, by row of latitude. */
+    int d_num_lat; /**< Rows of cells. */
+    int d_num_lon; /**< Cells in each row. */
+    double d_cell_size; /**< Size of a cell, in degrees. */
+};
+
+#endif /* TRIXEL_TABLE_H_ */
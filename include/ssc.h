@@ -7,6 +7,7 @@
 #define SSC_ENETCDF  1001
 #define SSC_ENOMEM   1002
 #define SSC_EINPUT   1003
+#define SSC_EFILE    1004
 
 #define SSC_DEFAULT_BUILD_LEVEL 5
 
@@ -26,12 +27,21 @@
 #define SSC_LONG_NAME "long_name"
 #define SSC_INDEX_LONG_NAME "SpatioTemporal Adaptive Resolution Encoding (STARE) index"
 #define SSC_COVER_LONG_NAME "SpatioTemporal Adaptive Resolution Encoding (STARE) cover"
+#define SSC_COVER_LEVEL_NAME "stare_cover_level"
 #define SSC_LAT_LONG_NAME "latitude"
 #define SSC_LON_LONG_NAME "longitude"
 #define SSC_UNITS "units"
 #define SSC_LAT_UNITS "degrees_north"
 #define SSC_LON_UNITS "degrees_east"
 #define SSC_INDEX_VAR_ATT_NAME "variables"
+#define SSC_GEO_PRECISION_NAME "geo_precision" /**< Attribute with the precision of a lat/lon kept as less than an exact double. */
+#define SSC_INDEX_CODEC_NAME "stare_codec" /**< Attribute naming the codec of a packed STARE index. */
+#define SSC_INDEX_CODEC "xor_bitpack" /**< Codec of PackedStareIndex. */
+#define SSC_INDEX_SHAPE_NAME "stare_index_shape" /**< Attribute with the rows and columns of a packed STARE index. */
+#define SSC_INDEX_OFFSETS_ATT_NAME "row_offsets" /**< Attribute naming the row offsets of a packed STARE index. */
+#define SSC_OFFSETS_NAME "STARE_row_offsets"
+#define SSC_OFFSETS_LONG_NAME "byte offset of each row of a packed STARE index"
+#define SSC_B_NAME "b"
 #define SSC_NUM_GRING 4
 #define SSC_MOD05 "mod05"
 #define SSC_TITLE_NAME "title"
@@ -43,4 +53,15 @@
 
 #define SSC_NOT_SIDECAR (-1001)
 
+#define SSC_GEO_FILL (-999.0) /**< Lat/lon of a pixel without geolocation. */
+
+// Build vector kernels for several instruction sets and let the
+// loader pick the best one for the machine we are running on.
+#if defined(__linux__) && (defined(__x86_64__) || defined(__i386__)) && \
+    ((defined(__clang__) && __clang_major__ >= 14) || (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 6))
+#define SSC_TARGET_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define SSC_TARGET_CLONES
+#endif
+
 
@@ -0,0 +1,64 @@
+/// @file
+/// This class writes a file under a temporary name and renames it
+/// into place once it is complete.
+
+#include "config.h"
+#include "AtomicFile.h"
+#include "ssc.h"
+#include <sstream>
+#include <unistd.h>
+
+/**
+ * A file to write.
+ *
+ * @param file_name Name of the file once it is written.
+ */
+AtomicFile::AtomicFile(const std::string &file_name) : d_file_name(file_name), d_fp(NULL) {
+    std::ostringstream tmp;
+    tmp << file_name << ".tmp" << getpid();
+    d_tmp_name = tmp.str();
+}
+
+/**
+ * Remove the temporary file, if it was not renamed into place.
+ */
+AtomicFile::~AtomicFile() {
+    if (d_fp) {
+        fclose(d_fp);
+        remove(d_tmp_name.c_str());
+    }
+}
+
+/**
+ * Open the temporary file for writing.
+ *
+ * @return the file, or NULL if it can't be created.
+ */
+FILE *
+AtomicFile::open() {
+    d_fp = fopen(d_tmp_name.c_str(), "wb");
+    return d_fp;
+}
+
+/**
+ * Close the temporary file and, if everything was written, rename it
+ * into place. Otherwise the temporary file is removed.
+ *
+ * @param ok True if everything was written.
+ *
+ * @return 0 for success, SSC_EFILE if the file was not written,
+ * can't be closed, or can't be renamed.
+ */
+int
+AtomicFile::commit(bool ok) {
+    if (!d_fp)
+        return SSC_EFILE;
+    int ret = fclose(d_fp);
+    d_fp = NULL;
+    if (ret || !ok || rename(d_tmp_name.c_str(), d_file_name.c_str())) {
+        remove(d_tmp_name.c_str());
+        return SSC_EFILE;
+    }
+
+    return 0;
+}
@@ -0,0 +1,172 @@
+/// @file
+/// This class builds the STARE cover of a grid from the indices of
+/// its points.
+
+#include "config.h"
+#include "CoverBuilder.h"
+#include "GeoGrid.h"
+#include "StareBits.h"
+#include "StareIntervalSet.h"
+#include <algorithm>
+#include <cmath>
+
+#define RADIX_BITS 8 /**< Bits sorted in each radix pass. */
+#define RADIX (1 << RADIX_BITS) /**< Buckets in each radix pass. */
+#define COMPACT_MIN (1 << 20) /**< Unsorted trixels kept before compacting. */
+
+/**
+ * Sort trixels on key_bits bits from key_shift up, with a parallel
+ * LSD radix sort. The array is cut into one chunk for each thread;
+ * each pass counts the digits of every chunk, then each chunk
+ * scatters its values to where the counts say, keeping their order.
+ *
+ * @param a Values to sort.
+ * @param key_shift Lowest bit of the key.
+ * @param key_bits Number of bits in the key.
+ * @param num_threads Number of threads to use.
+ */
+static void
+radix_sort(std::vector<unsigned long long> &a, int key_shift, int key_bits, int num_threads) {
+    size_t n = a.size();
+    int num_chunks = std::max(num_threads, 1);
+    std::vector<unsigned long long> b(n);
+    std::vector<size_t> count((size_t) num_chunks * RADIX);
+
+    for (int shift = key_shift; shift < key_shift + key_bits; shift += RADIX_BITS) {
+        std::fill(count.begin(), count.end(), 0);
+
+#pragma omp parallel for num_threads(num_chunks) schedule(static, 1)
+        for (int c = 0; c < num_chunks; c++) {
+            size_t *cnt = &count[(size_t) c * RADIX];
+            for (size_t k = n * c / num_chunks; k < n * (c + 1) / num_chunks; k++)
+                cnt[(a[k] >> shift) & (RADIX - 1)]++;
+        }
+
+        // Each chunk's place for a digit is after all smaller digits,
+        // and after that digit in the chunks before it.
+        size_t offset = 0;
+        for (int d = 0; d < RADIX; d++) {
+            for (int c = 0; c < num_chunks; c++) {
+                size_t m = count[(size_t) c * RADIX + d];
+                count[(size_t) c * RADIX + d] = offset;
+                offset += m;
+            }
+        }
+
+#pragma omp parallel for num_threads(num_chunks) schedule(static, 1)
+        for (int c = 0; c < num_chunks; c++) {
+            size_t *pos = &count[(size_t) c * RADIX];
+            for (size_t k = n * c / num_chunks; k < n * (c + 1) / num_chunks; k++)
+                b[pos[(a[k] >> shift) & (RADIX - 1)]++] = a[k];
+        }
+        a.swap(b);
+    }
+}
+
+/**
+ * Set up a cover.
+ *
+ * @param level Cover level, 0 to 27, or -1 to set it later with
+ * set_level(), before any points are added.
+ * @param num_threads Number of threads to use.
+ */
+CoverBuilder::CoverBuilder(int level, int num_threads) :
+    d_level(level), d_num_threads(std::max(num_threads, 1)), d_num_sorted(0) {
+}
+
+/**
+ * Set the cover level. The trixels already added are truncated to
+ * it, so it may only be coarser than the level they were added at.
+ *
+ * @param level Cover level, 0 to 27.
+ */
+void
+CoverBuilder::set_level(int level) {
+    if (d_level >= 0 && level < d_level) {
+        for (size_t k = 0; k < d_trixels.size(); k++)
+            d_trixels[k] = stare_truncate(d_trixels[k], level);
+        d_num_sorted = 0;
+    }
+    d_level = level;
+}
+
+/**
+ * Add the trixels of n points. The cover level must be set.
+ *
+ * @param lat Latitudes of the points. Points that are not valid
+ * latitudes are left out.
+ * @param index STARE indices of the points.
+ * @param n Number of points.
+ */
+void
+CoverBuilder::add(const double *lat, const unsigned long long *index, size_t n) {
+    int num_chunks = d_num_threads;
+    std::vector<std::vector<unsigned long long> > part(num_chunks);
+
+#pragma omp parallel for num_threads(num_chunks) schedule(static, 1)
+    for (int c = 0; c < num_chunks; c++) {
+        std::vector<unsigned long long> &out = part[c];
+        unsigned long long last = SSC_STARE_NO_TRIXEL;
+
+        for (size_t k = n * c / num_chunks; k < n * (c + 1) / num_chunks; k++) {
+            if (!(std::fabs(lat[k]) <= 90.0))
+                continue;
+            unsigned long long t = stare_truncate(index[k], d_level);
+            if (t != last)
+                out.push_back(last = t);
+        }
+    }
+
+    for (int c = 0; c < num_chunks; c++)
+        d_trixels.insert(d_trixels.end(), part[c].begin(), part[c].end());
+    if (d_trixels.size() - d_num_sorted > std::max(d_num_sorted, (size_t) COMPACT_MIN))
+        compact();
+}
+
+/**
+ * Add the trixels of every point of a grid.
+ *
+ * @param grid The grid, with its indices computed.
+ */
+void
+CoverBuilder::add(const GeoGrid &grid) {
+    add(grid.lat().data(), grid.index().data(), grid.size());
+}
+
+/** Sort the trixels added and remove duplicates. */
+void
+CoverBuilder::compact() {
+    if (d_trixels.empty())
+        return;
+    radix_sort(d_trixels, stare_digit_shift(d_level), SSC_STARE_FACE_SHIFT + 3 -
+               stare_digit_shift(d_level), d_num_threads);
+    d_trixels.erase(std::unique(d_trixels.begin(), d_trixels.end()), d_trixels.end());
+    d_num_sorted = d_trixels.size();
+}
+
+/**
+ * Get the cover as a set of trixels.
+ *
+ * @param set Gets the trixels of the points.
+ */
+void
+CoverBuilder::trixels(StareIntervalSet &set) {
+    compact();
+    set = StareIntervalSet::from_intervals(d_trixels);
+}
+
+/**
+ * Get the cover. Each run of trixels that follow one another is one
+ * coarser trixel if it is exactly that trixel's descendants at the
+ * cover level, a trixel if it is only one, and otherwise its first
+ * trixel followed by the terminator of its last one.
+ *
+ * @param cover Gets the cover, in STARE_SpatialIntervals form.
+ */
+void
+CoverBuilder::intervals(std::vector<unsigned long long> &cover) {
+    StareIntervalSet set;
+
+    trixels(set);
+    set.intervals(cover, d_level);
+}
@@ -0,0 +1,427 @@
+/// @file
+/// This class reads and writes sidecar files in a flat binary format
+/// that is mapped into memory and read without a copy.
+
+#include "config.h"
+#include "FlatSidecar.h"
+#include "AtomicFile.h"
+#include "SidecarFile.h"
+#include "ssc.h"
+#include <netcdf.h>
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define FLAT_MAGIC "SSCFLAT\n" /**< First eight bytes of a flat sidecar. */
+#define FLAT_BYTE_ORDER 0x01020304 /**< Reads back the same only in the byte order it was written in. */
+#define FLAT_VALUE_BYTES 8 /**< Bytes of each value, a 64-bit STARE value or a double. */
+
+/** Start of a flat sidecar. The entries follow it. */
+struct FlatHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t num_arrays;
+    uint64_t file_size;
+};
+
+/** Where an array is in a flat sidecar. Offsets are from the start of the file. */
+struct FlatEntry {
+    uint32_t kind;
+    int32_t level;
+    uint64_t num_i;
+    uint64_t num_j;
+    uint64_t offset;
+    uint64_t name_offset;
+    uint64_t name_len;
+    uint64_t variables_offset;
+    uint64_t variables_len;
+};
+
+/** Round up to the alignment of an array. */
+static uint64_t
+align(uint64_t offset) {
+    return (offset + SSC_FLAT_ALIGN - 1) / SSC_FLAT_ALIGN * SSC_FLAT_ALIGN;
+}
+
+/** Is [offset, offset + len) within a file of size bytes? */
+static bool
+in_file(uint64_t offset, uint64_t len, uint64_t size) {
+    return offset <= size && len <= size - offset;
+}
+
+FlatSidecar::FlatSidecar() : d_map(NULL), d_map_size(0) {
+}
+
+FlatSidecar::~FlatSidecar() {
+    close();
+}
+
+/**
+ * Map a flat sidecar file into memory, and check its header.
+ *
+ * @param file_name The flat sidecar file.
+ *
+ * @return 0 for success, SSC_EFILE if the file can't be read, or is
+ * not a flat sidecar of this version and byte order.
+ */
+int
+FlatSidecar::open(const std::string &file_name) {
+    struct stat st;
+    int fd;
+
+    close();
+    if ((fd = ::open(file_name.c_str(), O_RDONLY)) < 0)
+        return SSC_EFILE;
+    if (fstat(fd, &st) || (size_t) st.st_size < sizeof(FlatHeader)) {
+        ::close(fd);
+        return SSC_EFILE;
+    }
+
+    void *m = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (m == MAP_FAILED)
+        return SSC_EFILE;
+    d_map = m;
+    d_map_size = st.st_size;
+
+    const char *base = (const char *) m;
+    const FlatHeader *h = (const FlatHeader *) m;
+    if (memcmp(h->magic, FLAT_MAGIC, sizeof(h->magic)) || h->version != SSC_FLAT_VERSION ||
+        h->byte_order != FLAT_BYTE_ORDER || h->file_size != d_map_size ||
+        h->num_arrays > (d_map_size - sizeof(FlatHeader)) / sizeof(FlatEntry)) {
+        close();
+        return SSC_EFILE;
+    }
+
+    const FlatEntry *e = (const FlatEntry *) (h + 1);
+    for (uint64_t k = 0; k < h->num_arrays; k++) {
+        FlatArray a;
+
+        if (e[k].kind > SSC_FLAT_COVER || e[k].offset % SSC_FLAT_ALIGN ||
+            (e[k].num_j && e[k].num_i > UINT64_MAX / FLAT_VALUE_BYTES / e[k].num_j) ||
+            !in_file(e[k].offset, e[k].num_i * e[k].num_j * FLAT_VALUE_BYTES, d_map_size) ||
+            !in_file(e[k].name_offset, e[k].name_len, d_map_size) ||
+            !in_file(e[k].variables_offset, e[k].variables_len, d_map_size)) {
+            close();
+            return SSC_EFILE;
+        }
+        a.kind = e[k].kind;
+        a.name.assign(base + e[k].name_offset, e[k].name_len);
+        a.variables.assign(base + e[k].variables_offset, e[k].variables_len);
+        a.level = e[k].level;
+        a.num_i = e[k].num_i;
+        a.num_j = e[k].num_j;
+        a.data = base + e[k].offset;
+        d_arrays.push_back(a);
+    }
+
+    return 0;
+}
+
+/**
+ * Unmap the file.
+ */
+void
+FlatSidecar::close() {
+    if (d_map)
+        munmap(d_map, d_map_size);
+    d_map = NULL;
+    d_map_size = 0;
+    d_arrays.clear();
+}
+
+/**
+ * Find an array by kind and name.
+ *
+ * @param kind Kind of the array, such as SSC_FLAT_INDEX.
+ * @param name Name of the index or cover, such as "1km".
+ *
+ * @return the array, or NULL if there is none.
+ */
+const FlatArray *
+FlatSidecar::find(int kind, const std::string &name) const {
+    for (size_t k = 0; k < d_arrays.size(); k++)
+        if (d_arrays[k].kind == kind && d_arrays[k].name == name)
+            return &d_arrays[k];
+    return NULL;
+}
+
+/**
+ * Find the STARE index that applies to a data variable, as
+ * GeoFile::get_stare_indices() does in a netCDF sidecar.
+ *
+ * @param var_name Name of the data variable.
+ *
+ * @return the index, or NULL if there is none.
+ */
+const FlatArray *
+FlatSidecar::find_index(const std::string &var_name) const {
+    for (size_t k = 0; k < d_arrays.size(); k++)
+        if (d_arrays[k].kind == SSC_FLAT_INDEX &&
+            d_arrays[k].variables.find(var_name) != std::string::npos)
+            return &d_arrays[k];
+    return NULL;
+}
+
+/**
+ * Write a flat sidecar file. The file is written under a temporary
+ * name and renamed into place, so readers never map a partly written
+ * file.
+ *
+ * @param file_name The flat sidecar file.
+ * @param arrays The arrays, in the order to keep them.
+ *
+ * @return 0 for success, error code otherwise.
+ */
+int
+FlatSidecar::write(const std::string &file_name, const std::vector<FlatArray> &arrays) {
+    FlatHeader h;
+    std::vector<FlatEntry> e(arrays.size());
+    std::string strings;
+
+    // The names follow the entries, and the arrays the names.
+    uint64_t offset = sizeof(FlatHeader) + e.size() * sizeof(FlatEntry);
+    for (size_t k = 0; k < arrays.size(); k++) {
+        if (arrays[k].kind < SSC_FLAT_INDEX || arrays[k].kind > SSC_FLAT_COVER)
+            return SSC_EINPUT;
+        memset(&e[k], 0, sizeof(FlatEntry));
+        e[k].kind = arrays[k].kind;
+        e[k].level = arrays[k].level;
+        e[k].num_i = arrays[k].num_i;
+        e[k].num_j = arrays[k].num_j;
+        e[k].name_offset = offset + strings.size();
+        e[k].name_len = arrays[k].name.size();
+        strings += arrays[k].name;
+        e[k].variables_offset = offset + strings.size();
+        e[k].variables_len = arrays[k].variables.size();
+        strings += arrays[k].variables;
+    }
+    offset += strings.size();
+    for (size_t k = 0; k < arrays.size(); k++) {
+        e[k].offset = align(offset);
+        offset = e[k].offset + arrays[k].size() * FLAT_VALUE_BYTES;
+    }
+
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, FLAT_MAGIC, sizeof(h.magic));
+    h.version = SSC_FLAT_VERSION;
+    h.byte_order = FLAT_BYTE_ORDER;
+    h.num_arrays = arrays.size();
+    h.file_size = offset;
+
+    AtomicFile out(file_name);
+    FILE *fp = out.open();
+    if (!fp)
+        return SSC_EFILE;
+    static const char zeros[SSC_FLAT_ALIGN] = {0};
+    uint64_t written = sizeof(h) + e.size() * sizeof(FlatEntry) + strings.size();
+    bool ok = fwrite(&h, sizeof(h), 1, fp) == 1 &&
+              (e.empty() || fwrite(&e[0], sizeof(FlatEntry), e.size(), fp) == e.size()) &&
+              fwrite(strings.data(), 1, strings.size(), fp) == strings.size();
+    for (size_t k = 0; k < arrays.size() && ok; k++) {
+        size_t pad = e[k].offset - written;
+        size_t n = arrays[k].size();
+        ok = fwrite(zeros, 1, pad, fp) == pad &&
+             (!n || fwrite(arrays[k].data, FLAT_VALUE_BYTES, n, fp) == n);
+        written = e[k].offset + n * FLAT_VALUE_BYTES;
+    }
+
+    return out.commit(ok);
+}
+
+/**
+ * Get a text attribute of any length, without the NUL the sidecar
+ * writer adds.
+ */
+static int
+get_text_att(int ncid, int varid, const char *name, std::string &value) {
+    size_t len;
+    int ret;
+
+    if ((ret = nc_inq_attlen(ncid, varid, name, &len)))
+        return ret;
+    std::vector<char> text(len + 1, 0);
+    if ((ret = nc_get_att_text(ncid, varid, name, &text[0])))
+        return ret;
+    value = &text[0];
+
+    return 0;
+}
+
+/**
+ * Read the STARE indices, with their lat/lons, and the covers of a
+ * netCDF sidecar.
+ */
+static int
+read_netcdf(int ncid, int num_index, const vector<string> &index_name,
+            const vector<size_t> &size_i, const vector<size_t> &size_j,
+            const vector<string> &variables, const vector<int> &index_varid,
+            std::vector<FlatArray> &arrays, std::vector<std::vector<unsigned long long> > &values,
+            std::vector<std::vector<double> > &geo) {
+    const size_t prefix = strlen(SSC_INDEX_NAME) + 1;
+    int nvars, varid;
+    int ret;
+
+    for (int k = 0; k < num_index; k++) {
+        FlatArray a;
+        a.kind = SSC_FLAT_INDEX;
+        a.name = index_name[k].substr(prefix);
+        a.variables = variables[k];
+        a.level = -1;
+        a.num_i = size_i[k];
+        a.num_j = size_j[k];
+
+        values.push_back(std::vector<unsigned long long>(a.size()));
+        if (a.size() && (ret = SidecarFile::readSTAREIndex(ncid, index_varid[k], 0, a.num_i,
+                                                           &values.back()[0])))
+            return ret;
+        arrays.push_back(a);
+
+        // The lat/lons, read as doubles whatever their precision.
+        const char *geo_name[2] = {SSC_LAT_NAME, SSC_LON_NAME};
+        for (int g = 0; g < 2; g++) {
+            a.kind = g ? SSC_FLAT_LONGITUDE : SSC_FLAT_LATITUDE;
+            a.variables.clear();
+            geo.push_back(std::vector<double>(a.size()));
+            if ((ret = nc_inq_varid(ncid, (string(geo_name[g]) + "_" + a.name).c_str(), &varid)))
+                return ret;
+            if (a.size() && (ret = nc_get_var_double(ncid, varid, &geo.back()[0])))
+                return ret;
+            arrays.push_back(a);
+        }
+    }
+
+    // The covers.
+    if ((ret = nc_inq(ncid, NULL, &nvars, NULL, NULL)))
+        return ret;
+    for (int v = 0; v < nvars; v++) {
+        char var_name[NC_MAX_NAME + 1];
+        string long_name;
+        int dimid;
+        FlatArray a;
+
+        if (get_text_att(ncid, v, SSC_LONG_NAME, long_name) || long_name != SSC_COVER_LONG_NAME)
+            continue;
+        if ((ret = nc_inq_var(ncid, v, var_name, NULL, NULL, &dimid, NULL)))
+            return ret;
+        a.kind = SSC_FLAT_COVER;
+        a.name = string(var_name).substr(strlen(SSC_COVER_NAME) + 1);
+        if (nc_get_att_int(ncid, v, SSC_COVER_LEVEL_NAME, &a.level))
+            a.level = -1;
+        if ((ret = nc_inq_dimlen(ncid, dimid, &a.num_i)))
+            return ret;
+        a.num_j = 1;
+
+        values.push_back(std::vector<unsigned long long>(a.size()));
+        if (a.size() && (ret = nc_get_var_ulonglong(ncid, v, &values.back()[0])))
+            return ret;
+        arrays.push_back(a);
+    }
+
+    return 0;
+}
+
+/**
+ * Make a flat sidecar from a netCDF sidecar. It holds each STARE
+ * index, its lat/lons, as doubles, and each cover, in the order of the
+ * netCDF sidecar.
+ *
+ * @param nc_file The netCDF sidecar file.
+ * @param flat_file The flat sidecar file to write.
+ *
+ * @return 0 for success, error code otherwise.
+ */
+int
+FlatSidecar::fromNetcdf(const std::string &nc_file, const std::string &flat_file) {
+    SidecarFile sf;
+    int ncid, num_index;
+    vector<string> index_name, variables;
+    vector<size_t> size_i, size_j;
+    vector<int> index_varid;
+    std::vector<FlatArray> arrays;
+    std::vector<std::vector<unsigned long long> > values;
+    std::vector<std::vector<double> > geo;
+    int ret;
+
+    if ((ret = sf.read_sidecar_file(nc_file, 0, num_index, index_name, size_i, size_j, variables,
+                                    index_varid, ncid)))
+        return ret;
+    ret = read_netcdf(ncid, num_index, index_name, size_i, size_j, variables, index_varid, arrays,
+                      values, geo);
+    nc_close(ncid);
+    if (ret)
+        return ret;
+
+    // Point each array at its values, now that none will move.
+    size_t v = 0, g = 0;
+    for (size_t k = 0; k < arrays.size(); k++) {
+        if (arrays[k].kind == SSC_FLAT_INDEX || arrays[k].kind == SSC_FLAT_COVER)
+            arrays[k].data = values[v++].data();
+        else
+            arrays[k].data = geo[g++].data();
+    }
+
+    return write(flat_file, arrays);
+}
+
+/**
+ * Make a netCDF sidecar from a flat sidecar. The global attributes are
+ * those of a new sidecar, without an institution.
+ *
+ * @param flat_file The flat sidecar file.
+ * @param nc_file The netCDF sidecar file to write.
+ * @param layout How the variables are chunked and compressed.
+ *
+ * @return 0 for success, error code otherwise.
+ */
+int
+FlatSidecar::toNetcdf(const std::string &flat_file, const std::string &nc_file,
+                      const SidecarLayout &layout) {
+    FlatSidecar flat;
+    SidecarFile sf;
+    int ret;
+
+    if ((ret = flat.open(flat_file)))
+        return ret;
+    sf.setLayout(layout);
+    if ((ret = sf.createFile(nc_file, 0, NULL)))
+        return ret;
+
+    for (size_t k = 0; k < flat.num_arrays(); k++) {
+        const FlatArray &a = flat.array(k);
+        if (a.kind != SSC_FLAT_INDEX)
+            continue;
+        const FlatArray *lat = flat.find(SSC_FLAT_LATITUDE, a.name);
+        const FlatArray *lon = flat.find(SSC_FLAT_LONGITUDE, a.name);
+        if (!lat || !lon || lat->size() != a.size() || lon->size() != a.size()) {
+            sf.close_file();
+            return SSC_EFILE;
+        }
+        // The writer only reads the values, which are in the read-only mapping.
+        if ((ret = sf.writeSTAREIndex(0, SSC_DEFAULT_BUILD_LEVEL, a.num_i, a.num_j,
+                                      const_cast<double *>(lat->geo()),
+                                      const_cast<double *>(lon->geo()),
+                                      const_cast<unsigned long long *>(a.values()),
+                                      vector<string>(1, a.variables), a.name))) {
+            sf.close_file();
+            return ret;
+        }
+    }
+    for (size_t k = 0; k < flat.num_arrays(); k++) {
+        const FlatArray &a = flat.array(k);
+        if (a.kind != SSC_FLAT_COVER)
+            continue;
+        if ((ret = sf.writeSTARECover(0, a.size(), const_cast<unsigned long long *>(a.values()),
+                                      a.name, a.level))) {
+            sf.close_file();
+            return ret;
+        }
+    }
+
+    return sf.close_file();
+}
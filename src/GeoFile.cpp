@@ -74,7 +74,22 @@ Options:
 #include "config.h"
 #include "GeoFile.h"
 #include "SidecarFile.h"
+#include "TrixelTable.h"
+#include "CoverBuilder.h"
+#include "StareIntervalSet.h"
+#include "PerimeterWalker.h"
+#include "SpatialResolution.h"
+#include "StareBits.h"
+#include "StarePool.h"
 #include <netcdf.h>
+#include <algorithm>
+#include <chrono>
+
+#ifdef HAVE_OPENMP
+#include <omp.h>
+#endif
+
+#define BUDGET_START_LEVEL 5 /**< Level a hull cover under a budget starts at. */
 
 /** Construct a GeoFile.
  *
@@ -82,6 +97,13 @@ Options:
  */
 GeoFile::GeoFile() {
     d_num_index = 0;
+    num_threads = 0;
+    fine_grids = false;
+    exact_cover = false;
+    spacing_resolution = false;
+    perimeter_tolerance = 0.0;
+    max_cover_values = 0;
+    max_cover_seconds = 0.0;
 }
 
 /** Destroy a GeoFile.
@@ -182,21 +204,75 @@ GeoFile::get_stare_indices(const std::string varName, int ncid, vector<unsigned
             my_size_i = d_size_i.at(v);
             my_size_j = d_size_j.at(v);
 
-            // Copy the variables stare index data.
+            // Copy the variables stare index data, unpacking it if it
+            // was packed.
             {
-                unsigned long long *data;
-                if (!(data = (unsigned long long *) malloc(my_size_i * my_size_j * sizeof(unsigned long long))))
-                    return 99;
-                if ((ret = nc_get_var(ncid, varid, data)))
+                size_t first = values.size();
+                values.resize(first + my_size_i * my_size_j);
+                if ((ret = SidecarFile::readSTAREIndex(ncid, varid, 0, my_size_i, &values[first])))
                     return ret;
-                values.insert(values.end(), &data[0], &data[my_size_i * my_size_j]);
-                free(data);
             }
         }
     }
     return 0;
 }
 
+/**
+ * Get a window of the STARE indices for a data variable, optionally
+ * taking every n-th row and column, read straight into the caller's
+ * buffer. Only the window is read, so a few rows cost only those rows.
+ *
+ * @param varName Name of the data variable.
+ * @param ncid ID of the sidecar file, opened with read_sidecar_file().
+ * @param start First row and column of the window.
+ * @param count Number of rows and columns of the window.
+ * @param stride Step between the rows, and columns, of the window, or
+ * NULL to read every row and column.
+ * @param values Gets count[0] * count[1] STARE indices, row by row.
+ * @return 0 for success, SSC_EINPUT if no STARE index applies to the
+ * variable or the window is not within it, error code otherwise.
+ */
+int
+GeoFile::get_stare_indices(const std::string varName, int ncid, const size_t *start,
+                           const size_t *count, const ptrdiff_t *stride, unsigned long long *values) {
+    for (size_t v = 0; v < d_variables.size(); v++)
+        if (d_variables.at(v).find(varName) != string::npos)
+            return SidecarFile::readSTAREIndex(ncid, d_stare_varid.at(v), start, count, stride,
+                                               values);
+    return SSC_EINPUT;
+}
+
+/**
+ * Get a STARE cover from the sidecar file, as a set of trixels that
+ * can be queried and combined with other covers.
+ *
+ * @param coverName Name of the cover, such as "1km".
+ * @param ncid ID of the sidecar file.
+ * @param cover_set Gets the cover.
+ * @return 0 for success, error code otherwise.
+ */
+int
+GeoFile::get_stare_cover(const std::string coverName, int ncid, StareIntervalSet &cover_set) {
+    string var_name = string(SSC_COVER_NAME) + "_" + coverName;
+    int varid, dimid;
+    size_t len;
+    int ret;
+
+    if ((ret = nc_inq_varid(ncid, var_name.c_str(), &varid)))
+        return ret;
+    if ((ret = nc_inq_vardimid(ncid, varid, &dimid)))
+        return ret;
+    if ((ret = nc_inq_dimlen(ncid, dimid, &len)))
+        return ret;
+
+    vector<unsigned long long> values(len);
+    if (len && (ret = nc_get_var_ulonglong(ncid, varid, &values[0])))
+        return ret;
+    cover_set = StareIntervalSet::from_intervals(values);
+
+    return 0;
+}
+
 /**
  * Close sidecar file.
  *
@@ -215,4 +291,239 @@ GeoFile::close_sidecar_file(int ncid) {
     return 0;
 }
 
+/**
+ * Number of threads to use for the parallel parts of a read. When
+ * num_threads is 0 this is whatever OpenMP would use by default; when
+ * built without OpenMP it is always 1.
+ *
+ * @return number of threads, at least 1.
+ */
+int
+GeoFile::thread_count() {
+#ifdef HAVE_OPENMP
+    if (num_threads > 0)
+        return num_threads;
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
 
+/**
+ * Set the resolution level of the STARE indices of a grid. By default
+ * this is STARE's own estimate along each row; with
+ * spacing_resolution it is from the 2-D spacing of each point's
+ * neighbors, with estimate_resolution().
+ *
+ * @param lat Latitudes, num_i rows of num_j.
+ * @param lon Longitudes, laid out like lat.
+ * @param num_i Number of rows.
+ * @param num_j Number of columns.
+ * @param rows_per_scan Rows in each scan; num_i for a grid with no
+ * scans.
+ * @param build_level STARE build level.
+ * @param index STARE indices of the points, laid out like lat.
+ *
+ * @return the finest level of any point, or 0 if there is none.
+ */
+int
+GeoFile::setResolution(const double *lat, const double *lon, size_t num_i, size_t num_j,
+                       size_t rows_per_scan, int build_level, unsigned long long *index) {
+    if (spacing_resolution)
+        return estimate_resolution(lat, lon, num_i, num_j, rows_per_scan, index, thread_count());
+    return adapt_resolution(index, num_i, num_j, SSC_STARE_MAX_LEVEL, build_level, thread_count());
+}
+
+/**
+ * Set the resolution level of the STARE indices of a GeoGrid.
+ *
+ * @param grid The grid, with its indices computed.
+ * @param rows_per_scan Rows in each scan; num_i for a grid with no
+ * scans.
+ * @param build_level STARE build level.
+ *
+ * @return the finest level of any point, or 0 if there is none.
+ */
+int
+GeoFile::setResolution(GeoGrid &grid, size_t rows_per_scan, int build_level) {
+    return setResolution(grid.lat().data(), grid.lon().data(), grid.num_i(), grid.num_j(),
+                         rows_per_scan, build_level, grid.index().data());
+}
+
+/**
+ * Get the trixel lookup table for a STARE level, if lut_dir is set.
+ * The table is built and saved in lut_dir the first time it is
+ * needed.
+ *
+ * @param level STARE search level.
+ * @param build_level STARE build level.
+ * @param table Gets the table, or NULL if none is to be used.
+ *
+ * @return 0 for success, error code otherwise.
+ */
+int
+GeoFile::trixel_table(int level, int build_level, const TrixelTable **table) {
+    *table = NULL;
+    if (lut_dir.empty())
+        return 0;
+    return TrixelTable::get(lut_dir, level, build_level, table);
+}
+
+/**
+ * Set the cover from the trixels of the points added to a
+ * CoverBuilder, instead of from a hull of the perimeter. The cover is
+ * exact for the points, and costs about a pass over them.
+ *
+ * @param verbose non-zero for verbose output to stdout.
+ * @param name Name of the cover, such as "1km".
+ * @param builder Holds the trixels of the points.
+ */
+void
+GeoFile::setCover(int verbose, const string &name, CoverBuilder &builder) {
+    vector<unsigned long long int> geo_cover_1;
+
+    builder.intervals(geo_cover_1);
+    if (verbose) std::cout << "Cover built from the point indices, cover size = " <<
+                     geo_cover_1.size() << "\n";
+
+    cover.assign(geo_cover_1.begin(), geo_cover_1.end());
+    if (max_cover_values)
+        fitCover(verbose);
+    keepCover(name);
+}
+
+/**
+ * Set the cover from a hull of the perimeter of a swath, at
+ * cover_level.
+ *
+ * @param verbose non-zero for verbose output to stdout.
+ * @param name Name of the cover, such as "1km".
+ * @param build_level STARE build level.
+ * @param walker Holds the edge of the swath.
+ */
+void
+GeoFile::setCover(int verbose, const string &name, int build_level, const PerimeterWalker &walker) {
+    LatLonDegrees64ValueVector perimeter;
+
+    walker.perimeter(perimeter);
+    if (verbose) std::cout << "perimeter size = " << perimeter.size() << "\n" << std::flush;
+    setCover(verbose, name, build_level, perimeter);
+}
+
+/**
+ * Set the cover from a hull of a perimeter, at cover_level.
+ *
+ * With a cover budget, cover_level is the finest level wanted, and
+ * the hull is refined up to it from a coarse level. The size and cost
+ * of a hull go with the number of trixels along its edge, which
+ * doubles with each level, so each hull predicts the next; the finest
+ * hull predicted to fit the budget is kept, and cover_level set to
+ * its level. Refining costs less than twice the last hull. A hull
+ * that turns out over max_cover_values is dropped for the one before,
+ * or coarsened if it is the first.
+ *
+ * @param verbose non-zero for verbose output to stdout.
+ * @param name Name of the cover, such as "1km".
+ * @param build_level STARE build level.
+ * @param perimeter The perimeter.
+ */
+void
+GeoFile::setCover(int verbose, const string &name, int build_level,
+                  const LatLonDegrees64ValueVector &perimeter) {
+    STARE &index = StarePool::get(27, build_level);
+
+    if (!coverBudget()) {
+        cover = index.NonConvexHull(perimeter, cover_level);
+    } else {
+        STARE_SpatialIntervals hull;
+        double seconds = 0.0, total = 0.0;
+        int level = std::min(cover_level, BUDGET_START_LEVEL), best = -1;
+
+        for (; level <= cover_level; level++) {
+            // Stop when the next hull is predicted to break the budget.
+            if (best >= 0 && ((max_cover_values && 2 * cover.size() > max_cover_values) ||
+                              (max_cover_seconds > 0.0 && total + 2 * seconds > max_cover_seconds)))
+                break;
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            hull = index.NonConvexHull(perimeter, level);
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            total += seconds;
+            if (verbose) std::cout << "Hull at level " << level << ": " << hull.size() <<
+                             " values in " << seconds << " s\n";
+            if (best >= 0 && max_cover_values && hull.size() > max_cover_values)
+                break;
+            cover.swap(hull);
+            best = level;
+        }
+        cover_level = best;
+        if (max_cover_values)
+            fitCover(verbose);
+        if (verbose) std::cout << "Cover level chosen within budget = " << cover_level << "\n";
+    }
+    if (verbose) std::cout << "Cover calculated, cover size = " << cover.size() << "\n";
+    keepCover(name);
+}
+
+/**
+ * Coarsen the cover a level at a time until it has no more than
+ * max_cover_values values, or is at level 0. Each coarser cover holds
+ * the one before.
+ *
+ * @param verbose non-zero for verbose output to stdout.
+ */
+void
+GeoFile::fitCover(int verbose) {
+    if (cover.size() <= max_cover_values || cover_level <= 0)
+        return;
+
+    vector<unsigned long long int> values;
+    StareIntervalSet set = StareIntervalSet::from_intervals(
+        vector<unsigned long long int>(cover.begin(), cover.end()));
+    do {
+        cover_level--;
+        set = set.coarsen(cover_level);
+        set.intervals(values, cover_level);
+    } while (cover_level > 0 && values.size() > max_cover_values);
+
+    if (verbose) std::cout << "Cover coarsened to level " << cover_level << " to fit " <<
+                     max_cover_values << " values, cover size = " << values.size() << "\n";
+    cover.assign(values.begin(), values.end());
+}
+
+/**
+ * Remember the cover, to be written to the sidecar file as the next
+ * of geo_cover.
+ *
+ * Each level of pyramid_levels coarser than cover_level adds a cover
+ * to pyramid_cover, named for the cover and the level, such as
+ * "1km_L5". The coarser covers are made by widening the one before
+ * to whole trixels, finest first, so they nest: a trixel of one holds
+ * trixels of the next only where they meet the swath.
+ *
+ * @param name Name of the cover, such as "1km".
+ */
+void
+GeoFile::keepCover(const string &name) {
+    geo_num_cover_values.push_back(cover.size());
+    geo_cover.push_back(vector<unsigned long long int>(cover.begin(), cover.end()));
+    geo_cover_level.push_back(cover_level);
+    if (pyramid_levels.empty())
+        return;
+
+    vector<int> levels(pyramid_levels);
+    std::sort(levels.begin(), levels.end());
+    levels.erase(std::unique(levels.begin(), levels.end()), levels.end());
+
+    StareIntervalSet set = StareIntervalSet::from_intervals(geo_cover.back());
+    for (int k = (int) levels.size() - 1; k >= 0; k--) {
+        if (levels[k] >= cover_level)
+            continue;
+        PyramidCover coarse;
+        coarse.name = name + "_L" + std::to_string(levels[k]);
+        coarse.level = levels[k];
+        set = set.coarsen(levels[k]);
+        set.intervals(coarse.values, levels[k]);
+        pyramid_cover.push_back(coarse);
+    }
+}
@@ -0,0 +1,176 @@
+/// @file
+/// This class holds a HDF4 granule open for the whole of a read,
+/// through both the SD and the HDF-EOS swath interfaces.
+
+#include "config.h"
+#include "Hdf4Granule.h"
+#include "ssc.h"
+#include <vector>
+
+Hdf4Granule::Hdf4Granule() : d_swath_file_id(-1), d_sd_id(-1), d_num_swath(-1) {
+}
+
+Hdf4Granule::~Hdf4Granule() {
+    close();
+}
+
+/**
+ * Open a granule. A HDF-EOS file is opened with SWopen(), and its SD
+ * interface is the one HDF-EOS opened; any other HDF4 file with
+ * SDstart(). A granule already open is closed first.
+ *
+ * @param file_name Name of the granule.
+ *
+ * @return 0 for success, SSC_EHDF4ERR if the file can't be opened as
+ * HDF4.
+ */
+int
+Hdf4Granule::open(const std::string &file_name) {
+    int32 hdf_id;
+
+    close();
+    if ((d_swath_file_id = SWopen((char *) file_name.c_str(), DFACC_RDONLY)) != -1) {
+        if (EHidinfo(d_swath_file_id, &hdf_id, &d_sd_id) == -1) {
+            close();
+            return SSC_EHDF4ERR;
+        }
+    }
+    else if ((d_sd_id = SDstart(file_name.c_str(), DFACC_READ)) == -1) {
+        return SSC_EHDF4ERR;
+    }
+    d_file_name = file_name;
+
+    return 0;
+}
+
+/**
+ * Detach the swaths and close the granule. Does nothing if no granule
+ * is open.
+ *
+ * @return 0 for success, SSC_EHDF4ERR if a swath can't be detached or
+ * the file closed. The granule is closed either way.
+ */
+int
+Hdf4Granule::close() {
+    int ret = 0;
+
+    for (std::map<std::string, int32>::iterator s = d_swaths.begin(); s != d_swaths.end(); ++s)
+        if (SWdetach(s->second) < 0)
+            ret = SSC_EHDF4ERR;
+    d_swaths.clear();
+
+    // The SD interface of a HDF-EOS file is closed by SWclose().
+    if (d_swath_file_id != -1) {
+        if (SWclose(d_swath_file_id) < 0)
+            ret = SSC_EHDF4ERR;
+    }
+    else if (d_sd_id != -1) {
+        if (SDend(d_sd_id))
+            ret = SSC_EHDF4ERR;
+    }
+    d_swath_file_id = -1;
+    d_sd_id = -1;
+    d_num_swath = -1;
+    d_swath_list.clear();
+    d_attributes.clear();
+    d_file_name.clear();
+
+    return ret;
+}
+
+/**
+ * Get the swaths of the granule. SWinqswath() reads the structural
+ * metadata of the file again each time, so the list is kept after the
+ * first call.
+ *
+ * @param num_swath Gets the number of swaths.
+ * @param swaths Gets the swath names, separated by commas.
+ *
+ * @return 0 for success, SSC_EHDF4ERR if the granule is not an open
+ * HDF-EOS file, or the swaths can't be listed.
+ */
+int
+Hdf4Granule::swath_list(int32 &num_swath, std::string &swaths) {
+    if (!is_swath())
+        return SSC_EHDF4ERR;
+
+    if (d_num_swath == -1) {
+        int32 strbufsize = 0;
+        if (SWinqswath((char *) d_file_name.c_str(), NULL, &strbufsize) < 0)
+            return SSC_EHDF4ERR;
+        std::vector<char> list(strbufsize + 1, 0);
+        if ((d_num_swath = SWinqswath((char *) d_file_name.c_str(), &list[0], &strbufsize)) < 0) {
+            d_num_swath = -1;
+            return SSC_EHDF4ERR;
+        }
+        d_swath_list = &list[0];
+    }
+    num_swath = d_num_swath;
+    swaths = d_swath_list;
+
+    return 0;
+}
+
+/**
+ * Attach to a swath. The swath stays attached until the granule is
+ * closed, and attaching to it again gives the same id.
+ *
+ * @param swath_name Name of the swath, such as "mod05".
+ * @param swath_id Gets the swath id.
+ *
+ * @return 0 for success, SSC_EHDF4ERR if the granule is not an open
+ * HDF-EOS file, or has no such swath.
+ */
+int
+Hdf4Granule::attach(const std::string &swath_name, int32 &swath_id) {
+    if (!is_swath())
+        return SSC_EHDF4ERR;
+
+    std::map<std::string, int32>::const_iterator s = d_swaths.find(swath_name);
+    if (s == d_swaths.end()) {
+        int32 id;
+        if ((id = SWattach(d_swath_file_id, (char *) swath_name.c_str())) < 0)
+            return SSC_EHDF4ERR;
+        s = d_swaths.insert(std::make_pair(swath_name, id)).first;
+    }
+    swath_id = s->second;
+
+    return 0;
+}
+
+/**
+ * Read a global text attribute with the SD interface, such as the
+ * ArchiveMetadata.0 that holds the GRing. Each attribute is read from
+ * the file once and kept until the granule is closed.
+ *
+ * @param attr_name Name of the attribute.
+ * @param text Gets the attribute text.
+ *
+ * @return 0 for success, SSC_EHDF4ERR if no granule is open, or it
+ * has no such attribute.
+ */
+int
+Hdf4Granule::read_attribute(const std::string &attr_name, std::string &text) {
+    if (!is_open())
+        return SSC_EHDF4ERR;
+
+    std::map<std::string, std::string>::const_iterator a = d_attributes.find(attr_name);
+    if (a == d_attributes.end()) {
+        char name[SSC_MAX_NAME];
+        int32 attr_idx, data_type, count;
+
+        if ((attr_idx = SDfindattr(d_sd_id, attr_name.c_str())) == -1)
+            return SSC_EHDF4ERR;
+        if (SDattrinfo(d_sd_id, attr_idx, name, &data_type, &count) == -1)
+            return SSC_EHDF4ERR;
+
+        // The text is not NUL terminated in the file.
+        std::vector<char> value(count + 1, 0);
+        if (SDreadattr(d_sd_id, attr_idx, &value[0]) == -1)
+            return SSC_EHDF4ERR;
+        a = d_attributes.insert(std::make_pair(attr_name, std::string(&value[0]))).first;
+    }
+    text = a->second;
+
+    return 0;
+}
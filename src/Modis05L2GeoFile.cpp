@@ -4,6 +4,10 @@
 
 #include "config.h"
 #include "Modis05L2GeoFile.h"
+#include "TrixelIndexer.h"
+#include "ScanInterpolator.h"
+#include "CoverBuilder.h"
+#include "PerimeterWalker.h"
 #include <mfhdf.h>
 #include <hdf.h>
 #include <HdfEosDef.h>
@@ -11,15 +15,14 @@
 #include <iostream>
 #include <sstream>
 
-// #ifdef USE_OPENMP
-// #include <omp.h>
-// #endif
-
 #define MAX_NAME 256
 #define MAX_DIMS 16
 
 #define MAX_ALONG 406
 #define MAX_ACROSS 270
+#define MAX_ALONG_1KM 2030
+#define MAX_ACROSS_1KM 1354
+#define SCAN_ROWS 2 /**< 5 km rows in one MODIS scan. */
 
 /** Construct a Modis05L2GeoFile.
  *
@@ -53,7 +56,35 @@ int
 Modis05L2GeoFile::readFile(const std::string fileName, int verbose,
                            int build_level, int cover_level,
                            bool use_gring, int perimeter_stride) {
-    int32 swathfileid, swathid;
+    Hdf4Granule granule;
+    int ret;
+
+    if ((ret = granule.open(fileName)))
+        return ret;
+    if ((ret = readFile(granule, verbose, build_level, cover_level, use_gring, perimeter_stride)))
+        return ret;
+
+    return granule.close();
+}
+
+/**
+ * Read an open HDF4 MODIS L2 MOD05 granule. The lat/lons and the GRing
+ * are read from the one open granule.
+ *
+ * @param granule the open granule.
+ * @param verbose non-zero for verbose output to stdout.
+ * @param build_level STARE build level.
+ * @param cover_level STARE cover level.
+ * @param use_gring if true, use g-ring data for cover calculation.
+ * @param perimeter_stride perimeter stride.
+ *
+ * @return 0 for no error, error code otherwise.
+ */
+int
+Modis05L2GeoFile::readFile(Hdf4Granule &granule, int verbose,
+                           int build_level, int cover_level,
+                           bool use_gring, int perimeter_stride) {
+    int32 swathid;
     int32 ndims, dimids[MAX_DIMS];
     float32 longitude[MAX_ALONG][MAX_ACROSS];
     float32 latitude[MAX_ALONG][MAX_ACROSS];
@@ -71,10 +102,9 @@ Modis05L2GeoFile::readFile(const std::string fileName, int verbose,
     char idxmap[MAX_NAME + 1];
     int32 idxsizes[MAX_DIMS];
     int32 nattr;
-    int32 strbufsize;
     char attrlist[MAX_NAME + 1] = "";
     int32 nswath;
-    char swathlist[MAX_NAME + 1];
+    string swathlist;
     float gring_lat[SSC_NUM_GRING], gring_lon[SSC_NUM_GRING];
     int ret;
 
@@ -94,25 +124,20 @@ Modis05L2GeoFile::readFile(const std::string fileName, int verbose,
     stare_cover_name.push_back("5km");
 
     if (verbose)
-        std::cout << "Reading HDF4 file " << fileName <<
+        std::cout << "Reading HDF4 file " << granule.file_name() <<
                   " with build level " << build_level << "\n";
 
     d_num_index = 1;
 
     num_cover = 1;
 
-    // Open the swath file.
-    if ((swathfileid = SWopen((char *) fileName.c_str(), DFACC_RDONLY)) < 0)
-        return SSC_EHDF4ERR;
-
-    if ((nswath = SWinqswath((char *) fileName.c_str(), swathlist, &strbufsize)) < 0)
-        return SSC_EHDF4ERR;
+    if ((ret = granule.swath_list(nswath, swathlist)))
+        return ret;
     // if (verbose) std::cout << "nswath " << nswath << " " << swathlist << "\n";
 
-    // Attach to a swath.
-    string ssc_mod05 = SSC_MOD05;
-    if ((swathid = SWattach(swathfileid, (char *) ssc_mod05.c_str())) < 0)
-        return SSC_EHDF4ERR;
+    // Attach to a swath. It is detached when the granule is closed.
+    if ((ret = granule.attach(SSC_MOD05, swathid)))
+        return ret;
 
     // Get lat and lon values.
     if (verbose) std::cout << "Reading lat/lon values...\n";
@@ -123,169 +148,97 @@ Modis05L2GeoFile::readFile(const std::string fileName, int verbose,
     if (SWreadfield(swathid, (char *) ssc_lat_name.c_str(), NULL, NULL, NULL, latitude))
         return SSC_EHDF4ERR;
 
-    // Detach from the swath.
-    if (SWdetach(swathid) < 0)
-        return SSC_EHDF4ERR;
-
-    // Save size of grid.
-    geo_num_i.push_back(MAX_ALONG);
-    geo_num_j.push_back(MAX_ACROSS);
-
-    // Construct STARE object.
     int level = 27;
     int finest_resolution = 0;
-    STARE index(level, build_level);
 
-    // Calculate STARE index for each point.
-    if (verbose) std::cout << "Calculating STARE index for each point...\n";    
-//#pragma omp parallel reduction(max : finest_resolution)
+    // Allocate the grid up front, so that each row can be written in
+    // place by whichever thread computes it.
+    geo_grid.push_back(GeoGrid(MAX_ALONG, MAX_ACROSS, SCAN_ROWS));
+    double *lats = geo_grid.back().lat().data();
+    double *lons = geo_grid.back().lon().data();
+    unsigned long long int *geo_index_1 = geo_grid.back().index().data();
+
+    // Calculate STARE index for each point. Rows are independent, so
+    // each thread takes whole rows with its own indexer.
+    const TrixelTable *table;
+    if ((ret = trixel_table(level, build_level, &table)))
+        return ret;
+
+    int nthreads = thread_count();
+    if (verbose) std::cout << "Calculating STARE index for each point with " <<
+                     nthreads << " thread(s)...\n";
+#pragma omp parallel num_threads(nthreads)
     {
-        STARE index1(level, build_level);
-//#pragma omp for
-	vector<double> lats;
-	vector<double> lons;
-	vector<unsigned long long int> geo_index_1;
+        TrixelIndexer indexer(level, build_level);
+        indexer.set_table(table);
+#pragma omp for schedule(static)
         for (int i = 0; i < MAX_ALONG; i++) {
+            size_t row = (size_t) i * MAX_ACROSS;
             for (int j = 0; j < MAX_ACROSS; j++) {
-		lats.push_back(latitude[i][j]);
-		lons.push_back(longitude[i][j]);
-
-                // Calculate the stare indices.
-                geo_index_1.push_back(index1.ValueFromLatLonDegrees((double) latitude[i][j],
-								    (double) longitude[i][j], level));
+                lats[row + j] = latitude[i][j];
+                lons[row + j] = longitude[i][j];
             } // next j
-            index1.adaptSpatialResolutionEstimatesInPlace(&(geo_index_1[i * MAX_ACROSS]), MAX_ACROSS);
 
-            for (int j = 0; j < MAX_ACROSS; j++) {
-                int test_resolution = geo_index_1[i * MAX_ACROSS + j] & 31; // LevelMask
-                if (test_resolution > finest_resolution) {
-                    finest_resolution = test_resolution;
-                }
-            }
+            // Calculate the stare indices for the whole row.
+            indexer.index(&lats[row], &lons[row], MAX_ACROSS, level, &geo_index_1[row]);
         } // next i
-	geo_lat.push_back(lats);
-	geo_lon.push_back(lons);
-	geo_index.push_back(geo_index_1);
+    }
+
+    // Encode the resolution of each point.
+    finest_resolution = setResolution(geo_grid[0], SCAN_ROWS, build_level);
+
+    // Add the geolocation interpolated to 1 km, if wanted.
+    if (fine_grids && (ret = index1km(verbose, build_level, table)))
+        return ret;
+
+    // Build the cover from the 5 km indices, if wanted, instead of
+    // from a hull of the perimeter.
+    if (exact_cover) {
+        this->cover_level = cover_level == -1 ? finest_resolution : cover_level;
+        if (verbose) std::cout << "Building cover: cover_level = " << this->cover_level << "\n";
+        CoverBuilder builder(this->cover_level, nthreads);
+        builder.add(geo_grid[0]);
+        setCover(verbose, "5km", builder);
+        return 0;
     }
 
     // Now set up and calculate STARE cover
-    // int perimeter_stride = 10;
     this->perimeter_stride = perimeter_stride;
+    if (cover_level == -1)
+        this->cover_level = finest_resolution;
+    else
+        this->cover_level = cover_level;
+
+    // Walk the perimeter of the 5 km swath, if wanted, instead of
+    // using the GRing.
+    if (!use_gring) {
+        if (verbose) std::cout << "calculating perimeter: perimeter_stride = " <<
+                         this->perimeter_stride << ", tolerance = " << perimeter_tolerance <<
+                         "\n" << std::flush;
+        PerimeterWalker walker(MAX_ALONG, MAX_ACROSS, perimeter_stride, perimeter_tolerance);
+        walker.add(geo_grid[0]);
+        setCover(verbose, "5km", build_level, walker);
+        return 0;
+    }
 
     LatLonDegrees64ValueVector perimeter; // Resize below
     int pk; // perimeter counter
 
-    if (!use_gring) { // walk_perimeter, stride > 0...
-
-        pk = 2 * MAX_ALONG + 2 * MAX_ACROSS - 4 - 1;
-        perimeter.resize(2 * MAX_ALONG + 2 * MAX_ACROSS - 4); // Walk the perimeter. Note pk below.
-
-        if (perimeter_stride > 0) { // Maybe redundant if-block
-
-            if (verbose) std::cout << "calculating perimeter: perimeter_stride = " <<
-			     this->perimeter_stride << "\n" << std::flush;
-
-            { // Go along the 'bottom' CCW. Do the full side.
-                int i = 0;
-                {
-                    for (int j = 0; j < MAX_ACROSS; j += perimeter_stride) {
-                        perimeter[pk].lat = latitude[i][j];
-                        perimeter[pk].lon = longitude[i][j];
-                        --pk;
-                        if ((perimeter_stride > 1) && (j + perimeter_stride >= MAX_ACROSS)) {
-                            perimeter[pk].lat = latitude[i][MAX_ACROSS - 1];
-                            perimeter[pk].lon = longitude[i][MAX_ACROSS - 1];
-                            --pk;
-                        }
-                    }
-                }
-            }
-
-            { // Go up along the right side. Start at 1, because the corner's done.
-                int j = MAX_ACROSS - 1;
-                for (int i = 1; i < MAX_ALONG; i += perimeter_stride) {
-                    {
-                        perimeter[pk].lat = latitude[i][j];
-                        perimeter[pk].lon = longitude[i][j];
-                        --pk;
-                        if ((perimeter_stride > 1) && (i + perimeter_stride >= MAX_ALONG)) {
-                            perimeter[pk].lat = latitude[MAX_ALONG - 1][j];
-                            perimeter[pk].lon = longitude[MAX_ALONG - 1][j];
-                            --pk;
-                        }
-                    }
-                }
-            }
-
-            { // Go back along the top. Start one over.
-                int i = MAX_ALONG - 1;
-                {
-                    for (int j = MAX_ACROSS - 2; j > -1; j -= perimeter_stride) {
-                        perimeter[pk].lat = latitude[i][j];
-                        perimeter[pk].lon = longitude[i][j];
-                        --pk;
-                        if ((perimeter_stride > 1) && (j - perimeter_stride < 0)) {
-                            perimeter[pk].lat = latitude[i][0];
-                            perimeter[pk].lon = longitude[i][0];
-                            --pk;
-                        }
-
-                    }
-                }
-            }
-
-            { // Go back down along the left side. Start one over and don't include the end.
-                int j = 0;
-                for (int i = MAX_ALONG - 2; i > 0; i -= perimeter_stride) {
-                    {
-                        perimeter[pk].lat = latitude[i][j];
-                        perimeter[pk].lon = longitude[i][j];
-                        --pk;
-                        if ((perimeter_stride > 1) && (i - perimeter_stride < 0)) {
-                            perimeter[pk].lat = latitude[0][j];
-                            perimeter[pk].lon = longitude[0][j];
-                            --pk;
-                        }
-
-                    }
-                }
-            }
-
-            if (perimeter_stride > 1) {
-                // Clean up and resize the vector.
-                // Recall that     LatLonDegrees64ValueVector perimeter(2*MAX_ALONG+2*MAX_ACROSS-4).
-
-                // Copy to front of vector.
-                int i = 0;
-                for (int k = pk + 1; k < 2 * MAX_ALONG + 2 * MAX_ACROSS - 4; ++k) {
-                    perimeter[i].lat = perimeter[k].lat;
-                    perimeter[i].lon = perimeter[k].lon;
-                    ++i;
-                }
-                perimeter.resize(i);
-            }
-
-        }
+    // Get the GRing info. After this call, gring_lat and gring_lon
+    // contain the 4 gring values for lat and lon.
+    if (verbose) std::cout << "Getting GRING info from HDF4 file...\n";
+    if ((ret = getGRing(granule, verbose, gring_lat, gring_lon))) {
+        cerr << "Error with GRing, maybe retry with --walk_perimeter 1.\n";
+        return ret;
     }
-    else { // Right now, use_gring goes here. If we ever load from a separate file, reconsider.
-        //             perimeter_stride <= 0 ) {
-
-        // Get the GRing info. After this call, gring_lat and gring_lon
-        // contain the 4 gring values for lat and lon.
-	if (verbose) std::cout << "Getting GRING info from HDF4 file...\n";	
-        if ((ret = getGRing(fileName, verbose, gring_lat, gring_lon))) {
-            cerr << "Error with GRing, maybe retry with --walk_perimeter 1.\n";
-            return ret;
-        }
 
-        // Note the hardcoded 4 for the 4 corners or the gring.
-        perimeter.resize(4); // Use 4 here until we find a granule with more than 4.
-        pk = 3;
-        for (int i = 0; i < 4; ++i) {
-            perimeter[pk].lat = gring_lat[i];
-            perimeter[pk].lon = gring_lon[i];
-            --pk;
-        }
+    // Note the hardcoded 4 for the 4 corners or the gring.
+    perimeter.resize(4); // Use 4 here until we find a granule with more than 4.
+    pk = 3;
+    for (int i = 0; i < 4; ++i) {
+        perimeter[pk].lat = gring_lat[i];
+        perimeter[pk].lon = gring_lon[i];
+        --pk;
     }
     if (verbose)
         std::cout << "perimeter size = " << perimeter.size() << ", pk = " << pk << "\n" << std::flush;
@@ -293,19 +246,65 @@ Modis05L2GeoFile::readFile(const std::string fileName, int verbose,
     // Calculating cover.
     if (verbose)
         std::cout << "Calculating cover: cover_level = " << this->cover_level << "\n" << std::flush;
-    if (cover_level == -1)
-        this->cover_level = finest_resolution;
-    else
-        this->cover_level = cover_level;
-    cover = index.NonConvexHull(perimeter, this->cover_level);
-    if (verbose) std::cout << "Cover calculated, cover size = " << cover.size() << "\n";
-
-    // Remember the cover info.
-    geo_num_cover_values.push_back(cover.size());
-    vector<unsigned long long int> geo_cover_1;
-    for (int k = 0; k < geo_num_cover_values[0]; ++k) 
-	geo_cover_1.push_back(cover[k]);
-    geo_cover.push_back(geo_cover_1);
+    setCover(verbose, "5km", build_level, perimeter);
+
+    return 0;
+}
+
+/**
+ * Add a second STARE index, for the 5 km geolocation interpolated to
+ * the 1 km grid of the MOD05 near infrared fields. Each 1 km point is
+ * indexed down from the trixel shared by the two 5 km points it lies
+ * between.
+ *
+ * @param verbose non-zero for verbose output to stdout.
+ * @param build_level STARE build level.
+ * @param table Trixel lookup table, or NULL.
+ *
+ * @return 0 for no error, error code otherwise.
+ */
+int
+Modis05L2GeoFile::index1km(int verbose, int build_level, const TrixelTable *table) {
+    static const ScanInterpolator interp(MAX_ALONG, MAX_ACROSS, SCAN_ROWS, 5, MAX_ACROSS_1KM);
+    const int factor = 5;
+    int level = 27;
+
+    d_num_index = 2;
+    d_stare_index_name.push_back("1km");
+    var_name[1].push_back("Water_Vapor_Near_Infrared");
+    var_name[1].push_back("Quality_Assurance_Near_Infrared");
+
+    geo_grid.push_back(GeoGrid(MAX_ALONG_1KM, MAX_ACROSS_1KM, SCAN_ROWS * factor));
+    const GeoGrid &grid_5km = geo_grid[0];
+    GeoGrid &grid_1km = geo_grid[1];
+    const double *lats = grid_5km.lat().data();
+    const double *lons = grid_5km.lon().data();
+    const unsigned long long int *index_5km = grid_5km.index().data();
+
+    int nthreads = thread_count();
+    if (verbose) std::cout << "Calculating 1km STARE indices with " << nthreads << " thread(s)...\n";
+#pragma omp parallel num_threads(nthreads)
+    {
+        TrixelIndexer indexer(level, build_level);
+        indexer.set_table(table);
+        vector<unsigned long long int> hint(MAX_ACROSS_1KM);
+
+#pragma omp for schedule(dynamic, 8)
+        for (int q = 0; q < MAX_ALONG_1KM; q++) {
+            size_t row = (size_t) q * MAX_ACROSS_1KM;
+            const unsigned long long int *parent = &index_5km[(size_t) (q / factor) * MAX_ACROSS];
+
+            interp.interpolate(lats, lons, 0, q, q + 1, &grid_1km.lat()[row], &grid_1km.lon()[row]);
+            for (int p = 0; p < MAX_ACROSS_1KM; p++) {
+                int n = interp.coarse_col(p);
+                int common = stare_common_level(parent[n], parent[n + 1]);
+                hint[p] = common < 0 ? SSC_STARE_NO_TRIXEL : stare_truncate(parent[n], common);
+            }
+            indexer.refine(&grid_1km.lat()[row], &grid_1km.lon()[row], &hint[0], MAX_ACROSS_1KM,
+                           level, &grid_1km.index()[row]);
+        }
+    }
+    setResolution(grid_1km, SCAN_ROWS * factor, build_level);
 
     return 0;
 }
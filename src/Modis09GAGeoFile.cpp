@@ -9,6 +9,11 @@
 #include <vector>
 #include <HdfEosDef.h>
 #include "STARE.h"
+#include "StareBits.h"
+#include "SinusoidalGrid.h"
+#include "TrixelIndexer.h"
+#include "CoverBuilder.h"
+#include <algorithm>
 
 using namespace std;
 
@@ -35,80 +40,163 @@ Modis09GAGeoFile::fileExists(const std::string &name) {
     }
 }
 
+/**
+ * Get the tile numbers of a MOD09GA file from its name, which is like
+ * MOD09GA.A2020009.h00v08.006.2020011025435.hdf.
+ *
+ * @param fileName the data file name, with or without a directory.
+ * @param h Gets the horizontal tile number.
+ * @param v Gets the vertical tile number.
+ *
+ * @return 0 for no error, SSC_EINPUT if the name has no tile numbers.
+ */
+int
+Modis09GAGeoFile::tileNumbers(const std::string &fileName, int &h, int &v) {
+    const size_t H_POS = 17;
+    const size_t V_POS = 20;
+    string base_name = fileName.substr(fileName.rfind("/") + 1);
+
+    if (base_name.size() < V_POS + 3 || base_name[H_POS] != 'h' || base_name[V_POS] != 'v' ||
+        !isdigit(base_name[H_POS + 1]) || !isdigit(base_name[H_POS + 2]) ||
+        !isdigit(base_name[V_POS + 1]) || !isdigit(base_name[V_POS + 2]))
+        return SSC_EINPUT;
+    h = stoi(base_name.substr(H_POS + 1, 2));
+    v = stoi(base_name.substr(V_POS + 1, 2));
+
+    return 0;
+}
+
 /**
  * Read a HDF4 MODIS MOD09 GA file.
  *
+ * The geolocation of a tile is not read from the file; it is computed
+ * from the definition of the sinusoidal grid, for the tile the file
+ * name gives, at 1 km and 500 m, and at 250 m if fine grids are
+ * wanted. The cover is built from the 1 km indices, since tiles at
+ * the edges of the grid are partly off the sphere and have no simple
+ * perimeter.
+ *
  * @param fileName the data file name.
  * @param verbose non-zero for verbose output to stdout.
  * @param build_level STARE build level.
+ * @param cover_level STARE cover level, -1 for one level coarser than
+ * the finest of the 1 km pixels.
  *
  * @return 0 for no error, error code otherwise.
  */
 int
-Modis09GAGeoFile::readFile(const std::string fileName, int verbose, int build_level) {
+Modis09GAGeoFile::readFile(const std::string fileName, int verbose, int build_level,
+                           int cover_level) {
+    const size_t pixels[] = {SSC_SIN_1KM, SSC_SIN_500M, SSC_SIN_250M};
+    int level = 27;
+    int finest_resolution = 0;
+    double bounds[4];
+    int h, v;
+    int ret;
 
     if (verbose)
         std::cout << "Reading HDF4 file " << fileName <<
                   " with build level " << build_level << "\n";
 
-    string dir_name, base_name;
-    string h_str, v_str;
-    const int FILE_NAME_LEN = 45;
-    const int H_POS = 18;
-    const int V_POS = 21;
-    const int LEN = 2;
-    const string FILE_PREFIX = "MOD09GA_";
-    const string TABLE_NAME = "sn_bound_10deg.txt";
-    string fileOut;
-    int h, v;
-
     d_stare_index_name.push_back("1km");
+    var_name[0].push_back("num_observations_1km");
+    var_name[0].push_back("state_1km_1");
+    var_name[0].push_back("SensorZenith_1");
+    var_name[0].push_back("SensorAzimuth_1");
+    var_name[0].push_back("Range_1");
+    var_name[0].push_back("SolarZenith_1");
+    var_name[0].push_back("SolarAzimuth_1");
+    var_name[0].push_back("gflags_1");
+    var_name[0].push_back("orbit_pnt_1");
+    var_name[0].push_back("granule_pnt_1");
     d_stare_index_name.push_back("500m");
-    d_stare_index_name.push_back("250m");
-    stare_cover_name.push_back("1km");
-
-    // Create the output file name and find the h and v tile numbers.
-    dir_name = fileName.substr(0, fileName.rfind("/") + 1);
-    cout << "dir_name " << dir_name << "\n";
-    base_name = fileName.substr(fileName.rfind("/") + 1, FILE_NAME_LEN);
-    cout << "base_name " << base_name << "\n";
-    h_str = base_name.substr(H_POS, LEN);
-    v_str = base_name.substr(V_POS, LEN);
-    cout << "h " << h_str << " v " << v_str << "\n";
-    h = stoi(h_str);
-    v = stoi(v_str);
-    cout << "h " << h << " v " << v << "\n";
-    fileOut = dir_name + FILE_PREFIX + "h" + h_str + "v" + v_str + "_stare.nc";
-    cout << "fileOut = " << fileOut << "\n";
-
-    // If this file already exists, assume we are done. ;-)
-    if (fileExists(fileOut)) {
-        cout << fileOut << " exists\n";
-        return 0;
+    var_name[1].push_back("num_observations_500m");
+    var_name[1].push_back("sur_refl_b01_1");
+    var_name[1].push_back("sur_refl_b02_1");
+    var_name[1].push_back("sur_refl_b03_1");
+    var_name[1].push_back("sur_refl_b04_1");
+    var_name[1].push_back("sur_refl_b05_1");
+    var_name[1].push_back("sur_refl_b06_1");
+    var_name[1].push_back("sur_refl_b07_1");
+    var_name[1].push_back("QC_500m_1");
+    var_name[1].push_back("obscov_500m_1");
+    var_name[1].push_back("iobs_res_1");
+    var_name[1].push_back("q_scan_1");
+    d_num_index = 2;
+
+    // The 250 m grid has no MOD09GA fields; it is the grid of the
+    // MOD09GQ tiles.
+    if (fine_grids) {
+        d_stare_index_name.push_back("250m");
+        d_num_index = 3;
     }
 
-    // Open the table file and get the lat/lons for this v/h.
-    cout << "creating " << fileOut << "\n";
-    fstream newfile;
-    const int SKIP_LINES = 7;
-
-    newfile.open(TABLE_NAME, ios::in);
-    if (newfile.is_open()) {
-        string tp;
-        int c = 0;
-        while (getline(newfile, tp)) {
-            if (c++ <= SKIP_LINES)
-                continue;
-            cout << tp << "\n";
+    // Find the h and v tile numbers. A sidecar that was already made
+    // for the tile is reused by mk_stare through its TileCache.
+    if ((ret = tileNumbers(fileName, h, v)))
+        return ret;
+    if ((ret = sinusoidal_tile_bounds(h, v, bounds)))
+        return ret;
+    if (verbose) std::cout << "h " << h << " v " << v << ", lon " << bounds[0] << " to " <<
+                     bounds[1] << ", lat " << bounds[2] << " to " << bounds[3] << "\n";
+
+    const TrixelTable *table;
+    if ((ret = trixel_table(level, build_level, &table)))
+        return ret;
+
+    int nthreads = thread_count();
+    for (int g = 0; g < d_num_index; g++) {
+        const long n = (long) pixels[g];
+
+        if (verbose) std::cout << "Calculating " << d_stare_index_name[g] << " lat/lons and "
+                         "STARE indices with " << nthreads << " thread(s)...\n";
+        geo_grid.push_back(GeoGrid(n, n));
+        GeoGrid &grid = geo_grid.back();
+        if ((ret = sinusoidal_tile_geolocation(h, v, grid, nthreads)))
+            return ret;
+
+        // Index each row in place. The pixels of a row that are on
+        // the sphere are one run, and the rest have no trixel.
+#pragma omp parallel num_threads(nthreads)
+        {
+            TrixelIndexer indexer(level, build_level);
+            indexer.set_table(table);
+#pragma omp for schedule(static)
+            for (long i = 0; i < n; i++) {
+                size_t row = (size_t) i * n;
+                const double *lats = grid.lat().data() + row;
+                const double *lons = grid.lon().data() + row;
+                unsigned long long int *index = grid.index().data() + row;
+                long j0 = 0, j1 = n;
+
+                while (j0 < n && lats[j0] == SSC_GEO_FILL)
+                    j0++;
+                while (j1 > j0 && lats[j1 - 1] == SSC_GEO_FILL)
+                    j1--;
+                std::fill(index, index + j0, SSC_STARE_NO_TRIXEL);
+                std::fill(index + j1, index + n, SSC_STARE_NO_TRIXEL);
+                if (j1 > j0)
+                    indexer.index(lats + j0, lons + j0, j1 - j0, level, index + j0);
+            }
         }
-        newfile.close();
-    }
-
-    // Calculate the rest of the lat/lons.
 
-    // Calculate the STARE indexes.
+        // The grid has no scans.
+        int finest = setResolution(grid, n, build_level);
+        if (!g)
+            finest_resolution = finest;
+    }
 
+    // Build the cover from the 1 km indices. At the finest level of
+    // the pixels many trixels are smaller than a pixel and hold no
+    // pixel center, so the cover would be riddled with holes; by
+    // default it is one level coarser, where each trixel holds a few.
+    this->cover_level = cover_level == -1 ? std::max(finest_resolution - 1, 0) : cover_level;
+    if (verbose) std::cout << "Building cover: cover_level = " << this->cover_level << "\n";
+    num_cover = 1;
+    stare_cover_name.push_back("1km");
+    CoverBuilder builder(this->cover_level, nthreads);
+    builder.add(geo_grid[0]);
+    setCover(verbose, "1km", builder);
 
     return 0;
 }
-
@@ -4,9 +4,16 @@
 
 #include "config.h"
 #include "Modis09L2GeoFile.h"
+#include "StarePool.h"
+#include "TrixelIndexer.h"
+#include "SidecarFile.h"
+#include "ScanInterpolator.h"
+#include "CoverBuilder.h"
+#include "PerimeterWalker.h"
 #include <mfhdf.h>
 #include <hdf.h>
 #include <vector>
+#include <algorithm>
 #include <HdfEosDef.h>
 #include "STARE.h"
 
@@ -26,6 +33,8 @@ using namespace std;
 #define MAX_ALONG_250 (MAX_ALONG_500 * 2)
 #define MAX_ACROSS_250 (MAX_ACROSS_500 * 2)
 #define NUM_PIXELS 40
+#define SCAN_ROWS 10 /**< 1 km rows in one MODIS scan. */
+#define MODIS_SWATH_TYPE_L2 "MODIS SWATH TYPE L2" /**< Name of the MOD09 swath. */
 
 /** Construct a Modis09L2GeoFile.
  *
@@ -53,7 +62,34 @@ Modis09L2GeoFile::Modis09L2GeoFile() {
 int
 Modis09L2GeoFile::readFile(const std::string fileName, int verbose, int build_level,
 			   int cover_level, bool use_gring, int perimeter_stride) {
-    int32 swathfileid, swathid;
+    Hdf4Granule granule;
+    int ret;
+
+    if ((ret = granule.open(fileName)))
+        return ret;
+    if ((ret = readFile(granule, verbose, build_level, cover_level, use_gring, perimeter_stride)))
+        return ret;
+
+    return granule.close();
+}
+
+/**
+ * Read an open HDF4 MODIS L2 MOD09 granule. The GRing and the lat/lons
+ * are read from the one open granule.
+ *
+ * @param granule the open granule.
+ * @param verbose non-zero for verbose output to stdout.
+ * @param build_level STARE build level.
+ * @param cover_level STARE cover level.
+ * @param use_gring if true, use g-ring data for cover calculation.
+ * @param perimeter_stride perimeter stride.
+ *
+ * @return 0 for no error, error code otherwise.
+ */
+int
+Modis09L2GeoFile::readFile(Hdf4Granule &granule, int verbose, int build_level,
+			   int cover_level, bool use_gring, int perimeter_stride) {
+    int32 swathid;
     int32 ndims, dimids[MAX_DIMS];
     char dimnames[MAX_NAME + 1];
     int32 dimsize;
@@ -72,117 +108,58 @@ Modis09L2GeoFile::readFile(const std::string fileName, int verbose, int build_le
     int32 strbufsize;
     char attrlist[MAX_NAME + 1] = "";
     int32 nswath;
-    char swathlist[MAX_NAME + 1];
+    string swathlist;
     int ret;
     
-    if (verbose) std::cout << "Reading HDF4 file " << fileName <<
+    if (verbose) std::cout << "Reading HDF4 file " << granule.file_name() <<
 		     " with build level " << build_level << "\n";
 
-    num_cover = 1;
-    stare_cover_name.push_back("1km");
-    LatLonDegrees64ValueVector perimeter; // Resize below
-    int pk; // perimeter counter
-
-    // Get the GRing info. After this call, gring_lat and gring_lon
-    // contain the 4 gring values for lat and lon.
-    float gring_lat[SSC_NUM_GRING], gring_lon[SSC_NUM_GRING];
-    if ((ret = getGRing(fileName, verbose, gring_lat, gring_lon))) {
-	cerr << "Error with GRing, maybe retry with --walk_perimeter 1.\n";
-	return ret;
-    }
-    
-    // Note the hardcoded 4 for the 4 corners or the gring.
-    perimeter.resize(4); // Use 4 here until we find a granule with more than 4.
-    pk = 3;
-    for (int i = 0; i < 4; ++i) {
-	perimeter[pk].lat = gring_lat[i];
-	perimeter[pk].lon = gring_lon[i];
-	--pk;
-    }
-
-    if (verbose)
-        std::cout << "perimeter size = " << perimeter.size() << ", pk = " << pk << "\n" << std::flush;
-
-    int finest_resolution = 0;
-    if (cover_level == -1)
-        this->cover_level = finest_resolution;
-    else
-        this->cover_level = cover_level;
-
-    if (verbose)
-        std::cout << "cover_level = " << this->cover_level << "\n" << std::flush;
-
-    int level = 27;
-    STARE index(level, build_level);
-
-    cover = index.NonConvexHull(perimeter, this->cover_level);
+    if ((ret = readCover(granule, verbose, build_level, cover_level, use_gring)))
+        return ret;
+    setIndexNames();
 
-    if (verbose) std::cout << "cover size = " << cover.size() << "\n";
-
-    geo_num_cover_values.push_back(cover.size());
-    vector<unsigned long long int> geo_cover_1;
-    for (int k = 0; k < geo_num_cover_values[0]; ++k) 
-	geo_cover_1.push_back(cover[k]);
-    geo_cover.push_back(geo_cover_1);
-    
-    d_num_index = 3;
-    stare_cover_name.push_back("1km");
-    // Open the swath file.
-    if ((swathfileid = SWopen((char *) fileName.c_str(), DFACC_RDONLY)) < 0)
-        return SSC_EHDF4ERR;
-
-    if ((nswath = SWinqswath((char *) fileName.c_str(), swathlist, &strbufsize)) < 0)
-        return SSC_EHDF4ERR;
+    if ((ret = granule.swath_list(nswath, swathlist)))
+        return ret;
     if (verbose) std::cout << "nswath " << nswath << " " << swathlist << "\n";
 
-    // Attach to a swath.
-    string MODIS_SWATH_TYPE_L2 = "MODIS SWATH TYPE L2";
-    if ((swathid = SWattach(swathfileid, (char *) MODIS_SWATH_TYPE_L2.c_str())) < 0)
-        return SSC_EHDF4ERR;
+    // Attach to a swath. It is detached when the granule is closed.
+    if ((ret = granule.attach(MODIS_SWATH_TYPE_L2, swathid)))
+        return ret;
+
+    // Allocate the grids for all three resolutions up front. The
+    // indices are computed in place, and the 1 km lat/lons are read
+    // straight into the 1 km grid.
+    geo_grid.push_back(GeoGrid(MAX_ALONG, MAX_ACROSS, SCAN_ROWS));
+    geo_grid.push_back(GeoGrid(MAX_ALONG_500, MAX_ACROSS_500, 2 * SCAN_ROWS));
+    geo_grid.push_back(GeoGrid(MAX_ALONG_250, MAX_ACROSS_250, 4 * SCAN_ROWS));
+    double *lats = geo_grid[0].lat().data();
+    double *lons = geo_grid[0].lon().data();
 
     // Get lat and lon values.
-    vector<double> lats;
-    vector<double> lons;
     {
-	float *longitude;
-	float *latitude;
-	
-	if (!(longitude = (float *) calloc(MAX_ALONG * MAX_ACROSS, sizeof(float))))
-	    return SSC_ENOMEM;
-	if (!(latitude = (float *) calloc(MAX_ALONG * MAX_ACROSS, sizeof(float))))
-	    return SSC_ENOMEM;
-	
+        vector<float> longitude((size_t) MAX_ALONG * MAX_ACROSS);
+        vector<float> latitude((size_t) MAX_ALONG * MAX_ACROSS);
+
 	string LONGITUDE = "Longitude";
-	if (SWreadfield(swathid, (char *) LONGITUDE.c_str(), NULL, NULL, NULL, longitude))
+	if (SWreadfield(swathid, (char *) LONGITUDE.c_str(), NULL, NULL, NULL, &longitude[0]))
 	    return SSC_EHDF4ERR;
 	string LATITUDE = "Latitude";
-	if (SWreadfield(swathid, (char *) LATITUDE.c_str(), NULL, NULL, NULL, latitude))
+	if (SWreadfield(swathid, (char *) LATITUDE.c_str(), NULL, NULL, NULL, &latitude[0]))
 	    return SSC_EHDF4ERR;
 
-        for (int i = 0; i < MAX_ALONG; i++) {
-            for (int j = 0; j < MAX_ACROSS; j++) {
-		lats.push_back(latitude[i * MAX_ACROSS + j]);
-		lons.push_back(longitude[i * MAX_ACROSS + j]);
-	    }
-	}
-
-	free(longitude);
-	free(latitude);
+        std::copy(latitude.begin(), latitude.end(), lats);
+        std::copy(longitude.begin(), longitude.end(), lons);
     }
 
-    level = 27;
-
     // Learn about dims for this swath.
     if ((ndims = SWinqdims(swathid, dimnames, dimids)) < 0)
         return SSC_EHDF4ERR;
     if (verbose) std::cout << "ndims " << ndims << " " << dimnames << "\n";
 
     std::stringstream ss(dimnames);
-    std::vector<std::string> result;
     while (ss.good()) {
         std::string substr;
         getline(ss, substr, ',');
-        result.push_back(substr);
 
         // Get a dimsize.
         if ((dimsize = SWdiminfo(swathid, (char *) substr.c_str())) < 0)
@@ -191,9 +168,6 @@ Modis09L2GeoFile::readFile(const std::string fileName, int verbose, int build_le
 
     }
 
-    for (std::size_t i = 0; i < result.size(); i++)
-        std::cout << result[i] << std::endl;
-
     if ((ngeofields = SWinqgeofields(swathid, fieldlist, rank, numbertype)) < 0)
         return SSC_EHDF4ERR;
     if (verbose) std::cout << "ngeofields " << ngeofields << " " << fieldlist << "\n";
@@ -221,207 +195,500 @@ Modis09L2GeoFile::readFile(const std::string fileName, int verbose, int build_le
     // 		  offset, increment))
     // 	return SSC_EHDF4ERR;
 
-    // Detach from the swath.
-    if (SWdetach(swathid) < 0)
-        return SSC_EHDF4ERR;
+    // Index the whole granule as one block.
+    int finest_resolution;
+    if ((ret = indexRows(verbose, build_level, lats, lons, 0, 0, MAX_ALONG,
+                         geo_grid[0].index().data(), geo_grid[1].lat().data(),
+                         geo_grid[1].lon().data(), geo_grid[1].index().data(),
+                         geo_grid[2].lat().data(), geo_grid[2].lon().data(),
+                         geo_grid[2].index().data(), finest_resolution)))
+        return ret;
+
+    // Build the cover from the 1 km indices, if wanted.
+    if (exact_cover) {
+        if (this->cover_level == -1)
+            this->cover_level = finest_resolution;
+        CoverBuilder builder(this->cover_level, thread_count());
+        builder.add(geo_grid[0]);
+        setCover(verbose, "1km", builder);
+    }
+    else if (!use_gring) {
+        if (this->cover_level == -1)
+            this->cover_level = finest_resolution;
+        PerimeterWalker walker(MAX_ALONG, MAX_ACROSS, perimeter_stride, perimeter_tolerance);
+        walker.add(geo_grid[0]);
+        setCover(verbose, "1km", build_level, walker);
+    }
 
-    // Close the swath file.
-    if (SWclose(swathfileid) < 0)
-        return SSC_EHDF4ERR;
+    return 0;
+}
 
-    STARE index1(level, build_level);
-    vector<unsigned long long int> geo_index_1;
-
-    // // Calculate STARE index for each point.
-    // {
-    //     unsigned long length = MAX_ALONG * MAX_ACROSS;
-    //     for (unsigned long i = 0; i < length; ++i) {
-    // 	    // lats.push_back(latitude[i]);
-    // 	    // lons.push_back(longitude[i]);
-
-    //         // Calculate the stare indices.
-    // 	    geo_index_1.push_back(index1.ValueFromLatLonDegrees(lats[i], lons[i], level));
-    //     }
-    // }
-
-    vector<double> lats_500;
-    vector<double> lons_500;
-    vector<unsigned long long int> geo_index_500;
-    // {
-
-    //     // Calculate STARE index for each point.
-    //     int m = 0;
-    //     for (int i = 0; i < MAX_ALONG_500; i++) {
-    //         if (i && !(i % 2)) m++;
-    //         int n = 0;
-    //         for (int j = 0; j < MAX_ACROSS_500; j++) {
-    // 		int ret;
-    // 		double lat_delta, lon_delta;
-
-    //             if (j && !(j % 2)) n++;
-    // 		if (n == 0)
-    // 		    lon_delta = abs(lons[m * MAX_ACROSS + n] - lons[m * MAX_ACROSS + n + 1]);
-    // 		else
-    // 		    lon_delta = abs(lons[m * MAX_ACROSS + n] - lons[m * MAX_ACROSS + n - 1]);
-
-    // 		if (m == 0)
-    // 		    lat_delta = abs(lats[m * MAX_ACROSS + n] - lats[m * MAX_ACROSS + n + MAX_ACROSS]);
-    // 		else
-    // 		    lat_delta = abs(lats[m * MAX_ACROSS + n] - lats[m * MAX_ACROSS + n - MAX_ACROSS]);
-
-    // 		// Deal with meridian.
-    // 		if (lon_delta >= 0.4)
-    // 		    lon_delta = 360 - abs(lon_delta);
-
-    // 		lats_500.push_back(lats[m * MAX_ACROSS + n] + (j % 2) * lat_delta / 2.0);
-    // 		lons_500.push_back(lons[m * MAX_ACROSS + n] + (j % 2) * lon_delta / 2.0);
-
-    //             // Calculate the stare indices.
-    // 		geo_index_500.push_back(index1.ValueFromLatLonDegrees((double)lats[m * MAX_ACROSS + n],
-    // 								      (double)lons[m * MAX_ACROSS + n], level));
-    //         }
-    //     }
-
-    // }
-
-    vector<double> lats_250;
-    vector<double> lons_250;
-    vector<unsigned long long int> geo_index_250;
-    {
-        // Calculate STARE index for each point.
-        int m = 0;
-        for (int i = 0; i < MAX_ALONG_250; i++) {
-            if (i && !(i % 4)) m++;
-            int n = 0;
-	    int edge = 1; // True if on the bounrery between 40-pixel scans.
-            for (int j = 0; j < MAX_ACROSS_250; j++) {
-		int ret;
-		double lat_delta, lon_delta;
-                if (j && !(j % 4)) {
-		    n++;
-		    edge = 0;
-		    if (!(n % NUM_PIXELS))
-			edge++;
-		}
-		// printf("i %d j %d m %d n %d edge %d i%%4 %d j%%4 %d\n", i, j, m, n, edge, i%4, j%4);		    
-
-		// Determine longitude delta.
-		if (edge)
-		    lon_delta = abs(lons[m * MAX_ACROSS + n] - lons[m * MAX_ACROSS + n + 1]);
-		else
-		    lon_delta = abs(lons[m * MAX_ACROSS + n] - lons[m * MAX_ACROSS + n - 1]);
-
-		// Determine lats delta.
-		{
-		    if (m == 0)
-			lat_delta = abs(lats[m * MAX_ACROSS + n] - lats[m * MAX_ACROSS + n + MAX_ACROSS]);
-		    else
-			lat_delta = abs(lats[m * MAX_ACROSS + n] - lats[m * MAX_ACROSS + n - MAX_ACROSS]);
-		}
-
-		if (i < 10 && j < 10)
-		    printf("i %d j %d lat_delta %g lon_delta %g\n", i, j, lat_delta, lon_delta);
-
-		// Deal with meridian.
-		if (lon_delta >= 0.4)
-		{
-		    lon_delta = 360 - abs(lon_delta);
-		}
-		if (lon_delta >= 0.4)
-		{
-		    printf("i %d j %d lon_delta %g\n", i, j, lon_delta);
-		    printf("m %d n %d edge %d lons[m * MAX_ACROSS + n] %g lons[m * MAX_ACROSS + n - 1] %g\n", m, n, edge,
-			   lons[m * MAX_ACROSS + n], lons[m * MAX_ACROSS + n - 1]);
-		    printf("(lons[m * MAX_ACROSS + n] - lons[m * MAX_ACROSS + n - 1]) %g\n",
-			   (lons[m * MAX_ACROSS + n] - lons[m * MAX_ACROSS + n - 1]));
-		    printf("(lons[m * MAX_ACROSS + n] - lons[m * MAX_ACROSS + n + 1]) %g\n",
-			   (lons[m * MAX_ACROSS + n] - lons[m * MAX_ACROSS + n + 1]));
-		    printf("abs((lons[m * MAX_ACROSS + n] - lons[m * MAX_ACROSS + n - 1])) %g\n",
-			   abs((lons[m * MAX_ACROSS + n] - lons[m * MAX_ACROSS + n - 1])));
-		    printf("abs(lons[m * MAX_ACROSS + n] - lons[m * MAX_ACROSS + n + 1]) %g\n",
-			   abs(lons[m * MAX_ACROSS + n] - lons[m * MAX_ACROSS + n + 1]));
-		    return 99;
-		}
-		if (lat_delta >= 0.4)
-		{
-		    printf("i %d j %d lat_delta %g\n", i, j, lat_delta);
-		    return 99;
-		}
-		double this_lat, this_lon;
-		this_lat = lats[m * MAX_ACROSS + n] + (j % 4) * lat_delta / 4.0;
-		this_lon = lons[m * MAX_ACROSS + n] + (j % 4) * lon_delta / 4.0;
-
-                // Calculate the stare indices.
-		unsigned long long int this_index;
-		this_index = index1.ValueFromLatLonDegrees(this_lat, this_lon, level);
-
-		// Store these values for 250m grid.
-		lats_250.push_back(this_lat);
-		lons_250.push_back(this_lon);
-		geo_index_250.push_back(this_index);
-
-		// For every other point, store the values on the 500m grid.
-		if (!i%2 && !j%2) {
-		    lats_500.push_back(this_lat);
-		    lons_500.push_back(this_lon);
-		    geo_index_500.push_back(this_index);
-		}
-
-		// For every forth point, store the values on the 1km grid.
-		if (!i%4 && !j%4) {
-		    geo_index_1.push_back(this_index);
-		}
+/**
+ * Get the cover of a MOD09 granule from its GRing. With exact_cover
+ * set, or without use_gring, only the cover level is set here, and
+ * the cover is built from the 1 km points as they are read.
+ *
+ * @param granule the open granule.
+ * @param verbose non-zero for verbose output to stdout.
+ * @param build_level STARE build level.
+ * @param cover_level STARE cover level, -1 for the default.
+ * @param use_gring if false, walk the perimeter of the swath instead.
+ *
+ * @return 0 for no error, error code otherwise.
+ */
+int
+Modis09L2GeoFile::readCover(Hdf4Granule &granule, int verbose, int build_level, int cover_level,
+                            bool use_gring) {
+    int ret;
 
+    num_cover = 1;
+    stare_cover_name.push_back("1km");
+
+    // An exact cover is built from the 1 km indices once they are
+    // computed, and a walked perimeter from the 1 km lat/lons. The
+    // default level is the finest of the 1 km points.
+    if (exact_cover || !use_gring) {
+        this->cover_level = cover_level;
+        return 0;
+    }
+
+    LatLonDegrees64ValueVector perimeter; // Resize below
+    int pk; // perimeter counter
+
+    // Get the GRing info. After this call, gring_lat and gring_lon
+    // contain the 4 gring values for lat and lon.
+    float gring_lat[SSC_NUM_GRING], gring_lon[SSC_NUM_GRING];
+    if ((ret = getGRing(granule, verbose, gring_lat, gring_lon))) {
+	cerr << "Error with GRing, maybe retry with --walk_perimeter 1.\n";
+	return ret;
+    }
+    
+    // Note the hardcoded 4 for the 4 corners or the gring.
+    perimeter.resize(4); // Use 4 here until we find a granule with more than 4.
+    pk = 3;
+    for (int i = 0; i < 4; ++i) {
+	perimeter[pk].lat = gring_lat[i];
+	perimeter[pk].lon = gring_lon[i];
+	--pk;
+    }
+
+    if (verbose)
+        std::cout << "perimeter size = " << perimeter.size() << ", pk = " << pk << "\n" << std::flush;
+
+    int finest_resolution = 0;
+    if (cover_level == -1)
+        this->cover_level = finest_resolution;
+    else
+        this->cover_level = cover_level;
+
+    if (verbose)
+        std::cout << "cover_level = " << this->cover_level << "\n" << std::flush;
+
+    setCover(verbose, "1km", build_level, perimeter);
+
+    return 0;
+}
+
+/**
+ * Set up the names of the three STARE indices of a MOD09 granule, and
+ * the variables each applies to.
+ */
+void
+Modis09L2GeoFile::setIndexNames() {
+    d_num_index = 3;
+
+    // Settings for 1 km.
+    d_stare_index_name.push_back("1km");  //Added jhrg 6/9/21
+    var_name[0].push_back("1km Atmospheric Optical Depth Band 1");
+    var_name[0].push_back("1km Atmospheric Optical Depth Band 3");
+    var_name[0].push_back("1km Atmospheric Optical Depth Band 8");
+    var_name[0].push_back("1km Atmospheric Optical Depth Model");
+    var_name[0].push_back("1km water_vapor");
+    var_name[0].push_back("1km Atmospheric Optical Depth Band QA");
+    var_name[0].push_back("1km Atmospheric Optical Depth Band CM");
+
+    // Settings for 500m.
+    d_stare_index_name.push_back("500m");
+    var_name[1].push_back("500m Surface Reflectance Band 1");
+    var_name[1].push_back("500m Surface Reflectance Band 2");
+    var_name[1].push_back("500m Surface Reflectance Band 3");
+    var_name[1].push_back("500m Surface Reflectance Band 4");
+    var_name[1].push_back("500m Surface Reflectance Band 5");
+    var_name[1].push_back("500m Surface Reflectance Band 6");
+    var_name[1].push_back("500m Surface Reflectance Band 7");
+
+    // Settings for 250m
+    d_stare_index_name.push_back("250m");
+    var_name[2].push_back("250m Surface Reflectance Band 1");
+    var_name[2].push_back("250m Surface Reflectance Band 2");
+    var_name[2].push_back("250m Surface Reflectance Band 3");
+    var_name[2].push_back("250m Surface Reflectance Band 4");
+    var_name[2].push_back("250m Surface Reflectance Band 5");
+    var_name[2].push_back("250m Surface Reflectance Band 6");
+    var_name[2].push_back("250m Surface Reflectance Band 7");
+}
+
+/** Interpolation from the 1 km grid to the 500 m grid. */
+static const ScanInterpolator &
+interp_500() {
+    static const ScanInterpolator interp(MAX_ALONG, MAX_ACROSS, SCAN_ROWS, 2, MAX_ACROSS_500);
+    return interp;
+}
+
+/** Interpolation from the 1 km grid to the 250 m grid. */
+static const ScanInterpolator &
+interp_250() {
+    static const ScanInterpolator interp(MAX_ALONG, MAX_ACROSS, SCAN_ROWS, 4, MAX_ACROSS_250);
+    return interp;
+}
+
+/**
+ * Find the 1 km rows needed to index a block of 1 km rows at all
+ * three resolutions.
+ *
+ * @param m0 First 1 km row of the block.
+ * @param m1 One past the last 1 km row of the block.
+ * @param first_row Gets the first 1 km row needed.
+ * @param last_row Gets one past the last 1 km row needed.
+ */
+static void
+needed_rows(int m0, int m1, int &first_row, int &last_row) {
+    int c0, c1;
+
+    interp_250().coarse_rows(4 * m0, 4 * m1, first_row, last_row);
+    interp_500().coarse_rows(2 * m0, 2 * m1, c0, c1);
+    first_row = std::min(std::min(first_row, c0), m0);
+    last_row = std::max(std::max(last_row, c1), m1);
+}
+
+/**
+ * Interpolate one 1 km row to a finer grid, and index the fine points
+ * starting from the trixel shared by the two 1 km points each one is
+ * interpolated between.
+ *
+ * @param indexer Indexer of the calling thread.
+ * @param interp Interpolation to the fine grid.
+ * @param factor Fine rows per 1 km row.
+ * @param lats 1 km latitudes, starting at row first_row.
+ * @param lons 1 km longitudes, laid out like lats.
+ * @param first_row 1 km row that lats and lons start at.
+ * @param m The 1 km row.
+ * @param shared Trixel shared by each 1 km point of row m and the next.
+ * @param hint Scratch space for factor rows of hints.
+ * @param fine_lat Gets factor rows of fine latitudes.
+ * @param fine_lon Gets factor rows of fine longitudes.
+ * @param fine_index Gets factor rows of fine indices.
+ */
+static void
+refine_row(TrixelIndexer &indexer, const ScanInterpolator &interp, int factor, const double *lats,
+           const double *lons, int first_row, int m, const unsigned long long int *shared,
+           unsigned long long int *hint, double *fine_lat, double *fine_lon,
+           unsigned long long int *fine_index) {
+    int cols = interp.fine_cols();
+    size_t n = (size_t) factor * cols;
+
+    interp.interpolate(lats, lons, first_row, factor * m, factor * (m + 1), fine_lat, fine_lon);
+    for (int p = 0; p < cols; p++)
+        hint[p] = shared[interp.coarse_col(p)];
+    for (int k = 1; k < factor; k++)
+        std::copy(hint, hint + cols, hint + (size_t) k * cols);
+    indexer.refine(fine_lat, fine_lon, hint, n, 27, fine_index);
+}
+
+/**
+ * Compute the 1 km, 500 m and 250 m STARE indices, and the 500 m and
+ * 250 m lat/lons, for a block of 1 km rows. The finer lat/lons are
+ * interpolated from the 1 km ones within each scan, with
+ * ScanInterpolator. The 1 km points are indexed first, and the finer
+ * points are refined down from the trixels of the 1 km points around
+ * them. Last, the resolution of every point is estimated from the
+ * spacing of its neighbors.
+ *
+ * @param verbose non-zero for verbose output to stdout.
+ * @param build_level STARE build level.
+ * @param lats 1 km latitudes, starting at row first_row. Must include
+ * the rows needed_rows() gives for m0 and m1.
+ * @param lons 1 km longitudes, laid out like lats.
+ * @param first_row 1 km row that lats and lons start at.
+ * @param m0 First 1 km row of the block, the first row of a scan.
+ * @param m1 One past the last 1 km row of the block, the end of a
+ * scan.
+ * @param geo_index_1 Gets the 1 km indices of rows m0 to m1 - 1.
+ * @param lats_500 Gets the 500 m latitudes of the block.
+ * @param lons_500 Gets the 500 m longitudes of the block.
+ * @param geo_index_500 Gets the 500 m indices of the block.
+ * @param lats_250 Gets the 250 m latitudes of the block.
+ * @param lons_250 Gets the 250 m longitudes of the block.
+ * @param geo_index_250 Gets the 250 m indices of the block.
+ * @param finest Gets the finest resolution level of the 1 km points.
+ *
+ * @return 0 for no error, error code otherwise.
+ */
+int
+Modis09L2GeoFile::indexRows(int verbose, int build_level, const double *lats, const double *lons,
+                            int first_row, int m0, int m1, unsigned long long int *geo_index_1,
+                            double *lats_500, double *lons_500, unsigned long long int *geo_index_500,
+                            double *lats_250, double *lons_250, unsigned long long int *geo_index_250,
+                            int &finest) {
+    // Each 1 km row and the 500 m and 250 m rows under it only read
+    // the 1 km lat/lons and write their own rows, so the rows can be
+    // done in any order, each thread with its own indexer.
+    const TrixelTable *table;
+    int level = 27;
+    int ret;
+    if ((ret = trixel_table(level, build_level, &table)))
+        return ret;
+
+    int nthreads = thread_count();
+    if (verbose) std::cout << "Calculating STARE indices with " << nthreads << " thread(s)...\n";
+
+#pragma omp parallel num_threads(nthreads)
+    {
+        TrixelIndexer indexer(level, build_level);
+        indexer.set_table(table);
+        vector<unsigned long long int> shared(MAX_ACROSS);
+        vector<unsigned long long int> hint((size_t) 4 * MAX_ACROSS_250);
+
+#pragma omp for schedule(dynamic, 8)
+        for (int m = m0; m < m1; m++) {
+            const double *lat_1km = &lats[(size_t) (m - first_row) * MAX_ACROSS];
+            const double *lon_1km = &lons[(size_t) (m - first_row) * MAX_ACROSS];
+            unsigned long long int *parent = &geo_index_1[(size_t) (m - m0) * MAX_ACROSS];
+
+            // Index the native 1 km points first.
+            indexer.index(lat_1km, lon_1km, MAX_ACROSS, level, parent);
+            for (int n = 0; n + 1 < MAX_ACROSS; n++) {
+                int common = stare_common_level(parent[n], parent[n + 1]);
+                shared[n] = common < 0 ? SSC_STARE_NO_TRIXEL : stare_truncate(parent[n], common);
             }
-        }
 
-	// Settings for 1 km.
-	d_stare_index_name.push_back("1km");  //Added jhrg 6/9/21
-	var_name[0].push_back("1km Atmospheric Optical Depth Band 1");
-	var_name[0].push_back("1km Atmospheric Optical Depth Band 3");
-	var_name[0].push_back("1km Atmospheric Optical Depth Band 8");
-	var_name[0].push_back("1km Atmospheric Optical Depth Model");
-	var_name[0].push_back("1km water_vapor");
-	var_name[0].push_back("1km Atmospheric Optical Depth Band QA");
-	var_name[0].push_back("1km Atmospheric Optical Depth Band CM");
-	geo_num_i.push_back(MAX_ALONG);
-	geo_num_j.push_back(MAX_ACROSS);
-	geo_lat.push_back(lats);
-	geo_lon.push_back(lons);
-	geo_index.push_back(geo_index_1);
-
-	// Settings for 500m.
-        d_stare_index_name.push_back("500m");
-        var_name[1].push_back("500m Surface Reflectance Band 1");
-        var_name[1].push_back("500m Surface Reflectance Band 2");
-        var_name[1].push_back("500m Surface Reflectance Band 3");
-        var_name[1].push_back("500m Surface Reflectance Band 4");
-        var_name[1].push_back("500m Surface Reflectance Band 5");
-        var_name[1].push_back("500m Surface Reflectance Band 6");
-        var_name[1].push_back("500m Surface Reflectance Band 7");
-	geo_num_i.push_back(MAX_ALONG_500);
-        geo_num_j.push_back(MAX_ACROSS_500);
-	geo_lat.push_back(lats_500);
-	geo_lon.push_back(lons_500);
-	geo_index.push_back(geo_index_500);
-
-	// Settings for 250m
-        d_stare_index_name.push_back("250m");
-        var_name[2].push_back("250m Surface Reflectance Band 1");
-        var_name[2].push_back("250m Surface Reflectance Band 2");
-        var_name[2].push_back("250m Surface Reflectance Band 3");
-        var_name[2].push_back("250m Surface Reflectance Band 4");
-        var_name[2].push_back("250m Surface Reflectance Band 5");
-        var_name[2].push_back("250m Surface Reflectance Band 6");
-        var_name[2].push_back("250m Surface Reflectance Band 7");
-        geo_num_i.push_back(MAX_ALONG_250);
-        geo_num_j.push_back(MAX_ACROSS_250);
-	geo_lat.push_back(lats_250);
-	geo_lon.push_back(lons_250);
-	geo_index.push_back(geo_index_250);
-	
+            size_t row_500 = (size_t) 2 * (m - m0) * MAX_ACROSS_500;
+            refine_row(indexer, interp_500(), 2, lats, lons, first_row, m, &shared[0], &hint[0],
+                       &lats_500[row_500], &lons_500[row_500], &geo_index_500[row_500]);
+            size_t row_250 = (size_t) 4 * (m - m0) * MAX_ACROSS_250;
+            refine_row(indexer, interp_250(), 4, lats, lons, first_row, m, &shared[0], &hint[0],
+                       &lats_250[row_250], &lons_250[row_250], &geo_index_250[row_250]);
+        }
     }
 
+    // Encode the resolution of each point. The block is whole scans,
+    // so it holds every neighbor the spacing estimate looks at.
+    size_t rows = m1 - m0, in_block = (size_t) (m0 - first_row) * MAX_ACROSS;
+    finest = setResolution(&lats[in_block], &lons[in_block], rows, MAX_ACROSS, SCAN_ROWS,
+                           build_level, geo_index_1);
+    setResolution(lats_500, lons_500, 2 * rows, MAX_ACROSS_500, 2 * SCAN_ROWS, build_level,
+                  geo_index_500);
+    setResolution(lats_250, lons_250, 4 * rows, MAX_ACROSS_250, 4 * SCAN_ROWS, build_level,
+                  geo_index_250);
+
     return 0;
 }
 
+/**
+ * Number of 1 km rows to read and index at a time so that the row
+ * buffers of streamFile() fit in max_memory bytes. Blocks are whole
+ * scans (SCAN_ROWS rows), since the resolution of a point depends on
+ * the rows above and below it in its scan, so a budget smaller than
+ * one scan still gets one scan.
+ *
+ * @param max_memory Memory budget in bytes, 0 for no limit.
+ *
+ * @return number of 1 km rows per block, a multiple of SCAN_ROWS.
+ */
+static int
+block_rows(size_t max_memory) {
+    // Bytes for the lat/lons read for one 1 km row, as float and double.
+    size_t in_row = (size_t) MAX_ACROSS * 2 * (sizeof(float) + sizeof(double));
+    // Bytes for everything computed from one 1 km row: its index, and
+    // lat/lon/index for 2 rows at 500 m and 4 at 250 m.
+    size_t out_row = (size_t) MAX_ACROSS * sizeof(unsigned long long) +
+                     (size_t) 2 * MAX_ACROSS_500 * (2 * sizeof(double) + sizeof(unsigned long long)) +
+                     (size_t) 4 * MAX_ACROSS_250 * (2 * sizeof(double) + sizeof(unsigned long long));
+    size_t rows;
+
+    if (!max_memory)
+        return MAX_ALONG;
+
+    // Each block may also read the row on either side of it.
+    rows = max_memory > 2 * in_row ? (max_memory - 2 * in_row) / (in_row + out_row) : 0;
+    rows -= rows % SCAN_ROWS;
+    if (rows < SCAN_ROWS)
+        rows = SCAN_ROWS;
+    if (rows > MAX_ALONG)
+        rows = MAX_ALONG;
+
+    return (int) rows;
+}
+
+/**
+ * Read a HDF4 MODIS L2 MOD09 file and write its STARE indices to a
+ * sidecar file as it goes. Lat/lons are read a block of 1 km rows at
+ * a time with SWreadfield(), the block is indexed at all three
+ * resolutions, and the rows are written with nc_put_vara, so memory
+ * use depends on the block size and not on the size of the granule.
+ *
+ * The indices are written and not kept, so geo_grid is left empty.
+ * The cover is computed as in readFile(), and still has to be written
+ * by the caller. With exact_cover the cover level must be given: the
+ * cover is built a block at a time, before the finest level of the
+ * granule is known.
+ *
+ * @param fileName the data file name.
+ * @param verbose non-zero for verbose output to stdout.
+ * @param build_level STARE build level.
+ * @param cover_level STARE cover level; -1 for the default, except
+ * with exact_cover.
+ * @param use_gring if true, use g-ring data for cover calculation.
+ * @param perimeter_stride perimeter stride.
+ * @param max_memory Budget in bytes for the row buffers, 0 to do the
+ * granule as one block.
+ * @param sf Sidecar file, created and not yet holding any STARE
+ * index.
+ *
+ * @return 0 for no error, SSC_EINPUT for exact_cover without a cover
+ * level, error code otherwise.
+ */
+int
+Modis09L2GeoFile::streamFile(const std::string fileName, int verbose, int build_level,
+                             int cover_level, bool use_gring, int perimeter_stride,
+                             size_t max_memory, SidecarFile &sf) {
+    Hdf4Granule granule;
+    int ret;
+
+    if ((ret = granule.open(fileName)))
+        return ret;
+    if ((ret = streamFile(granule, verbose, build_level, cover_level, use_gring,
+                          perimeter_stride, max_memory, sf)))
+        return ret;
+
+    return granule.close();
+}
+
+/**
+ * Read an open HDF4 MODIS L2 MOD09 granule and write its STARE indices
+ * to a sidecar file as it goes, as streamFile() above. The GRing and
+ * the lat/lons are read from the one open granule.
+ *
+ * @param granule the open granule.
+ * @param verbose non-zero for verbose output to stdout.
+ * @param build_level STARE build level.
+ * @param cover_level STARE cover level; -1 for the default, except
+ * with exact_cover.
+ * @param use_gring if true, use g-ring data for cover calculation.
+ * @param perimeter_stride perimeter stride.
+ * @param max_memory Budget in bytes for the row buffers, 0 to do the
+ * granule as one block.
+ * @param sf Sidecar file, created and not yet holding any STARE
+ * index.
+ *
+ * @return 0 for no error, SSC_EINPUT for exact_cover without a cover
+ * level, error code otherwise.
+ */
+int
+Modis09L2GeoFile::streamFile(Hdf4Granule &granule, int verbose, int build_level,
+                             int cover_level, bool use_gring, int perimeter_stride,
+                             size_t max_memory, SidecarFile &sf) {
+    int32 swathid;
+    int index_id[3];
+    int ret;
+
+    if (exact_cover && cover_level == -1)
+        return SSC_EINPUT;
+    if ((ret = readCover(granule, verbose, build_level, cover_level, use_gring)))
+        return ret;
+    setIndexNames();
+
+    // Define all three indices before writing any rows, so the
+    // variables are in the same order as with readFile().
+    const int num_i[3] = {MAX_ALONG, MAX_ALONG_500, MAX_ALONG_250};
+    const int num_j[3] = {MAX_ACROSS, MAX_ACROSS_500, MAX_ACROSS_250};
+    const int scan_rows[3] = {SCAN_ROWS, 2 * SCAN_ROWS, 4 * SCAN_ROWS};
+    for (int k = 0; k < d_num_index; k++)
+        if ((ret = sf.defineSTAREIndex(verbose, build_level, num_i[k], num_j[k], scan_rows[k],
+                                       var_name[k], d_stare_index_name[k], index_id[k])))
+            return ret;
+
+    int block = block_rows(max_memory);
+    if (verbose) std::cout << "Streaming " << granule.file_name() << " in blocks of " << block << " 1km rows\n";
+
+    // Attach to the swath. It is detached when the granule is closed.
+    if ((ret = granule.attach(MODIS_SWATH_TYPE_L2, swathid)))
+        return ret;
+
+    // Buffers for one block, plus the row it needs on either side.
+    int max_read = std::min(block + 2, MAX_ALONG);
+    vector<float> latitude((size_t) max_read * MAX_ACROSS);
+    vector<float> longitude((size_t) max_read * MAX_ACROSS);
+    vector<double> lats((size_t) max_read * MAX_ACROSS);
+    vector<double> lons((size_t) max_read * MAX_ACROSS);
+    vector<unsigned long long int> geo_index_1((size_t) block * MAX_ACROSS);
+    vector<double> lats_500((size_t) 2 * block * MAX_ACROSS_500);
+    vector<double> lons_500((size_t) 2 * block * MAX_ACROSS_500);
+    vector<unsigned long long int> geo_index_500((size_t) 2 * block * MAX_ACROSS_500);
+    vector<double> lats_250((size_t) 4 * block * MAX_ACROSS_250);
+    vector<double> lons_250((size_t) 4 * block * MAX_ACROSS_250);
+    vector<unsigned long long int> geo_index_250((size_t) 4 * block * MAX_ACROSS_250);
+
+    // With exact_cover, the cover is built from the 1 km indices of
+    // each block, at the cover level given.
+    CoverBuilder builder(this->cover_level, thread_count());
+
+    // Without the GRing, the edge of each block is kept to walk the
+    // perimeter, at the finest level of any block by default.
+    PerimeterWalker walker(MAX_ALONG, MAX_ACROSS, perimeter_stride, perimeter_tolerance);
+    int finest_resolution = 0;
+
+    for (int m0 = 0; m0 < MAX_ALONG; m0 += block) {
+        int m1 = std::min(m0 + block, MAX_ALONG);
+        int first_row, last_row, finest;
+        needed_rows(m0, m1, first_row, last_row);
+        int32 start[SSC_NDIM2] = {first_row, 0};
+        int32 edge[SSC_NDIM2] = {last_row - first_row, MAX_ACROSS};
+        size_t n = (size_t) (last_row - first_row) * MAX_ACROSS;
+
+        string LONGITUDE = "Longitude";
+        if (SWreadfield(swathid, (char *) LONGITUDE.c_str(), start, NULL, edge, &longitude[0]))
+            return SSC_EHDF4ERR;
+        string LATITUDE = "Latitude";
+        if (SWreadfield(swathid, (char *) LATITUDE.c_str(), start, NULL, edge, &latitude[0]))
+            return SSC_EHDF4ERR;
+        std::copy(latitude.begin(), latitude.begin() + n, lats.begin());
+        std::copy(longitude.begin(), longitude.begin() + n, lons.begin());
+
+        if ((ret = indexRows(verbose, build_level, &lats[0], &lons[0], first_row, m0, m1,
+                             &geo_index_1[0], &lats_500[0], &lons_500[0], &geo_index_500[0],
+                             &lats_250[0], &lons_250[0], &geo_index_250[0], finest)))
+            return ret;
+
+        size_t in_block = (size_t) (m0 - first_row) * MAX_ACROSS;
+        int rows = m1 - m0;
+        if (exact_cover) {
+            builder.add(&lats[in_block], &geo_index_1[0], (size_t) rows * MAX_ACROSS);
+        }
+        else if (!use_gring) {
+            walker.add_rows(&lats[in_block], &lons[in_block], m0, rows);
+            finest_resolution = std::max(finest_resolution, finest);
+        }
+        if ((ret = sf.writeSTAREIndexRows(index_id[0], m0, rows, &lats[in_block],
+                                          &lons[in_block], &geo_index_1[0])))
+            return ret;
+        if ((ret = sf.writeSTAREIndexRows(index_id[1], 2 * m0, 2 * rows, &lats_500[0],
+                                          &lons_500[0], &geo_index_500[0])))
+            return ret;
+        if ((ret = sf.writeSTAREIndexRows(index_id[2], 4 * m0, 4 * rows, &lats_250[0],
+                                          &lons_250[0], &geo_index_250[0])))
+            return ret;
+    }
+
+    if (exact_cover) {
+        this->cover_level = builder.level();
+        setCover(verbose, "1km", builder);
+    }
+    else if (!use_gring) {
+        if (this->cover_level == -1)
+            this->cover_level = finest_resolution;
+        setCover(verbose, "1km", build_level, walker);
+    }
+
+    return 0;
+}
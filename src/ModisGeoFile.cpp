@@ -38,21 +38,30 @@ ModisGeoFile::~ModisGeoFile() {
  */
 int
 ModisGeoFile::determineFormat(const std::string fileName, int *gf_format) {
-    int32 swathfileid;
+    Hdf4Granule granule;
+    int ret;
 
-    if (gf_format)
-        *gf_format = SSC_FORMAT_HDF4;
+    // A file that doesn't open is left as HDF4.
+    granule.open(fileName);
+    if ((ret = determineFormat(granule, gf_format)))
+        return ret;
 
-    // Try to open as swath file with the HDF-EOS library.
-    swathfileid = SWopen((char *) fileName.c_str(), DFACC_RDONLY);
-    if (swathfileid != -1) {
-        if (gf_format)
-            *gf_format = SSC_FORMAT_MODIS_L2;
+    return granule.close();
+}
 
-        // Close the swath file.
-        if (SWclose(swathfileid) < 0)
-            return SSC_EHDF4ERR;
-    }
+/**
+ * Determine the format of an open granule.
+ *
+ * @param granule The granule.
+ * @param gf_format Pointer to int that gets a constant indicating the
+ * format. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ */
+int
+ModisGeoFile::determineFormat(Hdf4Granule &granule, int *gf_format) {
+    if (gf_format)
+        *gf_format = granule.is_swath() ? SSC_FORMAT_MODIS_L2 : SSC_FORMAT_HDF4;
 
     return 0;
 }
@@ -60,51 +69,56 @@ ModisGeoFile::determineFormat(const std::string fileName, int *gf_format) {
 /** Read the GRing info.
  *
  * @param fileName name of the file.
+ * @param verbose non-zero for verbose output to stdout.
+ * @param gring_lat Gets the SSC_NUM_GRING GRing latitudes.
+ * @param gring_lon Gets the SSC_NUM_GRING GRing longitudes.
  *
  * @return 0 for success, error code otherwise.
  */
 int
 ModisGeoFile::getGRing(const std::string fileName, int verbose, float *gring_lat, float *gring_lon) {
-    char attr_name[SSC_MAX_NAME];
-    char *sm_attr;
+    Hdf4Granule granule;
+    int ret;
+
+    if ((ret = granule.open(fileName)))
+        return ret;
+    if ((ret = getGRing(granule, verbose, gring_lat, gring_lon)))
+        return ret;
+
+    return granule.close();
+}
+
+/** Read the GRing info from the metadata of an open granule.
+ *
+ * @param granule The granule.
+ * @param verbose non-zero for verbose output to stdout.
+ * @param gring_lat Gets the SSC_NUM_GRING GRing latitudes.
+ * @param gring_lon Gets the SSC_NUM_GRING GRing longitudes.
+ *
+ * @return 0 for success, SSC_EHDF4ERR if the metadata has no GRing,
+ * error code otherwise.
+ */
+int
+ModisGeoFile::getGRing(Hdf4Granule &granule, int verbose, float *gring_lat, float *gring_lon) {
     string sm;
     string lon_str = "GRINGPOINTLONGITUDE";
     string lat_str = "GRINGPOINTLATITUDE";
     int32 num_datasets, num_global_attrs;
     string grlon, grlat;
-    int32 sd_id;
-    int32 data_type, count;
-    int32 am0_idx;
-    const int LON_INC = 126;
-    const int LAT_INC = 125;
-    const int LON_LEN = 71;
-    const int LAT_LEN = 70;
     int ret;
 
-    // Open the HDF4 SD API for this file.
-    if ((sd_id = SDstart(fileName.c_str(), DFACC_READ)) == -1)
-        return SSC_EHDF4ERR;
-
     // Learn about this file.
-    if (SDfileinfo(sd_id, &num_datasets, &num_global_attrs))
-        return SSC_EHDF4ERR;
-    if (verbose)
+    if (verbose) {
+        if (SDfileinfo(granule.sd_id(), &num_datasets, &num_global_attrs))
+            return SSC_EHDF4ERR;
         cout << "num_datasets " << num_datasets << " num_global_attrs " << num_global_attrs << "\n";
+    }
 
-    // Find the attribute called ArchiveMetadata.0.
-    if ((am0_idx = SDfindattr(sd_id, am0_str.c_str())) == -1)
-        return SSC_EHDF4ERR;
-
-    // Learn about the am0 attribute.
-    if ((ret = SDattrinfo(sd_id, am0_idx, attr_name, &data_type, &count)) == -1)
-        return SSC_EHDF4ERR;
+    // Read the metadata attribute, such as ArchiveMetadata.0.
+    if ((ret = granule.read_attribute(am0_str, sm)))
+        return ret;
     if (verbose)
-        cout << "attribute " << attr_name << " data type " << data_type << " count " << count << "\n";
-    if (!(sm_attr = (char *) malloc(count * sizeof(char))))
-        return SSC_ENOMEM;
-    if ((ret = SDreadattr(sd_id, am0_idx, sm_attr)))
-        return SSC_EHDF4ERR;
-    sm = sm_attr;
+        cout << "attribute " << am0_str << " length " << sm.size() << "\n";
 
     // Find the positions of the longitude and latitude GRing info in
     // the ArchiveMetadata.0 text string.
@@ -114,7 +128,9 @@ ModisGeoFile::getGRing(const std::string fileName, int verbose, float *gring_lat
     string open_paren_str = "(";
 
     // Find GRINGPOINTLONGITUDE section.
-    lon_pos = sm.find(lon_str, 0);
+    if ((lon_pos = sm.find(lon_str, 0)) == string::npos ||
+        sm.find(lat_str, 0) == string::npos)
+        return SSC_EHDF4ERR;
     // Find start of longitude list.
     lon_pos = sm.find(open_paren_str, lon_pos) + 1;
     end_lon_pos = sm.find(close_paren_str, lon_pos);
@@ -155,13 +171,6 @@ ModisGeoFile::getGRing(const std::string fileName, int verbose, float *gring_lat
             cout << "gring_lat[" << i << "]=" << gring_lat[i] << "\n";
     }
 
-    // Free resources.
-    free(sm_attr);
-
-    // Close the HDF4 SD API for this file.
-    if (SDend(sd_id))
-        return SSC_EHDF4ERR;
-
     return 0;
 }
 
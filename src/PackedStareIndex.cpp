@@ -0,0 +1,314 @@
+/// @file
+/// This class holds a 2-D array of STARE indices packed with a
+/// lossless codec made for them.
+
+#include "config.h"
+#include "PackedStareIndex.h"
+#include "StareBits.h"
+#include "ssc.h"
+#include <algorithm>
+#include <cstring>
+
+#define LEVEL_BITS 5 /**< Bits of the level of an index. */
+#define LOCATION_BITS 59 /**< Bits of the location of an index, above the level. */
+#define LOCATION_ONES ((1ULL << LOCATION_BITS) - 1) /**< All location bits set. */
+#define WIDTH_BITS 6 /**< Bits of the bit width of a block. */
+#define NOT_LEVEL 31 /**< Level of an index that is not a trixel. */
+#define MIN_PARALLEL_ROWS 64 /**< Fewest rows worth unpacking in parallel. */
+
+/** Writes values of up to 64 bits to bytes, least significant bit first. */
+class BitWriter {
+public:
+    BitWriter(std::vector<unsigned char> &out) : d_out(out), d_acc(0), d_num_bits(0) {}
+
+    /** Write the low width bits of value; the rest must be zero. */
+    void put(unsigned long long value, int width) {
+        if (width > 32) {
+            put(value & 0xffffffffULL, 32);
+            value >>= 32;
+            width -= 32;
+        }
+        d_acc |= value << d_num_bits;
+        d_num_bits += width;
+        while (d_num_bits >= 8) {
+            d_out.push_back((unsigned char) d_acc);
+            d_acc >>= 8;
+            d_num_bits -= 8;
+        }
+    }
+
+    /** Write the last partial byte. */
+    void flush() {
+        if (d_num_bits)
+            d_out.push_back((unsigned char) d_acc);
+        d_acc = 0;
+        d_num_bits = 0;
+    }
+
+private:
+    std::vector<unsigned char> &d_out;
+    unsigned long long d_acc; /**< Bits not yet written. */
+    int d_num_bits; /**< Number of bits not yet written. */
+};
+
+/** Reads values written by a BitWriter. Reads past the end give zeros. */
+class BitReader {
+public:
+    BitReader(const unsigned char *bytes, size_t num_bytes) :
+        d_bytes(bytes), d_num_bytes(num_bytes), d_pos(0) {}
+
+    /** Read width bits. */
+    unsigned long long get(int width) {
+        if (width > 32) {
+            unsigned long long low = get(32);
+            return low | get(width - 32) << 32;
+        }
+        if (!width)
+            return 0;
+        unsigned long long value = load(d_pos >> 3) >> (d_pos & 7);
+        d_pos += width;
+        return value & ((1ULL << width) - 1);
+    }
+
+    /** Were no more bits read than there are? */
+    bool ok() const { return d_pos <= d_num_bytes * 8; }
+
+private:
+    /** The 8 bytes from byte, as a little endian value. */
+    unsigned long long load(size_t byte) const {
+        unsigned long long value = 0;
+
+        if (byte + sizeof(value) <= d_num_bytes)
+            memcpy(&value, d_bytes + byte, sizeof(value));
+        else if (byte < d_num_bytes)
+            memcpy(&value, d_bytes + byte, d_num_bytes - byte);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        value = __builtin_bswap64(value);
+#endif
+        return value;
+    }
+
+    const unsigned char *d_bytes;
+    size_t d_num_bytes;
+    size_t d_pos; /**< Bits read. */
+};
+
+/** Bits needed for a value. */
+static inline int
+bit_width(unsigned long long value) {
+    return value ? 64 - __builtin_clzll(value) : 0;
+}
+
+/**
+ * Pack one row.
+ *
+ * @param index The row of indices.
+ * @param n Length of the row.
+ * @param out Gets the packed row appended.
+ */
+static void
+pack_row(const unsigned long long *index, size_t n, std::vector<unsigned char> &out) {
+    BitWriter bits(out);
+    unsigned long long residual[SSC_PACK_BLOCK];
+    size_t k;
+
+    // The level channel.
+    for (k = 1; k < n && stare_level(index[k]) == stare_level(index[0]); k++)
+        ;
+    if (k >= n) {
+        bits.put(0, 1);
+        bits.put(n ? stare_level(index[0]) : 0, LEVEL_BITS);
+    } else {
+        bits.put(1, 1);
+        for (k = 0; k < n; k++)
+            bits.put(stare_level(index[k]), LEVEL_BITS);
+    }
+
+    // The location of the first pixel with geolocation.
+    unsigned long long prev = 0;
+    for (k = 0; k < n; k++) {
+        if (stare_level(index[k]) != NOT_LEVEL) {
+            prev = index[k] >> LEVEL_BITS;
+            break;
+        }
+    }
+    bits.put(prev, LOCATION_BITS);
+
+    // The locations XORed with the one before, a block at a time.
+    for (size_t b = 0; b < n; b += SSC_PACK_BLOCK) {
+        size_t num = std::min(n - b, (size_t) SSC_PACK_BLOCK);
+        unsigned long long all = 0;
+
+        for (k = 0; k < num; k++) {
+            unsigned long long id = index[b + k], location = id >> LEVEL_BITS;
+            if (stare_level(id) == NOT_LEVEL) {
+                residual[k] = location ^ LOCATION_ONES;
+            } else {
+                residual[k] = location ^ prev;
+                prev = location;
+            }
+            all |= residual[k];
+        }
+        int width = bit_width(all);
+        bits.put(width, WIDTH_BITS);
+        for (k = 0; k < num; k++)
+            bits.put(residual[k], width);
+    }
+    bits.flush();
+}
+
+/**
+ * Unpack one row.
+ *
+ * @param bytes The packed row.
+ * @param num_bytes Length of the packed row.
+ * @param n Length of the row.
+ * @param index Gets the row of indices.
+ *
+ * @return 0 for success, SSC_EINPUT if the packed row is not valid.
+ */
+static int
+unpack_row(const unsigned char *bytes, size_t num_bytes, size_t n, unsigned long long *index) {
+    BitReader bits(bytes, num_bytes);
+    size_t k;
+
+    // The level channel, kept in index until the locations are added.
+    if (!bits.get(1)) {
+        unsigned long long level = bits.get(LEVEL_BITS);
+        for (k = 0; k < n; k++)
+            index[k] = level;
+    } else {
+        for (k = 0; k < n; k++)
+            index[k] = bits.get(LEVEL_BITS);
+    }
+
+    unsigned long long prev = bits.get(LOCATION_BITS);
+    for (size_t b = 0; b < n; b += SSC_PACK_BLOCK) {
+        size_t end = std::min(n, b + SSC_PACK_BLOCK);
+        int width = (int) bits.get(WIDTH_BITS);
+
+        if (width > LOCATION_BITS)
+            return SSC_EINPUT;
+        for (k = b; k < end; k++) {
+            unsigned long long residual = bits.get(width), location;
+            if (index[k] == NOT_LEVEL) {
+                location = residual ^ LOCATION_ONES;
+            } else {
+                location = residual ^ prev;
+                prev = location;
+            }
+            index[k] |= location << LEVEL_BITS;
+        }
+    }
+
+    return bits.ok() ? 0 : SSC_EINPUT;
+}
+
+/**
+ * An empty array.
+ *
+ * @param num_j Number of columns.
+ */
+PackedStareIndex::PackedStareIndex(size_t num_j) : d_num_j(num_j) {
+}
+
+/**
+ * Pack an array of STARE indices.
+ *
+ * @param index num_i rows of num_j indices.
+ * @param num_i Number of rows.
+ * @param num_j Number of columns.
+ *
+ * @return the packed array.
+ */
+PackedStareIndex
+PackedStareIndex::pack(const unsigned long long *index, size_t num_i, size_t num_j) {
+    PackedStareIndex packed(num_j);
+
+    packed.append_rows(index, num_i);
+    return packed;
+}
+
+/**
+ * Pack rows, appended to those packed before, such as a block of
+ * scans of a granule that is streamed.
+ *
+ * @param index num_rows rows of num_j() indices.
+ * @param num_rows Number of rows.
+ */
+void
+PackedStareIndex::append_rows(const unsigned long long *index, size_t num_rows) {
+    for (size_t i = 0; i < num_rows; i++) {
+        d_offsets.push_back(d_bytes.size());
+        pack_row(index + i * d_num_j, d_num_j, d_bytes);
+    }
+}
+
+/**
+ * Unpack a run of rows. The rows are unpacked in parallel.
+ *
+ * @param start_row First row.
+ * @param num_rows Number of rows.
+ * @param index Gets num_rows rows of num_j() indices.
+ *
+ * @return 0 for success, SSC_EINPUT if the rows are not in the array
+ * or are not valid.
+ */
+int
+PackedStareIndex::unpack_rows(size_t start_row, size_t num_rows, unsigned long long *index) const {
+    int num_bad = 0;
+
+    if (start_row > num_i() || num_rows > num_i() - start_row)
+        return SSC_EINPUT;
+
+#pragma omp parallel for schedule(static) reduction(+:num_bad) if (num_rows >= MIN_PARALLEL_ROWS)
+    for (long long r = 0; r < (long long) num_rows; r++) {
+        size_t i = start_row + r;
+        size_t end = i + 1 < num_i() ? d_offsets[i + 1] : d_bytes.size();
+        if (unpack_row(d_bytes.data() + d_offsets[i], end - d_offsets[i], d_num_j,
+                       index + r * d_num_j))
+            num_bad++;
+    }
+
+    return num_bad ? SSC_EINPUT : 0;
+}
+
+/**
+ * Unpack all rows.
+ *
+ * @param index Gets num_i() rows of num_j() indices.
+ *
+ * @return 0 for success, SSC_EINPUT if the rows are not valid.
+ */
+int
+PackedStareIndex::unpack(std::vector<unsigned long long> &index) const {
+    index.resize(num_i() * d_num_j);
+    return unpack_rows(0, num_i(), index.data());
+}
+
+/**
+ * Use packed rows, such as those read from a sidecar file. The bytes
+ * and offsets are copied.
+ *
+ * @param num_j Number of columns.
+ * @param bytes The packed rows.
+ * @param num_bytes Length of bytes.
+ * @param offsets Byte offset of each row, in order.
+ * @param num_i Number of rows.
+ *
+ * @return 0 for success, SSC_EINPUT if the offsets are not in order
+ * or are past the bytes.
+ */
+int
+PackedStareIndex::assign(size_t num_j, const unsigned char *bytes, size_t num_bytes,
+                         const unsigned long long *offsets, size_t num_i) {
+    for (size_t i = 0; i < num_i; i++)
+        if (offsets[i] > num_bytes || (i && offsets[i] < offsets[i - 1]))
+            return SSC_EINPUT;
+
+    d_num_j = num_j;
+    d_bytes.assign(bytes, bytes + num_bytes);
+    d_offsets.assign(offsets, offsets + num_i);
+
+    return 0;
+}
@@ -0,0 +1,210 @@
+/// @file
+/// This class walks the edge of a swath to get the perimeter for a
+/// STARE cover.
+
+#include "config.h"
+#include "PerimeterWalker.h"
+#include "GeoGrid.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#define DEG_TO_RAD 1.74532925199432957692e-02
+#define FIRST_ROW 0 /**< Side of the first row. */
+#define LAST_COLUMN 1 /**< Side of the last column. */
+#define LAST_ROW 2 /**< Side of the last row. */
+#define FIRST_COLUMN 3 /**< Side of the first column. */
+
+/** A point of the perimeter, as a unit vector. */
+struct EdgePoint {
+    double lat, lon;
+    double x, y, z;
+};
+
+/** Make an edge point from a lat/lon. */
+static EdgePoint
+edge_point(double lat, double lon) {
+    EdgePoint p;
+    double cos_lat = std::cos(lat * DEG_TO_RAD);
+    p.lat = lat;
+    p.lon = lon;
+    p.x = cos_lat * std::cos(lon * DEG_TO_RAD);
+    p.y = cos_lat * std::sin(lon * DEG_TO_RAD);
+    p.z = std::sin(lat * DEG_TO_RAD);
+    return p;
+}
+
+/**
+ * Sine of the angle between p and the great circle through a and b,
+ * or between p and a if a and b are the same point.
+ */
+static double
+sin_off_arc(const EdgePoint &p, const EdgePoint &a, const EdgePoint &b) {
+    double nx = a.y * b.z - a.z * b.y;
+    double ny = a.z * b.x - a.x * b.z;
+    double nz = a.x * b.y - a.y * b.x;
+    double norm = std::sqrt(nx * nx + ny * ny + nz * nz);
+
+    if (norm < 1e-15) {
+        double cx = p.y * a.z - p.z * a.y;
+        double cy = p.z * a.x - p.x * a.z;
+        double cz = p.x * a.y - p.y * a.x;
+        return std::sqrt(cx * cx + cy * cy + cz * cz);
+    }
+    return std::fabs(p.x * nx + p.y * ny + p.z * nz) / norm;
+}
+
+/**
+ * Set up a walk of the edge.
+ *
+ * @param num_i Rows in the swath.
+ * @param num_j Points in each row.
+ * @param stride Take every stride'th point of each side, 1 for all.
+ * @param tolerance Drop points within this many degrees of the
+ * perimeter without them, 0 to keep every point taken.
+ */
+PerimeterWalker::PerimeterWalker(size_t num_i, size_t num_j, int stride, double tolerance) :
+    d_num_i(num_i), d_num_j(num_j), d_stride(std::max(stride, 1)),
+    d_tolerance(std::max(tolerance, 0.0)) {
+    for (int s = 0; s < 4; s++) {
+        size_t n = (s == FIRST_ROW || s == LAST_ROW) ? num_j : num_i;
+        d_lat[s].resize(n);
+        d_lon[s].resize(n);
+    }
+}
+
+/**
+ * Add a block of rows. Only the edge points are kept.
+ *
+ * @param lat Latitudes of the rows, row major.
+ * @param lon Longitudes of the rows, row major.
+ * @param first_row Row of the swath the block starts at.
+ * @param num_rows Rows in the block.
+ */
+void
+PerimeterWalker::add_rows(const double *lat, const double *lon, size_t first_row, size_t num_rows) {
+    for (size_t r = 0; r < num_rows; r++) {
+        size_t i = first_row + r;
+        const double *row_lat = lat + r * d_num_j;
+        const double *row_lon = lon + r * d_num_j;
+
+        d_lat[FIRST_COLUMN][i] = row_lat[0];
+        d_lon[FIRST_COLUMN][i] = row_lon[0];
+        d_lat[LAST_COLUMN][i] = row_lat[d_num_j - 1];
+        d_lon[LAST_COLUMN][i] = row_lon[d_num_j - 1];
+        if (i == 0) {
+            std::copy(row_lat, row_lat + d_num_j, d_lat[FIRST_ROW].begin());
+            std::copy(row_lon, row_lon + d_num_j, d_lon[FIRST_ROW].begin());
+        }
+        if (i == d_num_i - 1) {
+            std::copy(row_lat, row_lat + d_num_j, d_lat[LAST_ROW].begin());
+            std::copy(row_lon, row_lon + d_num_j, d_lon[LAST_ROW].begin());
+        }
+    }
+}
+
+/**
+ * Add every row of a grid.
+ *
+ * @param grid The grid, num_i by num_j.
+ */
+void
+PerimeterWalker::add(const GeoGrid &grid) {
+    add_rows(grid.lat().data(), grid.lon().data(), 0, grid.num_i());
+}
+
+/**
+ * Get the perimeter. The edge is walked counterclockwise in row and
+ * column terms, along the first row, up the last column, back along
+ * the last row and down the first column, and the points given in the
+ * reverse order.
+ *
+ * @param perimeter Gets the perimeter.
+ */
+void
+PerimeterWalker::perimeter(LatLonDegrees64ValueVector &perimeter) const {
+    const long num_i = (long) d_num_i, num_j = (long) d_num_j, stride = d_stride;
+    std::vector<std::pair<int, long> > walk;
+    std::vector<EdgePoint> points;
+    std::vector<size_t> corners;
+
+    // Take the points of each side as the readers always have,
+    // including a corner after the last stride of a side.
+    for (long j = 0; j < num_j; j += stride) {
+        walk.push_back(std::make_pair(FIRST_ROW, j));
+        if (stride > 1 && j + stride >= num_j)
+            walk.push_back(std::make_pair(FIRST_ROW, num_j - 1));
+    }
+    for (long i = 1; i < num_i; i += stride) {
+        walk.push_back(std::make_pair(LAST_COLUMN, i));
+        if (stride > 1 && i + stride >= num_i)
+            walk.push_back(std::make_pair(LAST_COLUMN, num_i - 1));
+    }
+    for (long j = num_j - 2; j > -1; j -= stride) {
+        walk.push_back(std::make_pair(LAST_ROW, j));
+        if (stride > 1 && j - stride < 0)
+            walk.push_back(std::make_pair(LAST_ROW, 0L));
+    }
+    for (long i = num_i - 2; i > 0; i -= stride) {
+        walk.push_back(std::make_pair(FIRST_COLUMN, i));
+        if (stride > 1 && i - stride < 0)
+            walk.push_back(std::make_pair(FIRST_COLUMN, 0L));
+    }
+
+    // Leave out fill values, and note where each side starts.
+    int side = -1;
+    for (size_t k = 0; k < walk.size(); k++) {
+        double lat = d_lat[walk[k].first][walk[k].second];
+        double lon = d_lon[walk[k].first][walk[k].second];
+        if (!(std::fabs(lat) <= 90.0) || !(std::fabs(lon) <= 360.0))
+            continue;
+        if (walk[k].first != side) {
+            side = walk[k].first;
+            corners.push_back(points.size());
+        }
+        points.push_back(edge_point(lat, lon));
+    }
+
+    // Keep the points off the great circle between the points kept on
+    // either side, one stretch between corners at a time.
+    size_t n = points.size();
+    std::vector<char> keep(n, d_tolerance == 0.0);
+    if (d_tolerance > 0.0 && n) {
+        double sin_tolerance = std::sin(std::min(d_tolerance, 90.0) * DEG_TO_RAD);
+        std::vector<std::pair<size_t, size_t> > stack;
+
+        for (size_t c = 0; c < corners.size(); c++) {
+            keep[corners[c]] = 1;
+            size_t end = c + 1 < corners.size() ? corners[c + 1] : n + corners[0];
+            stack.push_back(std::make_pair(corners[c], end));
+        }
+        while (!stack.empty()) {
+            size_t first = stack.back().first, last = stack.back().second;
+            stack.pop_back();
+
+            size_t worst = 0;
+            double worst_sin = sin_tolerance;
+            for (size_t k = first + 1; k < last; k++) {
+                double s = sin_off_arc(points[k % n], points[first % n], points[last % n]);
+                if (s > worst_sin) {
+                    worst_sin = s;
+                    worst = k;
+                }
+            }
+            if (worst) {
+                keep[worst % n] = 1;
+                stack.push_back(std::make_pair(first, worst));
+                stack.push_back(std::make_pair(worst, last));
+            }
+        }
+    }
+
+    perimeter.clear();
+    for (size_t k = n; k-- > 0;) {
+        if (!keep[k])
+            continue;
+        perimeter.resize(perimeter.size() + 1);
+        perimeter.back().lat = points[k].lat;
+        perimeter.back().lon = points[k].lon;
+    }
+}
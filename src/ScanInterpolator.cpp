@@ -0,0 +1,169 @@
+/// @file
+/// This class interpolates MODIS geolocation from a coarse grid to a
+/// finer one, one scan at a time.
+
+#include "config.h"
+#include "ScanInterpolator.h"
+#include "ssc.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// The tests and selections below work on the bits of the doubles as
+// integers. Floating point comparisons and selections would do the
+// same, but compilers do not vectorize them unless told that floating
+// point operations can not trap.
+
+/** Is x a valid latitude? For non-negative doubles, comparing the
+ * bits as integers orders them like the values, with NaN last. */
+static inline bool
+valid_lat(double x) {
+    double ax = std::fabs(x), limit = 90.0;
+    long long bx, bl;
+
+    std::memcpy(&bx, &ax, sizeof(bx));
+    std::memcpy(&bl, &limit, sizeof(bl));
+    return bx <= bl;
+}
+
+/** a if ok, else b. */
+static inline double
+pick(bool ok, double a, double b) {
+    long long ba, bb, mask = -(long long) ok;
+
+    std::memcpy(&ba, &a, sizeof(ba));
+    std::memcpy(&bb, &b, sizeof(bb));
+    ba = (ba & mask) | (bb & ~mask);
+    std::memcpy(&a, &ba, sizeof(a));
+    return a;
+}
+
+/**
+ * Step from one lat/lon toward another, the short way around in
+ * longitude. Gives SSC_GEO_FILL if either end is not a valid lat/lon.
+ * Longitudes in [-180, 180] are left as they are.
+ */
+static inline void
+lerp(double lat0, double lon0, double lat1, double lon1, double t, double &lat, double &lon) {
+    double dlon = lon1 - lon0;
+    dlon -= 360.0 * std::nearbyint(dlon / 360.0);
+    bool ok = valid_lat(lat0) & valid_lat(lat1);
+    double la = lat0 + t * (lat1 - lat0);
+    double lo = lon0 + t * dlon;
+
+    lo -= 360.0 * std::nearbyint(lo / 360.0);
+    lat = pick(ok, la, SSC_GEO_FILL);
+    lon = pick(ok, lo, SSC_GEO_FILL);
+}
+
+/** Interpolate between two coarse rows at every coarse column. */
+SSC_TARGET_CLONES static void
+row_kernel(const double *lat0, const double *lon0, const double *lat1, const double *lon1,
+           double t, int n, double *lat, double *lon) {
+#pragma omp simd
+    for (int c = 0; c < n; c++)
+        lerp(lat0[c], lon0[c], lat1[c], lon1[c], t, lat[c], lon[c]);
+}
+
+/** Interpolate across a row to every fine column. */
+SSC_TARGET_CLONES static void
+col_kernel(const double *row_lat, const double *row_lon, const int *col0, const double *col_t,
+           int n, double *lat, double *lon) {
+#pragma omp simd
+    for (int p = 0; p < n; p++) {
+        int j = col0[p];
+        lerp(row_lat[j], row_lon[j], row_lat[j + 1], row_lon[j + 1], col_t[p], lat[p], lon[p]);
+    }
+}
+
+/**
+ * Set up interpolation from one grid to another.
+ *
+ * @param num_rows Number of coarse rows, a whole number of scans.
+ * @param num_cols Number of coarse columns, at least 2.
+ * @param rows_per_scan Number of coarse rows in a scan.
+ * @param factor Number of fine pixels along each side of a coarse one.
+ * @param fine_cols Number of fine columns. Columns past the coarse
+ * ones are extrapolated.
+ */
+ScanInterpolator::ScanInterpolator(int num_rows, int num_cols, int rows_per_scan, int factor,
+                                   int fine_cols) :
+    d_num_rows(num_rows), d_num_cols(num_cols), d_rows_per_scan(rows_per_scan), d_factor(factor),
+    d_fine_cols(fine_cols), d_col0(fine_cols), d_col_t(fine_cols) {
+    double offset = (factor - 1) / 2.0;
+
+    for (int p = 0; p < fine_cols; p++) {
+        double v = (p - offset) / factor;
+        int j = std::min(std::max((int) std::floor(v), 0), num_cols - 2);
+        d_col0[p] = j;
+        d_col_t[p] = v - j;
+    }
+}
+
+/**
+ * Find the coarse rows that a fine row is interpolated from, both in
+ * the same scan.
+ *
+ * @param q Fine row.
+ * @param i0 Gets the first coarse row.
+ * @param t Gets the weight of the row after i0.
+ */
+void
+ScanInterpolator::along_track(int q, int &i0, double &t) const {
+    int scan = q / (d_rows_per_scan * d_factor);
+    int first = scan * d_rows_per_scan;
+    int last = first + d_rows_per_scan - 1;
+    double u = (q - (d_factor - 1) / 2.0) / d_factor;
+
+    i0 = std::min(std::max((int) std::floor(u), first), std::max(first, last - 1));
+    t = last > first ? u - i0 : 0.0;
+}
+
+/**
+ * Find the coarse rows needed to interpolate some fine rows.
+ *
+ * @param q0 First fine row.
+ * @param q1 One past the last fine row.
+ * @param c0 Gets the first coarse row needed.
+ * @param c1 Gets one past the last coarse row needed.
+ */
+void
+ScanInterpolator::coarse_rows(int q0, int q1, int &c0, int &c1) const {
+    double t;
+    int i;
+
+    along_track(q0, c0, t);
+    along_track(q1 - 1, i, t);
+    c1 = std::min(i + 2, (q1 - 1) / (d_rows_per_scan * d_factor) * d_rows_per_scan + d_rows_per_scan);
+}
+
+/**
+ * Interpolate some fine rows.
+ *
+ * @param lat Coarse latitudes, starting at row first_row. Must hold the
+ * rows coarse_rows() gives for q0 and q1.
+ * @param lon Coarse longitudes, laid out like lat.
+ * @param first_row Coarse row that lat and lon start at.
+ * @param q0 First fine row.
+ * @param q1 One past the last fine row.
+ * @param fine_lat Gets q1 - q0 rows of fine latitudes.
+ * @param fine_lon Gets q1 - q0 rows of fine longitudes.
+ */
+void
+ScanInterpolator::interpolate(const double *lat, const double *lon, int first_row, int q0, int q1,
+                              double *fine_lat, double *fine_lon) const {
+    std::vector<double> row_lat(d_num_cols), row_lon(d_num_cols);
+
+    for (int q = q0; q < q1; q++) {
+        size_t a, b, out = (size_t) (q - q0) * d_fine_cols;
+        double t;
+        int i0;
+
+        along_track(q, i0, t);
+        a = (size_t) (i0 - first_row) * d_num_cols;
+        b = t != 0.0 ? a + d_num_cols : a;
+        row_kernel(&lat[a], &lon[a], &lat[b], &lon[b], t, d_num_cols, &row_lat[0], &row_lon[0]);
+        col_kernel(&row_lat[0], &row_lon[0], &d_col0[0], &d_col_t[0], d_fine_cols,
+                   &fine_lat[out], &fine_lon[out]);
+    }
+}
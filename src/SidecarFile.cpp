@@ -6,8 +6,14 @@
 
 #include "config.h"
 #include "SidecarFile.h"
+#include "PackedStareIndex.h"
 #include "ssc.h"
 #include <netcdf.h>
+#if defined(NC_HAS_ZSTD) && NC_HAS_ZSTD
+#include <netcdf_filter.h>
+#endif
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
 
 #define NDIM2 2
@@ -17,6 +23,273 @@
 #define NAME_HISTORY "history"
 #define MAX_TIME_STR 128
 #define CF_VERSION "CF-1.8"
+#define DEFAULT_DEFLATE_LEVEL 3
+#define DEFAULT_ZSTD_LEVEL 3
+#define MAX_DEFLATE_LEVEL 9
+#define MAX_ZSTD_LEVEL 22
+#define PACK_PREFIX "stare+" /**< Codec prefix to pack STARE indices. */
+#define MAX_DOUBLE_DIGITS 15 /**< Most significant digits a double lat/lon is quantized to. */
+#define MAX_FLOAT_DIGITS 7 /**< Most significant digits a float lat/lon is quantized to. */
+
+/**
+ * The default layout: chunks of whole scans, shuffled and deflated at
+ * level 3, with exact double lat/lons.
+ */
+SidecarLayout::SidecarLayout() :
+    d_codec(SSC_CODEC_DEFLATE), d_level(DEFAULT_DEFLATE_LEVEL), d_pack_index(false),
+    d_chunk_rows(0), d_chunk_cols(0), d_geo_type(NC_DOUBLE), d_geo_digits(0) {
+}
+
+/**
+ * Set the codec from text.
+ *
+ * @param spec "none", or "deflate" or "zstd", optionally followed by
+ * a colon and a level, 1 to 9 for deflate and 1 to 22 for zstd. Any of
+ * these may follow "stare+" to pack the STARE indices, and "stare" is
+ * "stare+deflate:3".
+ *
+ * @return 0 for success, SSC_EINPUT if spec is not valid, or names
+ * zstd and netCDF-C was built without it.
+ */
+int
+SidecarLayout::set_codec(const string &spec) {
+    if (spec == "stare")
+        return set_codec(PACK_PREFIX "deflate");
+    if (!spec.compare(0, sizeof(PACK_PREFIX) - 1, PACK_PREFIX)) {
+        string rest = spec.substr(sizeof(PACK_PREFIX) - 1);
+        int ret;
+        if (!rest.compare(0, 5, "stare"))
+            return SSC_EINPUT;
+        if ((ret = set_codec(rest)))
+            return ret;
+        d_pack_index = true;
+        return 0;
+    }
+
+    string name = spec.substr(0, spec.find(':'));
+    int codec, level, max_level;
+
+    if (name == "none" && name == spec) {
+        d_codec = SSC_CODEC_NONE;
+        d_level = 0;
+        d_pack_index = false;
+        return 0;
+    }
+    if (name == "deflate") {
+        codec = SSC_CODEC_DEFLATE;
+        level = DEFAULT_DEFLATE_LEVEL;
+        max_level = MAX_DEFLATE_LEVEL;
+    } else if (name == "zstd") {
+#if defined(NC_HAS_ZSTD) && NC_HAS_ZSTD
+        codec = SSC_CODEC_ZSTD;
+        level = DEFAULT_ZSTD_LEVEL;
+        max_level = MAX_ZSTD_LEVEL;
+#else
+        return SSC_EINPUT;
+#endif
+    } else {
+        return SSC_EINPUT;
+    }
+
+    if (name != spec) {
+        const char *str = spec.c_str() + name.size() + 1;
+        char *end;
+        long n = strtol(str, &end, 10);
+        if (end == str || *end || n < 1 || n > max_level)
+            return SSC_EINPUT;
+        level = (int) n;
+    }
+    d_codec = codec;
+    d_level = level;
+    d_pack_index = false;
+
+    return 0;
+}
+
+/**
+ * Set the chunks from text.
+ *
+ * @param spec "scan" for chunks of whole scans, or the rows of a
+ * chunk, optionally followed by "x" and its columns.
+ *
+ * @return 0 for success, SSC_EINPUT if spec is not valid.
+ */
+int
+SidecarLayout::set_chunks(const string &spec) {
+    const char *str = spec.c_str();
+    char *end;
+
+    if (spec == "scan") {
+        d_chunk_rows = d_chunk_cols = 0;
+        return 0;
+    }
+
+    long rows = strtol(str, &end, 10), cols = 0;
+    if (end == str || rows < 1)
+        return SSC_EINPUT;
+    if (*end == 'x') {
+        str = end + 1;
+        cols = strtol(str, &end, 10);
+        if (end == str || cols < 1)
+            return SSC_EINPUT;
+    }
+    if (*end)
+        return SSC_EINPUT;
+    d_chunk_rows = rows;
+    d_chunk_cols = cols;
+
+    return 0;
+}
+
+/**
+ * Set the precision of the lat/lons from text.
+ *
+ * @param spec "double" or "float", optionally followed by a colon and
+ * the significant digits to quantize to, 1 to 15 for double and 1 to 7
+ * for float.
+ *
+ * @return 0 for success, SSC_EINPUT if spec is not valid, or asks for
+ * digits and netCDF-C was built without quantize.
+ */
+int
+SidecarLayout::set_geo(const string &spec) {
+    string name = spec.substr(0, spec.find(':'));
+    int type, digits = 0, max_digits;
+
+    if (name == "double") {
+        type = NC_DOUBLE;
+        max_digits = MAX_DOUBLE_DIGITS;
+    } else if (name == "float") {
+        type = NC_FLOAT;
+        max_digits = MAX_FLOAT_DIGITS;
+    } else {
+        return SSC_EINPUT;
+    }
+
+    if (name != spec) {
+#if defined(NC_HAS_QUANTIZE) && NC_HAS_QUANTIZE
+        const char *str = spec.c_str() + name.size() + 1;
+        char *end;
+        long n = strtol(str, &end, 10);
+        if (end == str || *end || n < 1 || n > max_digits)
+            return SSC_EINPUT;
+        digits = (int) n;
+#else
+        return SSC_EINPUT;
+#endif
+    }
+    d_geo_type = type;
+    d_geo_digits = digits;
+
+    return 0;
+}
+
+/**
+ * The precision of the lat/lons as text, in the form set_geo() takes.
+ *
+ * @return the precision, such as "double" or "float:5".
+ */
+string
+SidecarLayout::geo_str() const {
+    std::ostringstream out;
+
+    out << (d_geo_type == NC_FLOAT ? "float" : "double");
+    if (d_geo_digits)
+        out << ":" << d_geo_digits;
+
+    return out.str();
+}
+
+/**
+ * Chunk shape of a STARE index, and its lat/lons.
+ *
+ * @param num_i Number of rows.
+ * @param num_j Number of columns.
+ * @param rows_per_scan Rows in one scan of the instrument, 0 for a
+ * grid without scans.
+ * @param chunks Gets the rows and columns of a chunk.
+ */
+void
+SidecarLayout::index_chunks(size_t num_i, size_t num_j, size_t rows_per_scan,
+                            size_t chunks[2]) const {
+    size_t rows = d_chunk_rows, cols = d_chunk_cols ? d_chunk_cols : num_j;
+
+    if (!rows) {
+        size_t scan = std::max(rows_per_scan, (size_t) 1);
+        size_t scan_bytes = std::max(scan * num_j * sizeof(double), (size_t) 1);
+        rows = scan * ((SSC_CHUNK_BYTES + scan_bytes - 1) / scan_bytes);
+    }
+    chunks[0] = std::max(std::min(rows, num_i), (size_t) 1);
+    chunks[1] = std::max(std::min(cols, num_j), (size_t) 1);
+}
+
+/**
+ * Chunk length of a STARE cover, the whole cover up to SSC_CHUNK_BYTES.
+ *
+ * @param size Number of values in the cover.
+ *
+ * @return the chunk length.
+ */
+size_t
+SidecarLayout::cover_chunk(size_t size) const {
+    return std::max(std::min(size, (size_t) SSC_CHUNK_BYTES / sizeof(unsigned long long)),
+                    (size_t) 1);
+}
+
+/**
+ * The layout as text, in the form set_codec() and set_chunks() take,
+ * followed by that of set_geo() unless the lat/lons are exact doubles.
+ *
+ * @return the layout, such as "deflate:3,scan" or "deflate:3,scan,float".
+ */
+string
+SidecarLayout::str() const {
+    std::ostringstream out;
+
+    if (d_pack_index)
+        out << PACK_PREFIX;
+    if (d_codec == SSC_CODEC_NONE)
+        out << "none";
+    else
+        out << (d_codec == SSC_CODEC_ZSTD ? "zstd:" : "deflate:") << d_level;
+    out << ",";
+    if (!d_chunk_rows)
+        out << "scan";
+    else
+        out << d_chunk_rows;
+    if (d_chunk_rows && d_chunk_cols)
+        out << "x" << d_chunk_cols;
+    if (d_geo_type != NC_DOUBLE || d_geo_digits)
+        out << "," << geo_str();
+
+    return out.str();
+}
+
+/**
+ * Write the history attribute of a sidecar file: the current
+ * date/time and the name of the file.
+ *
+ * @param ncid ID of the sidecar file.
+ * @param fileName The name of the sidecar file.
+ * @return 0 for success, error code otherwise.
+ */
+static int
+put_history(int ncid, const std::string &fileName) {
+    string history;
+    int ret;
+
+    // Get the current date/time.
+    char time_str[MAX_TIME_STR + 1];
+    time_t time_ptr = time(NULL);
+    strftime(time_str, MAX_TIME_STR, "%F %T", localtime(&time_ptr));
+    history.append(time_str);
+    history.append(" - STAREmaster ");
+    history.append(fileName);
+    if ((ret = nc_put_att_text(ncid, NC_GLOBAL, NAME_HISTORY, history.size() + 1, history.c_str())))
+        NCERR(ret);
+
+    return 0;
+}
 
 /**
  * Create a sidecar file.
@@ -28,12 +301,11 @@
  * @return 0 for success, error code otherwise.
  */
 int
-SidecarFile::createFile(const std::string fileName, int verbose, char *institution_c) {
+SidecarFile::createFile(const std::string fileName, int verbose, const char *institution_c) {
     int ret;
     string title = SSC_TITLE;
     string institution = "";
     string source = "";
-    string history = "";
     string cf_version = CF_VERSION;
 
     if (verbose) std::cout << "Creating NETCDF sidecar file " << fileName << "\n";
@@ -80,17 +352,32 @@ SidecarFile::createFile(const std::string fileName, int verbose, char *instituti
     // netCDF file. We recommend that each line begin with a timestamp
     // indicating the date and time of day that the program was
     // executed.
+    if ((ret = put_history(ncid, fileName)))
+        return ret;
 
-    // Get the current date/time.
-    char time_str[MAX_TIME_STR + 1];
-    time_t time_ptr = time(NULL);
-    strftime(time_str, MAX_TIME_STR, "%F %T", localtime(&time_ptr));
-    history.append(time_str);
-    history.append(" - STAREmaster ");
-    history.append(fileName);
-    if (history.size())
-        if ((ret = nc_put_att_text(ncid, NC_GLOBAL, NAME_HISTORY, history.size() + 1, history.c_str())))
-            NCERR(ret);
+    return 0;
+}
+
+/**
+ * Rewrite the history attribute of a sidecar file that is a copy of
+ * another, such as one fetched from a tile cache, so it names this
+ * file and the time it was made instead of those of the original.
+ *
+ * @param fileName The name of the sidecar file.
+ * @return 0 for success, error code otherwise.
+ */
+int
+SidecarFile::rewriteHistory(const std::string fileName) {
+    int ncid, ret;
+
+    if ((ret = nc_open(fileName.c_str(), NC_WRITE, &ncid)))
+        NCERR(ret);
+    if ((ret = put_history(ncid, fileName))) {
+        nc_close(ncid);
+        return ret;
+    }
+    if ((ret = nc_close(ncid)))
+        NCERR(ret);
 
     return 0;
 }
@@ -115,13 +402,74 @@ int
 SidecarFile::writeSTAREIndex(int verbose, int build_level, int i, int j,
                              double *geo_lat, double *geo_lon, unsigned long long *stare_index,
                              vector <string> var_name, string stare_index_name) {
+    int index_id;
+    int ret;
+
+    if ((ret = defineSTAREIndex(verbose, build_level, i, j, 0, var_name, stare_index_name,
+                                index_id)))
+        return ret;
+
+    return writeSTAREIndexRows(index_id, 0, i, geo_lat, geo_lon, stare_index);
+}
+
+/**
+ * Write a STARE index, with its lat/lons, from a grid.
+ *
+ * @param verbose Set to non-zero for verbose output.
+ * @param build_level STARE build level.
+ * @param grid The lat/lons and STARE indices.
+ * @param var_name Vector of string with variable names this STARE
+ * index applies to.
+ * @param stare_index_name Name of the variable that will hold this
+ * STARE index.
+ * @return 0 for success, error code otherwise.
+ */
+int
+SidecarFile::writeSTAREIndex(int verbose, int build_level, const GeoGrid &grid,
+                             vector <string> var_name, string stare_index_name) {
+    int index_id;
+    int ret;
+
+    if ((ret = defineSTAREIndex(verbose, build_level, grid.num_i(), grid.num_j(),
+                                grid.rows_per_scan(), var_name, stare_index_name, index_id)))
+        return ret;
+
+    return writeSTAREIndexRows(index_id, 0, grid.num_i(), grid.lat().data(), grid.lon().data(),
+                               grid.index().data());
+}
+
+/**
+ * Define the dimensions and variables of a STARE index, with its
+ * latitude and longitude. The data are written later with
+ * writeSTAREIndexRows(), all at once or a block of rows at a time.
+ *
+ * @param verbose Set to non-zero for verbose output.
+ * @param build_level STARE build level.
+ * @param i Number of rows.
+ * @param j Number of columns.
+ * @param rows_per_scan Rows in one scan of the instrument, 0 for a
+ * grid without scans. Chunks are whole scans by default.
+ * @param var_name Vector of string with variable names this STARE
+ * index applies to.
+ * @param stare_index_name Name of the variable that will hold this
+ * STARE index.
+ * @param index_id Gets the id to pass to writeSTAREIndexRows().
+ * @return 0 for success, error code otherwise.
+ */
+int
+SidecarFile::defineSTAREIndex(int verbose, int build_level, int i, int j, size_t rows_per_scan,
+                              vector <string> var_name, string stare_index_name, int &index_id) {
     int dimid[SSC_NDIM2];
-    int lat_varid, lon_varid, index_varid;
+    size_t chunks[SSC_NDIM2];
+    int lat_varid, lon_varid, index_varid, offsets_varid = -1;
     string var_att;
     string dim_name;
     int ret;
 
     if (verbose) std::cout << "Writing NETCDF sidecar indices with build level " << build_level << "\n";
+    d_layout.index_chunks(i, j, rows_per_scan, chunks);
+    if (verbose) std::cout << "Layout " << d_layout.str() << ", chunks of " << chunks[0] << "x" <<
+                     chunks[1] << "\n";
 
     // Define dimensions.
     dim_name.append(SSC_I_NAME);
@@ -137,47 +485,37 @@ SidecarFile::writeSTAREIndex(int verbose, int build_level, int i, int j,
     if ((ret = nc_def_dim(ncid, dim_name.c_str(), j, &dimid[1])))
         NCERR(ret);
 
-    // Define latitude.
+    // Define latitude and longitude.
     string lat_name;
     lat_name.append(SSC_LAT_NAME);
     lat_name.append("_");
     lat_name.append(stare_index_name);
-    if ((ret = nc_def_var(ncid, lat_name.c_str(), NC_DOUBLE, SSC_NDIM2, dimid, &lat_varid)))
-        NCERR(ret);
-    if ((ret = nc_def_var_deflate(ncid, lat_varid, 1, 1, 3)))
-        NCERR(ret);
-    if ((ret = nc_put_att_text(ncid, lat_varid, SSC_LONG_NAME, sizeof(SSC_LAT_LONG_NAME),
-                               SSC_LAT_LONG_NAME)))
-        NCERR(ret);
-    if ((ret = nc_put_att_text(ncid, lat_varid, SSC_UNITS, sizeof(SSC_LAT_UNITS),
-                               SSC_LAT_UNITS)))
-        NCERR(ret);
+    if ((ret = defineGeoVar(lat_name, dimid, chunks, SSC_LAT_LONG_NAME, SSC_LAT_UNITS, lat_varid)))
+        return ret;
 
-    // Define longitude.
     string lon_name;
     lon_name.append(SSC_LON_NAME);
     lon_name.append("_");
     lon_name.append(stare_index_name);
-    if ((ret = nc_def_var(ncid, lon_name.c_str(), NC_DOUBLE, SSC_NDIM2, dimid, &lon_varid)))
-        NCERR(ret);
-    if ((ret = nc_def_var_deflate(ncid, lon_varid, 1, 1, 3)))
-        NCERR(ret);
-    if ((ret = nc_put_att_text(ncid, lon_varid, SSC_LONG_NAME, sizeof(SSC_LON_LONG_NAME),
-                               SSC_LON_LONG_NAME)))
-        NCERR(ret);
-    if ((ret = nc_put_att_text(ncid, lon_varid, SSC_UNITS, sizeof(SSC_LON_UNITS),
-                               SSC_LON_UNITS)))
-        NCERR(ret);
+    if ((ret = defineGeoVar(lon_name, dimid, chunks, SSC_LON_LONG_NAME, SSC_LON_UNITS, lon_varid)))
+        return ret;
 
     // Define STARE index.
     string index_name;
     index_name.append(SSC_INDEX_NAME);
     index_name.append("_");
     index_name.append(stare_index_name);
-    if ((ret = nc_def_var(ncid, index_name.c_str(), NC_UINT64, SSC_NDIM2, dimid, &index_varid)))
-        NCERR(ret);
-    if ((ret = nc_def_var_deflate(ncid, index_varid, 1, 1, 3)))
-        NCERR(ret);
+    if (!d_layout.pack_index()) {
+        if ((ret = nc_def_var(ncid, index_name.c_str(), NC_UINT64, SSC_NDIM2, dimid, &index_varid)))
+            NCERR(ret);
+        if ((ret = nc_def_var_chunking(ncid, index_varid, NC_CHUNKED, chunks)))
+            NCERR(ret);
+        if ((ret = compressVar(index_varid)))
+            return ret;
+    } else if ((ret = definePackedIndex(index_name, stare_index_name, i, j, dimid[0], chunks[0],
+                                        index_varid, offsets_varid))) {
+        return ret;
+    }
     if ((ret = nc_put_att_text(ncid, index_varid, SSC_LONG_NAME, sizeof(SSC_INDEX_LONG_NAME),
                                SSC_INDEX_LONG_NAME)))
         NCERR(ret);
@@ -192,17 +530,318 @@ SidecarFile::writeSTAREIndex(int verbose, int build_level, int i, int j,
                                var_att.c_str())))
         NCERR(ret);
 
-    // Write data.
-    if ((ret = nc_put_var(ncid, lat_varid, geo_lat)))
+    // Remember the variables for writeSTAREIndexRows().
+    index_id = d_index_varid.size();
+    d_lat_varid.push_back(lat_varid);
+    d_lon_varid.push_back(lon_varid);
+    d_index_varid.push_back(index_varid);
+    d_num_j.push_back(j);
+    d_offsets_varid.push_back(offsets_varid);
+    d_num_rows.push_back(0);
+    d_num_bytes.push_back(0);
+
+    return 0;
+}
+
+/**
+ * Define a STARE index packed with PackedStareIndex: a variable of the
+ * packed bytes, along an unlimited dimension since their number is not
+ * known until they are written, and a variable of the byte offset of
+ * each row. The attributes the packed index shares with an index that
+ * is not packed are left to the caller.
+ *
+ * @param index_name Name of the packed index variable.
+ * @param stare_index_name Name of the STARE index, such as "1km".
+ * @param i Number of rows.
+ * @param j Number of columns.
+ * @param i_dimid Dimension of the rows.
+ * @param chunk_rows Rows in a chunk of the row offsets.
+ * @param index_varid Gets the varid of the packed bytes.
+ * @param offsets_varid Gets the varid of the row offsets.
+ * @return 0 for success, error code otherwise.
+ */
+int
+SidecarFile::definePackedIndex(const string &index_name, const string &stare_index_name, size_t i,
+                               size_t j, int i_dimid, size_t chunk_rows, int &index_varid,
+                               int &offsets_varid) {
+    int b_dimid;
+    size_t chunk = SSC_CHUNK_BYTES;
+    unsigned long long shape[SSC_NDIM2] = {i, j};
+    int ret;
+
+    // The bytes are packed already, so are not compressed again.
+    string dim_name = string(SSC_B_NAME) + "_" + stare_index_name;
+    if ((ret = nc_def_dim(ncid, dim_name.c_str(), NC_UNLIMITED, &b_dimid)))
+        NCERR(ret);
+    if ((ret = nc_def_var(ncid, index_name.c_str(), NC_UBYTE, SSC_NDIM1, &b_dimid, &index_varid)))
+        NCERR(ret);
+    if ((ret = nc_def_var_chunking(ncid, index_varid, NC_CHUNKED, &chunk)))
         NCERR(ret);
-    if ((ret = nc_put_var(ncid, lon_varid, geo_lon)))
+
+    string offsets_name = string(SSC_OFFSETS_NAME) + "_" + stare_index_name;
+    if ((ret = nc_def_var(ncid, offsets_name.c_str(), NC_UINT64, SSC_NDIM1, &i_dimid,
+                          &offsets_varid)))
+        NCERR(ret);
+    if ((ret = nc_def_var_chunking(ncid, offsets_varid, NC_CHUNKED, &chunk_rows)))
         NCERR(ret);
-    if ((ret = nc_put_var(ncid, index_varid, stare_index)))
+    if ((ret = compressVar(offsets_varid)))
+        return ret;
+    if ((ret = nc_put_att_text(ncid, offsets_varid, SSC_LONG_NAME, sizeof(SSC_OFFSETS_LONG_NAME),
+                               SSC_OFFSETS_LONG_NAME)))
+        NCERR(ret);
+
+    if ((ret = nc_put_att_text(ncid, index_varid, SSC_INDEX_CODEC_NAME, sizeof(SSC_INDEX_CODEC),
+                               SSC_INDEX_CODEC)))
+        NCERR(ret);
+    if ((ret = nc_put_att_ulonglong(ncid, index_varid, SSC_INDEX_SHAPE_NAME, NC_UINT64, SSC_NDIM2,
+                                    shape)))
+        NCERR(ret);
+    if ((ret = nc_put_att_text(ncid, index_varid, SSC_INDEX_OFFSETS_ATT_NAME,
+                               offsets_name.size() + 1, offsets_name.c_str())))
         NCERR(ret);
 
     return 0;
 }
 
+/**
+ * Write a block of rows of a STARE index, and its latitude and
+ * longitude.
+ *
+ * @param index_id Id from defineSTAREIndex().
+ * @param start_row First row to write.
+ * @param num_rows Number of rows to write.
+ * @param geo_lat Pointer to num_rows rows of latitudes.
+ * @param geo_lon Pointer to num_rows rows of longitudes.
+ * @param stare_index Pointer to num_rows rows of STARE indexes.
+ * @return 0 for success, error code otherwise.
+ */
+int
+SidecarFile::writeSTAREIndexRows(int index_id, size_t start_row, size_t num_rows,
+                                 const double *geo_lat, const double *geo_lon,
+                                 const unsigned long long *stare_index) {
+    size_t start[SSC_NDIM2] = {start_row, 0};
+    size_t count[SSC_NDIM2];
+    int ret;
+
+    if (index_id < 0 || index_id >= (int) d_index_varid.size())
+        return SSC_EINPUT;
+    count[0] = num_rows;
+    count[1] = d_num_j[index_id];
+
+    if (d_offsets_varid[index_id] >= 0 && start_row != d_num_rows[index_id])
+        return SSC_EINPUT;
+
+    if ((ret = nc_put_vara_double(ncid, d_lat_varid[index_id], start, count, geo_lat)))
+        NCERR(ret);
+    if ((ret = nc_put_vara_double(ncid, d_lon_varid[index_id], start, count, geo_lon)))
+        NCERR(ret);
+    if (d_offsets_varid[index_id] < 0) {
+        if ((ret = nc_put_vara_ulonglong(ncid, d_index_varid[index_id], start, count, stare_index)))
+            NCERR(ret);
+    } else if (num_rows) {
+        // Packed rows go after those written before.
+        PackedStareIndex packed = PackedStareIndex::pack(stare_index, num_rows, count[1]);
+        vector<unsigned long long> offsets(packed.offsets());
+        size_t byte_start = d_num_bytes[index_id], byte_count = packed.bytes().size();
+
+        for (size_t r = 0; r < num_rows; r++)
+            offsets[r] += byte_start;
+        if ((ret = nc_put_vara_uchar(ncid, d_index_varid[index_id], &byte_start, &byte_count,
+                                     packed.bytes().data())))
+            NCERR(ret);
+        if ((ret = nc_put_vara_ulonglong(ncid, d_offsets_varid[index_id], start, count,
+                                         offsets.data())))
+            NCERR(ret);
+        d_num_bytes[index_id] += byte_count;
+    }
+    d_num_rows[index_id] = start_row + num_rows;
+
+    return 0;
+}
+
+/**
+ * Read a block of rows of a STARE index, unpacking it if it was
+ * packed with PackedStareIndex.
+ *
+ * @param ncid ID of the sidecar file.
+ * @param varid Varid of the STARE index, as read_sidecar_file() finds.
+ * @param start_row First row to read.
+ * @param num_rows Number of rows to read.
+ * @param stare_index Gets num_rows rows of STARE indices.
+ * @return 0 for success, error code otherwise.
+ */
+int
+SidecarFile::readSTAREIndex(int ncid, int varid, size_t start_row, size_t num_rows,
+                            unsigned long long *stare_index) {
+    size_t shape[SSC_NDIM2];
+    int ret;
+
+    if ((ret = indexShape(ncid, varid, shape)))
+        return ret;
+    size_t start[SSC_NDIM2] = {start_row, 0}, count[SSC_NDIM2] = {num_rows, shape[1]};
+
+    return readSTAREIndex(ncid, varid, start, count, NULL, stare_index);
+}
+
+/**
+ * Read a window of a STARE index, optionally taking every n-th row
+ * and column, straight into the caller's buffer.
+ *
+ * An index that is not packed is read with nc_get_vara or nc_get_vars
+ * into the buffer, so only the chunks of the window are read and
+ * decompressed, and nothing is copied after. A packed index is read
+ * only for the rows from the first to the last of the window; rows
+ * are unpacked into the buffer when the window is whole rows, and
+ * otherwise one at a time, keeping the columns of the window.
+ *
+ * @param ncid ID of the sidecar file.
+ * @param varid Varid of the STARE index, as read_sidecar_file() finds.
+ * @param start First row and column of the window.
+ * @param count Number of rows and columns of the window.
+ * @param stride Step between the rows, and columns, of the window, or
+ * NULL to read every row and column.
+ * @param stare_index Gets count[0] * count[1] STARE indices, row by
+ * row.
+ * @return 0 for success, SSC_EINPUT if the window is not within the
+ * index or a stride is not positive, netCDF error code otherwise.
+ */
+int
+SidecarFile::readSTAREIndex(int ncid, int varid, const size_t *start, const size_t *count,
+                            const ptrdiff_t *stride, unsigned long long *stare_index) {
+    size_t shape[SSC_NDIM2];
+    ptrdiff_t step[SSC_NDIM2] = {1, 1};
+    int ret;
+
+    if ((ret = indexShape(ncid, varid, shape)))
+        return ret;
+    for (int d = 0; d < SSC_NDIM2; d++) {
+        if (stride)
+            step[d] = stride[d];
+        if (step[d] < 1 || start[d] > shape[d])
+            return SSC_EINPUT;
+        if (count[d] && (start[d] == shape[d] ||
+                         count[d] - 1 > (shape[d] - start[d] - 1) / step[d]))
+            return SSC_EINPUT;
+    }
+    if (!count[0] || !count[1])
+        return 0;
+
+    // An index that is not packed is read as it is.
+    if (nc_inq_att(ncid, varid, SSC_INDEX_CODEC_NAME, NULL, NULL)) {
+        if (step[0] == 1 && step[1] == 1)
+            return nc_get_vara_ulonglong(ncid, varid, start, count, stare_index);
+        return nc_get_vars_ulonglong(ncid, varid, start, count, step, stare_index);
+    }
+
+    char codec[NC_MAX_NAME + 1] = "", offsets_name[NC_MAX_NAME + 1] = "";
+    size_t len;
+    int offsets_varid, b_dimid;
+
+    if ((ret = nc_inq_attlen(ncid, varid, SSC_INDEX_CODEC_NAME, &len)))
+        return ret;
+    if (len > NC_MAX_NAME)
+        return SSC_EINPUT;
+    if ((ret = nc_get_att_text(ncid, varid, SSC_INDEX_CODEC_NAME, codec)))
+        return ret;
+    if (strncmp(codec, SSC_INDEX_CODEC, NC_MAX_NAME))
+        return SSC_EINPUT;
+    if ((ret = nc_inq_attlen(ncid, varid, SSC_INDEX_OFFSETS_ATT_NAME, &len)))
+        return ret;
+    if (len > NC_MAX_NAME)
+        return SSC_EINPUT;
+    if ((ret = nc_get_att_text(ncid, varid, SSC_INDEX_OFFSETS_ATT_NAME, offsets_name)))
+        return ret;
+    if ((ret = nc_inq_varid(ncid, offsets_name, &offsets_varid)))
+        return ret;
+
+    // The offsets of the rows, and of the row after them to find where
+    // the last one ends.
+    size_t start_row = start[0], num_rows = (count[0] - 1) * step[0] + 1;
+    vector<unsigned long long> offsets(num_rows + 1);
+    size_t offsets_count = std::min(num_rows + 1, shape[0] - start_row);
+    if ((ret = nc_get_vara_ulonglong(ncid, offsets_varid, &start_row, &offsets_count,
+                                     offsets.data())))
+        return ret;
+    if (offsets_count == num_rows) {
+        if ((ret = nc_inq_vardimid(ncid, varid, &b_dimid)))
+            return ret;
+        if ((ret = nc_inq_dimlen(ncid, b_dimid, &len)))
+            return ret;
+        offsets[num_rows] = len;
+    }
+    if (offsets[num_rows] < offsets[0])
+        return SSC_EINPUT;
+
+    // Read only the bytes of the rows.
+    size_t byte_start = offsets[0], byte_count = offsets[num_rows] - offsets[0];
+    vector<unsigned char> bytes(byte_count);
+    if (byte_count &&
+        (ret = nc_get_vara_uchar(ncid, varid, &byte_start, &byte_count, bytes.data())))
+        return ret;
+    for (size_t r = 0; r <= num_rows; r++)
+        offsets[r] -= byte_start;
+
+    PackedStareIndex packed;
+    if ((ret = packed.assign(shape[1], bytes.data(), byte_count, offsets.data(), num_rows)))
+        return ret;
+    if (step[0] == 1 && step[1] == 1 && !start[1] && count[1] == shape[1])
+        return packed.unpack_rows(0, num_rows, stare_index);
+
+    // Unpack each row of the window, and keep its columns.
+    int err = 0;
+#pragma omp parallel reduction(|:err)
+    {
+        vector<unsigned long long> row(shape[1]);
+#pragma omp for schedule(static)
+        for (long r = 0; r < (long) count[0]; r++) {
+            if (packed.unpack_rows(r * step[0], 1, row.data())) {
+                err = 1;
+                continue;
+            }
+            unsigned long long *out = stare_index + r * count[1];
+            for (size_t c = 0; c < count[1]; c++)
+                out[c] = row[start[1] + c * step[1]];
+        }
+    }
+
+    return err ? SSC_EINPUT : 0;
+}
+
+/**
+ * Number of rows and columns of a STARE index, packed or not.
+ *
+ * @param ncid ID of the sidecar file.
+ * @param varid Varid of the STARE index.
+ * @param shape Gets the rows and columns.
+ * @return 0 for success, error code otherwise.
+ */
+int
+SidecarFile::indexShape(int ncid, int varid, size_t *shape) {
+    int ret;
+
+    // A packed index keeps its shape in an attribute.
+    if (!nc_inq_att(ncid, varid, SSC_INDEX_CODEC_NAME, NULL, NULL)) {
+        unsigned long long packed_shape[SSC_NDIM2];
+        if ((ret = nc_get_att_ulonglong(ncid, varid, SSC_INDEX_SHAPE_NAME, packed_shape)))
+            return ret;
+        shape[0] = packed_shape[0];
+        shape[1] = packed_shape[1];
+        return 0;
+    }
+
+    int ndims, dimids[SSC_NDIM2];
+    if ((ret = nc_inq_varndims(ncid, varid, &ndims)))
+        return ret;
+    if (ndims != SSC_NDIM2)
+        return SSC_EINPUT;
+    if ((ret = nc_inq_vardimid(ncid, varid, dimids)))
+        return ret;
+    for (int d = 0; d < SSC_NDIM2; d++)
+        if ((ret = nc_inq_dimlen(ncid, dimids[d], &shape[d])))
+            return ret;
+
+    return 0;
+}
 
 /**
  * Write a cover to the file.
@@ -211,11 +850,13 @@ SidecarFile::writeSTAREIndex(int verbose, int build_level, int i, int j,
  * @param stare_cover_size Size of the STARE cover.
  * @param stare_cover Pointer to array which is the STARE cover.
  * @param stare_cover_name Name of the STARE cover.
+ * @param stare_cover_level Level of the cover, to be recorded in an
+ * attribute, or -1 to not record it.
  * @return zero for success, error code otherwise.
  */
 int
 SidecarFile::writeSTARECover(int verbose, int stare_cover_size, unsigned long long *stare_cover,
-                             string stare_cover_name) {
+                             string stare_cover_name, int stare_cover_level) {
 
     if (verbose) std::cout << "Writing NETCDF sidecar cover." << "\n";
 
@@ -243,11 +884,17 @@ SidecarFile::writeSTARECover(int verbose, int stare_cover_size, unsigned long lo
     // SSC_NDIM?
     if ((ret = nc_def_var(ncid, cover_name.c_str(), NC_UINT64, SSC_NDIM1, cover_dimid, &cover_varid)))
         NCERR(ret);
-    if ((ret = nc_def_var_deflate(ncid, cover_varid, 1, 1, 3)))
+    size_t chunk = d_layout.cover_chunk(stare_cover_size);
+    if ((ret = nc_def_var_chunking(ncid, cover_varid, NC_CHUNKED, &chunk)))
         NCERR(ret);
+    if ((ret = compressVar(cover_varid)))
+        return ret;
     if ((ret = nc_put_att_text(ncid, cover_varid, SSC_LONG_NAME, sizeof(SSC_COVER_LONG_NAME),
                                SSC_COVER_LONG_NAME)))
         NCERR(ret);
+    if (stare_cover_level >= 0 &&
+        (ret = nc_put_att_int(ncid, cover_varid, SSC_COVER_LEVEL_NAME, NC_INT, 1, &stare_cover_level)))
+        NCERR(ret);
 
     if ((ret = nc_put_var(ncid, cover_varid, stare_cover)))
         NCERR(ret);
@@ -255,6 +902,86 @@ SidecarFile::writeSTARECover(int verbose, int stare_cover_size, unsigned long lo
     return 0;
 }
 
+/**
+ * Define a latitude or longitude, of the type and precision the layout
+ * says.
+ *
+ * A quantized lat/lon gets SSC_GEO_FILL as its fill value, which
+ * netCDF-C leaves as it is, so pixels without geolocation keep it
+ * exactly.
+ *
+ * @param name Name of the variable.
+ * @param dimid The i and j dimensions.
+ * @param chunks The chunk shape.
+ * @param long_name Long name of the variable.
+ * @param units Units of the variable.
+ * @param varid Gets the varid.
+ * @return 0 for success, error code otherwise.
+ */
+int
+SidecarFile::defineGeoVar(const string &name, const int *dimid, const size_t *chunks,
+                          const char *long_name, const char *units, int &varid) {
+    int ret;
+
+    if ((ret = nc_def_var(ncid, name.c_str(), d_layout.geo_type(), SSC_NDIM2, dimid, &varid)))
+        NCERR(ret);
+    if ((ret = nc_def_var_chunking(ncid, varid, NC_CHUNKED, chunks)))
+        NCERR(ret);
+    if ((ret = compressVar(varid)))
+        return ret;
+#if defined(NC_HAS_QUANTIZE) && NC_HAS_QUANTIZE
+    if (d_layout.geo_digits()) {
+        double fill = SSC_GEO_FILL;
+        if ((ret = nc_put_att_double(ncid, varid, _FillValue, d_layout.geo_type(), 1, &fill)))
+            NCERR(ret);
+        if ((ret = nc_def_var_quantize(ncid, varid, NC_QUANTIZE_GRANULARBR,
+                                       d_layout.geo_digits())))
+            NCERR(ret);
+    }
+#endif
+    if ((ret = nc_put_att_text(ncid, varid, SSC_LONG_NAME, strlen(long_name) + 1, long_name)))
+        NCERR(ret);
+    if ((ret = nc_put_att_text(ncid, varid, SSC_UNITS, strlen(units) + 1, units)))
+        NCERR(ret);
+    if (d_layout.geo_type() != NC_DOUBLE || d_layout.geo_digits()) {
+        string precision = d_layout.geo_str();
+        if ((ret = nc_put_att_text(ncid, varid, SSC_GEO_PRECISION_NAME, precision.size() + 1,
+                                   precision.c_str())))
+            NCERR(ret);
+    }
+
+    return 0;
+}
+
+/**
+ * Set the compression of a variable, as the layout says.
+ *
+ * @param varid The variable, defined and not yet written.
+ * @return 0 for success, error code otherwise.
+ */
+int
+SidecarFile::compressVar(int varid) {
+    int ret;
+
+    switch (d_layout.codec()) {
+    case SSC_CODEC_DEFLATE:
+        if ((ret = nc_def_var_deflate(ncid, varid, 1, 1, d_layout.level())))
+            NCERR(ret);
+        break;
+#if defined(NC_HAS_ZSTD) && NC_HAS_ZSTD
+    case SSC_CODEC_ZSTD:
+        // Shuffle, without deflate, ahead of the zstd filter.
+        if ((ret = nc_def_var_deflate(ncid, varid, 1, 0, 0)))
+            NCERR(ret);
+        if ((ret = nc_def_var_zstandard(ncid, varid, d_layout.level())))
+            NCERR(ret);
+        break;
+#endif
+    }
+
+    return 0;
+}
+
 /**
  * Close a sidecar file.
  */
@@ -343,21 +1070,34 @@ SidecarFile::read_sidecar_file(const std::string fileName, int verbose, int &num
 
         // If this is a STARE index, learn about it.
         if (!strncmp(long_name_in, SSC_INDEX_LONG_NAME, NC_MAX_NAME)) {
-            char variables_in[NC_MAX_NAME + 1];
+            size_t variables_len;
 
             // Save the varid.
             stare_varid.push_back(v);
 
-            // Find the length of the dimensions.
-            if ((ret = nc_inq_dimlen(ncid, dimids[0], &dimlen[0])))
-                return ret;
-            if ((ret = nc_inq_dimlen(ncid, dimids[1], &dimlen[1])))
-                return ret;
+            // Find the length of the dimensions. A packed index keeps
+            // them in an attribute.
+            if (ndims == SSC_NDIM1) {
+                unsigned long long shape[NDIM2];
+                if ((ret = nc_get_att_ulonglong(ncid, v, SSC_INDEX_SHAPE_NAME, shape)))
+                    return ret;
+                dimlen[0] = shape[0];
+                dimlen[1] = shape[1];
+            } else {
+                if ((ret = nc_inq_dimlen(ncid, dimids[0], &dimlen[0])))
+                    return ret;
+                if ((ret = nc_inq_dimlen(ncid, dimids[1], &dimlen[1])))
+                    return ret;
+            }
 
-            // What variables does this STARE index apply to?
-            if ((ret = nc_get_att_text(ncid, v, SSC_INDEX_VAR_ATT_NAME, variables_in)))
+            // What variables does this STARE index apply to? The list
+            // may be longer than a name.
+            if ((ret = nc_inq_attlen(ncid, v, SSC_INDEX_VAR_ATT_NAME, &variables_len)))
+                return ret;
+            vector<char> variables_in(variables_len + 1, 0);
+            if ((ret = nc_get_att_text(ncid, v, SSC_INDEX_VAR_ATT_NAME, &variables_in[0])))
                 return ret;
-            std::string var_list = variables_in;
+            std::string var_list = &variables_in[0];
             variables.push_back(var_list);
 
             // Save the name of this STARE index variable.
@@ -370,7 +1110,7 @@ SidecarFile::read_sidecar_file(const std::string fileName, int verbose, int &num
             // Keep count of how many STARE indexes we find in the file.
             num_index++;
             if (verbose)
-                std::cout << "variable_in " << variables_in << "\n";
+                std::cout << "variable_in " << var_list << "\n";
         }
     }
 
@@ -0,0 +1,226 @@
+/// @file
+/// This class writes the sidecar files of granules on a thread of its
+/// own, while the next granule is read and indexed.
+
+#include "config.h"
+#include "SidecarWriter.h"
+#include "GeoFile.h"
+#include "TileCache.h"
+#include "ssc.h"
+#include <cstdio>
+#include <iostream>
+
+/**
+ * A writer. The thread is started with the first granule.
+ *
+ * @param layout How the variables of each sidecar are chunked and
+ * compressed.
+ * @param verbose Set to non-zero for verbose output.
+ * @param build_level STARE build level.
+ * @param institution Institution attribute of each sidecar, may be
+ * empty.
+ * @param queue_size Granules held by the writer, counting the one
+ * being written, or 0 to write each granule in submit().
+ * @param cache Tile cache to store sidecars with a tile key in, or
+ * NULL.
+ */
+SidecarWriter::SidecarWriter(const SidecarLayout &layout, int verbose, int build_level,
+                             const std::string &institution, int queue_size,
+                             const TileCache *cache) :
+    d_layout(layout), d_verbose(verbose), d_build_level(build_level), d_institution(institution),
+    d_queue_size(queue_size > 0 ? queue_size : 0), d_cache(cache), d_writing(false),
+    d_done(false), d_err(0) {
+}
+
+/**
+ * Wait until every granule is written.
+ */
+SidecarWriter::~SidecarWriter() {
+    finish();
+}
+
+/**
+ * Hand over a granule to be written. This waits while the writer
+ * holds queue_size granules.
+ *
+ * @param gf The granule, read and indexed. The writer takes ownership,
+ * and deletes it once written, or if it can't be.
+ * @param file_out Name of the sidecar file.
+ * @param tile_key Key to store the sidecar under in the tile cache,
+ * or empty to not store it.
+ *
+ * @return 0 for success, or the error of a granule written before, or
+ * of this one with a queue size of 0.
+ */
+int
+SidecarWriter::submit(GeoFile *gf, const std::string &file_out, const std::string &tile_key) {
+    Job job = {gf, file_out, tile_key};
+
+    if (!d_queue_size) {
+        if (!d_err)
+            d_err = write(job);
+        delete gf;
+        return d_err;
+    }
+
+    std::unique_lock<std::mutex> lock(d_mutex);
+    if (!d_thread.joinable() && !d_done)
+        d_thread = std::thread(&SidecarWriter::run, this);
+    while (!d_err && d_jobs.size() + d_writing >= d_queue_size)
+        d_cond.wait(lock);
+    if (d_err || d_done) {
+        delete gf;
+        return d_err ? d_err : SSC_EINPUT;
+    }
+    d_jobs.push_back(job);
+    d_cond.notify_all();
+
+    return 0;
+}
+
+/**
+ * Wait until every granule handed over is written, and stop the
+ * writer thread. No more granules may be handed over after this.
+ *
+ * @return 0 for success, or the first error.
+ */
+int
+SidecarWriter::finish() {
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        d_done = true;
+        d_cond.notify_all();
+    }
+    if (d_thread.joinable())
+        d_thread.join();
+
+    return d_err;
+}
+
+/**
+ * The writer thread. Writes the granules in the order they were
+ * handed over, until finish() is called and none are left.
+ */
+void
+SidecarWriter::run() {
+    std::unique_lock<std::mutex> lock(d_mutex);
+
+    for (;;) {
+        while (d_jobs.empty() && !d_done)
+            d_cond.wait(lock);
+        if (d_jobs.empty())
+            break;
+        Job job = d_jobs.front();
+        d_jobs.pop_front();
+        d_writing = true;
+
+        lock.unlock();
+        int ret = write(job);
+        delete job.gf;
+        lock.lock();
+
+        d_writing = false;
+        if (ret && !d_err) {
+            d_err = ret;
+            for (size_t k = 0; k < d_jobs.size(); k++)
+                delete d_jobs[k].gf;
+            d_jobs.clear();
+        }
+        d_cond.notify_all();
+    }
+}
+
+/**
+ * Write the sidecar file of a granule, and store it in the tile cache
+ * if it has a tile key.
+ *
+ * @param job The granule.
+ *
+ * @return 0 for success, error code otherwise.
+ */
+int
+SidecarWriter::write(const Job &job) {
+    SidecarFile sf;
+    int ret;
+
+    sf.setLayout(d_layout);
+    if ((ret = sf.createFile(job.file_out, d_verbose, d_institution.c_str()))) {
+        std::cerr << "Error creating sidecar file.\n";
+        return ret;
+    }
+    // Don't leave a half-written sidecar under its final name.
+    if ((ret = writeContents(*job.gf, sf, d_verbose, d_build_level, true))) {
+        sf.close_file();
+        remove(job.file_out.c_str());
+        return ret;
+    }
+    if ((ret = sf.close_file())) {
+        std::cerr << "Error closing sidecar file.\n";
+        remove(job.file_out.c_str());
+        return ret;
+    }
+
+    // Keep a new tile sidecar for the other days of the tile.
+    if (!job.tile_key.empty() && d_cache && (ret = d_cache->store(job.tile_key, job.file_out))) {
+        std::cerr << "Error storing sidecar in tile cache.\n";
+        return ret;
+    }
+
+    return 0;
+}
+
+/**
+ * Write the STARE indices and covers of a granule to an open sidecar
+ * file. The coarser covers of the pyramid follow the covers they were
+ * made from.
+ *
+ * @param gf The granule, read and indexed.
+ * @param sf The sidecar file.
+ * @param verbose Set to non-zero for verbose output.
+ * @param build_level STARE build level.
+ * @param write_indices False if the indices were streamed to the file
+ * already, so only the covers are left to write.
+ *
+ * @return 0 for success, error code otherwise.
+ */
+int
+SidecarWriter::writeContents(GeoFile &gf, SidecarFile &sf, int verbose, int build_level,
+                             bool write_indices) {
+    int ret;
+
+    for (int i = 0; i < gf.d_num_index && write_indices; i++) {
+        if ((ret = sf.writeSTAREIndex(verbose, build_level, gf.geo_grid[i], gf.var_name[i],
+                                      gf.d_stare_index_name[i]))) {
+            std::cerr << "Error writing STARE index.\n";
+            return ret;
+        }
+    }
+
+    if (verbose)
+        std::cout << "writing covers" << std::endl;
+    for (int i = 0; i < gf.num_cover; i++) {
+        if (verbose)
+            std::cout << "writing cover i = " << i << ", name = " <<
+                gf.stare_cover_name.at(i) << std::endl;
+        // Record the level of each cover when it was picked to fit a
+        // budget.
+        if ((ret = sf.writeSTARECover(verbose, gf.geo_num_cover_values[i], &gf.geo_cover[i][0],
+                                      gf.stare_cover_name.at(i),
+                                      gf.coverBudget() ? gf.geo_cover_level.at(i) : -1))) {
+            std::cerr << "Error writing STARE cover.\n";
+            return ret;
+        }
+    }
+    for (size_t i = 0; i < gf.pyramid_cover.size(); i++) {
+        PyramidCover &coarse = gf.pyramid_cover[i];
+        if (verbose)
+            std::cout << "writing pyramid cover name = " << coarse.name << std::endl;
+        if ((ret = sf.writeSTARECover(verbose, coarse.values.size(), &coarse.values[0],
+                                      coarse.name, gf.coverBudget() ? coarse.level : -1))) {
+            std::cerr << "Error writing STARE cover.\n";
+            return ret;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,771 @@
+/// @file
+/// Geolocation of the tiles of the MODIS sinusoidal grid, such as the
+/// tiles of MOD09GA.
+
+#include "config.h"
+#include "SinusoidalGrid.h"
+#include "GeoGrid.h"
+#include "ssc.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#define SIN_RADIUS 6371007.181 /**< Radius of the sphere of the grid, in meters. */
+#define SIN_TILE_SIZE 1111950.5196666666 /**< Side of a tile, 10 degrees of arc, in meters. */
+#define SIN_X_MIN (-20015109.354) /**< x of the left edge of the grid, -pi R. */
+#define SIN_Y_MAX 10007554.677 /**< y of the top edge of the grid, pi R / 2. */
+#define RAD_TO_DEG 57.2957795130823208768
+#define NO_TILE (-999.0) /**< Longitude bound of a tile wholly off the sphere. */
+
+/**
+ * Bounds of each tile, by v then h: least and greatest longitude,
+ * least and greatest latitude. From sn_bound_10deg.txt of MODLAND.
+ */
+static const double tile_bounds[SSC_SIN_NUM_V * SSC_SIN_NUM_H][4] = {
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h00v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h01v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h02v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h03v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h04v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h05v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h06v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h07v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h08v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h09v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h10v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h11v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h12v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h13v00 */
+    {-180.0000, -172.7151,  80.0000,  80.4083}, /* h14v00 */
+    {-180.0000, -115.1274,  80.0000,  83.6250}, /* h15v00 */
+    {-180.0000,  -57.5397,  80.0000,  86.8167}, /* h16v00 */
+    {-180.0000,   57.2957,  80.0000,  90.0000}, /* h17v00 */
+    {  -0.0040,  180.0000,  80.0000,  90.0000}, /* h18v00 */
+    {  57.5877,  180.0000,  80.0000,  86.8167}, /* h19v00 */
+    { 115.1754,  180.0000,  80.0000,  83.6250}, /* h20v00 */
+    { 172.7631,  180.0000,  80.0000,  80.4083}, /* h21v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h22v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h23v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h24v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h25v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h26v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h27v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h28v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h29v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h30v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h31v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h32v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h33v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h34v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h35v00 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h00v01 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h01v01 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h02v01 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h03v01 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h04v01 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h05v01 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h06v01 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h07v01 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h08v01 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h09v01 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h10v01 */
+    {-180.0000, -175.4039,  70.0000,  70.5333}, /* h11v01 */
+    {-180.0000, -146.1659,  70.0000,  73.8750}, /* h12v01 */
+    {-180.0000, -116.9278,  70.0000,  77.1667}, /* h13v01 */
+    {-180.0000,  -87.6898,  70.0000,  80.0000}, /* h14v01 */
+    {-172.7631,  -58.4517,  70.0000,  80.0000}, /* h15v01 */
+    {-115.1754,  -29.2137,  70.0000,  80.0000}, /* h16v01 */
+    { -57.5877,    0.0480,  70.0000,  80.0000}, /* h17v01 */
+    {   0.0000,   57.6357,  70.0000,  80.0000}, /* h18v01 */
+    {  29.2380,  115.2234,  70.0000,  80.0000}, /* h19v01 */
+    {  58.4761,  172.8111,  70.0000,  80.0000}, /* h20v01 */
+    {  87.7141,  180.0000,  70.0000,  80.0000}, /* h21v01 */
+    { 116.9522,  180.0000,  70.0000,  77.1583}, /* h22v01 */
+    { 146.1902,  180.0000,  70.0000,  73.8750}, /* h23v01 */
+    { 175.4283,  180.0000,  70.0000,  70.5333}, /* h24v01 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h25v01 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h26v01 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h27v01 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h28v01 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h29v01 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h30v01 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h31v01 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h32v01 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h33v01 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h34v01 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h35v01 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h00v02 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h01v02 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h02v02 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h03v02 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h04v02 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h05v02 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h06v02 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h07v02 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h08v02 */
+    {-180.0000, -159.9833,  60.0000,  63.6167}, /* h09v02 */
+    {-180.0000, -139.9833,  60.0000,  67.1167}, /* h10v02 */
+    {-180.0000, -119.9833,  60.0000,  70.0000}, /* h11v02 */
+    {-175.4283,  -99.9833,  60.0000,  70.0000}, /* h12v02 */
+    {-146.1902,  -79.9833,  60.0000,  70.0000}, /* h13v02 */
+    {-116.9522,  -59.9833,  60.0000,  70.0000}, /* h14v02 */
+    { -87.7141,  -39.9833,  60.0000,  70.0000}, /* h15v02 */
+    { -58.4761,  -19.9833,  60.0000,  70.0000}, /* h16v02 */
+    { -29.2380,    0.0244,  60.0000,  70.0000}, /* h17v02 */
+    {   0.0000,   29.2624,  60.0000,  70.0000}, /* h18v02 */
+    {  20.0000,   58.5005,  60.0000,  70.0000}, /* h19v02 */
+    {  40.0000,   87.7385,  60.0000,  70.0000}, /* h20v02 */
+    {  60.0000,  116.9765,  60.0000,  70.0000}, /* h21v02 */
+    {  80.0000,  146.2146,  60.0000,  70.0000}, /* h22v02 */
+    { 100.0000,  175.4526,  60.0000,  70.0000}, /* h23v02 */
+    { 120.0000,  180.0000,  60.0000,  70.0000}, /* h24v02 */
+    { 140.0000,  180.0000,  60.0000,  67.1167}, /* h25v02 */
+    { 160.0000,  180.0000,  60.0000,  63.6167}, /* h26v02 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h27v02 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h28v02 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h29v02 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h30v02 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h31v02 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h32v02 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h33v02 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h34v02 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h35v02 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h00v03 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h01v03 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h02v03 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h03v03 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h04v03 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h05v03 */
+    {-180.0000, -171.1167,  50.0000,  52.3333}, /* h06v03 */
+    {-180.0000, -155.5594,  50.0000,  56.2583}, /* h07v03 */
+    {-180.0000, -140.0022,  50.0000,  60.0000}, /* h08v03 */
+    {-180.0000, -124.4449,  50.0000,  60.0000}, /* h09v03 */
+    {-160.0000, -108.8877,  50.0000,  60.0000}, /* h10v03 */
+    {-140.0000,  -93.3305,  50.0000,  60.0000}, /* h11v03 */
+    {-120.0000,  -77.7732,  50.0000,  60.0000}, /* h12v03 */
+    {-100.0000,  -62.2160,  50.0000,  60.0000}, /* h13v03 */
+    { -80.0000,  -46.6588,  50.0000,  60.0000}, /* h14v03 */
+    { -60.0000,  -31.1015,  50.0000,  60.0000}, /* h15v03 */
+    { -40.0000,  -15.5443,  50.0000,  60.0000}, /* h16v03 */
+    { -20.0000,    0.0167,  50.0000,  60.0000}, /* h17v03 */
+    {   0.0000,   20.0167,  50.0000,  60.0000}, /* h18v03 */
+    {  15.5572,   40.0167,  50.0000,  60.0000}, /* h19v03 */
+    {  31.1145,   60.0167,  50.0000,  60.0000}, /* h20v03 */
+    {  46.6717,   80.0167,  50.0000,  60.0000}, /* h21v03 */
+    {  62.2290,  100.0167,  50.0000,  60.0000}, /* h22v03 */
+    {  77.7862,  120.0167,  50.0000,  60.0000}, /* h23v03 */
+    {  93.3434,  140.0167,  50.0000,  60.0000}, /* h24v03 */
+    { 108.9007,  160.0167,  50.0000,  60.0000}, /* h25v03 */
+    { 124.4579,  180.0000,  50.0000,  60.0000}, /* h26v03 */
+    { 140.0151,  180.0000,  50.0000,  60.0000}, /* h27v03 */
+    { 155.5724,  180.0000,  50.0000,  56.2500}, /* h28v03 */
+    { 171.1296,  180.0000,  50.0000,  52.3333}, /* h29v03 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h30v03 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h31v03 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h32v03 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h33v03 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h34v03 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h35v03 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h00v04 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h01v04 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h02v04 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h03v04 */
+    {-180.0000, -169.6921,  40.0000,  43.7667}, /* h04v04 */
+    {-180.0000, -156.6380,  40.0000,  48.1917}, /* h05v04 */
+    {-180.0000, -143.5839,  40.0000,  50.0000}, /* h06v04 */
+    {-171.1296, -130.5299,  40.0000,  50.0000}, /* h07v04 */
+    {-155.5724, -117.4758,  40.0000,  50.0000}, /* h08v04 */
+    {-140.0151, -104.4217,  40.0000,  50.0000}, /* h09v04 */
+    {-124.4579,  -91.3676,  40.0000,  50.0000}, /* h10v04 */
+    {-108.9007,  -78.3136,  40.0000,  50.0000}, /* h11v04 */
+    { -93.3434,  -65.2595,  40.0000,  50.0000}, /* h12v04 */
+    { -77.7862,  -52.2054,  40.0000,  50.0000}, /* h13v04 */
+    { -62.2290,  -39.1513,  40.0000,  50.0000}, /* h14v04 */
+    { -46.6717,  -26.0973,  40.0000,  50.0000}, /* h15v04 */
+    { -31.1145,  -13.0432,  40.0000,  50.0000}, /* h16v04 */
+    { -15.5572,    0.0130,  40.0000,  50.0000}, /* h17v04 */
+    {   0.0000,   15.5702,  40.0000,  50.0000}, /* h18v04 */
+    {  13.0541,   31.1274,  40.0000,  50.0000}, /* h19v04 */
+    {  26.1081,   46.6847,  40.0000,  50.0000}, /* h20v04 */
+    {  39.1622,   62.2419,  40.0000,  50.0000}, /* h21v04 */
+    {  52.2163,   77.7992,  40.0000,  50.0000}, /* h22v04 */
+    {  65.2704,   93.3564,  40.0000,  50.0000}, /* h23v04 */
+    {  78.3244,  108.9136,  40.0000,  50.0000}, /* h24v04 */
+    {  91.3785,  124.4709,  40.0000,  50.0000}, /* h25v04 */
+    { 104.4326,  140.0281,  40.0000,  50.0000}, /* h26v04 */
+    { 117.4867,  155.5853,  40.0000,  50.0000}, /* h27v04 */
+    { 130.5407,  171.1426,  40.0000,  50.0000}, /* h28v04 */
+    { 143.5948,  180.0000,  40.0000,  50.0000}, /* h29v04 */
+    { 156.6489,  180.0000,  40.0000,  48.1917}, /* h30v04 */
+    { 169.7029,  180.0000,  40.0000,  43.7583}, /* h31v04 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h32v04 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h33v04 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h34v04 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h35v04 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h00v05 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h01v05 */
+    {-180.0000, -173.1955,  30.0000,  33.5583}, /* h02v05 */
+    {-180.0000, -161.6485,  30.0000,  38.9500}, /* h03v05 */
+    {-180.0000, -150.1014,  30.0000,  40.0000}, /* h04v05 */
+    {-169.7029, -138.5544,  30.0000,  40.0000}, /* h05v05 */
+    {-156.6489, -127.0074,  30.0000,  40.0000}, /* h06v05 */
+    {-143.5948, -115.4604,  30.0000,  40.0000}, /* h07v05 */
+    {-130.5407, -103.9134,  30.0000,  40.0000}, /* h08v05 */
+    {-117.4867,  -92.3664,  30.0000,  40.0000}, /* h09v05 */
+    {-104.4326,  -80.8194,  30.0000,  40.0000}, /* h10v05 */
+    { -91.3785,  -69.2724,  30.0000,  40.0000}, /* h11v05 */
+    { -78.3244,  -57.7254,  30.0000,  40.0000}, /* h12v05 */
+    { -65.2704,  -46.1784,  30.0000,  40.0000}, /* h13v05 */
+    { -52.2163,  -34.6314,  30.0000,  40.0000}, /* h14v05 */
+    { -39.1622,  -23.0844,  30.0000,  40.0000}, /* h15v05 */
+    { -26.1081,  -11.5374,  30.0000,  40.0000}, /* h16v05 */
+    { -13.0541,    0.0109,  30.0000,  40.0000}, /* h17v05 */
+    {   0.0000,   13.0650,  30.0000,  40.0000}, /* h18v05 */
+    {  11.5470,   26.1190,  30.0000,  40.0000}, /* h19v05 */
+    {  23.0940,   39.1731,  30.0000,  40.0000}, /* h20v05 */
+    {  34.6410,   52.2272,  30.0000,  40.0000}, /* h21v05 */
+    {  46.1880,   65.2812,  30.0000,  40.0000}, /* h22v05 */
+    {  57.7350,   78.3353,  30.0000,  40.0000}, /* h23v05 */
+    {  69.2820,   91.3894,  30.0000,  40.0000}, /* h24v05 */
+    {  80.8290,  104.4435,  30.0000,  40.0000}, /* h25v05 */
+    {  92.3760,  117.4975,  30.0000,  40.0000}, /* h26v05 */
+    { 103.9230,  130.5516,  30.0000,  40.0000}, /* h27v05 */
+    { 115.4701,  143.6057,  30.0000,  40.0000}, /* h28v05 */
+    { 127.0171,  156.6598,  30.0000,  40.0000}, /* h29v05 */
+    { 138.5641,  169.7138,  30.0000,  40.0000}, /* h30v05 */
+    { 150.1111,  180.0000,  30.0000,  40.0000}, /* h31v05 */
+    { 161.6581,  180.0000,  30.0000,  38.9417}, /* h32v05 */
+    { 173.2051,  180.0000,  30.0000,  33.5583}, /* h33v05 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h34v05 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h35v05 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h00v06 */
+    {-180.0000, -170.2596,  20.0000,  27.2667}, /* h01v06 */
+    {-180.0000, -159.6178,  20.0000,  30.0000}, /* h02v06 */
+    {-173.2051, -148.9760,  20.0000,  30.0000}, /* h03v06 */
+    {-161.6581, -138.3342,  20.0000,  30.0000}, /* h04v06 */
+    {-150.1111, -127.6925,  20.0000,  30.0000}, /* h05v06 */
+    {-138.5641, -117.0507,  20.0000,  30.0000}, /* h06v06 */
+    {-127.0171, -106.4089,  20.0000,  30.0000}, /* h07v06 */
+    {-115.4701,  -95.7671,  20.0000,  30.0000}, /* h08v06 */
+    {-103.9230,  -85.1254,  20.0000,  30.0000}, /* h09v06 */
+    { -92.3760,  -74.4836,  20.0000,  30.0000}, /* h10v06 */
+    { -80.8290,  -63.8418,  20.0000,  30.0000}, /* h11v06 */
+    { -69.2820,  -53.2000,  20.0000,  30.0000}, /* h12v06 */
+    { -57.7350,  -42.5582,  20.0000,  30.0000}, /* h13v06 */
+    { -46.1880,  -31.9165,  20.0000,  30.0000}, /* h14v06 */
+    { -34.6410,  -21.2747,  20.0000,  30.0000}, /* h15v06 */
+    { -23.0940,  -10.6329,  20.0000,  30.0000}, /* h16v06 */
+    { -11.5470,    0.0096,  20.0000,  30.0000}, /* h17v06 */
+    {   0.0000,   11.5566,  20.0000,  30.0000}, /* h18v06 */
+    {  10.6418,   23.1036,  20.0000,  30.0000}, /* h19v06 */
+    {  21.2836,   34.6506,  20.0000,  30.0000}, /* h20v06 */
+    {  31.9253,   46.1976,  20.0000,  30.0000}, /* h21v06 */
+    {  42.5671,   57.7446,  20.0000,  30.0000}, /* h22v06 */
+    {  53.2089,   69.2917,  20.0000,  30.0000}, /* h23v06 */
+    {  63.8507,   80.8387,  20.0000,  30.0000}, /* h24v06 */
+    {  74.4924,   92.3857,  20.0000,  30.0000}, /* h25v06 */
+    {  85.1342,  103.9327,  20.0000,  30.0000}, /* h26v06 */
+    {  95.7760,  115.4797,  20.0000,  30.0000}, /* h27v06 */
+    { 106.4178,  127.0267,  20.0000,  30.0000}, /* h28v06 */
+    { 117.0596,  138.5737,  20.0000,  30.0000}, /* h29v06 */
+    { 127.7013,  150.1207,  20.0000,  30.0000}, /* h30v06 */
+    { 138.3431,  161.6677,  20.0000,  30.0000}, /* h31v06 */
+    { 148.9849,  173.2147,  20.0000,  30.0000}, /* h32v06 */
+    { 159.6267,  180.0000,  20.0000,  30.0000}, /* h33v06 */
+    { 170.2684,  180.0000,  20.0000,  27.2667}, /* h34v06 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h35v06 */
+    {-180.0000, -172.6141,  10.0000,  19.1917}, /* h00v07 */
+    {-180.0000, -162.4598,  10.0000,  20.0000}, /* h01v07 */
+    {-170.2684, -152.3055,  10.0000,  20.0000}, /* h02v07 */
+    {-159.6267, -142.1513,  10.0000,  20.0000}, /* h03v07 */
+    {-148.9849, -131.9970,  10.0000,  20.0000}, /* h04v07 */
+    {-138.3431, -121.8427,  10.0000,  20.0000}, /* h05v07 */
+    {-127.7013, -111.6885,  10.0000,  20.0000}, /* h06v07 */
+    {-117.0596, -101.5342,  10.0000,  20.0000}, /* h07v07 */
+    {-106.4178,  -91.3799,  10.0000,  20.0000}, /* h08v07 */
+    { -95.7760,  -81.2257,  10.0000,  20.0000}, /* h09v07 */
+    { -85.1342,  -71.0714,  10.0000,  20.0000}, /* h10v07 */
+    { -74.4924,  -60.9171,  10.0000,  20.0000}, /* h11v07 */
+    { -63.8507,  -50.7629,  10.0000,  20.0000}, /* h12v07 */
+    { -53.2089,  -40.6086,  10.0000,  20.0000}, /* h13v07 */
+    { -42.5671,  -30.4543,  10.0000,  20.0000}, /* h14v07 */
+    { -31.9253,  -20.3001,  10.0000,  20.0000}, /* h15v07 */
+    { -21.2836,  -10.1458,  10.0000,  20.0000}, /* h16v07 */
+    { -10.6418,    0.0089,  10.0000,  20.0000}, /* h17v07 */
+    {   0.0000,   10.6506,  10.0000,  20.0000}, /* h18v07 */
+    {  10.1543,   21.2924,  10.0000,  20.0000}, /* h19v07 */
+    {  20.3085,   31.9342,  10.0000,  20.0000}, /* h20v07 */
+    {  30.4628,   42.5760,  10.0000,  20.0000}, /* h21v07 */
+    {  40.6171,   53.2178,  10.0000,  20.0000}, /* h22v07 */
+    {  50.7713,   63.8595,  10.0000,  20.0000}, /* h23v07 */
+    {  60.9256,   74.5013,  10.0000,  20.0000}, /* h24v07 */
+    {  71.0799,   85.1431,  10.0000,  20.0000}, /* h25v07 */
+    {  81.2341,   95.7849,  10.0000,  20.0000}, /* h26v07 */
+    {  91.3884,  106.4266,  10.0000,  20.0000}, /* h27v07 */
+    { 101.5427,  117.0684,  10.0000,  20.0000}, /* h28v07 */
+    { 111.6969,  127.7102,  10.0000,  20.0000}, /* h29v07 */
+    { 121.8512,  138.3520,  10.0000,  20.0000}, /* h30v07 */
+    { 132.0055,  148.9938,  10.0000,  20.0000}, /* h31v07 */
+    { 142.1597,  159.6355,  10.0000,  20.0000}, /* h32v07 */
+    { 152.3140,  170.2773,  10.0000,  20.0000}, /* h33v07 */
+    { 162.4683,  180.0000,  10.0000,  20.0000}, /* h34v07 */
+    { 172.6225,  180.0000,  10.0000,  19.1833}, /* h35v07 */
+    {-180.0000, -169.9917,   0.0000,  10.0000}, /* h00v08 */
+    {-172.6225, -159.9917,   0.0000,  10.0000}, /* h01v08 */
+    {-162.4683, -149.9917,   0.0000,  10.0000}, /* h02v08 */
+    {-152.3140, -139.9917,   0.0000,  10.0000}, /* h03v08 */
+    {-142.1597, -129.9917,   0.0000,  10.0000}, /* h04v08 */
+    {-132.0055, -119.9917,   0.0000,  10.0000}, /* h05v08 */
+    {-121.8512, -109.9917,   0.0000,  10.0000}, /* h06v08 */
+    {-111.6969,  -99.9917,   0.0000,  10.0000}, /* h07v08 */
+    {-101.5427,  -89.9917,   0.0000,  10.0000}, /* h08v08 */
+    { -91.3884,  -79.9917,   0.0000,  10.0000}, /* h09v08 */
+    { -81.2341,  -69.9917,   0.0000,  10.0000}, /* h10v08 */
+    { -71.0799,  -59.9917,   0.0000,  10.0000}, /* h11v08 */
+    { -60.9256,  -49.9917,   0.0000,  10.0000}, /* h12v08 */
+    { -50.7713,  -39.9917,   0.0000,  10.0000}, /* h13v08 */
+    { -40.6171,  -29.9917,   0.0000,  10.0000}, /* h14v08 */
+    { -30.4628,  -19.9917,   0.0000,  10.0000}, /* h15v08 */
+    { -20.3085,   -9.9917,   0.0000,  10.0000}, /* h16v08 */
+    { -10.1543,    0.0085,   0.0000,  10.0000}, /* h17v08 */
+    {   0.0000,   10.1627,   0.0000,  10.0000}, /* h18v08 */
+    {  10.0000,   20.3170,   0.0000,  10.0000}, /* h19v08 */
+    {  20.0000,   30.4713,   0.0000,  10.0000}, /* h20v08 */
+    {  30.0000,   40.6255,   0.0000,  10.0000}, /* h21v08 */
+    {  40.0000,   50.7798,   0.0000,  10.0000}, /* h22v08 */
+    {  50.0000,   60.9341,   0.0000,  10.0000}, /* h23v08 */
+    {  60.0000,   71.0883,   0.0000,  10.0000}, /* h24v08 */
+    {  70.0000,   81.2426,   0.0000,  10.0000}, /* h25v08 */
+    {  80.0000,   91.3969,   0.0000,  10.0000}, /* h26v08 */
+    {  90.0000,  101.5511,   0.0000,  10.0000}, /* h27v08 */
+    { 100.0000,  111.7054,   0.0000,  10.0000}, /* h28v08 */
+    { 110.0000,  121.8597,   0.0000,  10.0000}, /* h29v08 */
+    { 120.0000,  132.0139,   0.0000,  10.0000}, /* h30v08 */
+    { 130.0000,  142.1682,   0.0000,  10.0000}, /* h31v08 */
+    { 140.0000,  152.3225,   0.0000,  10.0000}, /* h32v08 */
+    { 150.0000,  162.4767,   0.0000,  10.0000}, /* h33v08 */
+    { 160.0000,  172.6310,   0.0000,  10.0000}, /* h34v08 */
+    { 170.0000,  180.0000,   0.0000,  10.0000}, /* h35v08 */
+    {-180.0000, -169.9917, -10.0000,   0.0000}, /* h00v09 */
+    {-172.6225, -159.9917, -10.0000,   0.0000}, /* h01v09 */
+    {-162.4683, -149.9917, -10.0000,   0.0000}, /* h02v09 */
+    {-152.3140, -139.9917, -10.0000,   0.0000}, /* h03v09 */
+    {-142.1597, -129.9917, -10.0000,   0.0000}, /* h04v09 */
+    {-132.0055, -119.9917, -10.0000,   0.0000}, /* h05v09 */
+    {-121.8512, -109.9917, -10.0000,   0.0000}, /* h06v09 */
+    {-111.6969,  -99.9917, -10.0000,   0.0000}, /* h07v09 */
+    {-101.5427,  -89.9917, -10.0000,   0.0000}, /* h08v09 */
+    { -91.3884,  -79.9917, -10.0000,   0.0000}, /* h09v09 */
+    { -81.2341,  -69.9917, -10.0000,   0.0000}, /* h10v09 */
+    { -71.0799,  -59.9917, -10.0000,   0.0000}, /* h11v09 */
+    { -60.9256,  -49.9917, -10.0000,   0.0000}, /* h12v09 */
+    { -50.7713,  -39.9917, -10.0000,   0.0000}, /* h13v09 */
+    { -40.6171,  -29.9917, -10.0000,   0.0000}, /* h14v09 */
+    { -30.4628,  -19.9917, -10.0000,   0.0000}, /* h15v09 */
+    { -20.3085,   -9.9917, -10.0000,   0.0000}, /* h16v09 */
+    { -10.1543,    0.0085, -10.0000,   0.0000}, /* h17v09 */
+    {   0.0000,   10.1627, -10.0000,   0.0000}, /* h18v09 */
+    {  10.0000,   20.3170, -10.0000,   0.0000}, /* h19v09 */
+    {  20.0000,   30.4713, -10.0000,   0.0000}, /* h20v09 */
+    {  30.0000,   40.6255, -10.0000,   0.0000}, /* h21v09 */
+    {  40.0000,   50.7798, -10.0000,   0.0000}, /* h22v09 */
+    {  50.0000,   60.9341, -10.0000,   0.0000}, /* h23v09 */
+    {  60.0000,   71.0883, -10.0000,   0.0000}, /* h24v09 */
+    {  70.0000,   81.2426, -10.0000,   0.0000}, /* h25v09 */
+    {  80.0000,   91.3969, -10.0000,   0.0000}, /* h26v09 */
+    {  90.0000,  101.5511, -10.0000,   0.0000}, /* h27v09 */
+    { 100.0000,  111.7054, -10.0000,   0.0000}, /* h28v09 */
+    { 110.0000,  121.8597, -10.0000,   0.0000}, /* h29v09 */
+    { 120.0000,  132.0139, -10.0000,   0.0000}, /* h30v09 */
+    { 130.0000,  142.1682, -10.0000,   0.0000}, /* h31v09 */
+    { 140.0000,  152.3225, -10.0000,   0.0000}, /* h32v09 */
+    { 150.0000,  162.4767, -10.0000,   0.0000}, /* h33v09 */
+    { 160.0000,  172.6310, -10.0000,   0.0000}, /* h34v09 */
+    { 170.0000,  180.0000, -10.0000,   0.0000}, /* h35v09 */
+    {-180.0000, -172.6141, -19.1917, -10.0000}, /* h00v10 */
+    {-180.0000, -162.4598, -20.0000, -10.0000}, /* h01v10 */
+    {-170.2684, -152.3055, -20.0000, -10.0000}, /* h02v10 */
+    {-159.6267, -142.1513, -20.0000, -10.0000}, /* h03v10 */
+    {-148.9849, -131.9970, -20.0000, -10.0000}, /* h04v10 */
+    {-138.3431, -121.8427, -20.0000, -10.0000}, /* h05v10 */
+    {-127.7013, -111.6885, -20.0000, -10.0000}, /* h06v10 */
+    {-117.0596, -101.5342, -20.0000, -10.0000}, /* h07v10 */
+    {-106.4178,  -91.3799, -20.0000, -10.0000}, /* h08v10 */
+    { -95.7760,  -81.2257, -20.0000, -10.0000}, /* h09v10 */
+    { -85.1342,  -71.0714, -20.0000, -10.0000}, /* h10v10 */
+    { -74.4924,  -60.9171, -20.0000, -10.0000}, /* h11v10 */
+    { -63.8507,  -50.7629, -20.0000, -10.0000}, /* h12v10 */
+    { -53.2089,  -40.6086, -20.0000, -10.0000}, /* h13v10 */
+    { -42.5671,  -30.4543, -20.0000, -10.0000}, /* h14v10 */
+    { -31.9253,  -20.3001, -20.0000, -10.0000}, /* h15v10 */
+    { -21.2836,  -10.1458, -20.0000, -10.0000}, /* h16v10 */
+    { -10.6418,    0.0089, -20.0000, -10.0000}, /* h17v10 */
+    {   0.0000,   10.6506, -20.0000, -10.0000}, /* h18v10 */
+    {  10.1543,   21.2924, -20.0000, -10.0000}, /* h19v10 */
+    {  20.3085,   31.9342, -20.0000, -10.0000}, /* h20v10 */
+    {  30.4628,   42.5760, -20.0000, -10.0000}, /* h21v10 */
+    {  40.6171,   53.2178, -20.0000, -10.0000}, /* h22v10 */
+    {  50.7713,   63.8595, -20.0000, -10.0000}, /* h23v10 */
+    {  60.9256,   74.5013, -20.0000, -10.0000}, /* h24v10 */
+    {  71.0799,   85.1431, -20.0000, -10.0000}, /* h25v10 */
+    {  81.2341,   95.7849, -20.0000, -10.0000}, /* h26v10 */
+    {  91.3884,  106.4266, -20.0000, -10.0000}, /* h27v10 */
+    { 101.5427,  117.0684, -20.0000, -10.0000}, /* h28v10 */
+    { 111.6969,  127.7102, -20.0000, -10.0000}, /* h29v10 */
+    { 121.8512,  138.3520, -20.0000, -10.0000}, /* h30v10 */
+    { 132.0055,  148.9938, -20.0000, -10.0000}, /* h31v10 */
+    { 142.1597,  159.6355, -20.0000, -10.0000}, /* h32v10 */
+    { 152.3140,  170.2773, -20.0000, -10.0000}, /* h33v10 */
+    { 162.4683,  180.0000, -20.0000, -10.0000}, /* h34v10 */
+    { 172.6225,  180.0000, -19.1833, -10.0000}, /* h35v10 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h00v11 */
+    {-180.0000, -170.2596, -27.2667, -20.0000}, /* h01v11 */
+    {-180.0000, -159.6178, -30.0000, -20.0000}, /* h02v11 */
+    {-173.2051, -148.9760, -30.0000, -20.0000}, /* h03v11 */
+    {-161.6581, -138.3342, -30.0000, -20.0000}, /* h04v11 */
+    {-150.1111, -127.6925, -30.0000, -20.0000}, /* h05v11 */
+    {-138.5641, -117.0507, -30.0000, -20.0000}, /* h06v11 */
+    {-127.0171, -106.4089, -30.0000, -20.0000}, /* h07v11 */
+    {-115.4701,  -95.7671, -30.0000, -20.0000}, /* h08v11 */
+    {-103.9230,  -85.1254, -30.0000, -20.0000}, /* h09v11 */
+    { -92.3760,  -74.4836, -30.0000, -20.0000}, /* h10v11 */
+    { -80.8290,  -63.8418, -30.0000, -20.0000}, /* h11v11 */
+    { -69.2820,  -53.2000, -30.0000, -20.0000}, /* h12v11 */
+    { -57.7350,  -42.5582, -30.0000, -20.0000}, /* h13v11 */
+    { -46.1880,  -31.9165, -30.0000, -20.0000}, /* h14v11 */
+    { -34.6410,  -21.2747, -30.0000, -20.0000}, /* h15v11 */
+    { -23.0940,  -10.6329, -30.0000, -20.0000}, /* h16v11 */
+    { -11.5470,    0.0096, -30.0000, -20.0000}, /* h17v11 */
+    {   0.0000,   11.5566, -30.0000, -20.0000}, /* h18v11 */
+    {  10.6418,   23.1036, -30.0000, -20.0000}, /* h19v11 */
+    {  21.2836,   34.6506, -30.0000, -20.0000}, /* h20v11 */
+    {  31.9253,   46.1976, -30.0000, -20.0000}, /* h21v11 */
+    {  42.5671,   57.7446, -30.0000, -20.0000}, /* h22v11 */
+    {  53.2089,   69.2917, -30.0000, -20.0000}, /* h23v11 */
+    {  63.8507,   80.8387, -30.0000, -20.0000}, /* h24v11 */
+    {  74.4924,   92.3857, -30.0000, -20.0000}, /* h25v11 */
+    {  85.1342,  103.9327, -30.0000, -20.0000}, /* h26v11 */
+    {  95.7760,  115.4797, -30.0000, -20.0000}, /* h27v11 */
+    { 106.4178,  127.0267, -30.0000, -20.0000}, /* h28v11 */
+    { 117.0596,  138.5737, -30.0000, -20.0000}, /* h29v11 */
+    { 127.7013,  150.1207, -30.0000, -20.0000}, /* h30v11 */
+    { 138.3431,  161.6677, -30.0000, -20.0000}, /* h31v11 */
+    { 148.9849,  173.2147, -30.0000, -20.0000}, /* h32v11 */
+    { 159.6267,  180.0000, -30.0000, -20.0000}, /* h33v11 */
+    { 170.2684,  180.0000, -27.2667, -20.0000}, /* h34v11 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h35v11 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h00v12 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h01v12 */
+    {-180.0000, -173.1955, -33.5583, -30.0000}, /* h02v12 */
+    {-180.0000, -161.6485, -38.9500, -30.0000}, /* h03v12 */
+    {-180.0000, -150.1014, -40.0000, -30.0000}, /* h04v12 */
+    {-169.7029, -138.5544, -40.0000, -30.0000}, /* h05v12 */
+    {-156.6489, -127.0074, -40.0000, -30.0000}, /* h06v12 */
+    {-143.5948, -115.4604, -40.0000, -30.0000}, /* h07v12 */
+    {-130.5407, -103.9134, -40.0000, -30.0000}, /* h08v12 */
+    {-117.4867,  -92.3664, -40.0000, -30.0000}, /* h09v12 */
+    {-104.4326,  -80.8194, -40.0000, -30.0000}, /* h10v12 */
+    { -91.3785,  -69.2724, -40.0000, -30.0000}, /* h11v12 */
+    { -78.3244,  -57.7254, -40.0000, -30.0000}, /* h12v12 */
+    { -65.2704,  -46.1784, -40.0000, -30.0000}, /* h13v12 */
+    { -52.2163,  -34.6314, -40.0000, -30.0000}, /* h14v12 */
+    { -39.1622,  -23.0844, -40.0000, -30.0000}, /* h15v12 */
+    { -26.1081,  -11.5374, -40.0000, -30.0000}, /* h16v12 */
+    { -13.0541,    0.0109, -40.0000, -30.0000}, /* h17v12 */
+    {   0.0000,   13.0650, -40.0000, -30.0000}, /* h18v12 */
+    {  11.5470,   26.1190, -40.0000, -30.0000}, /* h19v12 */
+    {  23.0940,   39.1731, -40.0000, -30.0000}, /* h20v12 */
+    {  34.6410,   52.2272, -40.0000, -30.0000}, /* h21v12 */
+    {  46.1880,   65.2812, -40.0000, -30.0000}, /* h22v12 */
+    {  57.7350,   78.3353, -40.0000, -30.0000}, /* h23v12 */
+    {  69.2820,   91.3894, -40.0000, -30.0000}, /* h24v12 */
+    {  80.8290,  104.4435, -40.0000, -30.0000}, /* h25v12 */
+    {  92.3760,  117.4975, -40.0000, -30.0000}, /* h26v12 */
+    { 103.9230,  130.5516, -40.0000, -30.0000}, /* h27v12 */
+    { 115.4701,  143.6057, -40.0000, -30.0000}, /* h28v12 */
+    { 127.0171,  156.6598, -40.0000, -30.0000}, /* h29v12 */
+    { 138.5641,  169.7138, -40.0000, -30.0000}, /* h30v12 */
+    { 150.1111,  180.0000, -40.0000, -30.0000}, /* h31v12 */
+    { 161.6581,  180.0000, -38.9417, -30.0000}, /* h32v12 */
+    { 173.2051,  180.0000, -33.5583, -30.0000}, /* h33v12 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h34v12 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h35v12 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h00v13 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h01v13 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h02v13 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h03v13 */
+    {-180.0000, -169.6921, -43.7667, -40.0000}, /* h04v13 */
+    {-180.0000, -156.6380, -48.1917, -40.0000}, /* h05v13 */
+    {-180.0000, -143.5839, -50.0000, -40.0000}, /* h06v13 */
+    {-171.1296, -130.5299, -50.0000, -40.0000}, /* h07v13 */
+    {-155.5724, -117.4758, -50.0000, -40.0000}, /* h08v13 */
+    {-140.0151, -104.4217, -50.0000, -40.0000}, /* h09v13 */
+    {-124.4579,  -91.3676, -50.0000, -40.0000}, /* h10v13 */
+    {-108.9007,  -78.3136, -50.0000, -40.0000}, /* h11v13 */
+    { -93.3434,  -65.2595, -50.0000, -40.0000}, /* h12v13 */
+    { -77.7862,  -52.2054, -50.0000, -40.0000}, /* h13v13 */
+    { -62.2290,  -39.1513, -50.0000, -40.0000}, /* h14v13 */
+    { -46.6717,  -26.0973, -50.0000, -40.0000}, /* h15v13 */
+    { -31.1145,  -13.0432, -50.0000, -40.0000}, /* h16v13 */
+    { -15.5572,    0.0130, -50.0000, -40.0000}, /* h17v13 */
+    {   0.0000,   15.5702, -50.0000, -40.0000}, /* h18v13 */
+    {  13.0541,   31.1274, -50.0000, -40.0000}, /* h19v13 */
+    {  26.1081,   46.6847, -50.0000, -40.0000}, /* h20v13 */
+    {  39.1622,   62.2419, -50.0000, -40.0000}, /* h21v13 */
+    {  52.2163,   77.7992, -50.0000, -40.0000}, /* h22v13 */
+    {  65.2704,   93.3564, -50.0000, -40.0000}, /* h23v13 */
+    {  78.3244,  108.9136, -50.0000, -40.0000}, /* h24v13 */
+    {  91.3785,  124.4709, -50.0000, -40.0000}, /* h25v13 */
+    { 104.4326,  140.0281, -50.0000, -40.0000}, /* h26v13 */
+    { 117.4867,  155.5853, -50.0000, -40.0000}, /* h27v13 */
+    { 130.5407,  171.1426, -50.0000, -40.0000}, /* h28v13 */
+    { 143.5948,  180.0000, -50.0000, -40.0000}, /* h29v13 */
+    { 156.6489,  180.0000, -48.1917, -40.0000}, /* h30v13 */
+    { 169.7029,  180.0000, -43.7583, -40.0000}, /* h31v13 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h32v13 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h33v13 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h34v13 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h35v13 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h00v14 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h01v14 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h02v14 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h03v14 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h04v14 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h05v14 */
+    {-180.0000, -171.1167, -52.3333, -50.0000}, /* h06v14 */
+    {-180.0000, -155.5594, -56.2583, -50.0000}, /* h07v14 */
+    {-180.0000, -140.0022, -60.0000, -50.0000}, /* h08v14 */
+    {-180.0000, -124.4449, -60.0000, -50.0000}, /* h09v14 */
+    {-160.0000, -108.8877, -60.0000, -50.0000}, /* h10v14 */
+    {-140.0000,  -93.3305, -60.0000, -50.0000}, /* h11v14 */
+    {-120.0000,  -77.7732, -60.0000, -50.0000}, /* h12v14 */
+    {-100.0000,  -62.2160, -60.0000, -50.0000}, /* h13v14 */
+    { -80.0000,  -46.6588, -60.0000, -50.0000}, /* h14v14 */
+    { -60.0000,  -31.1015, -60.0000, -50.0000}, /* h15v14 */
+    { -40.0000,  -15.5443, -60.0000, -50.0000}, /* h16v14 */
+    { -20.0000,    0.0167, -60.0000, -50.0000}, /* h17v14 */
+    {   0.0000,   20.0167, -60.0000, -50.0000}, /* h18v14 */
+    {  15.5572,   40.0167, -60.0000, -50.0000}, /* h19v14 */
+    {  31.1145,   60.0167, -60.0000, -50.0000}, /* h20v14 */
+    {  46.6717,   80.0167, -60.0000, -50.0000}, /* h21v14 */
+    {  62.2290,  100.0167, -60.0000, -50.0000}, /* h22v14 */
+    {  77.7862,  120.0167, -60.0000, -50.0000}, /* h23v14 */
+    {  93.3434,  140.0167, -60.0000, -50.0000}, /* h24v14 */
+    { 108.9007,  160.0167, -60.0000, -50.0000}, /* h25v14 */
+    { 124.4579,  180.0000, -60.0000, -50.0000}, /* h26v14 */
+    { 140.0151,  180.0000, -60.0000, -50.0000}, /* h27v14 */
+    { 155.5724,  180.0000, -56.2500, -50.0000}, /* h28v14 */
+    { 171.1296,  180.0000, -52.3333, -50.0000}, /* h29v14 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h30v14 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h31v14 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h32v14 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h33v14 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h34v14 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h35v14 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h00v15 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h01v15 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h02v15 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h03v15 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h04v15 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h05v15 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h06v15 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h07v15 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h08v15 */
+    {-180.0000, -159.9833, -63.6167, -60.0000}, /* h09v15 */
+    {-180.0000, -139.9833, -67.1167, -60.0000}, /* h10v15 */
+    {-180.0000, -119.9833, -70.0000, -60.0000}, /* h11v15 */
+    {-175.4283,  -99.9833, -70.0000, -60.0000}, /* h12v15 */
+    {-146.1902,  -79.9833, -70.0000, -60.0000}, /* h13v15 */
+    {-116.9522,  -59.9833, -70.0000, -60.0000}, /* h14v15 */
+    { -87.7141,  -39.9833, -70.0000, -60.0000}, /* h15v15 */
+    { -58.4761,  -19.9833, -70.0000, -60.0000}, /* h16v15 */
+    { -29.2380,    0.0244, -70.0000, -60.0000}, /* h17v15 */
+    {   0.0000,   29.2624, -70.0000, -60.0000}, /* h18v15 */
+    {  20.0000,   58.5005, -70.0000, -60.0000}, /* h19v15 */
+    {  40.0000,   87.7385, -70.0000, -60.0000}, /* h20v15 */
+    {  60.0000,  116.9765, -70.0000, -60.0000}, /* h21v15 */
+    {  80.0000,  146.2146, -70.0000, -60.0000}, /* h22v15 */
+    { 100.0000,  175.4526, -70.0000, -60.0000}, /* h23v15 */
+    { 120.0000,  180.0000, -70.0000, -60.0000}, /* h24v15 */
+    { 140.0000,  180.0000, -67.1167, -60.0000}, /* h25v15 */
+    { 160.0000,  180.0000, -63.6167, -60.0000}, /* h26v15 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h27v15 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h28v15 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h29v15 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h30v15 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h31v15 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h32v15 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h33v15 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h34v15 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h35v15 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h00v16 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h01v16 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h02v16 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h03v16 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h04v16 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h05v16 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h06v16 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h07v16 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h08v16 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h09v16 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h10v16 */
+    {-180.0000, -175.4039, -70.5333, -70.0000}, /* h11v16 */
+    {-180.0000, -146.1659, -73.8750, -70.0000}, /* h12v16 */
+    {-180.0000, -116.9278, -77.1667, -70.0000}, /* h13v16 */
+    {-180.0000,  -87.6898, -80.0000, -70.0000}, /* h14v16 */
+    {-172.7631,  -58.4517, -80.0000, -70.0000}, /* h15v16 */
+    {-115.1754,  -29.2137, -80.0000, -70.0000}, /* h16v16 */
+    { -57.5877,    0.0480, -80.0000, -70.0000}, /* h17v16 */
+    {   0.0000,   57.6357, -80.0000, -70.0000}, /* h18v16 */
+    {  29.2380,  115.2234, -80.0000, -70.0000}, /* h19v16 */
+    {  58.4761,  172.8111, -80.0000, -70.0000}, /* h20v16 */
+    {  87.7141,  180.0000, -80.0000, -70.0000}, /* h21v16 */
+    { 116.9522,  180.0000, -77.1583, -70.0000}, /* h22v16 */
+    { 146.1902,  180.0000, -73.8750, -70.0000}, /* h23v16 */
+    { 175.4283,  180.0000, -70.5333, -70.0000}, /* h24v16 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h25v16 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h26v16 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h27v16 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h28v16 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h29v16 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h30v16 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h31v16 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h32v16 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h33v16 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h34v16 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h35v16 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h00v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h01v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h02v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h03v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h04v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h05v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h06v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h07v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h08v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h09v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h10v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h11v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h12v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h13v17 */
+    {-180.0000, -172.7151, -80.4083, -80.0000}, /* h14v17 */
+    {-180.0000, -115.1274, -83.6250, -80.0000}, /* h15v17 */
+    {-180.0000,  -57.5397, -86.8167, -80.0000}, /* h16v17 */
+    {-180.0000,   57.2957, -90.0000, -80.0000}, /* h17v17 */
+    {  -0.0040,  180.0000, -90.0000, -80.0000}, /* h18v17 */
+    {  57.5877,  180.0000, -86.8167, -80.0000}, /* h19v17 */
+    { 115.1754,  180.0000, -83.6250, -80.0000}, /* h20v17 */
+    { 172.7631,  180.0000, -80.4083, -80.0000}, /* h21v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h22v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h23v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h24v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h25v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h26v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h27v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h28v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h29v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h30v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h31v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h32v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h33v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h34v17 */
+    {-999.0000, -999.0000, -99.0000, -99.0000}, /* h35v17 */
+};
+
+/** Is x a valid longitude? For non-negative doubles, comparing the
+ * bits as integers orders them like the values, so the loop below
+ * vectorizes without floating point comparisons. */
+static inline bool
+valid_lon(double x) {
+    double ax = std::fabs(x), limit = 180.0;
+    long long bx, bl;
+
+    std::memcpy(&bx, &ax, sizeof(bx));
+    std::memcpy(&bl, &limit, sizeof(bl));
+    return bx <= bl;
+}
+
+/** a if ok, else b. */
+static inline double
+pick(bool ok, double a, double b) {
+    long long ba, bb, mask = -(long long) ok;
+
+    std::memcpy(&ba, &a, sizeof(ba));
+    std::memcpy(&bb, &b, sizeof(bb));
+    ba = (ba & mask) | (bb & ~mask);
+    std::memcpy(&a, &ba, sizeof(a));
+    return a;
+}
+
+/**
+ * Fill in one row of pixels, all at latitude lat. The x of pixel j is
+ * x0 + (j + 0.5) step, and its longitude that times scale.
+ */
+SSC_TARGET_CLONES static void
+row_kernel(double lat, double x0, double step, double scale, size_t n,
+           double *row_lat, double *row_lon) {
+#pragma omp simd
+    for (size_t j = 0; j < n; j++) {
+        double lon = (x0 + (j + 0.5) * step) * scale;
+        bool ok = valid_lon(lon);
+        row_lat[j] = pick(ok, lat, SSC_GEO_FILL);
+        row_lon[j] = pick(ok, lon, SSC_GEO_FILL);
+    }
+}
+
+int
+sinusoidal_tile_bounds(int h, int v, double bounds[4]) {
+    if (h < 0 || h >= SSC_SIN_NUM_H || v < 0 || v >= SSC_SIN_NUM_V)
+        return SSC_EINPUT;
+
+    const double *b = tile_bounds[v * SSC_SIN_NUM_H + h];
+    if (b[0] == NO_TILE)
+        return SSC_EINPUT;
+    for (int k = 0; k < 4; k++)
+        bounds[k] = b[k];
+
+    return 0;
+}
+
+int
+sinusoidal_tile_geolocation(int h, int v, size_t pixels, double *lat, double *lon,
+                            int num_threads) {
+    if (h < 0 || h >= SSC_SIN_NUM_H || v < 0 || v >= SSC_SIN_NUM_V || !pixels)
+        return SSC_EINPUT;
+
+    const double step = SIN_TILE_SIZE / pixels;
+    const double x0 = SIN_X_MIN + h * SIN_TILE_SIZE;
+    const double y0 = SIN_Y_MAX - v * SIN_TILE_SIZE;
+    const long num_rows = (long) pixels;
+
+#pragma omp parallel for schedule(static) num_threads(std::max(num_threads, 1))
+    for (long i = 0; i < num_rows; i++) {
+        double row_lat = (y0 - (i + 0.5) * step) / SIN_RADIUS;
+        double scale = RAD_TO_DEG / (SIN_RADIUS * std::cos(row_lat));
+        size_t row = (size_t) i * pixels;
+
+        row_kernel(row_lat * RAD_TO_DEG, x0, step, scale, pixels, &lat[row], &lon[row]);
+    }
+
+    return 0;
+}
+
+/**
+ * Compute the lat/lon of the center of each pixel of a tile.
+ *
+ * @param h Horizontal tile number, 0 to 35.
+ * @param v Vertical tile number, 0 to 17.
+ * @param grid A square grid, with as many pixels along each side as
+ * the tile is wanted at. Its lat/lons are set.
+ * @param num_threads Threads to use.
+ *
+ * @return 0 for success, SSC_EINPUT if there is no such tile or the
+ * grid is not square.
+ */
+int
+sinusoidal_tile_geolocation(int h, int v, GeoGrid &grid, int num_threads) {
+    if (grid.num_i() != grid.num_j())
+        return SSC_EINPUT;
+    return sinusoidal_tile_geolocation(h, v, grid.num_i(), grid.lat().data(), grid.lon().data(),
+                                       num_threads);
+}
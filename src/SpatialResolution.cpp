@@ -0,0 +1,186 @@
+/// @file
+/// Estimate the STARE resolution level of each point of a grid, with
+/// the STARE library or from the spacing of its neighbors.
+
+#include "config.h"
+#include "SpatialResolution.h"
+#include "GeoGrid.h"
+#include "StareBits.h"
+#include "StarePool.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#define BLOCK_ROWS 16 /**< Rows a thread takes at a time. */
+#define DEG_TO_RAD 1.74532925199432957692e-02
+#define ROOT_EDGE 1.57079632679489661923 /**< Edge of a root trixel, in radians. */
+
+/** Is lat a valid latitude? False for fill values and NaN. */
+static inline bool
+valid_lat(double lat) {
+    return std::fabs(lat) <= 90.0;
+}
+
+/**
+ * Haversine of the arc between two points, or 0 if either is not a
+ * valid lat/lon. Longitudes may be any number of turns apart.
+ */
+static inline double
+haversine(double lat0, double lon0, double lat1, double lon1) {
+    if (!valid_lat(lat0) || !valid_lat(lat1))
+        return 0.0;
+    double s = std::sin((lat1 - lat0) * DEG_TO_RAD / 2);
+    double t = std::sin((lon1 - lon0) * DEG_TO_RAD / 2);
+    return s * s + std::cos(lat0 * DEG_TO_RAD) * std::cos(lat1 * DEG_TO_RAD) * t * t;
+}
+
+/** Level of the smallest trixel no smaller than an arc with haversine h > 0. */
+static inline int
+level_of(double h) {
+    double arc = 2.0 * std::asin(std::sqrt(std::min(h, 1.0)));
+    int level = (int) std::floor(std::log2(ROOT_EDGE / arc));
+    return std::min(std::max(level, 0), SSC_STARE_MAX_LEVEL);
+}
+
+/**
+ * Haversines of the steps from each point of row i to the point below
+ * it, all 0 if row i is the last of its scan.
+ */
+static void
+step_down(const double *lat, const double *lon, size_t num_i, size_t num_j, size_t rows_per_scan,
+          size_t i, double *h) {
+    if (i + 1 >= num_i || (i + 1) % rows_per_scan == 0) {
+        std::fill(h, h + num_j, 0.0);
+        return;
+    }
+    const double *lat0 = &lat[i * num_j], *lon0 = &lon[i * num_j];
+    for (size_t j = 0; j < num_j; j++)
+        h[j] = haversine(lat0[j], lon0[j], lat0[num_j + j], lon0[num_j + j]);
+}
+
+/**
+ * Set the resolution level of each STARE index from the spacing of
+ * the points around it.
+ *
+ * @param lat Latitudes, num_i rows of num_j.
+ * @param lon Longitudes, laid out like lat.
+ * @param num_i Number of rows.
+ * @param num_j Number of columns.
+ * @param rows_per_scan Rows in each scan; row 0 starts a scan.
+ * @param index STARE indices of the points, laid out like lat.
+ * @param num_threads Number of threads to use.
+ *
+ * @return the finest level of any point, or 0 if there is none.
+ */
+int
+estimate_resolution(const double *lat, const double *lon, size_t num_i, size_t num_j,
+                    size_t rows_per_scan, unsigned long long *index, int num_threads) {
+    int num_blocks = (int) ((num_i + BLOCK_ROWS - 1) / BLOCK_ROWS);
+    int finest = 0;
+
+    if (!rows_per_scan)
+        rows_per_scan = num_i;
+
+    // Each thread takes blocks of rows, carrying the steps between
+    // rows down the block so that each one is worked out once.
+#pragma omp parallel num_threads(std::max(num_threads, 1)) reduction(max : finest)
+    {
+        std::vector<double> up(num_j), down(num_j), across(num_j);
+
+#pragma omp for schedule(static)
+        for (int b = 0; b < num_blocks; b++) {
+            size_t i0 = (size_t) b * BLOCK_ROWS;
+            size_t i1 = std::min(i0 + BLOCK_ROWS, num_i);
+
+            if (i0 > 0)
+                step_down(lat, lon, num_i, num_j, rows_per_scan, i0 - 1, &up[0]);
+            else
+                std::fill(up.begin(), up.end(), 0.0);
+
+            for (size_t i = i0; i < i1; i++) {
+                size_t row = i * num_j;
+
+                step_down(lat, lon, num_i, num_j, rows_per_scan, i, &down[0]);
+                for (size_t j = 0; j + 1 < num_j; j++)
+                    across[j] = haversine(lat[row + j], lon[row + j], lat[row + j + 1], lon[row + j + 1]);
+
+                for (size_t j = 0; j < num_j; j++) {
+                    if (!valid_lat(lat[row + j]))
+                        continue;
+                    double h = std::max(up[j], down[j]);
+                    if (j > 0)
+                        h = std::max(h, across[j - 1]);
+                    if (j + 1 < num_j)
+                        h = std::max(h, across[j]);
+                    if (h <= 0.0)
+                        continue;
+
+                    int level = level_of(h);
+                    index[row + j] = stare_set_level(index[row + j], level);
+                    finest = std::max(finest, level);
+                }
+                up.swap(down);
+            }
+        }
+    }
+
+    return finest;
+}
+
+/**
+ * Set the resolution level of the STARE indices of a GeoGrid.
+ *
+ * @param grid The grid, with its indices computed.
+ * @param rows_per_scan Rows in each scan; row 0 starts a scan.
+ * @param num_threads Number of threads to use.
+ *
+ * @return the finest level of any point, or 0 if there is none.
+ */
+int
+estimate_resolution(GeoGrid &grid, size_t rows_per_scan, int num_threads) {
+    return estimate_resolution(grid.lat().data(), grid.lon().data(), grid.num_i(), grid.num_j(),
+                               rows_per_scan, grid.index().data(), num_threads);
+}
+
+/**
+ * Set the resolution level of each STARE index with the STARE
+ * library, one row at a time.
+ *
+ * @param index STARE indices, num_i rows of num_j.
+ * @param num_i Number of rows.
+ * @param num_j Number of columns.
+ * @param level STARE search level.
+ * @param build_level STARE build level.
+ * @param num_threads Number of threads to use.
+ *
+ * @return the finest level of any point, or 0 if there is none.
+ */
+int
+adapt_resolution(unsigned long long *index, size_t num_i, size_t num_j, int level,
+                 int build_level, int num_threads) {
+    STARE &stare = StarePool::get(level, build_level);
+    int finest = 0;
+
+#pragma omp parallel for num_threads(std::max(num_threads, 1)) schedule(static) reduction(max : finest)
+    for (long i = 0; i < (long) num_i; i++) {
+        unsigned long long *row = &index[i * num_j];
+        size_t j0 = 0;
+
+        while (j0 < num_j) {
+            if (row[j0] == SSC_STARE_NO_TRIXEL) {
+                j0++;
+                continue;
+            }
+            size_t j1 = j0 + 1;
+            while (j1 < num_j && row[j1] != SSC_STARE_NO_TRIXEL)
+                j1++;
+            if (j1 - j0 > 1)
+                stare.adaptSpatialResolutionEstimatesInPlace(&row[j0], (int) (j1 - j0));
+            for (size_t j = j0; j < j1; j++)
+                finest = std::max(finest, stare_level(row[j]));
+            j0 = j1;
+        }
+    }
+
+    return finest;
+}
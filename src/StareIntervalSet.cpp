@@ -0,0 +1,395 @@
+/// @file
+/// This class holds a set of STARE trixels as sorted intervals, with
+/// set algebra and fast containment tests.
+
+#include "config.h"
+#include "StareIntervalSet.h"
+#include "StareBits.h"
+#include "ssc.h"
+#include <algorithm>
+#include <utility>
+
+#define POS_SHIFT 5 /**< Shift from an index to its level 27 trixel number. */
+#define SEARCH_BATCH 256 /**< Queries stepped through the search together. */
+
+/** Number of level 27 trixels in a trixel at level. */
+static inline unsigned long long
+span(int level) {
+    return 1ULL << 2 * (SSC_STARE_MAX_LEVEL - level);
+}
+
+/** First level 27 trixel of the trixel of id, which is not a terminator. */
+static inline unsigned long long
+first_pos(unsigned long long id, int &level) {
+    level = std::min(stare_level(id), SSC_STARE_MAX_LEVEL);
+    return (id & stare_location_mask(level)) >> POS_SHIFT;
+}
+
+/**
+ * For each query, the number of starts no greater than it. All queries
+ * take the same steps, halving the range each time, so the loop over
+ * the queries vectorizes with gathers. Trixel numbers are below 2^57,
+ * so they compare the same as signed numbers.
+ *
+ * @param lo Sorted starts.
+ * @param n Number of starts, at least 1.
+ * @param p Queries.
+ * @param m Number of queries.
+ * @param pos Gets the result for each query.
+ */
+SSC_TARGET_CLONES static void
+search_kernel(const long long *lo, size_t n, const long long *p, size_t m, long long *pos) {
+#pragma omp simd
+    for (size_t k = 0; k < m; k++)
+        pos[k] = 0;
+    for (size_t len = n; len > 1;) {
+        long long half = (long long) (len / 2);
+#pragma omp simd
+        for (size_t k = 0; k < m; k++)
+            pos[k] += lo[pos[k] + half] <= p[k] ? half : 0;
+        len -= half;
+    }
+#pragma omp simd
+    for (size_t k = 0; k < m; k++)
+        pos[k] += lo[pos[k]] <= p[k] ? 1 : 0;
+}
+
+/**
+ * Make a set from STARE_SpatialIntervals. The values may be in any
+ * order and may overlap. A terminator that does not follow a trixel is
+ * ignored.
+ *
+ * @param values Trixels, each one alone or followed by a terminator.
+ * @param n Number of values.
+ *
+ * @return the set.
+ */
+StareIntervalSet
+StareIntervalSet::from_intervals(const unsigned long long *values, size_t n) {
+    std::vector<std::pair<unsigned long long, unsigned long long> > range;
+    StareIntervalSet set;
+
+    range.reserve(n);
+    for (size_t k = 0; k < n; k++) {
+        if (stare_is_terminator(values[k]))
+            continue;
+        int level;
+        unsigned long long lo = first_pos(values[k], level);
+        unsigned long long hi = lo + span(level);
+        if (k + 1 < n && stare_is_terminator(values[k + 1]))
+            hi = std::max(hi, (values[++k] >> POS_SHIFT) + 1);
+        range.push_back(std::make_pair(lo, hi));
+    }
+
+    if (!std::is_sorted(range.begin(), range.end()))
+        std::sort(range.begin(), range.end());
+    set.d_lo.reserve(range.size());
+    set.d_hi.reserve(range.size());
+    for (size_t k = 0; k < range.size(); k++)
+        set.add(range[k].first, range[k].second);
+
+    return set;
+}
+
+/**
+ * Get the set as STARE_SpatialIntervals. A range that is exactly one
+ * trixel is that trixel. Any other range is its first trixel at level
+ * (or at level 27 if it does not start on a trixel of that level),
+ * followed by the terminator of its last one.
+ *
+ * @param values Gets the values.
+ * @param level Level of the trixels that start intervals.
+ */
+void
+StareIntervalSet::intervals(std::vector<unsigned long long> &values, int level) const {
+    values.clear();
+    for (size_t k = 0; k < d_lo.size(); k++) {
+        unsigned long long lo = d_lo[k], size = d_hi[k] - lo;
+        int twos = __builtin_ctzll(size);
+
+        if (!(size & (size - 1)) && !(twos & 1) && !(lo & (size - 1)) &&
+            size <= span(0)) {
+            values.push_back((lo << POS_SHIFT) | (unsigned long long) (SSC_STARE_MAX_LEVEL - twos / 2));
+        } else {
+            int start = (lo & (span(level) - 1)) ? SSC_STARE_MAX_LEVEL : level;
+            values.push_back((lo << POS_SHIFT) | (unsigned long long) start);
+            values.push_back(((d_hi[k] - 1) << POS_SHIFT) | SSC_STARE_LEVEL_MASK);
+        }
+    }
+}
+
+/** Number of level 27 trixels in the set. */
+unsigned long long
+StareIntervalSet::count() const {
+    unsigned long long total = 0;
+
+    for (size_t k = 0; k < d_lo.size(); k++)
+        total += d_hi[k] - d_lo[k];
+    return total;
+}
+
+/**
+ * Add a range that starts at or after the start of the last one.
+ *
+ * @param lo First level 27 trixel.
+ * @param hi One past the last level 27 trixel.
+ */
+void
+StareIntervalSet::add(unsigned long long lo, unsigned long long hi) {
+    if (lo >= hi)
+        return;
+    if (!d_lo.empty() && lo <= d_hi.back()) {
+        d_hi.back() = std::max(d_hi.back(), hi);
+    } else {
+        d_lo.push_back(lo);
+        d_hi.push_back(hi);
+    }
+}
+
+/** Number of ranges that start at or before level 27 trixel p. */
+size_t
+StareIntervalSet::upper(unsigned long long p) const {
+    const unsigned long long *base = d_lo.data();
+    size_t len = d_lo.size();
+
+    if (!len)
+        return 0;
+    while (len > 1) {
+        size_t half = len / 2;
+        base = base[half] <= p ? base + half : base;
+        len -= half;
+    }
+    return (size_t) (base - d_lo.data()) + (*base <= p);
+}
+
+/**
+ * Is all of the trixel of id in the set?
+ *
+ * @param id A STARE index, at any level.
+ *
+ * @return true if every level 27 trixel in it is in the set.
+ */
+bool
+StareIntervalSet::contains(unsigned long long id) const {
+    int level;
+    unsigned long long a = first_pos(id, level);
+    size_t i = upper(a);
+
+    return i && d_hi[i - 1] >= a + span(level);
+}
+
+/**
+ * Is any of the trixel of id in the set?
+ *
+ * @param id A STARE index, at any level.
+ *
+ * @return true if some level 27 trixel in it is in the set.
+ */
+bool
+StareIntervalSet::intersects(unsigned long long id) const {
+    int level;
+    unsigned long long a = first_pos(id, level);
+    size_t i = upper(a + span(level) - 1);
+
+    return i && d_hi[i - 1] > a;
+}
+
+/**
+ * Is all of the trixel of each id in the set?
+ *
+ * @param ids STARE indices, at any level.
+ * @param n Number of indices.
+ * @param out Gets 1 for each index whose trixel is in the set, else 0.
+ */
+void
+StareIntervalSet::contains(const unsigned long long *ids, size_t n, unsigned char *out) const {
+    long long a[SEARCH_BATCH], pos[SEARCH_BATCH];
+    unsigned long long b[SEARCH_BATCH];
+
+    if (d_lo.empty()) {
+        std::fill(out, out + n, 0);
+        return;
+    }
+    for (size_t start = 0; start < n; start += SEARCH_BATCH) {
+        size_t m = std::min((size_t) SEARCH_BATCH, n - start);
+
+        for (size_t k = 0; k < m; k++) {
+            int level;
+            a[k] = (long long) first_pos(ids[start + k], level);
+            b[k] = (unsigned long long) a[k] + span(level);
+        }
+        search_kernel((const long long *) d_lo.data(), d_lo.size(), a, m, pos);
+        for (size_t k = 0; k < m; k++)
+            out[start + k] = pos[k] && d_hi[pos[k] - 1] >= b[k];
+    }
+}
+
+/**
+ * Union of two sets.
+ *
+ * @param other The other set.
+ *
+ * @return the trixels in either set.
+ */
+StareIntervalSet
+StareIntervalSet::unite(const StareIntervalSet &other) const {
+    StareIntervalSet set;
+    size_t i = 0, j = 0;
+
+    while (i < d_lo.size() || j < other.d_lo.size()) {
+        if (j == other.d_lo.size() || (i < d_lo.size() && d_lo[i] <= other.d_lo[j])) {
+            set.add(d_lo[i], d_hi[i]);
+            i++;
+        } else {
+            set.add(other.d_lo[j], other.d_hi[j]);
+            j++;
+        }
+    }
+    return set;
+}
+
+/**
+ * Intersection of two sets.
+ *
+ * @param other The other set.
+ *
+ * @return the trixels in both sets.
+ */
+StareIntervalSet
+StareIntervalSet::intersect(const StareIntervalSet &other) const {
+    StareIntervalSet set;
+    size_t i = 0, j = 0;
+
+    while (i < d_lo.size() && j < other.d_lo.size()) {
+        set.add(std::max(d_lo[i], other.d_lo[j]), std::min(d_hi[i], other.d_hi[j]));
+        if (d_hi[i] < other.d_hi[j])
+            i++;
+        else
+            j++;
+    }
+    return set;
+}
+
+/**
+ * Difference of two sets.
+ *
+ * @param other The other set.
+ *
+ * @return the trixels in this set and not in other.
+ */
+StareIntervalSet
+StareIntervalSet::subtract(const StareIntervalSet &other) const {
+    StareIntervalSet set;
+    size_t j = 0;
+
+    for (size_t i = 0; i < d_lo.size(); i++) {
+        unsigned long long lo = d_lo[i];
+
+        // Skip the ranges of other that end before this one starts.
+        while (j < other.d_lo.size() && other.d_hi[j] <= lo)
+            j++;
+        for (size_t k = j; k < other.d_lo.size() && other.d_lo[k] < d_hi[i]; k++) {
+            set.add(lo, other.d_lo[k]);
+            lo = std::max(lo, other.d_hi[k]);
+        }
+        set.add(lo, d_hi[i]);
+    }
+    return set;
+}
+
+/**
+ * The trixels at a level that have any of the set in them. Each range
+ * is widened out to whole trixels at that level, so the result holds
+ * the set and is what a cover at the coarser level would be.
+ *
+ * @param level Level to coarsen to, 0 to 27.
+ *
+ * @return the coarser set.
+ */
+StareIntervalSet
+StareIntervalSet::coarsen(int level) const {
+    unsigned long long mask = span(level) - 1;
+    StareIntervalSet set;
+
+    for (size_t k = 0; k < d_lo.size(); k++)
+        set.add(d_lo[k] & ~mask, (d_hi[k] + mask) & ~mask);
+    return set;
+}
+
+/** Append n as a variable length number, 7 bits a byte, low first. */
+static void
+put_varint(std::vector<unsigned char> &bytes, unsigned long long n) {
+    while (n >= 0x80) {
+        bytes.push_back((unsigned char) (n | 0x80));
+        n >>= 7;
+    }
+    bytes.push_back((unsigned char) n);
+}
+
+/** Read a variable length number. @return false if it runs off the end. */
+static bool
+get_varint(const unsigned char *bytes, size_t n, size_t &k, unsigned long long &value) {
+    value = 0;
+    for (int shift = 0; k < n && shift < 64; shift += 7) {
+        unsigned char c = bytes[k++];
+        value |= (unsigned long long) (c & 0x7f) << shift;
+        if (!(c & 0x80))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Pack the set as the number of ranges, then for each range the gap
+ * since the end of the one before and its length, each as a variable
+ * length number.
+ *
+ * @param bytes Gets the packed set.
+ */
+void
+StareIntervalSet::compress(std::vector<unsigned char> &bytes) const {
+    unsigned long long end = 0;
+
+    bytes.clear();
+    put_varint(bytes, d_lo.size());
+    for (size_t k = 0; k < d_lo.size(); k++) {
+        put_varint(bytes, d_lo[k] - end);
+        put_varint(bytes, d_hi[k] - d_lo[k]);
+        end = d_hi[k];
+    }
+}
+
+/**
+ * Unpack a set packed by compress().
+ *
+ * @param bytes The packed set.
+ * @param n Number of bytes.
+ *
+ * @return 0 for success, SSC_EINPUT if the bytes are not a packed set.
+ */
+int
+StareIntervalSet::decompress(const unsigned char *bytes, size_t n) {
+    const unsigned long long limit = span(0) * SSC_STARE_NUM_FACES;
+    unsigned long long num, end = 0, gap, len;
+    size_t k = 0;
+
+    d_lo.clear();
+    d_hi.clear();
+    if (!get_varint(bytes, n, k, num) || num > n)
+        return SSC_EINPUT;
+    for (unsigned long long r = 0; r < num; r++) {
+        // Ranges must be in order, apart, not empty, and on the sphere.
+        if (!get_varint(bytes, n, k, gap) || !get_varint(bytes, n, k, len) ||
+            (r && !gap) || !len || gap > limit - end || len > limit - end - gap)
+            break;
+        d_lo.push_back(end + gap);
+        d_hi.push_back(end + gap + len);
+        end += gap + len;
+    }
+    if (d_lo.size() != num || k != n) {
+        d_lo.clear();
+        d_hi.clear();
+        return SSC_EINPUT;
+    }
+    return 0;
+}
@@ -0,0 +1,75 @@
+/// @file
+/// This class keeps a process-wide pool of STARE objects.
+
+#include "config.h"
+#include "StarePool.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <atomic>
+
+/** The STARE objects of the process, keyed by (level, build_level). */
+typedef std::map<std::pair<int, int>, std::unique_ptr<STARE> > StareMap;
+
+/** The pool, shared by all threads. */
+static StareMap pool;
+
+/** Guards pool, and the construction and warming of its objects. */
+static std::mutex pool_mutex;
+
+/** Count of objects constructed. */
+static std::atomic<int> constructed(0);
+
+/**
+ * Get the STARE object for (level, build_level), constructing it on
+ * first use.
+ *
+ * STARE builds the spatial index of a resolution level the first
+ * time that level is asked for, and keeps it. A new object is asked
+ * for a point at every level while the lock is held, so that all its
+ * indexes exist before any thread sees it; after that, lookups only
+ * read the object.
+ *
+ * @param level STARE search level.
+ * @param build_level STARE build level.
+ *
+ * @return reference to a STARE object, valid until clear() is called.
+ */
+STARE &
+StarePool::get(int level, int build_level) {
+    std::pair<int, int> key(level, build_level);
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    StareMap::iterator it = pool.find(key);
+
+    if (it == pool.end()) {
+        std::unique_ptr<STARE> stare(new STARE(level, build_level));
+        for (int r = 0; r <= level; r++)
+            stare->ValueFromLatLonDegrees(0.0, 0.0, r);
+        it = pool.insert(std::make_pair(key, std::move(stare))).first;
+        constructed++;
+    }
+
+    return *(it->second);
+}
+
+/**
+ * Number of STARE objects the pool has constructed.
+ *
+ * @return number of objects.
+ */
+int
+StarePool::num_constructed() {
+    return constructed;
+}
+
+/**
+ * Drop all the STARE objects. Any references handed out become
+ * invalid, so this must not be called while another thread may be
+ * using one.
+ */
+void
+StarePool::clear() {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    pool.clear();
+}
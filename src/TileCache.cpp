@@ -0,0 +1,147 @@
+/// @file
+/// This class keeps the sidecar files of fixed grid tiles, so a tile
+/// is only indexed once.
+
+#include "config.h"
+#include "TileCache.h"
+#include "AtomicFile.h"
+#include "SidecarFile.h"
+#include "ssc.h"
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <unistd.h>
+
+#define FNV_OFFSET 14695981039346656037ULL /**< FNV-1a 64 bit offset basis. */
+#define FNV_PRIME 1099511628211ULL /**< FNV-1a 64 bit prime. */
+#define COPY_BUFFER (1 << 20) /**< Bytes copied at a time. */
+
+/** FNV-1a hash of a string. */
+static unsigned long long
+fnv1a(const std::string &s) {
+    unsigned long long hash = FNV_OFFSET;
+
+    for (size_t k = 0; k < s.size(); k++) {
+        hash ^= (unsigned char) s[k];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * Copy a file. The copy is written under a temporary name and renamed
+ * into place.
+ *
+ * @param from File to copy.
+ * @param to Name of the copy.
+ *
+ * @return 0 for success, SSC_EFILE if either file can't be used.
+ */
+static int
+copy_file(const std::string &from, const std::string &to) {
+    FILE *in = fopen(from.c_str(), "rb");
+    if (!in)
+        return SSC_EFILE;
+    AtomicFile copy(to);
+    FILE *out = copy.open();
+    if (!out) {
+        fclose(in);
+        return SSC_EFILE;
+    }
+
+    std::vector<char> buffer(COPY_BUFFER);
+    bool ok = true;
+    size_t n;
+    while (ok && (n = fread(&buffer[0], 1, buffer.size(), in)) > 0)
+        ok = fwrite(&buffer[0], 1, n, out) == n;
+    ok = ok && !ferror(in);
+    fclose(in);
+
+    return copy.commit(ok);
+}
+
+/**
+ * Use a cache directory.
+ *
+ * @param dir Cache directory. Must exist.
+ */
+TileCache::TileCache(const std::string &dir) : d_dir(dir) {
+}
+
+/**
+ * Key of a tile sidecar. The key names the tile, so the directory
+ * can be looked through, and ends with a hash of everything else the
+ * sidecar depends on.
+ *
+ * @param product Product of the tiles, such as "MOD09GA".
+ * @param h Horizontal tile number.
+ * @param v Vertical tile number.
+ * @param resolution Resolutions indexed, such as "1km_500m_250m".
+ * @param build_level STARE build level.
+ * @param settings Any other settings the sidecar depends on.
+ *
+ * @return the key.
+ */
+std::string
+TileCache::key(const std::string &product, int h, int v, const std::string &resolution,
+               int build_level, const std::string &settings) {
+    std::ostringstream key, all;
+
+    all << product << ";" << h << ";" << v << ";" << resolution << ";" << build_level << ";" <<
+        settings << ";" << PACKAGE_VERSION;
+    key << product << "_h" << std::setw(2) << std::setfill('0') << h << "v" << std::setw(2) << v <<
+        "_" << resolution << "_b" << build_level << "_" << std::hex << std::setw(16) << fnv1a(all.str());
+    return key.str();
+}
+
+/**
+ * Name of the file stored for a key.
+ *
+ * @param key The key.
+ *
+ * @return the file name.
+ */
+std::string
+TileCache::file_name(const std::string &key) const {
+    return d_dir + "/" + key + "_stare.nc";
+}
+
+/**
+ * Copy the sidecar stored for a key to a file. The history attribute
+ * of the copy is rewritten to name it, instead of the sidecar the
+ * stored file was first made as.
+ *
+ * @param key The key.
+ * @param file_out Name of the sidecar to make.
+ *
+ * @return 0 for success, SSC_EFILE if there is no sidecar for the key
+ * or it can't be copied, SSC_ENETCDF if the copy can't be updated.
+ */
+int
+TileCache::fetch(const std::string &key, const std::string &file_out) const {
+    int ret;
+
+    if (access(file_name(key).c_str(), R_OK))
+        return SSC_EFILE;
+    if ((ret = copy_file(file_name(key), file_out)))
+        return ret;
+    if ((ret = SidecarFile::rewriteHistory(file_out))) {
+        remove(file_out.c_str());
+        return ret;
+    }
+    return 0;
+}
+
+/**
+ * Store a sidecar for a key, replacing any stored before.
+ *
+ * @param key The key.
+ * @param file_in The sidecar.
+ *
+ * @return 0 for success, SSC_EFILE if it can't be stored.
+ */
+int
+TileCache::store(const std::string &key, const std::string &file_in) const {
+    return copy_file(file_in, file_name(key));
+}
@@ -0,0 +1,828 @@
+/// @file
+/// This class computes STARE indices for arrays of lat/lon points.
+
+#include "config.h"
+#include "TrixelIndexer.h"
+#include "StarePool.h"
+#include "TrixelTable.h"
+#include "ssc.h"
+#include <algorithm>
+#include <cmath>
+
+// The walk repeats HTM's vertex and normal arithmetic, which does
+// not fuse products into FMAs.
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+/** Number of points converted to vectors at a time. */
+#define CHUNK 256
+
+/** Tolerance of HTM's point-in-trixel test (gEpsilon). */
+#define HTM_EPSILON 1.0e-15
+
+/**
+ * Bound on how far the components of a point vector from
+ * latlon_to_xyz() may be from the ones the library computes with its
+ * own trig functions, plus the rounding of a dot product with that
+ * vector. The polynomials are good to about an ulp, so this has a
+ * wide margin.
+ */
+#define VECTOR_SLACK 4.0e-15
+
+// Coefficients for sin and cos on [-pi/4, pi/4], from fdlibm.
+#define S1 -1.66666666666666324348e-01
+#define S2  8.33333333332248946124e-03
+#define S3 -1.98412698298579493134e-04
+#define S4  2.75573137070700676789e-06
+#define S5 -2.50507602534068634195e-08
+#define S6  1.58969099521155010221e-10
+#define C1  4.16666666666666019037e-02
+#define C2 -1.38888888888741095749e-03
+#define C3  2.48015872894767294178e-05
+#define C4 -2.75573143513906633035e-07
+#define C5  2.08757232129817482790e-09
+#define C6 -1.13596475577881948265e-11
+
+// pi/2 in two parts, for reducing the argument.
+#define PIO2_1  1.57079632673412561417e+00
+#define PIO2_1T 6.07710050650619224932e-11
+#define INV_PIO2 6.36619772367581382433e-01
+#define DEG_TO_RAD 1.74532925199432957692e-02
+
+/**
+ * Sine and cosine of an angle in degrees, without branches so that
+ * loops calling it can be vectorized.
+ */
+static inline void
+sincos_deg(double deg, double &s, double &c) {
+    double r = deg * DEG_TO_RAD;
+    double k = std::floor(r * INV_PIO2 + 0.5);
+    double y = (r - k * PIO2_1) - k * PIO2_1T;
+    double z = y * y;
+    double sy = y + y * z * (S1 + z * (S2 + z * (S3 + z * (S4 + z * (S5 + z * S6)))));
+    double cy = 1.0 - 0.5 * z + z * z * (C1 + z * (C2 + z * (C3 + z * (C4 + z * (C5 + z * C6)))));
+    double q = k - 4.0 * std::floor(k * 0.25); // Quadrant, 0 to 3.
+    bool odd = (q == 1.0 || q == 3.0);
+
+    s = odd ? cy : sy;
+    c = odd ? sy : cy;
+    s = (q >= 2.0) ? -s : s;
+    c = (q == 1.0 || q == 2.0) ? -c : c;
+}
+
+/** Vector kernel for TrixelIndexer::latlon_to_vectors(). */
+SSC_TARGET_CLONES static void
+latlon_to_xyz(const double *lat, const double *lon, size_t n, double *x, double *y, double *z) {
+#pragma omp simd
+    for (size_t k = 0; k < n; k++) {
+        double slat, clat, slon, clon;
+
+        sincos_deg(lat[k], slat, clat);
+        sincos_deg(lon[k], slon, clon);
+        x[k] = clat * clon;
+        y[k] = clat * slon;
+        z[k] = slat;
+    }
+}
+
+static inline TrixelVector
+cross(const TrixelVector &a, const TrixelVector &b) {
+    TrixelVector c = {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+    return c;
+}
+
+static inline double
+dot(const TrixelVector &a, const TrixelVector &b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+/** Normalized midpoint of a and b, as HTM computes it. */
+static inline TrixelVector
+midpoint(const TrixelVector &a, const TrixelVector &b) {
+    TrixelVector m = {a.x + b.x, a.y + b.y, a.z + b.z};
+    double len = std::sqrt(dot(m, m));
+    m.x /= len;
+    m.y /= len;
+    m.z /= len;
+    return m;
+}
+
+/** Normals of the edges of the trixel (v0, v1, v2), as HTM forms them. */
+static inline void
+edge_normals(const TrixelVector &v0, const TrixelVector &v1, const TrixelVector &v2,
+             TrixelVector *n) {
+    n[0] = cross(v0, v1);
+    n[1] = cross(v1, v2);
+    n[2] = cross(v2, v0);
+}
+
+/** Outcomes of a point-in-trixel test. */
+enum {
+    TEST_FAIL = -1, /**< The library's test fails. */
+    TEST_UNSURE = 0, /**< Too close to call; ask the library. */
+    TEST_PASS = 1 /**< The library's test passes. */
+};
+
+/**
+ * What does HTM's test against one edge, dot(n, p) >= -eps, give for
+ * the library's vector of the point p? That vector is within
+ * VECTOR_SLACK of p in each component, so the dot product is within
+ * |n| * VECTOR_SLACK, summed over the components, of the one here.
+ *
+ * @return TEST_PASS or TEST_FAIL if that holds for every vector that
+ * close to p, TEST_UNSURE if not.
+ */
+static inline int
+edge_test(const TrixelVector &n, const TrixelVector &p, double eps) {
+    double d = dot(n, p);
+    double slack = (std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z)) * VECTOR_SLACK;
+
+    if (d - slack >= -eps)
+        return TEST_PASS;
+    if (d + slack < -eps)
+        return TEST_FAIL;
+    return TEST_UNSURE;
+}
+
+/**
+ * Is p inside the trixel with edge normals n? This is HTM's
+ * point-in-trixel test, which passes only if all three edges pass.
+ *
+ * @return TEST_FAIL if any edge surely fails, TEST_PASS if every edge
+ * surely passes, TEST_UNSURE otherwise.
+ */
+static inline int
+inside(const TrixelVector *n, const TrixelVector &p, double eps) {
+    int result = TEST_PASS;
+
+    for (int e = 0; e < 3; e++) {
+        int t = edge_test(n[e], p, eps);
+        if (t == TEST_FAIL)
+            return TEST_FAIL;
+        result = std::min(result, t);
+    }
+    return result;
+}
+
+/** Vertices of the eight root trixels, as reported by STARE. */
+struct RootTrixels {
+    bool ok; /**< True if the trixel walk matches the library. */
+    double eps; /**< Tolerance of the point-in-trixel test, HTM_EPSILON. */
+    TrixelVector v[SSC_STARE_NUM_FACES][3];
+    TrixelVector n[SSC_STARE_NUM_FACES][3]; /**< Edge normals. */
+};
+
+static RootTrixels make_root_trixels();
+
+/** The root trixels, set up and checked on first use. */
+static const RootTrixels &
+root_trixels() {
+    static const RootTrixels roots = make_root_trixels();
+    return roots;
+}
+
+/**
+ * Construct a TrixelIndexer.
+ *
+ * @param level STARE search level, normally 27.
+ * @param build_level STARE build level of the library object used
+ * for points near trixel edges.
+ */
+TrixelIndexer::TrixelIndexer(int level, int build_level) :
+    d_stare(StarePool::get(level, build_level)), d_level(level), d_num_fallback(0),
+    d_seeded(true), d_table(NULL) {
+    d_path.depth = -1;
+}
+
+/**
+ * Is the trixel walk usable? This is false if the library's root
+ * trixels, or its answers for a set of test points, don't match what
+ * the walk expects.
+ *
+ * @return true if points may be located without the library.
+ */
+bool
+TrixelIndexer::geometry_ok() {
+    return root_trixels().ok;
+}
+
+/**
+ * Convert lat/lon in degrees to unit vectors.
+ *
+ * @param lat Array of n latitudes.
+ * @param lon Array of n longitudes.
+ * @param n Number of points.
+ * @param x Array that gets n x components.
+ * @param y Array that gets n y components.
+ * @param z Array that gets n z components.
+ */
+void
+TrixelIndexer::latlon_to_vectors(const double *lat, const double *lon, size_t n,
+                                 double *x, double *y, double *z) {
+    latlon_to_xyz(lat, lon, n, x, y, z);
+}
+
+/** Vertices of each child, as indices into (v0, v1, v2, w0, w1, w2). */
+static const int child_vertices[4][3] = {{0, 5, 4}, {1, 3, 5}, {2, 4, 3}, {3, 4, 5}};
+
+/** Put the edge midpoints of the trixel at level into path. */
+static inline void
+split(TrixelPath &path, int level) {
+    const TrixelVector *v = path.v[level];
+    TrixelVector *w = path.w[level];
+
+    w[0] = midpoint(v[1], v[2]);
+    w[1] = midpoint(v[0], v[2]);
+    w[2] = midpoint(v[0], v[1]);
+    for (int child = 0; child < 4; child++)
+        path.num_normals[level][child] = 0;
+}
+
+/** Make a child of the trixel at level, already split, level + 1 of path. */
+static inline void
+descend(TrixelPath &path, int level, int child) {
+    const TrixelVector *v = path.v[level];
+    const TrixelVector *w = path.w[level];
+    const TrixelVector *corner[6] = {&v[0], &v[1], &v[2], &w[0], &w[1], &w[2]};
+
+    for (int k = 0; k < 3; k++)
+        path.v[level + 1][k] = *corner[child_vertices[child][k]];
+    path.child[level + 1] = child;
+    path.prefix[level + 1] = path.prefix[level] |
+                             ((unsigned long long) child << stare_digit_shift(level + 1));
+}
+
+/** Make the root trixel face level 0 of path. */
+static inline void
+set_root(const RootTrixels &roots, TrixelPath &path, int face) {
+    path.child[0] = face;
+    path.prefix[0] = (unsigned long long) face << SSC_STARE_FACE_SHIFT;
+    for (int k = 0; k < 3; k++)
+        path.v[0][k] = roots.v[face][k];
+}
+
+/**
+ * Find the root trixel that contains p. Like HTM, take the first one
+ * that passes the point-in-trixel test.
+ *
+ * @param roots The root trixels.
+ * @param p The point.
+ * @param path Gets the root trixel as its level 0.
+ *
+ * @return true if found, false if not or if a test was too close to
+ * call.
+ */
+static bool
+find_root(const RootTrixels &roots, const TrixelVector &p, TrixelPath &path) {
+    for (int f = 0; f < SSC_STARE_NUM_FACES; f++) {
+        int t = inside(roots.n[f], p, roots.eps);
+        if (t == TEST_UNSURE)
+            return false;
+        if (t == TEST_PASS) {
+            set_root(roots, path, f);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Is p inside a child of the trixel at some level of a path? Edge
+ * normals are formed only as the test needs them, and kept in the path
+ * for the next point.
+ *
+ * @param p The point.
+ * @param eps Tolerance of the point-in-trixel test.
+ * @param path The path, with vertices and midpoints at level.
+ * @param level Level of the parent trixel.
+ * @param child Which child, 0 to 3.
+ *
+ * @return the outcome of HTM's point-in-trixel test for the child, as
+ * inside() gives it.
+ */
+static inline int
+inside_child(const TrixelVector &p, double eps, TrixelPath &path, int level, int child) {
+    const TrixelVector *v = path.v[level];
+    const TrixelVector *w = path.w[level];
+    const TrixelVector *corner[6] = {&v[0], &v[1], &v[2], &w[0], &w[1], &w[2]};
+    const int *cv = child_vertices[child];
+    TrixelVector *n = path.n[level][child];
+    int result = TEST_PASS;
+
+    for (int e = 0; e < 3; e++) {
+        if (e == path.num_normals[level][child]) {
+            n[e] = cross(*corner[cv[e]], *corner[cv[(e + 1) % 3]]);
+            path.num_normals[level][child]++;
+        }
+        int t = edge_test(n[e], p, eps);
+        if (t == TEST_FAIL)
+            return TEST_FAIL;
+        result = std::min(result, t);
+    }
+    return result;
+}
+
+/**
+ * Walk down the trixel tree from level from to level to.
+ *
+ * Each trixel (v0, v1, v2) has children (v0, w2, w1), (v1, w0, w2),
+ * (v2, w1, w0) and (w0, w1, w2), where w0, w1 and w2 are the midpoints
+ * of the edges opposite v0, v1 and v2. As in HTM, p goes to the first
+ * child that passes the point-in-trixel test. Near the deepest levels
+ * the tolerance of that test is wider than a trixel, so the order the
+ * children are tried in matters as much as the geometry.
+ *
+ * The vertices and edge normals are computed exactly as HTM computes
+ * them, so each test differs from the library's only through the
+ * point vector, which edge_test() allows for. A test too close to call
+ * stops the walk, and the point is left to the library.
+ *
+ * @param p The point.
+ * @param eps Tolerance of the point-in-trixel test.
+ * @param path Levels 0 to from hold the trixels containing p. Gets
+ * levels from + 1 to to.
+ * @param from Level to start from.
+ * @param to Level to stop at.
+ *
+ * @return true if found, false if p is in none of the children or a
+ * test was too close to call.
+ */
+static bool
+walk(const TrixelVector &p, double eps, TrixelPath &path, int from, int to) {
+    for (int level = from; level < to; level++) {
+        int child, t = TEST_FAIL;
+
+        split(path, level);
+        for (child = 0; child < 4; child++) {
+            t = inside_child(p, eps, path, level, child);
+            if (t != TEST_FAIL)
+                break;
+        }
+        if (t != TEST_PASS)
+            return false;
+        descend(path, level, child);
+    }
+    return true;
+}
+
+/**
+ * How much of the path of a nearby point also holds for p? Going down
+ * from the root, each level of the path is checked by repeating the
+ * tests the walk made there. The walk would have taken the same branch
+ * for p exactly when p fails the tests of the children before the one
+ * in the path, and passes the test of that child. Most edge normals
+ * needed are already in the path. A test too close to call ends the
+ * levels kept, so the walk makes it again and gives the point to the
+ * library.
+ *
+ * @param roots The root trixels.
+ * @param p The point.
+ * @param path The path of a nearby point. May get more edge normals.
+ * @param known Levels of path down to this one are already known to
+ * hold for p, -1 if none are.
+ *
+ * @return the deepest level of path that p would also reach, or -1 if
+ * p is in a different root trixel or path is empty.
+ */
+static int
+seed_level(const RootTrixels &roots, const TrixelVector &p, TrixelPath &path, int known) {
+    if (path.depth < 0)
+        return -1;
+
+    if (known < 0) {
+        int face = path.child[0];
+        for (int f = 0; f < face; f++)
+            if (inside(roots.n[f], p, roots.eps) != TEST_FAIL)
+                return -1;
+        if (inside(roots.n[face], p, roots.eps) != TEST_PASS)
+            return -1;
+        known = 0;
+    }
+
+    for (int level = known; level < path.depth; level++) {
+        int child = path.child[level + 1];
+        for (int c = 0; c < child; c++)
+            if (inside_child(p, roots.eps, path, level, c) != TEST_FAIL)
+                return level;
+        if (inside_child(p, roots.eps, path, level, child) != TEST_PASS)
+            return level;
+    }
+    return path.depth;
+}
+
+/**
+ * Fill in path from the root down to a given trixel, without testing
+ * any point against it. Levels the path already shares with the
+ * trixel are kept.
+ *
+ * @param roots The root trixels.
+ * @param path Gets levels 0 to the level of id.
+ * @param id STARE index of the trixel.
+ */
+static void
+follow(const RootTrixels &roots, TrixelPath &path, unsigned long long id) {
+    int depth = stare_level(id);
+    int level = 0;
+
+    if (path.depth >= 0 && path.child[0] == stare_face(id)) {
+        while (level < depth && level < path.depth &&
+               path.child[level + 1] == stare_digit(id, level + 1))
+            level++;
+        // The trixel at level is already split.
+        if (level < depth && level < path.depth) {
+            descend(path, level, stare_digit(id, level + 1));
+            level++;
+        }
+    } else {
+        set_root(roots, path, stare_face(id));
+    }
+    for (; level < depth; level++) {
+        split(path, level);
+        descend(path, level, stare_digit(id, level + 1));
+    }
+    path.depth = depth;
+}
+
+/** Slack for rounding in cap_side(). */
+#define CAP_SLACK 1e-14
+
+/**
+ * Where is a spherical cap relative to a trixel, under HTM's
+ * point-in-trixel test? Every point p of the cap is within chord of
+ * its center c, so dot(n, p) is within |n| * chord of dot(n, c). The
+ * chord is padded well past the error of any vector computed for a
+ * point of the cap, and CAP_SLACK, more than VECTOR_SLACK allows for a
+ * normal of length at most 1, covers the rounding of the dot products,
+ * so a cell that is given a trixel here gets the same one from the
+ * library for every point in it.
+ *
+ * @param n Edge normals of the trixel.
+ * @param c Center of the cap.
+ * @param chord Largest chord from c to a point of the cap.
+ * @param eps Tolerance of the point-in-trixel test.
+ *
+ * @return 1 if every point of the cap passes the test, -1 if every
+ * point fails it, 0 if it may go either way.
+ */
+static int
+cap_side(const TrixelVector *n, const TrixelVector &c, double chord, double eps) {
+    bool all_pass = true;
+
+    for (int e = 0; e < 3; e++) {
+        double d = dot(n[e], c);
+        double bound = std::sqrt(dot(n[e], n[e])) * chord + CAP_SLACK;
+        if (d + bound < -eps)
+            return -1;
+        if (d - bound < -eps)
+            all_pass = false;
+    }
+    return all_pass ? 1 : 0;
+}
+
+/** Unit vector of lat/lon in degrees, with the library trig functions. */
+static TrixelVector
+unit_vector(double lat, double lon) {
+    double la = lat * DEG_TO_RAD, lo = lon * DEG_TO_RAD;
+    TrixelVector v = {std::cos(la) * std::cos(lo), std::cos(la) * std::sin(lo), std::sin(la)};
+    return v;
+}
+
+/**
+ * Find the deepest trixel that the walk reaches for every point of a
+ * lat/lon cell. Below the root, a trixel qualifies when every point of
+ * the cell fails the test of each earlier sibling and passes its own,
+ * at every level above it, so the walk for any point of the cell can
+ * start there.
+ *
+ * @param lat0 Southern edge of the cell, in degrees.
+ * @param lat1 Northern edge.
+ * @param lon0 Western edge.
+ * @param lon1 Eastern edge.
+ * @param max_level Deepest level to go to.
+ *
+ * @return STARE index of the trixel, with its level, or
+ * SSC_STARE_NO_TRIXEL if the cell is not inside one root trixel or the
+ * trixel walk is not in use.
+ */
+unsigned long long
+TrixelIndexer::cell_trixel(double lat0, double lat1, double lon0, double lon1, int max_level) {
+    const RootTrixels &roots = root_trixels();
+    TrixelPath path;
+    int face, level;
+
+    if (!roots.ok)
+        return SSC_STARE_NO_TRIXEL;
+
+    // The cell lies in the cap around its center that reaches its
+    // farthest corner, padded for rounding in the point vectors.
+    TrixelVector c = unit_vector((lat0 + lat1) / 2, (lon0 + lon1) / 2);
+    const double corner_lat[4] = {lat0, lat0, lat1, lat1};
+    const double corner_lon[4] = {lon0, lon1, lon0, lon1};
+    double chord = 0;
+    for (int k = 0; k < 4; k++) {
+        TrixelVector v = unit_vector(corner_lat[k], corner_lon[k]);
+        TrixelVector d = {v.x - c.x, v.y - c.y, v.z - c.z};
+        chord = std::max(chord, std::sqrt(dot(d, d)));
+    }
+    chord = chord * (1 + 1e-6) + 1e-12;
+
+    for (face = 0; face < SSC_STARE_NUM_FACES; face++) {
+        int side = cap_side(roots.n[face], c, chord, roots.eps);
+        if (side > 0)
+            break;
+        if (side == 0)
+            return SSC_STARE_NO_TRIXEL;
+    }
+    if (face == SSC_STARE_NUM_FACES)
+        return SSC_STARE_NO_TRIXEL;
+    set_root(roots, path, face);
+
+    for (level = 0; level < max_level; level++) {
+        int child, side = -1;
+
+        split(path, level);
+        for (child = 0; child < 4; child++) {
+            TrixelVector n[3];
+            const TrixelVector *v = path.v[level];
+            const TrixelVector *w = path.w[level];
+            const TrixelVector *corner[6] = {&v[0], &v[1], &v[2], &w[0], &w[1], &w[2]};
+            const int *cv = child_vertices[child];
+
+            edge_normals(*corner[cv[0]], *corner[cv[1]], *corner[cv[2]], n);
+            side = cap_side(n, c, chord, roots.eps);
+            if (side >= 0)
+                break;
+        }
+        if (side <= 0)
+            break;
+        descend(path, level, child);
+    }
+
+    return path.prefix[level] | (unsigned long long) level;
+}
+
+/**
+ * Describe the geometry the walk uses: the tolerance of the
+ * point-in-trixel test, then the 72 coordinates of the root trixel
+ * vertices. Trixels found with cell_trixel() are only valid for the
+ * same geometry.
+ *
+ * @param geometry Gets SSC_TRIXEL_GEOMETRY_SIZE values.
+ */
+void
+TrixelIndexer::geometry(double *geometry) {
+    const RootTrixels &roots = root_trixels();
+
+    geometry[0] = roots.eps;
+    for (int f = 0; f < SSC_STARE_NUM_FACES; f++) {
+        for (int k = 0; k < 3; k++) {
+            double *g = &geometry[1 + 9 * f + 3 * k];
+            g[0] = roots.v[f][k].x;
+            g[1] = roots.v[f][k].y;
+            g[2] = roots.v[f][k].z;
+        }
+    }
+}
+
+/**
+ * Locate p in the trixel tree, down to the search level.
+ *
+ * @param p The point.
+ * @param path On entry, levels 0 to from hold the trixels containing
+ * p. On success, levels 0 to d_level hold the trixels containing p.
+ * @param from Level to start from, or -1 to start by finding the root
+ * trixel.
+ *
+ * @return true if found.
+ */
+bool
+TrixelIndexer::locate(const TrixelVector &p, TrixelPath &path, int from) {
+    const RootTrixels &roots = root_trixels();
+
+    path.depth = -1;
+    if (from < 0) {
+        if (!find_root(roots, p, path))
+            return false;
+        from = 0;
+    }
+    if (!walk(p, roots.eps, path, from, d_level))
+        return false;
+    path.depth = d_level;
+
+    return true;
+}
+
+/**
+ * Pick the level to start walking p from, and set d_path up to it.
+ * The lookup table, if any, gives a trixel p is known to be in; a hint
+ * gives a trixel p is likely to be in. The path of the previous point,
+ * or of the hint, gives more levels if it holds for p.
+ *
+ * @param roots The root trixels.
+ * @param p The point.
+ * @param lat Latitude of p, in degrees.
+ * @param lon Longitude of p, in degrees.
+ * @param hint STARE index of a trixel p is likely to be in, or
+ * SSC_STARE_NO_TRIXEL.
+ *
+ * @return the level to start from, -1 for the root.
+ */
+int
+TrixelIndexer::start_level(const RootTrixels &roots, const TrixelVector &p, double lat, double lon,
+                           unsigned long long hint) {
+    int known = -1;
+
+    if (d_table) {
+        unsigned long long start = d_table->lookup(lat, lon);
+
+        if (start != SSC_STARE_NO_TRIXEL) {
+            known = stare_level(start);
+            if (d_path.depth < known || d_path.prefix[known] != (start & ~SSC_STARE_LEVEL_MASK))
+                follow(roots, d_path, start);
+        }
+    }
+
+    // A hint below the known trixel replaces the path, but unlike the
+    // table it still has to be checked.
+    if (hint != SSC_STARE_NO_TRIXEL) {
+        int h = stare_level(hint);
+        if (h > known && (known < 0 || stare_truncate(hint, known) == stare_truncate(d_path.prefix[known], known))) {
+            if (d_path.depth < h || d_path.prefix[h] != (hint & ~SSC_STARE_LEVEL_MASK))
+                follow(roots, d_path, hint);
+            return seed_level(roots, p, d_path, known);
+        }
+    }
+
+    return d_seeded ? seed_level(roots, p, d_path, known) : known;
+}
+
+/**
+ * Compute the STARE index of one point.
+ *
+ * @param lat Latitude in degrees.
+ * @param lon Longitude in degrees.
+ * @param resolution Resolution level to put in the index.
+ *
+ * @return the STARE index.
+ */
+unsigned long long
+TrixelIndexer::index(double lat, double lon, int resolution) {
+    unsigned long long id;
+    index(&lat, &lon, 1, resolution, &id);
+    return id;
+}
+
+/**
+ * Compute STARE indices for an array of points. The results are the
+ * same as STARE::ValueFromLatLonDegrees() would give for each point.
+ *
+ * @param lat Array of n latitudes, in degrees.
+ * @param lon Array of n longitudes, in degrees.
+ * @param n Number of points.
+ * @param resolution Resolution level to put in the indices.
+ * @param out Array that gets n STARE indices.
+ */
+void
+TrixelIndexer::index(const double *lat, const double *lon, size_t n, int resolution,
+                     unsigned long long *out) {
+    index_points(lat, lon, NULL, n, resolution, out);
+}
+
+/**
+ * Compute STARE indices for an array of points, each starting from a
+ * trixel it is likely to be in, such as the trixel of a coarser pixel
+ * that contains it or the trixel two neighboring coarser pixels share.
+ * Each point is checked against the hint down from the root, and
+ * walked from the deepest level that holds, so the results are the
+ * same as index() gives, whatever the hints.
+ *
+ * @param lat Array of n latitudes, in degrees.
+ * @param lon Array of n longitudes, in degrees.
+ * @param hint Array of n STARE indices of trixels, at any level, or
+ * SSC_STARE_NO_TRIXEL for points without a hint.
+ * @param n Number of points.
+ * @param resolution Resolution level to put in the indices.
+ * @param out Array that gets n STARE indices.
+ */
+void
+TrixelIndexer::refine(const double *lat, const double *lon, const unsigned long long *hint,
+                      size_t n, int resolution, unsigned long long *out) {
+    index_points(lat, lon, hint, n, resolution, out);
+}
+
+/**
+ * Compute STARE indices for an array of points, with optional hints.
+ *
+ * @param lat Array of n latitudes, in degrees.
+ * @param lon Array of n longitudes, in degrees.
+ * @param hint Array of n trixels the points are likely to be in, or
+ * NULL.
+ * @param n Number of points.
+ * @param resolution Resolution level to put in the indices.
+ * @param out Array that gets n STARE indices.
+ */
+void
+TrixelIndexer::index_points(const double *lat, const double *lon, const unsigned long long *hint,
+                            size_t n, int resolution, unsigned long long *out) {
+    const RootTrixels &roots = root_trixels();
+    double x[CHUNK], y[CHUNK], z[CHUNK];
+    bool walk = geometry_ok() && resolution == d_level;
+
+    for (size_t start = 0; start < n; start += CHUNK) {
+        size_t len = n - start < CHUNK ? n - start : CHUNK;
+
+        if (walk)
+            latlon_to_xyz(&lat[start], &lon[start], len, x, y, z);
+
+        for (size_t k = 0; k < len; k++) {
+            size_t pt = start + k;
+
+            if (walk) {
+                TrixelVector p = {x[k], y[k], z[k]};
+                int from = start_level(roots, p, lat[pt], lon[pt],
+                                       hint ? hint[pt] : SSC_STARE_NO_TRIXEL);
+                if (locate(p, d_path, from)) {
+                    out[pt] = d_path.prefix[d_level] | (unsigned long long) resolution;
+                    continue;
+                }
+            }
+            out[pt] = d_stare.ValueFromLatLonDegrees(lat[pt], lon[pt], resolution);
+            d_num_fallback++;
+        }
+    }
+}
+
+/**
+ * Get the root trixel vertices from the STARE library, and check the
+ * trixel walk against the library on some test points. This catches a
+ * library built to do its arithmetic differently, e.g. with fused
+ * multiply-adds.
+ *
+ * @return the root trixels.
+ */
+static RootTrixels
+make_root_trixels() {
+    RootTrixels roots;
+    STARE &stare = StarePool::get(SSC_STARE_MAX_LEVEL, SSC_DEFAULT_BUILD_LEVEL);
+
+    roots.ok = false;
+    roots.eps = HTM_EPSILON;
+    for (int f = 0; f < SSC_STARE_NUM_FACES; f++) {
+        Triangle tr = stare.TriangleFromValue((unsigned long long) f << SSC_STARE_FACE_SHIFT, 0);
+        if (tr.vertices.size() != 3)
+            return roots;
+        for (int k = 0; k < 3; k++) {
+            TrixelVector v = {tr.vertices[k].x(), tr.vertices[k].y(), tr.vertices[k].z()};
+            roots.v[f][k] = v;
+        }
+        edge_normals(roots.v[f][0], roots.v[f][1], roots.v[f][2], roots.n[f]);
+    }
+
+    // Test points spread over all eight root trixels, with some near
+    // the poles, the antimeridian and the root trixel edges. The rest
+    // are pseudo-random. Near level 27 the library's choice between
+    // children depends on the details of its arithmetic, so a walk
+    // that does not match it exactly fails here quickly.
+    const double fixed_lat[] = {0.5, 45.3, -45.3, 89.9, -89.9, 12.34567, -33.3, 60.1,
+                                -60.1, 7.77, -7.77, 37.123456789, -71.5, 23.9, -0.25, 51.5};
+    const double fixed_lon[] = {0.5, 45.3, -135.7, 10.0, -170.0, 179.99, -179.99, 91.2,
+                                -91.2, 123.456, -45.6, -122.987654321, 100.1, -1.1, 270.5, -0.12};
+    const int num_fixed = sizeof(fixed_lat) / sizeof(fixed_lat[0]);
+    const int num_test = 256;
+    double test_lat[num_test], test_lon[num_test];
+    unsigned long long expected[num_test];
+    unsigned long long seed = 12345;
+
+    for (int t = 0; t < num_test; t++) {
+        if (t < num_fixed) {
+            test_lat[t] = fixed_lat[t];
+            test_lon[t] = fixed_lon[t];
+        } else {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            test_lat[t] = (double) (seed >> 11) / 9007199254740992.0 * 180.0 - 90.0;
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            test_lon[t] = (double) (seed >> 11) / 9007199254740992.0 * 360.0 - 180.0;
+        }
+        expected[t] = stare.ValueFromLatLonDegrees(test_lat[t], test_lon[t], SSC_STARE_MAX_LEVEL);
+    }
+
+    // Every point the walk locates must match the library. A point
+    // the walk leaves to the library is no evidence either way. If
+    // any differ, the library in use does not do HTM's arithmetic, and
+    // every point goes to it.
+    roots.ok = true;
+    for (int t = 0; t < num_test && roots.ok; t++) {
+        double x, y, z;
+        latlon_to_xyz(&test_lat[t], &test_lon[t], 1, &x, &y, &z);
+        TrixelVector p = {x, y, z};
+        TrixelPath path;
+
+        if (find_root(roots, p, path) && walk(p, roots.eps, path, 0, SSC_STARE_MAX_LEVEL))
+            roots.ok = (path.prefix[SSC_STARE_MAX_LEVEL] | SSC_STARE_MAX_LEVEL) == expected[t];
+    }
+
+    return roots;
+}
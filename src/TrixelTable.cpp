@@ -0,0 +1,233 @@
+/// @file
+/// This class holds a lookup table from lat/lon cells to the trixels
+/// where STARE index computation can start.
+
+#include "config.h"
+#include "TrixelTable.h"
+#include "TrixelIndexer.h"
+#include "AtomicFile.h"
+#include "ssc.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define TABLE_MAGIC "SSCTRIX1" /**< First eight bytes of a table file. */
+
+/** Start of a table file. The cells follow it. */
+struct TableHeader {
+    char magic[8];
+    int level;
+    int build_level;
+    int num_lat;
+    int num_lon;
+    double cell_size;
+    double geometry[SSC_TRIXEL_GEOMETRY_SIZE];
+};
+
+/** Tables already mapped, keyed by file name. */
+typedef std::map<std::string, std::unique_ptr<TrixelTable> > TableMap;
+
+static TableMap tables;
+static std::mutex tables_mutex;
+
+TrixelTable::TrixelTable() :
+    d_map(NULL), d_map_size(0), d_cell(NULL), d_num_lat(0), d_num_lon(0), d_cell_size(0) {
+}
+
+TrixelTable::~TrixelTable() {
+    if (d_map)
+        munmap(d_map, d_map_size);
+}
+
+/**
+ * Get the table for (level, build_level) from a table directory. The
+ * first call for a table maps its file, building and writing the file
+ * first if it is missing or was made for a different geometry. Later
+ * calls return the same table.
+ *
+ * @param dir Table directory. Must exist.
+ * @param level STARE search level.
+ * @param build_level STARE build level.
+ * @param table Gets a pointer to the table, valid for the rest of the
+ * process. Gets NULL if the trixel walk is not in use, since the table
+ * would never be consulted.
+ *
+ * @return 0 for success, error code otherwise.
+ */
+int
+TrixelTable::get(const std::string &dir, int level, int build_level, const TrixelTable **table) {
+    std::lock_guard<std::mutex> lock(tables_mutex);
+    std::ostringstream name;
+    bool stale;
+    int ret;
+
+    *table = NULL;
+    if (!TrixelIndexer::geometry_ok())
+        return 0;
+
+    name << dir << "/stare_trixels_" << level << "_" << build_level << ".tbl";
+    TableMap::iterator it = tables.find(name.str());
+    if (it != tables.end()) {
+        *table = it->second.get();
+        return 0;
+    }
+
+    std::unique_ptr<TrixelTable> t(new TrixelTable());
+    if ((ret = t->map(name.str(), level, build_level, stale)))
+        return ret;
+    if (stale) {
+        if ((ret = build(name.str(), level, build_level)))
+            return ret;
+        if ((ret = t->map(name.str(), level, build_level, stale)))
+            return ret;
+        if (stale)
+            return SSC_EFILE;
+    }
+
+    *table = t.get();
+    tables[name.str()] = std::move(t);
+
+    return 0;
+}
+
+/**
+ * Map a table file into memory, if it matches what is wanted.
+ *
+ * @param file_name Table file.
+ * @param level STARE search level.
+ * @param build_level STARE build level.
+ * @param stale Set to true if the file is missing or does not match.
+ *
+ * @return 0 for success, error code otherwise.
+ */
+int
+TrixelTable::map(const std::string &file_name, int level, int build_level, bool &stale) {
+    TableHeader want;
+    struct stat st;
+    int fd;
+
+    stale = true;
+    if ((fd = open(file_name.c_str(), O_RDONLY)) < 0)
+        return errno == ENOENT ? 0 : SSC_EFILE;
+    if (fstat(fd, &st)) {
+        close(fd);
+        return SSC_EFILE;
+    }
+    if ((size_t) st.st_size < sizeof(TableHeader)) {
+        close(fd);
+        return 0;
+    }
+
+    void *m = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED)
+        return SSC_EFILE;
+
+    const TableHeader *h = (const TableHeader *) m;
+    TrixelIndexer::geometry(want.geometry);
+    if (memcmp(h->magic, TABLE_MAGIC, sizeof(h->magic)) || h->level != level ||
+        h->build_level != build_level || h->cell_size != SSC_TRIXEL_TABLE_CELL ||
+        memcmp(h->geometry, want.geometry, sizeof(want.geometry)) ||
+        (size_t) st.st_size != sizeof(TableHeader) +
+                               (size_t) h->num_lat * h->num_lon * sizeof(unsigned long long)) {
+        munmap(m, st.st_size);
+        return 0;
+    }
+
+    stale = false;
+    d_file_name = file_name;
+    d_map = m;
+    d_map_size = st.st_size;
+    d_cell = (const unsigned long long *) (h + 1);
+    d_num_lat = h->num_lat;
+    d_num_lon = h->num_lon;
+    d_cell_size = h->cell_size;
+
+    return 0;
+}
+
+/**
+ * Build a table and write it to a file. The file is written under a
+ * temporary name and renamed into place, so other processes never map
+ * a partly written table.
+ *
+ * @param file_name Table file.
+ * @param level STARE search level.
+ * @param build_level STARE build level.
+ *
+ * @return 0 for success, error code otherwise.
+ */
+int
+TrixelTable::build(const std::string &file_name, int level, int build_level) {
+    TableHeader h;
+    double cell = SSC_TRIXEL_TABLE_CELL;
+
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, TABLE_MAGIC, sizeof(h.magic));
+    h.level = level;
+    h.build_level = build_level;
+    h.num_lat = (int) std::lround(180.0 / cell);
+    h.num_lon = (int) std::lround(360.0 / cell);
+    h.cell_size = cell;
+    TrixelIndexer::geometry(h.geometry);
+
+    std::vector<unsigned long long> cells((size_t) h.num_lat * h.num_lon);
+
+#pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < h.num_lat; i++) {
+        double lat0 = -90.0 + i * cell;
+        double lat1 = i == h.num_lat - 1 ? 90.0 : lat0 + cell;
+
+        for (int j = 0; j < h.num_lon; j++) {
+            double lon0 = -180.0 + j * cell;
+            double lon1 = j == h.num_lon - 1 ? 180.0 : lon0 + cell;
+            cells[(size_t) i * h.num_lon + j] = TrixelIndexer::cell_trixel(lat0, lat1, lon0, lon1, level);
+        }
+    }
+
+    AtomicFile out(file_name);
+    FILE *fp = out.open();
+    if (!fp)
+        return SSC_EFILE;
+    bool ok = fwrite(&h, sizeof(h), 1, fp) == 1 &&
+              fwrite(&cells[0], sizeof(unsigned long long), cells.size(), fp) == cells.size();
+
+    return out.commit(ok);
+}
+
+/**
+ * Get the trixel to start the walk from for a point.
+ *
+ * @param lat Latitude in degrees.
+ * @param lon Longitude in degrees.
+ *
+ * @return STARE index of the trixel, with its level, or
+ * SSC_STARE_NO_TRIXEL if the walk must start at the root.
+ */
+unsigned long long
+TrixelTable::lookup(double lat, double lon) const {
+    if (!(lat >= -90.0 && lat <= 90.0) || !std::isfinite(lon))
+        return SSC_STARE_NO_TRIXEL;
+
+    lon -= 360.0 * std::floor((lon + 180.0) / 360.0);
+    int i = (int) ((lat + 90.0) / d_cell_size);
+    int j = (int) ((lon + 180.0) / d_cell_size);
+    if (i >= d_num_lat)
+        i = d_num_lat - 1;
+    if (j >= d_num_lon)
+        j = d_num_lon - 1;
+    if (j < 0)
+        j = 0;
+
+    return d_cell[(size_t) i * d_num_lon + j];
+}
@@ -0,0 +1,111 @@
+//
+// Utility to convert a STARE sidecar file between netCDF and the flat
+// binary format that is mapped into memory for fast reads.
+
+#include "config.h"
+
+#include <getopt.h>
+#include <iostream>
+#include "ssc.h"
+#include "SidecarFile.h"
+#include "FlatSidecar.h"
+
+using namespace std;
+
+void usage(char *name) {
+    cout
+    << "STARE sidecar conversion utility. " << endl
+    << "Usage: " << name << " [options] in_file out_file " << endl
+    << "A netCDF sidecar is converted to a flat sidecar, and a flat sidecar to netCDF." << endl
+    << "Examples:" << endl
+    << "  " << name << " MOD05_L2.A2021232.1600.061.2021233022815_stare.nc MOD05_L2.A2021232.1600.061.2021233022815_stare.flat" << endl
+    << endl
+    << "Options:" << endl
+    << " -h, --help        : print this help" << endl
+    << " -z, --compression : Compression of a netCDF sidecar written, as mk_stare -z takes it." << endl
+    << " -y, --chunks      : Chunks of a netCDF sidecar written, as mk_stare -y takes them." << endl
+    << " -e, --geo_precision : Lat/lon precision of a netCDF sidecar written, as mk_stare -e takes it." << endl;
+
+    exit(0);
+};
+
+struct Arguments {
+    SidecarLayout layout; // chunking and compression of a netCDF sidecar written.
+    int err_code = 0;
+};
+
+Arguments parseArguments(int argc, char *argv[]) {
+    if (argc == 1) usage(argv[0]);
+    Arguments arguments;
+    static struct option long_options[] = {
+            {"help",             no_argument,       nullptr, 'h'},
+            {"compression",      required_argument, nullptr, 'z'},
+            {"chunks",           required_argument, nullptr, 'y'},
+            {"geo_precision",    required_argument, nullptr, 'e'},
+            {nullptr,           0,         nullptr, 0}
+    };
+
+    int long_index = 0;
+    int opt;
+    while ((opt = getopt_long(argc, argv, "hz:y:e:", long_options, &long_index)) != -1) {
+        switch (opt) {
+            case 'z':
+                if (arguments.layout.set_codec(optarg)) {
+                    cerr << "Bad compression (-z) " << optarg << ".\n";
+                    arguments.err_code = 99;
+                }
+                break;
+            case 'y':
+                if (arguments.layout.set_chunks(optarg)) {
+                    cerr << "Bad chunks (-y) " << optarg << ".\n";
+                    arguments.err_code = 99;
+                }
+                break;
+            case 'e':
+                if (arguments.layout.set_geo(optarg)) {
+                    cerr << "Bad lat/lon precision (-e) " << optarg << ".\n";
+                    arguments.err_code = 99;
+                }
+                break;
+            case 'h':
+            default:
+                usage(argv[0]);
+        }
+    }
+
+    return arguments;
+};
+
+int main(int argc, char *argv[])
+{
+    Arguments arg = parseArguments(argc, argv);
+    int ret;
+
+    if (arg.err_code)
+        return arg.err_code;
+
+    // Input and output files must be provided.
+    if (optind + 2 != argc) {
+        cerr << "Must provide input and output sidecar file names." << endl;
+        return 1;
+    }
+
+    // A file that maps as a flat sidecar is converted to netCDF, any
+    // other to a flat sidecar.
+    bool flat_in;
+    {
+        FlatSidecar flat;
+        flat_in = !flat.open(argv[optind]);
+    }
+    if (flat_in)
+        ret = FlatSidecar::toNetcdf(argv[optind], argv[optind + 1], arg.layout);
+    else
+        ret = FlatSidecar::fromNetcdf(argv[optind], argv[optind + 1]);
+    if (ret) {
+        cerr << "Error converting " << argv[optind] << " to " << (flat_in ? "netCDF" : "a flat sidecar") <<
+            ".\n";
+        return ret;
+    }
+
+    return 0;
+}
@@ -10,17 +10,20 @@
 #include "VarStr.h"
 
 #include "ssc.h"
+#include "StareBits.h"
 #include "Modis05L2GeoFile.h"
 #include "Modis09L2GeoFile.h"
 #include "Modis09GAGeoFile.h"
 #include "SidecarFile.h"
+#include "TileCache.h"
+#include "SidecarWriter.h"
 
 using namespace std;
 
 void usage(char *name) {
     cout
         << "STARE spatial create sidecar file. " << endl
-        << "Usage: " << name << " [options] filename " << endl
+        << "Usage: " << name << " [options] filename ..." << endl
         << "Examples:" << endl
         << "  " << name << " data.nc" << endl
         << "  " << name << " data.h5" << endl
@@ -33,10 +36,34 @@ void usage(char *name) {
         << "  " << " -g, --use_gring      : Use GRING data to construct cover (default)" << endl
         << "  " << " -w, --walk_perimeter : Provide stride and walk perimeter to construct cover (more accurate)"
         << endl
+        << "  " << " -a, --perimeter_tolerance : Drop perimeter points within this many degrees of the walked edge (implies -w 1)."
+        << endl
+        << "  " << " -x, --exact_cover    : Build the cover from the STARE indices of the points (exact, fast at fine levels)."
+        << endl
         << "  " << " -d, --data_type   : Allows specification of data type." << endl
         << "  " << " -i, --institution : Institution where sidecar file is produced." << endl
         << "  " << " -o, --output_file : Provide file name for output file." << endl
         << "  " << " -r, --output_dir  : Provide output directory name." << endl
+        << "  " << " -t, --threads     : Number of threads used to compute indices (default: all available)." << endl
+        << "  " << " -l, --lut_dir     : Directory of trixel lookup tables, built there on first use." << endl
+        << "  " << " -k, --tile_cache  : Directory of tile sidecars, reused for every day of a tile (MOD09GA only)." << endl
+        << "  " << " -f, --fine_grids  : Also index geolocation interpolated to 1 km (MOD05 only)." << endl
+        << "  " << " -S, --spacing_resolution : Estimate resolution levels from the 2-D pixel spacing instead of"
+        << endl
+        << "  " << "                      with STARE along each row." << endl
+        << "  " << " -m, --max_memory  : Stream the granule in blocks using about this much memory, e.g. 64M (MOD09 only)." << endl
+        << "  " << " -n, --max_cover   : Pick the cover level so the cover has at most this many values." << endl
+        << "  " << " -s, --cover_seconds : Pick the cover level so the hull of the perimeter takes about this long." << endl
+        << "  " << " -p, --pyramid     : Also write each cover at these coarser levels, e.g. 5,8,10,12." << endl
+        << "  " << " -z, --compression : none, deflate[:level] or zstd[:level] (default deflate:3)." << endl
+        << "  " << "                     Prefix stare+ to pack the STARE indices; stare is stare+deflate:3." << endl
+        << "  " << " -y, --chunks      : Chunk rows[xcolumns] of the indices, or scan for whole scans (default)." << endl
+        << "  " << " -e, --geo_precision : Keep lat/lons as double (default) or float, optionally :digits to quantize"
+        << endl
+        << "  " << "                      them to, e.g. float:5. The STARE indices are not changed." << endl
+        << "  " << " -u, --writer_queue : Granules held for the background writer (default 1); 0 writes each granule"
+        << endl
+        << "  " << "                      before the next is read." << endl
         << endl;
     exit(0);
 };
@@ -47,13 +74,76 @@ struct Arguments {
     int cover_level = -1;
     bool cover_gring = false;
     int stride = -1; // if stride > 0, then we're walking the perimeter and cover_gring = false.
+    bool exact_cover = false; // if true, neither gring nor perimeter are used for the cover.
+    double perimeter_tolerance = 0.0; // if > 0, the walked perimeter is simplified to this many degrees.
+    long max_cover = 0; // if > 0, the cover level is picked so the cover has at most this many values.
+    double cover_seconds = 0.0; // if > 0, the cover level is picked to fit this time for the hull.
     char data_type[SSC_MAX_NAME] = "";
     char institution[SSC_MAX_NAME] = "";
     char output_file[SSC_MAX_NAME] = "";
     char output_dir[SSC_MAX_NAME] = "";
+    int threads = 0;
+    char lut_dir[SSC_MAX_NAME] = "";
+    char tile_cache[SSC_MAX_NAME] = "";
+    bool fine_grids = false;
+    bool spacing_resolution = false; // if true, resolution levels come from the 2-D pixel spacing.
+    size_t max_memory = 0; // if max_memory > 0, the granule is streamed in blocks.
+    vector<int> pyramid_levels; // coarser levels to also write the covers at.
+    SidecarLayout layout; // chunking and compression of the sidecar variables.
+    int writer_queue = 1; // granules held for the background writer, 0 to write in the main thread.
     int err_code = 0;
 };
 
+/** Parse a memory size, in bytes or with a K, M or G suffix.
+ *
+ * @param str The size, e.g. "4096" or "64M".
+ * @param bytes Gets the size in bytes.
+ * @return 0 for success, non-zero if the size is not valid.
+ */
+int
+parseMemory(const char *str, size_t &bytes) {
+    char *end;
+    unsigned long long n = strtoull(str, &end, 10);
+
+    switch (toupper(*end)) {
+        case 'G':
+            n *= 1024; // fall through
+        case 'M':
+            n *= 1024; // fall through
+        case 'K':
+            n *= 1024;
+            end++;
+    }
+    if (end == str || *end || !n || *str == '-')
+        return 1;
+    bytes = n;
+
+    return 0;
+}
+
+/** Parse a comma separated list of STARE levels.
+ *
+ * @param str The levels, e.g. "5,8,10,12".
+ * @param levels Gets the levels.
+ * @return 0 for success, non-zero if a level is not valid.
+ */
+int
+parseLevels(const char *str, vector<int> &levels) {
+    const char *p = str;
+
+    levels.clear();
+    do {
+        char *end;
+        long level = strtol(p, &end, 10);
+        if (end == p || (*end && *end != ',') || level < 0 || level > SSC_STARE_MAX_LEVEL)
+            return 1;
+        levels.push_back((int) level);
+        p = *end ? end + 1 : end;
+    } while (*p);
+
+    return 0;
+}
+
 Arguments parseArguments(int argc, char *argv[]) {
     if (argc == 1) usage(argv[0]);
     Arguments arguments;
@@ -64,16 +154,31 @@ Arguments parseArguments(int argc, char *argv[]) {
             {"cover_level",      required_argument, 0, 'c'},
             {"use_gring",        no_argument,       0, 'g'},
             {"walk_perimeter",   required_argument, 0, 'w'},
+            {"perimeter_tolerance", required_argument, 0, 'a'},
+            {"exact_cover",      no_argument,       0, 'x'},
             {"data_type",        required_argument, 0, 'd'},
             {"institution",      required_argument, 0, 'i'},
             {"output_file",      required_argument, 0, 'o'},
             {"output_directory", required_argument, 0, 'r'},
+            {"threads",          required_argument, 0, 't'},
+            {"lut_dir",          required_argument, 0, 'l'},
+            {"tile_cache",       required_argument, 0, 'k'},
+            {"fine_grids",       no_argument,       0, 'f'},
+            {"spacing_resolution", no_argument,     0, 'S'},
+            {"max_memory",       required_argument, 0, 'm'},
+            {"pyramid",          required_argument, 0, 'p'},
+            {"max_cover",        required_argument, 0, 'n'},
+            {"cover_seconds",    required_argument, 0, 's'},
+            {"compression",      required_argument, 0, 'z'},
+            {"chunks",           required_argument, 0, 'y'},
+            {"geo_precision",    required_argument, 0, 'e'},
+            {"writer_queue",     required_argument, 0, 'u'},
             {0,                  0,                 0, 0}
     };
 
     int long_index = 0;
     int opt = 0;
-    while ((opt = getopt_long(argc, argv, "hvqb:c:gw:d:o:r:i:", long_options, &long_index)) != -1) {
+    while ((opt = getopt_long(argc, argv, "hvqb:c:gw:a:xd:o:r:i:t:l:k:fSm:p:n:s:z:y:e:u:", long_options, &long_index)) != -1) {
         switch (opt) {
             case 'h':
                 usage(argv[0]);
@@ -92,6 +197,12 @@ Arguments parseArguments(int argc, char *argv[]) {
             case 'w':
                 arguments.stride = atoi(optarg);
                 break;
+            case 'a':
+                arguments.perimeter_tolerance = atof(optarg);
+                break;
+            case 'x':
+                arguments.exact_cover = true;
+                break;
             case 'd':
                 strcpy(arguments.data_type, optarg);
                 break;
@@ -104,10 +215,119 @@ Arguments parseArguments(int argc, char *argv[]) {
             case 'r':
                 strcpy(arguments.output_dir, optarg);
                 break;
+            case 't':
+                arguments.threads = atoi(optarg);
+                break;
+            case 'l':
+                strcpy(arguments.lut_dir, optarg);
+                break;
+            case 'k':
+                strcpy(arguments.tile_cache, optarg);
+                break;
+            case 'f':
+                arguments.fine_grids = true;
+                break;
+            case 'S':
+                arguments.spacing_resolution = true;
+                break;
+            case 'm':
+                if (parseMemory(optarg, arguments.max_memory)) {
+                    cerr << "Memory size (-m) must be a positive number of bytes, with an optional K, M or G.\n";
+                    arguments.err_code = 99;
+                }
+                break;
+            case 'n':
+                arguments.max_cover = atol(optarg);
+                break;
+            case 's':
+                arguments.cover_seconds = atof(optarg);
+                break;
+            case 'p':
+                if (parseLevels(optarg, arguments.pyramid_levels)) {
+                    cerr << "Pyramid levels (-p) must be a comma separated list of levels from 0 to 27.\n";
+                    arguments.err_code = 99;
+                }
+                break;
+            case 'z':
+                if (arguments.layout.set_codec(optarg)) {
+                    cerr << "Compression (-z) must be none, deflate[:1-9] or zstd[:1-22], optionally after "
+                        "stare+, or stare, and zstd needs netCDF-C built with it.\n";
+                    arguments.err_code = 99;
+                }
+                break;
+            case 'y':
+                if (arguments.layout.set_chunks(optarg)) {
+                    cerr << "Chunks (-y) must be scan, or a number of rows with an optional x and number of columns.\n";
+                    arguments.err_code = 99;
+                }
+                break;
+            case 'e':
+                if (arguments.layout.set_geo(optarg)) {
+                    cerr << "Lat/lon precision (-e) must be double[:1-15] or float[:1-7], and digits need "
+                        "netCDF-C built with quantize.\n";
+                    arguments.err_code = 99;
+                }
+                break;
+            case 'u':
+                arguments.writer_queue = atoi(optarg);
+                break;
         }
     }
 
     // Check for argument consistency.
+    if (arguments.threads < 0) {
+        cerr << "Number of threads (-t) must not be negative.\n";
+        arguments.err_code = 99;
+    }
+
+    if (arguments.writer_queue < 0) {
+        cerr << "Writer queue (-u) must not be negative.\n";
+        arguments.err_code = 99;
+    }
+
+    if (strlen(arguments.output_file) && argc - optind > 1) {
+        cerr << "An output file (-o) can only be given with one input file.\n";
+        arguments.err_code = 99;
+    }
+
+    if (strlen(arguments.tile_cache) && strcmp(arguments.data_type, "MOD09GA")) {
+        cerr << "The tile cache (-k) is only supported for MOD09GA files.\n";
+        arguments.err_code = 99;
+    }
+
+    if (arguments.max_memory && strcmp(arguments.data_type, "MOD09")) {
+        cerr << "Streaming (-m) is only supported for MOD09 files.\n";
+        arguments.err_code = 99;
+    }
+
+    if (arguments.max_memory && arguments.exact_cover && arguments.cover_level == -1) {
+        cerr << "Streaming (-m) with an exact cover (-x) needs a cover level (-c).\n";
+        arguments.err_code = 99;
+    }
+
+    if (arguments.max_cover < 0 || !(arguments.cover_seconds >= 0.0)) {
+        cerr << "Cover budget (-n, -s) must not be negative.\n";
+        arguments.err_code = 99;
+    }
+
+    if (!(arguments.perimeter_tolerance >= 0.0)) {
+        cerr << "Perimeter tolerance (-a) must not be negative.\n";
+        arguments.err_code = 99;
+    }
+    else if (arguments.perimeter_tolerance > 0.0) {
+        if (arguments.cover_gring) {
+            cerr << "Incompatible arguments. Perimeter tolerance (-a) can not be used with gring (-g).\n";
+            arguments.err_code = 99;
+        }
+        if (arguments.stride <= 0)
+            arguments.stride = 1;
+    }
+
+    if (arguments.exact_cover && (arguments.cover_gring || arguments.stride > 0)) {
+        cerr << "Incompatible arguments. Exact cover (-x) can not be used with gring (-g) or perimeter walk (-w).\n";
+        arguments.err_code = 99;
+    }
+
     if (!arguments.cover_gring) {
         if (arguments.stride <= 0) {
             arguments.cover_gring = true;
@@ -123,6 +343,28 @@ Arguments parseArguments(int argc, char *argv[]) {
     return arguments;
 };
 
+/** The settings a tile sidecar depends on, besides the tile, its
+ * resolutions and the build level.
+ *
+ * @param arg The arguments.
+ * @return The settings, as text.
+ */
+string
+tileSettings(const Arguments &arg) {
+    ostringstream settings;
+
+    settings << "institution=" << arg.institution << ";cover_level=" << arg.cover_level <<
+        ";gring=" << arg.cover_gring << ";stride=" << arg.stride << ";exact=" << arg.exact_cover <<
+        ";tolerance=" << arg.perimeter_tolerance << ";max_cover=" << arg.max_cover <<
+        ";cover_seconds=" << arg.cover_seconds << ";fine_grids=" << arg.fine_grids <<
+        ";spacing_resolution=" << arg.spacing_resolution <<
+        ";layout=" << arg.layout.str() << ";pyramid=";
+    for (size_t k = 0; k < arg.pyramid_levels.size(); k++)
+        settings << arg.pyramid_levels[k] << ",";
+
+    return settings.str();
+}
+
 /** Pick an output filename for the STARE index file, including output
  * directory.
  *
@@ -132,7 +374,7 @@ Arguments parseArguments(int argc, char *argv[]) {
  * @return The path and name of the sidecar file.
  */
 string
-pickOutputName(const char *file_in_char, char *output_dir_char) {
+pickOutputName(const char *file_in_char, const char *output_dir_char) {
     string file_out(file_in_char);
     string output_dir(output_dir_char);
 
@@ -148,90 +390,185 @@ pickOutputName(const char *file_in_char, char *output_dir_char) {
     return file_out;
 }
 
-int
-main(int argc, char *argv[]) {
-    Arguments arg = parseArguments(argc, argv);
+/** Make the GeoFile for the data type, with the settings from the
+ * arguments.
+ *
+ * @param arg The arguments.
+ * @return The GeoFile, to be deleted by the caller.
+ */
+GeoFile *
+newGeoFile(const Arguments &arg) {
     GeoFile *gf;
-    SidecarFile sf;
-    string file_out;
+
+    if (!strcmp(arg.data_type, "MOD09"))
+        gf = new Modis09L2GeoFile();
+    else if (!strcmp(arg.data_type, "MOD09GA"))
+        gf = new Modis09GAGeoFile();
+    else
+        gf = new Modis05L2GeoFile();
+    gf->num_threads = arg.threads;
+    gf->lut_dir = arg.lut_dir;
+    gf->fine_grids = arg.fine_grids;
+    gf->spacing_resolution = arg.spacing_resolution;
+    gf->exact_cover = arg.exact_cover;
+    gf->pyramid_levels = arg.pyramid_levels;
+    gf->perimeter_tolerance = arg.perimeter_tolerance;
+    gf->max_cover_values = arg.max_cover;
+    gf->max_cover_seconds = arg.cover_seconds;
+
+    return gf;
+}
+
+/** Read a granule and compute its STARE indices and covers.
+ *
+ * @param arg The arguments.
+ * @param file_in Name of the data file.
+ * @param cache The tile cache.
+ * @param gf Gets the granule, to be deleted by the caller, or NULL if
+ * its sidecar was copied from the tile cache.
+ * @param file_out Gets the name of the sidecar file.
+ * @param tile_key Gets the key to keep the sidecar under in the tile
+ * cache, or empty.
+ * @return 0 for success, non-zero for error.
+ */
+int
+readGranule(const Arguments &arg, const char *file_in, const TileCache &cache, GeoFile *&gf,
+            string &file_out, string &tile_key) {
     const string MOD09 = "MOD09";
     const string MOD09GA = "MOD09GA";
-    const string SIN_TABLE = "sn_bound_10deg.txt";
+    int ret;
 
-    // Input file must be provided.
-    if (!argv[optind]) {
-        cerr << "Must provide input file.\n";
-        return SSC_EINPUT;
-    }
+    gf = newGeoFile(arg);
+    tile_key.clear();
 
-    if (arg.err_code) {
-        return arg.err_code;
-    }
+    // Determine the output filename.
+    if (strlen(arg.output_file))
+        file_out = arg.output_file;
+    else
+        file_out = pickOutputName(gf->sidecar_filename(file_in).c_str(), arg.output_dir);
 
     if (arg.data_type == MOD09) {
-        gf = new Modis09L2GeoFile();
-        if (((Modis09L2GeoFile *) gf)->readFile(argv[optind], arg.verbose, arg.build_level,
-						arg.cover_level, arg.cover_gring, arg.stride)) {
+        if ((ret = ((Modis09L2GeoFile *) gf)->readFile(file_in, arg.verbose, arg.build_level,
+                                                       arg.cover_level, arg.cover_gring, arg.stride)))
             cerr << "Error reading MOD09 L2 file.\n";
-            return 99;
-        }
     }
     else if (arg.data_type == MOD09GA) {
-        gf = new Modis09GAGeoFile();
-        if (((Modis09GAGeoFile *) gf)->readFile(argv[optind], arg.verbose, arg.build_level)) {
-            cerr << "Error reading MOD09GA file.\n";
-            return 99;
+        // Every day of a tile has the same geolocation, so a sidecar
+        // made for the tile before is copied instead.
+        if (strlen(arg.tile_cache)) {
+            int h, v;
+            if (Modis09GAGeoFile::tileNumbers(file_in, h, v)) {
+                cerr << "No tile numbers in MOD09GA file name.\n";
+                delete gf;
+                gf = NULL;
+                return 99;
+            }
+            tile_key = TileCache::key(MOD09GA, h, v, arg.fine_grids ? "1km_500m_250m" : "1km_500m",
+                                     arg.build_level, tileSettings(arg));
+            if (!cache.fetch(tile_key, file_out)) {
+                if (arg.verbose) std::cout << "Copied " << cache.file_name(tile_key) << "\n";
+                delete gf;
+                gf = NULL;
+                return 0;
+            }
         }
+
+        if ((ret = ((Modis09GAGeoFile *) gf)->readFile(file_in, arg.verbose, arg.build_level,
+                                                       arg.cover_level)))
+            cerr << "Error reading MOD09GA file.\n";
     }
     else {
-        gf = new Modis05L2GeoFile();
-        if (((Modis05L2GeoFile *) gf)->readFile(argv[optind], arg.verbose, arg.build_level,
-                                                arg.cover_level, arg.cover_gring, arg.stride)) {
+        if ((ret = ((Modis05L2GeoFile *) gf)->readFile(file_in, arg.verbose, arg.build_level,
+                                                       arg.cover_level, arg.cover_gring, arg.stride)))
             cerr << "Error reading MOD05 file.\n";
-            return 99;
-        }
     }
 
-    // Determine the output filename.
+    if (ret) {
+        delete gf;
+        gf = NULL;
+        return 99;
+    }
+    return 0;
+}
+
+/** Stream a MOD09 granule to its sidecar file as its indices are
+ * computed, so the whole granule is never held in memory.
+ *
+ * @param arg The arguments.
+ * @param file_in Name of the data file.
+ * @return 0 for success, non-zero for error.
+ */
+int
+streamGranule(const Arguments &arg, const char *file_in) {
+    Modis09L2GeoFile *gf = (Modis09L2GeoFile *) newGeoFile(arg);
+    SidecarFile sf;
+    string file_out;
+    int ret = 0;
+
+    sf.setLayout(arg.layout);
     if (strlen(arg.output_file))
         file_out = arg.output_file;
     else
-        file_out = pickOutputName(gf->sidecar_filename(argv[optind]).c_str(), arg.output_dir);
-
-    // Create the sidecar file.
-    sf.createFile(file_out, arg.verbose, arg.institution);
-
-    // Write the sidecar file.
-    for (int i = 0; i < gf->d_num_index; i++)
-    {
-	double *lats = &gf->geo_lat[i][0];
-	double *lons = &gf->geo_lon[i][0];
-	unsigned long long int *geo_idx = &gf->geo_index[i][0];
-	if (sf.writeSTAREIndex(arg.verbose, arg.build_level, gf->geo_num_i[i],
-                               gf->geo_num_j[i], lats, lons, geo_idx,
-                               gf->var_name[i], gf->d_stare_index_name[i])) {
-            cerr << "Error writing STARE index.\n";
-            return 99;
-        }
+        file_out = pickOutputName(gf->sidecar_filename(file_in).c_str(), arg.output_dir);
+    if (sf.createFile(file_out, arg.verbose, arg.institution)) {
+        cerr << "Error creating sidecar file.\n";
+        delete gf;
+        return 99;
     }
-
-    if (arg.verbose)
-	std::cout << "writing covers" << std::endl;
-    for (int i = 0; i < gf->num_cover; i++) {
-	if (arg.verbose)
-	    std::cout << "writing cover i = " << i << ", name = " <<
-		gf->stare_cover_name.at(i) << std::endl;
-        if (sf.writeSTARECover(arg.verbose, gf->geo_num_cover_values[i], &gf->geo_cover[i][0],
-                               gf->stare_cover_name.at(i))) {
-            cerr << "Error writing STARE cover.\n";
-            return 99;
-        }
+    if (gf->streamFile(file_in, arg.verbose, arg.build_level, arg.cover_level, arg.cover_gring,
+                       arg.stride, arg.max_memory, sf)) {
+        cerr << "Error streaming MOD09 L2 file.\n";
+        ret = 99;
     }
 
-    // Close the sidecar file.
+    // Streamed indices are already written, so only the covers are
+    // left.
+    if (!ret && SidecarWriter::writeContents(*gf, sf, arg.verbose, arg.build_level, false))
+        ret = 99;
     sf.close_file();
-
     delete gf;
+
+    return ret;
+}
+
+int
+main(int argc, char *argv[]) {
+    Arguments arg = parseArguments(argc, argv);
+    TileCache cache(arg.tile_cache);
+
+    // Input file must be provided.
+    if (!argv[optind]) {
+        cerr << "Must provide input file.\n";
+        return SSC_EINPUT;
+    }
+
+    if (arg.err_code) {
+        return arg.err_code;
+    }
+
+    // Each granule is written on the writer thread while the next is
+    // read and indexed. Streamed granules are written as they are
+    // indexed, so they don't use it.
+    SidecarWriter writer(arg.layout, arg.verbose, arg.build_level, arg.institution,
+                         arg.max_memory ? 0 : arg.writer_queue, &cache);
+
+    for (int f = optind; f < argc; f++) {
+        GeoFile *gf;
+        string file_out, tile_key;
+
+        if (arg.max_memory) {
+            if (streamGranule(arg, argv[f]))
+                return 99;
+            continue;
+        }
+
+        if (readGranule(arg, argv[f], cache, gf, file_out, tile_key))
+            return 99;
+        if (gf && writer.submit(gf, file_out, tile_key))
+            return 99;
+    }
+
+    if (writer.finish())
+        return 99;
     return 0;
 };
-
@@ -0,0 +1,101 @@
+/* This is a benchmark for the STAREmaster project. It times building
+ * a cover from per-point STARE indices with CoverBuilder, on a
+ * synthetic swath shaped like a MOD09 1 km granule, at several cover
+ * levels, next to STARE::NonConvexHull() of the walked perimeter.
+ * tst_cover checks the covers.
+ *
+ * Run as: bm_cover [rows]
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include "STARE.h"
+#include "ssc.h"
+#include "StarePool.h"
+#include "TrixelIndexer.h"
+#include "CoverBuilder.h"
+#include "synthetic_swath.h"
+
+#define ERR 1
+
+#define NUM_ROWS 2030
+#define NUM_COLS 1354
+#define LEVEL 27
+#define BUILD_LEVEL 5
+#define NUM_THREADS 4
+#define STRIDE 10
+
+/** Seconds since start. */
+static double
+seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/** Add a point to a perimeter. */
+static void
+add_point(LatLonDegrees64ValueVector &perimeter, double lat, double lon) {
+    perimeter.resize(perimeter.size() + 1);
+    perimeter.back().lat = lat;
+    perimeter.back().lon = lon;
+}
+
+int
+main(int argc, char **argv) {
+    int num_rows = argc > 1 ? atoi(argv[1]) : NUM_ROWS;
+    size_t n = (size_t) num_rows * NUM_COLS;
+    std::vector<double> lat(n), lon(n);
+    std::vector<unsigned long long> index(n);
+    const int levels[] = {6, 8, 10, 12};
+
+    if (num_rows <= 0)
+        return ERR;
+
+    // A swath about 2330 km wide, tilted like a descending orbit, that
+    // crosses the antimeridian, with a few pixels without geolocation.
+    synthetic_swath(num_rows, NUM_COLS, 0, SYNTHETIC_SWATH_DATELINE_LON, &lat[0], &lon[0]);
+    for (size_t k = 4321; k < n; k += 54321)
+        lat[k] = lon[k] = SSC_GEO_FILL;
+
+    TrixelIndexer indexer(LEVEL, BUILD_LEVEL);
+    indexer.index(&lat[0], &lon[0], n, LEVEL, &index[0]);
+
+    // The walked perimeter, for NonConvexHull().
+    STARE &stare = StarePool::get(LEVEL, BUILD_LEVEL);
+    LatLonDegrees64ValueVector perimeter;
+    for (int j = 0; j < NUM_COLS; j += STRIDE)
+        add_point(perimeter, lat[j], lon[j]);
+    for (int i = 0; i < num_rows; i += STRIDE)
+        add_point(perimeter, lat[(size_t) i * NUM_COLS + NUM_COLS - 1],
+                  lon[(size_t) i * NUM_COLS + NUM_COLS - 1]);
+    for (int j = NUM_COLS - 1; j >= 0; j -= STRIDE)
+        add_point(perimeter, lat[(size_t) (num_rows - 1) * NUM_COLS + j],
+                  lon[(size_t) (num_rows - 1) * NUM_COLS + j]);
+    for (int i = num_rows - 1; i >= 0; i -= STRIDE)
+        add_point(perimeter, lat[(size_t) i * NUM_COLS], lon[(size_t) i * NUM_COLS]);
+    std::reverse(perimeter.begin(), perimeter.end());
+
+    for (size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+        int level = levels[l];
+        std::vector<unsigned long long> cover;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        CoverBuilder builder(level, NUM_THREADS);
+        builder.add(&lat[0], &index[0], n);
+        builder.intervals(cover);
+        double build_time = seconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        STARE_SpatialIntervals hull = stare.NonConvexHull(perimeter, level);
+        double hull_time = seconds_since(start);
+
+        printf("level %2d: %zu points to %zu cover values in %.4f s, "
+               "NonConvexHull %zu values in %.4f s\n", level, n, cover.size(), build_time,
+               hull.size(), hull_time);
+    }
+
+    return 0;
+}
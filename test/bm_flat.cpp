@@ -0,0 +1,136 @@
+/* This is a benchmark for the STAREmaster project. It writes a
+ * synthetic MOD09 1 km granule to a netCDF sidecar, converts it to a
+ * flat sidecar, and reports the time to open each and read the STARE
+ * index and cover, and to open each and read the rows of one scan, as
+ * a server does for each request. tst_flat checks the flat sidecar.
+ *
+ * Run as: bm_flat
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <netcdf.h>
+#include "GeoGrid.h"
+#include "SidecarFile.h"
+#include "FlatSidecar.h"
+#include "TrixelIndexer.h"
+#include "synthetic_sidecar.h"
+#include "synthetic_swath.h"
+
+#define ERR 1
+
+#define NUM_ROWS 2030
+#define NUM_COLS 1354
+#define SCAN_ROWS 10
+#define LEVEL 27
+#define BUILD_LEVEL 5
+#define COVER_STEP 997
+#define COVER_LEVEL 8
+#define NUM_READS 50
+#define VAR_NAME "1km Surface Reflectance Band 1"
+#define NC_FILE "bm_flat.nc"
+#define FLAT_FILE "bm_flat.flat"
+
+/** Seconds since start. */
+static double
+seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int
+main() {
+    // A swath like a MOD09 1 km granule, and a cover of some of its
+    // trixels.
+    GeoGrid grid(NUM_ROWS, NUM_COLS, SCAN_ROWS);
+    synthetic_swath(grid);
+    TrixelIndexer indexer(LEVEL, BUILD_LEVEL);
+    indexer.index(grid.lat().data(), grid.lon().data(), grid.size(), LEVEL, grid.index().data());
+    std::vector<unsigned long long> cover;
+    for (size_t k = 0; k < grid.size(); k += COVER_STEP)
+        cover.push_back(grid.index()[k]);
+
+    if (write_synthetic_sidecar(NC_FILE, BUILD_LEVEL, grid, VAR_NAME, cover, COVER_LEVEL) ||
+        FlatSidecar::fromNetcdf(NC_FILE, FLAT_FILE)) {
+        printf("can't write sidecars\n");
+        return ERR;
+    }
+
+    // Open the file for each read, as a server does for each request.
+    // The values read are summed, so every page of the flat sidecar
+    // is touched.
+    std::vector<unsigned long long> index(grid.size()), cover_in(cover.size());
+    double nc_time = 0.0, flat_time = 0.0, nc_scan_time = 0.0, flat_scan_time = 0.0;
+    unsigned long long nc_sum = 0, flat_sum = 0;
+    for (int r = 0; r < NUM_READS; r++) {
+        size_t scan = (r * 37) % (NUM_ROWS / SCAN_ROWS);
+        int ncid, index_varid, cover_varid;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (nc_open(NC_FILE, NC_NOWRITE, &ncid) ||
+            nc_inq_varid(ncid, "STARE_index_1km", &index_varid) ||
+            nc_inq_varid(ncid, "STARE_cover_1km", &cover_varid) ||
+            SidecarFile::readSTAREIndex(ncid, index_varid, 0, NUM_ROWS, &index[0]) ||
+            nc_get_var_ulonglong(ncid, cover_varid, &cover_in[0]) || nc_close(ncid))
+            return ERR;
+        for (size_t k = 0; k < index.size(); k++)
+            nc_sum += index[k];
+        for (size_t k = 0; k < cover_in.size(); k++)
+            nc_sum += cover_in[k];
+        nc_time += seconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        {
+            FlatSidecar flat;
+            if (flat.open(FLAT_FILE))
+                return ERR;
+            const FlatArray *index_in = flat.find_index(VAR_NAME);
+            const FlatArray *cover_in = flat.find(SSC_FLAT_COVER, "1km");
+            if (!index_in || !cover_in)
+                return ERR;
+            for (size_t k = 0; k < index_in->size(); k++)
+                flat_sum += index_in->values()[k];
+            for (size_t k = 0; k < cover_in->size(); k++)
+                flat_sum += cover_in->values()[k];
+        }
+        flat_time += seconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        if (nc_open(NC_FILE, NC_NOWRITE, &ncid) ||
+            nc_inq_varid(ncid, "STARE_index_1km", &index_varid) ||
+            SidecarFile::readSTAREIndex(ncid, index_varid, scan * SCAN_ROWS, SCAN_ROWS, &index[0]) ||
+            nc_close(ncid))
+            return ERR;
+        for (size_t k = 0; k < (size_t) SCAN_ROWS * NUM_COLS; k++)
+            nc_sum += index[k];
+        nc_scan_time += seconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        {
+            FlatSidecar flat;
+            if (flat.open(FLAT_FILE))
+                return ERR;
+            const FlatArray *index_in = flat.find_index(VAR_NAME);
+            if (!index_in)
+                return ERR;
+            const unsigned long long *rows = index_in->values() + scan * SCAN_ROWS * NUM_COLS;
+            for (size_t k = 0; k < (size_t) SCAN_ROWS * NUM_COLS; k++)
+                flat_sum += rows[k];
+        }
+        flat_scan_time += seconds_since(start);
+    }
+    if (nc_sum != flat_sum)
+        return ERR;
+    printf("open and read index and cover: netCDF %.3f ms, flat %.3f ms, speedup %.1f\n",
+           nc_time / NUM_READS * 1000.0, flat_time / NUM_READS * 1000.0, nc_time / flat_time);
+    printf("open and read one scan:        netCDF %.3f ms, flat %.3f ms, speedup %.1f\n",
+           nc_scan_time / NUM_READS * 1000.0, flat_scan_time / NUM_READS * 1000.0,
+           nc_scan_time / flat_scan_time);
+
+    remove(NC_FILE);
+    remove(FLAT_FILE);
+
+    return 0;
+}
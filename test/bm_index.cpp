@@ -0,0 +1,123 @@
+/* This is a benchmark for the STAREmaster project. It times the batch
+ * STARE index kernel in TrixelIndexer against calling
+ * STARE::ValueFromLatLonDegrees() one point at a time, on a synthetic
+ * swath shaped like a MOD09 1 km granule, both walking every point
+ * from the root and starting each point from its neighbor's trixels.
+ * It then does the same for a 250 m grid interpolated across track
+ * from the swath, indexed on its own and refined down from the 1 km
+ * trixels. tst_index checks the indices.
+ *
+ * Run as: bm_index [rows]
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <chrono>
+#include "STARE.h"
+#include "StarePool.h"
+#include "TrixelIndexer.h"
+#include "synthetic_swath.h"
+
+#define ERR 1
+
+#define NUM_ROWS 203
+#define NUM_COLS 1354
+#define LEVEL 27
+#define BUILD_LEVEL 5
+
+/** Seconds since start. */
+static double
+seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int
+main(int argc, char **argv) {
+    int num_rows = argc > 1 ? atoi(argv[1]) : NUM_ROWS;
+    size_t n = (size_t) num_rows * NUM_COLS;
+    std::vector<double> lat(n), lon(n);
+    std::vector<unsigned long long> scalar_index(n), batch_index(n), seeded_index(n);
+
+    if (num_rows <= 0)
+        return ERR;
+
+    // A swath about 2330 km wide, tilted like a descending orbit, that
+    // crosses the antimeridian.
+    synthetic_swath(num_rows, NUM_COLS, 0, SYNTHETIC_SWATH_DATELINE_LON, &lat[0], &lon[0]);
+
+    // Set up the library object and the indexers before timing.
+    STARE &stare = StarePool::get(LEVEL, BUILD_LEVEL);
+    TrixelIndexer indexer(LEVEL, BUILD_LEVEL);
+    TrixelIndexer seeded(LEVEL, BUILD_LEVEL);
+    indexer.set_seeded(false);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t k = 0; k < n; k++)
+        scalar_index[k] = stare.ValueFromLatLonDegrees(lat[k], lon[k], LEVEL);
+    double scalar_time = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_rows; i++) {
+        size_t row = (size_t) i * NUM_COLS;
+        indexer.index(&lat[row], &lon[row], NUM_COLS, LEVEL, &batch_index[row]);
+    }
+    double batch_time = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_rows; i++) {
+        size_t row = (size_t) i * NUM_COLS;
+        seeded.index(&lat[row], &lon[row], NUM_COLS, LEVEL, &seeded_index[row]);
+    }
+    double seeded_time = seconds_since(start);
+
+    // Three 250 m points between each pair of 1 km points, like the
+    // MOD09 250 m grid, each hinted with the trixel its 1 km neighbors
+    // share.
+    size_t nf = 3 * n;
+    std::vector<double> fine_lat(nf), fine_lon(nf);
+    std::vector<unsigned long long> hint(nf), fine_seeded(nf), fine_refined(nf);
+    for (size_t k = 0; k < n; k++) {
+        size_t next = k % NUM_COLS == NUM_COLS - 1 ? k - 1 : k + 1;
+        double dlon = lon[next] - lon[k];
+        int common = stare_common_level(scalar_index[k], scalar_index[next]);
+        if (dlon > 180.0)
+            dlon -= 360.0;
+        else if (dlon < -180.0)
+            dlon += 360.0;
+        for (int q = 1; q < 4; q++) {
+            fine_lat[3 * k + q - 1] = lat[k] + q * (lat[next] - lat[k]) / 4.0;
+            fine_lon[3 * k + q - 1] = lon[k] + q * dlon / 4.0;
+            hint[3 * k + q - 1] = common < 0 ? SSC_STARE_NO_TRIXEL :
+                                  stare_truncate(scalar_index[k], common);
+        }
+    }
+
+    TrixelIndexer fine_indexer(LEVEL, BUILD_LEVEL);
+    start = std::chrono::steady_clock::now();
+    for (size_t row = 0; row < nf; row += 3 * NUM_COLS)
+        fine_indexer.index(&fine_lat[row], &fine_lon[row], 3 * NUM_COLS, LEVEL, &fine_seeded[row]);
+    double fine_seeded_time = seconds_since(start);
+
+    TrixelIndexer refiner(LEVEL, BUILD_LEVEL);
+    start = std::chrono::steady_clock::now();
+    for (size_t row = 0; row < nf; row += 3 * NUM_COLS)
+        refiner.refine(&fine_lat[row], &fine_lon[row], &hint[row], 3 * NUM_COLS, LEVEL,
+                       &fine_refined[row]);
+    double refined_time = seconds_since(start);
+
+    printf("%zu points, trixel walk %s\n", n, TrixelIndexer::geometry_ok() ? "on" : "off");
+    printf("scalar: %.3f s, %.0f points/s\n", scalar_time, n / scalar_time);
+    printf("batch:  %.3f s, %.0f points/s, %zu handed to the library\n", batch_time,
+           n / batch_time, indexer.num_fallback());
+    printf("seeded: %.3f s, %.0f points/s, %zu handed to the library\n", seeded_time,
+           n / seeded_time, seeded.num_fallback());
+    printf("250 m seeded:  %.3f s, %.0f points/s\n", fine_seeded_time, nf / fine_seeded_time);
+    printf("250 m refined: %.3f s, %.0f points/s\n", refined_time, nf / refined_time);
+    printf("speedup %.2f batch, %.2f seeded\n", scalar_time / batch_time,
+           scalar_time / seeded_time);
+
+    return 0;
+}
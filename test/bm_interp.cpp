@@ -0,0 +1,77 @@
+/* This is a benchmark for the STAREmaster project. It times
+ * ScanInterpolator on a synthetic swath shaped like a MOD09 1 km
+ * granule, interpolating to 500 m and 250 m, and on one shaped like a
+ * MOD05 5 km granule, interpolating to 1 km. tst_scan_interp checks
+ * the results.
+ *
+ * Run as: bm_interp [repeats]
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <chrono>
+#include "ScanInterpolator.h"
+
+#define ERR 1
+
+#define NUM_ROWS 2030
+#define NUM_COLS 1354
+#define SCAN_ROWS 10
+#define MOD05_ROWS 406
+#define MOD05_COLS 270
+#define MOD05_SCAN_ROWS 2
+
+/** Seconds since start. */
+static double
+seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/** A swath that is linear in row and column within each scan, and
+ * crosses the antimeridian. */
+static void
+swath_point(double scan, double row, double col, double &lat, double &lon) {
+    lat = 40.0 - scan * 0.09 - row * 0.011 + col * 0.003;
+    lon = 170.0 + col * 0.0155 - scan * 0.02 - row * 0.001;
+    if (lon > 180.0)
+        lon -= 360.0;
+}
+
+/** Time interpolating a whole swath. */
+static void
+time_swath(int rows, int cols, int scan_rows, int factor, int fine_cols, int repeats,
+           const char *name) {
+    ScanInterpolator interp(rows, cols, scan_rows, factor, fine_cols);
+    int fine_rows = interp.fine_rows();
+    std::vector<double> lat((size_t) rows * cols), lon((size_t) rows * cols);
+    std::vector<double> fine_lat((size_t) fine_rows * fine_cols), fine_lon((size_t) fine_rows * fine_cols);
+
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++)
+            swath_point(i / scan_rows, i % scan_rows, j, lat[(size_t) i * cols + j],
+                        lon[(size_t) i * cols + j]);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++)
+        interp.interpolate(&lat[0], &lon[0], 0, 0, fine_rows, &fine_lat[0], &fine_lon[0]);
+    double t = seconds_since(start) / repeats;
+
+    printf("%s: %zu points in %.4f s, %.0f points/s\n", name, fine_lat.size(), t,
+           fine_lat.size() / t);
+}
+
+int
+main(int argc, char **argv) {
+    int repeats = argc > 1 ? atoi(argv[1]) : 3;
+
+    if (repeats <= 0)
+        return ERR;
+
+    time_swath(NUM_ROWS, NUM_COLS, SCAN_ROWS, 2, 2 * NUM_COLS, repeats, "1km to 500m");
+    time_swath(NUM_ROWS, NUM_COLS, SCAN_ROWS, 4, 4 * NUM_COLS, repeats, "1km to 250m");
+    time_swath(MOD05_ROWS, MOD05_COLS, MOD05_SCAN_ROWS, 5, 1354, repeats, "5km to 1km");
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+/* This is a benchmark for the STAREmaster project. It times batch
+ * StareIntervalSet containment against one query at a time, on a set
+ * of many short ranges. tst_intervals checks the sets.
+ *
+ * Run as: bm_intervals [queries]
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <chrono>
+#include "StareBits.h"
+#include "StareIntervalSet.h"
+
+#define ERR 1
+
+#define NUM_QUERIES 1000000
+#define SEED 12345
+
+/** Number of trixels on the sphere at a level. */
+static unsigned long long
+num_trixels(int level) {
+    return (unsigned long long) SSC_STARE_NUM_FACES << 2 * level;
+}
+
+/** STARE index of trixel t at a level. */
+static unsigned long long
+trixel(unsigned long long t, int level) {
+    return (t << stare_digit_shift(level)) | (unsigned long long) level;
+}
+
+/** Seconds since start. */
+static double
+seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int
+main(int argc, char **argv) {
+    size_t num_queries = argc > 1 ? (size_t) atol(argv[1]) : NUM_QUERIES;
+
+    if (!num_queries)
+        return ERR;
+
+    srand(SEED);
+    // Batch containment on a set of many short ranges.
+    std::vector<unsigned long long> values, queries(num_queries);
+    for (int k = 0; k < 2000; k++) {
+        unsigned long long t = (unsigned long long) rand() % (num_trixels(12) - 64);
+        values.push_back(trixel(t, 12));
+        values.push_back(stare_terminator(trixel(t + rand() % 64, 12)));
+    }
+    StareIntervalSet set = StareIntervalSet::from_intervals(values);
+    for (size_t k = 0; k < num_queries; k++)
+        queries[k] = trixel((unsigned long long) rand() % num_trixels(14), 14);
+
+    std::vector<unsigned char> batch(num_queries), scalar(num_queries);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    set.contains(queries.data(), num_queries, batch.data());
+    double batch_time = seconds_since(start);
+    start = std::chrono::steady_clock::now();
+    for (size_t k = 0; k < num_queries; k++)
+        scalar[k] = set.contains(queries[k]);
+    double scalar_time = seconds_since(start);
+
+    size_t hits = 0;
+    for (size_t k = 0; k < num_queries; k++)
+        hits += batch[k];
+
+    printf("%zu ranges, %zu queries (%zu in set): batch %.4f s, one at a time %.4f s\n",
+           set.size(), num_queries, hits, batch_time, scalar_time);
+
+    return 0;
+}
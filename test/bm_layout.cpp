@@ -0,0 +1,155 @@
+/* This is a benchmark for the STAREmaster project. It writes a
+ * synthetic MOD09 1 km granule to a sidecar file with each of several
+ * chunking and compression layouts, and reports the write time, the
+ * file size, and the time to open the file and read the rows of one
+ * scan, as a server does for a row subset. tst_layout checks that the
+ * layouts read back what was written.
+ *
+ * Run as: bm_layout [layout ...]
+ *
+ * where each layout is a compression and chunks, as mk_stare -z and
+ * -y take them, separated by a comma, such as "zstd:3,scan" or
+ * "deflate:1,40x1354", optionally followed by a comma and the lat/lon
+ * precision as mk_stare -e takes it, such as "deflate:3,scan,float:5".
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <sys/stat.h>
+#include <netcdf.h>
+#include "ssc.h"
+#include "GeoGrid.h"
+#include "SidecarFile.h"
+#include "TrixelIndexer.h"
+#include "synthetic_swath.h"
+
+#define ERR 1
+
+#define NUM_ROWS 2030
+#define NUM_COLS 1354
+#define SCAN_ROWS 10
+#define LEVEL 27
+#define BUILD_LEVEL 5
+#define NUM_READS 50
+#define FILE_NAME "bm_layout.nc"
+
+/** Seconds since start. */
+static double
+seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/** Parse a layout, as "compression,chunks[,precision]". */
+static int
+parse_layout(const std::string &spec, SidecarLayout &layout) {
+    size_t comma = spec.find(',');
+
+    if (comma == std::string::npos)
+        return SSC_EINPUT;
+    size_t geo = spec.find(',', comma + 1);
+    if (layout.set_codec(spec.substr(0, comma)) ||
+        layout.set_chunks(spec.substr(comma + 1, geo == std::string::npos ? geo : geo - comma - 1)))
+        return SSC_EINPUT;
+    if (geo != std::string::npos && layout.set_geo(spec.substr(geo + 1)))
+        return SSC_EINPUT;
+    return 0;
+}
+
+/**
+ * Write the grid with a layout, then read back scans of it.
+ *
+ * @return 0 on success, ERR if the file can't be written or read.
+ */
+static int
+run_layout(const SidecarLayout &layout, const GeoGrid &grid) {
+    SidecarFile sf;
+    std::vector<std::string> var_name(1, "1km Surface Reflectance Band 1");
+    std::vector<unsigned long long> index((size_t) SCAN_ROWS * NUM_COLS);
+    std::vector<double> lat((size_t) SCAN_ROWS * NUM_COLS);
+    size_t chunks[2];
+    struct stat st;
+
+    layout.index_chunks(NUM_ROWS, NUM_COLS, SCAN_ROWS, chunks);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (sf.createFile(FILE_NAME, 0, NULL))
+        return ERR;
+    sf.setLayout(layout);
+    if (sf.writeSTAREIndex(0, BUILD_LEVEL, grid, var_name, "1km"))
+        return ERR;
+    if (sf.close_file())
+        return ERR;
+    double write_time = seconds_since(start);
+    if (stat(FILE_NAME, &st))
+        return ERR;
+
+    // Open the file for each read, as a server does for each request,
+    // so nothing is cached by netCDF between reads.
+    double read_time = 0.0;
+    for (int r = 0; r < NUM_READS; r++) {
+        int scan = (r * 37) % (NUM_ROWS / SCAN_ROWS);
+        size_t start_row[2] = {(size_t) scan * SCAN_ROWS, 0};
+        size_t count[2] = {SCAN_ROWS, NUM_COLS};
+        int ncid, index_varid, lat_varid;
+
+        start = std::chrono::steady_clock::now();
+        if (nc_open(FILE_NAME, NC_NOWRITE, &ncid) ||
+            nc_inq_varid(ncid, "STARE_index_1km", &index_varid) ||
+            nc_inq_varid(ncid, "Latitude_1km", &lat_varid) ||
+            SidecarFile::readSTAREIndex(ncid, index_varid, start_row[0], count[0], &index[0]) ||
+            nc_get_vara_double(ncid, lat_varid, start_row, count, &lat[0]) ||
+            nc_close(ncid))
+            return ERR;
+        read_time += seconds_since(start);
+    }
+
+    printf("%-24s chunks %4zux%-4zu  write %.3f s  size %6.2f MB  scan read %.2f ms\n",
+           layout.str().c_str(), chunks[0], chunks[1], write_time, st.st_size / 1048576.0,
+           read_time / NUM_READS * 1000.0);
+    remove(FILE_NAME);
+
+    return 0;
+}
+
+int
+main(int argc, char **argv) {
+    const char *default_layouts[] = {"deflate:3,scan", "none,scan", "deflate:1,scan",
+                                     "deflate:6,scan", "zstd:3,scan", "zstd:9,scan",
+                                     "deflate:3,10", "deflate:3,2030", "stare,scan",
+                                     "stare+none,scan", "deflate:3,scan,float",
+                                     "deflate:3,scan,double:6", "deflate:3,scan,float:5"};
+    std::vector<std::string> specs;
+
+    for (int a = 1; a < argc; a++)
+        specs.push_back(argv[a]);
+    if (specs.empty())
+        specs.assign(default_layouts, default_layouts + sizeof(default_layouts) / sizeof(default_layouts[0]));
+
+    // A swath like a MOD09 1 km granule.
+    GeoGrid grid(NUM_ROWS, NUM_COLS, SCAN_ROWS);
+    synthetic_swath(grid);
+    TrixelIndexer indexer(LEVEL, BUILD_LEVEL);
+    indexer.index(grid.lat().data(), grid.lon().data(), grid.size(), LEVEL, grid.index().data());
+
+    for (size_t s = 0; s < specs.size(); s++) {
+        SidecarLayout layout;
+        if (parse_layout(specs[s], layout)) {
+            // Without zstd or quantize in netCDF-C, the layouts that
+            // need them are left out.
+            if ((specs[s].compare(0, 4, "zstd") && specs[s].find(",double:") == std::string::npos &&
+                 specs[s].find(",float:") == std::string::npos) || argc > 1) {
+                printf("bad layout %s\n", specs[s].c_str());
+                return ERR;
+            }
+            continue;
+        }
+        if (run_layout(layout, grid))
+            return ERR;
+    }
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+/* This is a benchmark for the STAREmaster project. It walks the
+ * perimeter of a synthetic swath shaped like a MOD05 5 km granule
+ * with PerimeterWalker, with and without a tolerance, and times
+ * STARE::NonConvexHull() of each. tst_perimeter checks the perimeters.
+ *
+ * Run as: bm_perimeter [tolerance]
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <chrono>
+#include "STARE.h"
+#include "StarePool.h"
+#include "PerimeterWalker.h"
+
+#define ERR 1
+
+#define NUM_ROWS 406
+#define NUM_COLS 270
+#define LEVEL 27
+#define BUILD_LEVEL 5
+#define COVER_LEVEL 8
+#define TOLERANCE 0.01
+
+/** Seconds since start. */
+static double
+seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int
+main(int argc, char **argv) {
+    double tolerance = argc > 1 ? atof(argv[1]) : TOLERANCE;
+    size_t n = (size_t) NUM_ROWS * NUM_COLS;
+    std::vector<double> lat(n), lon(n);
+    const int strides[] = {1, 3, 10};
+
+    // A swath that bends along track, with edges that bow out across
+    // track, and crosses the antimeridian.
+    for (int i = 0; i < NUM_ROWS; i++) {
+        for (int j = 0; j < NUM_COLS; j++) {
+            size_t k = (size_t) i * NUM_COLS + j;
+            double across = (j - NUM_COLS / 2) * 0.08;
+            lat[k] = 40.0 - i * 0.045 + across * 0.2 + 0.002 * across * across;
+            lon[k] = 175.0 + across - i * 0.01 + 2.0 * sin(i * 0.01);
+            if (lon[k] > 180.0)
+                lon[k] -= 360.0;
+        }
+    }
+
+    STARE &stare = StarePool::get(LEVEL, BUILD_LEVEL);
+
+    for (size_t s = 0; s < sizeof(strides) / sizeof(strides[0]); s++) {
+        int stride = strides[s];
+        LatLonDegrees64ValueVector full, simple;
+
+        PerimeterWalker walker(NUM_ROWS, NUM_COLS, stride, 0.0);
+        walker.add_rows(&lat[0], &lon[0], 0, NUM_ROWS);
+        walker.perimeter(full);
+
+        PerimeterWalker adaptive(NUM_ROWS, NUM_COLS, stride, tolerance);
+        adaptive.add_rows(&lat[0], &lon[0], 0, NUM_ROWS);
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        adaptive.perimeter(simple);
+        double walk_time = seconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        STARE_SpatialIntervals full_cover = stare.NonConvexHull(full, COVER_LEVEL);
+        double full_time = seconds_since(start);
+        start = std::chrono::steady_clock::now();
+        STARE_SpatialIntervals simple_cover = stare.NonConvexHull(simple, COVER_LEVEL);
+        double simple_time = seconds_since(start);
+
+        printf("stride %2d: %zu points, hull %zu values in %.4f s; tolerance %g: %zu points "
+               "in %.5f s, hull %zu values in %.4f s\n", stride, full.size(), full_cover.size(),
+               full_time, tolerance, simple.size(), walk_time, simple_cover.size(), simple_time);
+    }
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+/* This is a benchmark for the STAREmaster project. It times the 2-D
+ * resolution estimate on a synthetic swath shaped like a MOD09 1 km
+ * granule. tst_resolution checks the results.
+ *
+ * Run as: bm_resolution [repeats]
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include "StareBits.h"
+#include "SpatialResolution.h"
+
+#define ERR 1
+
+#define NUM_ROWS 2030
+#define NUM_COLS 1354
+#define SCAN_ROWS 10
+#define NUM_THREADS 4
+#define PI 3.14159265358979323846
+
+/** Seconds since start. */
+static double
+seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * A swath with rows about 1 km apart, columns that spread out toward
+ * the edges of the swath as MODIS pixels do, scans that overlap so
+ * the first row of each is 0.3 km from the last row of the one before,
+ * and a crossing of the antimeridian.
+ */
+static void
+swath_point(int row, int col, double &lat, double &lon) {
+    double scan = row / SCAN_ROWS, r = row % SCAN_ROWS;
+    double x = (col - NUM_COLS / 2) / (double) (NUM_COLS / 2);
+    double across = x * (NUM_COLS / 2) * (1.0 + 0.8 * x * x);
+
+    lat = 50.0 - (scan * (SCAN_ROWS - 0.7) + r) * 0.009;
+    lon = 179.0 + across * 0.009 / std::cos(lat * PI / 180.0);
+    if (lon > 180.0)
+        lon -= 360.0;
+}
+
+int
+main(int argc, char **argv) {
+    int repeats = argc > 1 ? atoi(argv[1]) : 3;
+    size_t n = (size_t) NUM_ROWS * NUM_COLS;
+    std::vector<double> lat(n), lon(n);
+    std::vector<unsigned long long> input(n), index(n);
+
+    if (repeats <= 0)
+        return ERR;
+
+    for (int i = 0; i < NUM_ROWS; i++)
+        for (int j = 0; j < NUM_COLS; j++)
+            swath_point(i, j, lat[(size_t) i * NUM_COLS + j], lon[(size_t) i * NUM_COLS + j]);
+
+    for (size_t k = 0; k < n; k++)
+        input[k] = ((k * 0x9e3779b97f4a7c15ULL) & SSC_STARE_LOCATION_BITS) | SSC_STARE_MAX_LEVEL;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++) {
+        std::copy(input.begin(), input.end(), index.begin());
+        estimate_resolution(&lat[0], &lon[0], NUM_ROWS, NUM_COLS, SCAN_ROWS, &index[0],
+                            NUM_THREADS);
+    }
+    double t = seconds_since(start) / repeats;
+
+    printf("%zu points in %.4f s, %.0f points/s with %d threads\n", n, t, n / t, NUM_THREADS);
+
+    return 0;
+}
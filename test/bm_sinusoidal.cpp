@@ -0,0 +1,45 @@
+/* This is a benchmark for the STAREmaster project. It times computing
+ * the geolocation of a 250 m tile of the MODIS sinusoidal grid.
+ * tst_sinusoidal checks the geolocation.
+ *
+ * Run as: bm_sinusoidal [threads]
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include "ssc.h"
+#include "SinusoidalGrid.h"
+
+#define ERR 1
+
+#define NUM_TIMES 3
+
+/** Seconds since start. */
+static double
+seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int
+main(int argc, char **argv) {
+    int threads = argc > 1 ? atoi(argv[1]) : 1;
+
+    // Time the largest tile.
+    const size_t n = SSC_SIN_250M;
+    std::vector<double> lat(n * n), lon(n * n);
+    double best = 1e30;
+    for (int r = 0; r < NUM_TIMES; r++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        if (sinusoidal_tile_geolocation(18, 4, n, &lat[0], &lon[0], threads))
+            return ERR;
+        best = std::min(best, seconds_since(start));
+    }
+    printf("250 m tile of %zu pixels with %d thread(s) in %.4f s, %.2f ns per pixel\n", n * n,
+           threads, best, best * 1e9 / (n * n));
+
+    return 0;
+}
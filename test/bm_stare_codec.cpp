@@ -0,0 +1,60 @@
+/* This is a benchmark for the STAREmaster project. It packs the
+ * STARE indices of a synthetic MOD09 1 km granule with the codec of
+ * PackedStareIndex, and reports the bits a pixel and the time to pack
+ * and unpack. tst_stare_codec checks the codec.
+ *
+ * Run as: bm_stare_codec
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include "PackedStareIndex.h"
+#include "TrixelIndexer.h"
+#include "synthetic_swath.h"
+
+#define ERR 1
+
+#define NUM_ROWS 2030
+#define NUM_COLS 1354
+#define LEVEL 27
+#define BUILD_LEVEL 5
+#define NUM_TIMES 3
+
+/** Seconds since start. */
+static double
+seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int
+main() {
+    std::vector<unsigned long long> index((size_t) NUM_ROWS * NUM_COLS);
+    std::vector<double> lat(index.size()), lon(index.size());
+
+    // A swath like a MOD09 1 km granule.
+    synthetic_swath(NUM_ROWS, NUM_COLS, 0, SYNTHETIC_SWATH_LON, lat.data(), lon.data());
+    TrixelIndexer indexer(LEVEL, BUILD_LEVEL);
+    indexer.index(lat.data(), lon.data(), index.size(), LEVEL, index.data());
+
+    // Time packing and unpacking the swath.
+    PackedStareIndex packed;
+    std::vector<unsigned long long> out(index.size());
+    double pack_time = 1e30, unpack_time = 1e30;
+    for (int r = 0; r < NUM_TIMES; r++) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        packed = PackedStareIndex::pack(index.data(), NUM_ROWS, NUM_COLS);
+        pack_time = std::min(pack_time, seconds_since(start));
+        start = std::chrono::steady_clock::now();
+        if (packed.unpack_rows(0, NUM_ROWS, out.data()))
+            return ERR;
+        unpack_time = std::min(unpack_time, seconds_since(start));
+    }
+    printf("%zu pixels in %.2f MB, %.2f bits a pixel, pack %.1f Mpixel/s, unpack %.1f Mpixel/s\n",
+           index.size(), packed.size_bytes() / 1048576.0, packed.size_bytes() * 8.0 / index.size(),
+           index.size() / pack_time / 1e6, index.size() / unpack_time / 1e6);
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+/* This is a benchmark for the STAREmaster project. It writes a
+ * synthetic MOD09 1 km granule to a sidecar file, with the STARE index
+ * as it is and packed, and reports the time to open the file and read
+ * the whole index, and to open it and read a window of it into a
+ * buffer, as a server does for a subset request. tst_window checks
+ * the windows.
+ *
+ * Run as: bm_window
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <netcdf.h>
+#include "GeoGrid.h"
+#include "SidecarFile.h"
+#include "TrixelIndexer.h"
+#include "synthetic_swath.h"
+
+#define ERR 1
+
+#define NUM_ROWS 2030
+#define NUM_COLS 1354
+#define SCAN_ROWS 10
+#define LEVEL 27
+#define BUILD_LEVEL 5
+#define NUM_READS 20
+#define VAR_NAME "1km Surface Reflectance Band 1"
+#define FILE_NAME "bm_window.nc"
+
+/** A window of the index: start, count and stride of rows and columns. */
+struct Window {
+    size_t start[2];
+    size_t count[2];
+    ptrdiff_t stride[2];
+};
+
+/** Seconds since start. */
+static double
+seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/** Open the file and read a window of the index, NUM_READS times. Returns the time of each. */
+static double
+time_window(const Window &w, std::vector<unsigned long long> &values, int &ret) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int ncid, varid;
+
+    values.resize(w.count[0] * w.count[1]);
+    ret = 0;
+    for (int r = 0; r < NUM_READS && !ret; r++) {
+        ret = nc_open(FILE_NAME, NC_NOWRITE, &ncid) ||
+              nc_inq_varid(ncid, "STARE_index_1km", &varid) ||
+              SidecarFile::readSTAREIndex(ncid, varid, w.start, w.count, w.stride, values.data()) ||
+              nc_close(ncid);
+    }
+
+    return seconds_since(start) / NUM_READS;
+}
+
+/**
+ * Write the grid with a layout, then time reading windows of it.
+ *
+ * @return 0 on success, ERR if the file can't be written or read.
+ */
+static int
+run_layout(const char *codec, const GeoGrid &grid) {
+    const Window windows[] = {
+        {{0, 0}, {NUM_ROWS, NUM_COLS}, {1, 1}},
+        {{500, 0}, {40, NUM_COLS}, {1, 1}},
+        {{100, 300}, {40, 400}, {1, 1}},
+        {{0, 0}, {(NUM_ROWS - 1) / 10 + 1, (NUM_COLS - 1) / 10 + 1}, {10, 10}}
+    };
+    double times[sizeof(windows) / sizeof(windows[0])];
+    SidecarLayout layout;
+    SidecarFile sf;
+    std::vector<unsigned long long> values;
+    int ret;
+
+    if (layout.set_codec(codec) || sf.createFile(FILE_NAME, 0, NULL))
+        return ERR;
+    sf.setLayout(layout);
+    if (sf.writeSTAREIndex(0, BUILD_LEVEL, grid, std::vector<std::string>(1, VAR_NAME), "1km") ||
+        sf.close_file())
+        return ERR;
+
+    // A window costs about its rows, not the whole index.
+    for (size_t w = 0; w < sizeof(windows) / sizeof(windows[0]); w++) {
+        times[w] = time_window(windows[w], values, ret);
+        if (ret)
+            return ERR;
+    }
+    printf("%-16s whole %.2f ms  40 rows %.2f ms  40x400 %.2f ms  every 10th %.2f ms\n", codec,
+           times[0] * 1000.0, times[1] * 1000.0, times[2] * 1000.0, times[3] * 1000.0);
+    remove(FILE_NAME);
+
+    return 0;
+}
+
+int
+main() {
+    // A swath like a MOD09 1 km granule.
+    GeoGrid grid(NUM_ROWS, NUM_COLS, SCAN_ROWS);
+    synthetic_swath(grid);
+    TrixelIndexer indexer(LEVEL, BUILD_LEVEL);
+    indexer.index(grid.lat().data(), grid.lon().data(), grid.size(), LEVEL, grid.index().data());
+
+    if (run_layout("deflate:3", grid) || run_layout("stare", grid))
+        return ERR;
+
+    return 0;
+}
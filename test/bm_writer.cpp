@@ -0,0 +1,97 @@
+/* This is a benchmark for the STAREmaster project. It indexes a run
+ * of synthetic MOD09 1 km granules and writes their sidecar files,
+ * first writing each granule before the next is indexed, then with
+ * the background writer, and reports the time of each and the
+ * speedup. tst_writer checks the sidecars.
+ *
+ * Run as: bm_writer [granules]
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sstream>
+#include <chrono>
+#include "GeoFile.h"
+#include "SidecarWriter.h"
+#include "TrixelIndexer.h"
+#include "synthetic_swath.h"
+
+#define ERR 1
+
+#define NUM_ROWS 2030
+#define NUM_COLS 1354
+#define SCAN_ROWS 10
+#define LEVEL 27
+#define BUILD_LEVEL 5
+#define NUM_GRANULES 4
+
+/** Seconds since start. */
+static double
+seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/** Name of the sidecar of a granule. */
+static std::string
+sidecar_name(int g) {
+    std::ostringstream name;
+    name << "bm_writer_" << g << "_stare.nc";
+    return name.str();
+}
+
+/** Read and index a synthetic granule, each one a little further along the orbit. */
+static GeoFile *
+index_granule(int g, TrixelIndexer &indexer) {
+    GeoFile *gf = new GeoFile();
+
+    gf->geo_grid.push_back(GeoGrid(NUM_ROWS, NUM_COLS, SCAN_ROWS));
+    GeoGrid &grid = gf->geo_grid[0];
+
+    synthetic_swath(grid, g * NUM_ROWS);
+    indexer.index(grid.lat().data(), grid.lon().data(), grid.size(), LEVEL, grid.index().data());
+
+    gf->d_num_index = 1;
+    gf->var_name[0].push_back("1km Surface Reflectance Band 1");
+    gf->d_stare_index_name.push_back("1km");
+    gf->num_cover = 0;
+
+    return gf;
+}
+
+/** Index and write the granules, with a writer queue size. Returns the time taken. */
+static double
+run(int num_granules, int queue_size, TrixelIndexer &indexer, int &ret) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    SidecarWriter writer(SidecarLayout(), 0, BUILD_LEVEL, "", queue_size);
+
+    ret = 0;
+    for (int g = 0; g < num_granules && !ret; g++)
+        ret = writer.submit(index_granule(g, indexer), sidecar_name(g));
+    if (!ret)
+        ret = writer.finish();
+
+    return seconds_since(start);
+}
+
+int
+main(int argc, char **argv) {
+    int num_granules = argc > 1 ? atoi(argv[1]) : NUM_GRANULES;
+    TrixelIndexer indexer(LEVEL, BUILD_LEVEL);
+    int ret;
+
+    double serial = run(num_granules, 0, indexer, ret);
+    if (ret)
+        return ERR;
+    double background = run(num_granules, 1, indexer, ret);
+    if (ret)
+        return ERR;
+    for (int g = 0; g < num_granules; g++)
+        remove(sidecar_name(g).c_str());
+
+    printf("%d granules: written in turn %.3f s, background writer %.3f s, speedup %.2f\n",
+           num_granules, serial, background, serial / background);
+
+    return 0;
+}
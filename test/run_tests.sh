@@ -2,6 +2,15 @@
 set -e
 set -x
 
+# Check that two sidecar files hold the same data, leaving out the
+# first line and the history attribute of their CDL, which hold the
+# file name and the date/time.
+same_data() {
+    ncdump $1 | sed '1d;/:history/d' > ${1%.nc}_out.cdl
+    ncdump $2 | sed '1d;/:history/d' > ${2%.nc}_out.cdl
+    diff ${1%.nc}_out.cdl ${2%.nc}_out.cdl
+}
+
 echo "*** running test t1..."
 ./t1
 
@@ -17,12 +26,23 @@ echo "*** creating sidecar file for MOD09GA..."
 echo "*** creating CDL of MOD09 sidecar file header..."
 ncdump -h data/MOD09GA.A2020009.h00v08.006.2020011025435_stare.nc > MOD09GA.A2020009.h00v08.006.2020011025435_stare_out.cdl
 
-# Remove the line that has the history attribute, containing date/time.
-sed '7d' MOD09GA.A2020009.h00v08.006.2020011025435_stare_out.cdl > MOD09GA.A2020009.h00v08.006.2020011025435_stare_no_hist_out.cdl
+# Remove the line that has the history attribute, containing
+# date/time, and the size of the cover, which is checked on its own.
+grep 'l_1km = [1-9]' MOD09GA.A2020009.h00v08.006.2020011025435_stare_out.cdl
+sed '/:history = /d; /l_1km = /d' MOD09GA.A2020009.h00v08.006.2020011025435_stare_out.cdl > MOD09GA.A2020009.h00v08.006.2020011025435_stare_no_hist_out.cdl
 
 echo "*** checking that sidecar header is correct..."
 diff -b -w MOD09GA.A2020009.h00v08.006.2020011025435_stare_no_hist_out.cdl ref_MOD09GA.A2020009.h00v08.006.2020011025435_stare.cdl
 
+echo "*** checking that a MOD09GA tile sidecar is reused from the tile cache..."
+rm -rf tile_cache && mkdir tile_cache
+../src/mk_stare -d MOD09GA -k tile_cache -o MOD09GA_first_stare.nc data/MOD09GA.A2020009.h00v08.006.2020011025435.hdf
+ls tile_cache/MOD09GA_h00v08_1km_500m_b5_*_stare.nc
+../src/mk_stare -d MOD09GA -k tile_cache -o MOD09GA_cached_stare.nc data/MOD09GA.A2020009.h00v08.006.2020011025435.hdf
+same_data MOD09GA_first_stare.nc MOD09GA_cached_stare.nc
+ncdump -h MOD09GA_cached_stare.nc | grep -q ':history = ".* - STAREmaster MOD09GA_cached_stare.nc"'
+test `ls tile_cache | wc -l` -eq 1
+
 echo "*** creating sidecar file for MOD05..."
 ../src/mk_stare -w 1 data/MOD05_L2.A2005349.2125.061.2017294065400.hdf
 
@@ -47,6 +67,146 @@ sed '24d' MOD05_L2.A2005349.2125.061.2017294065400_stare_inst_out.cdl > MOD05_L2
 echo "*** checking that sidecar header with institution is correct..."
 diff -b -w MOD05_L2.A2005349.2125.061.2017294065400_stare_no_hist_inst_out.cdl ref_MOD05_L2.A2005349.2125.061.2017294065400_inst_stare.cdl
 
+echo "*** checking that serial and threaded MOD05 sidecars are identical..."
+../src/mk_stare -w 1 -t 1 -o MOD05_serial_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf
+../src/mk_stare -w 1 -t 4 -o MOD05_threaded_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf
+same_data MOD05_serial_stare.nc MOD05_threaded_stare.nc
+
+echo "*** checking that the trixel lookup table gives the same MOD05 sidecar..."
+rm -rf lut_dir && mkdir lut_dir
+../src/mk_stare -w 1 -l lut_dir -o MOD05_lut_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf
+same_data MOD05_serial_stare.nc MOD05_lut_stare.nc
+../src/mk_stare -w 1 -l lut_dir -o MOD05_lut_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf
+same_data MOD05_serial_stare.nc MOD05_lut_stare.nc
+
+echo "*** checking the MOD05 sidecar with the interpolated 1 km grid..."
+../src/mk_stare -w 1 -f -o MOD05_fine_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf
+ncdump -h MOD05_fine_stare.nc > MOD05_fine_stare_out.cdl
+grep -q "uint64 STARE_index_1km(i_1km, j_1km)" MOD05_fine_stare_out.cdl
+grep -q "i_1km = 2030" MOD05_fine_stare_out.cdl
+grep -q "j_1km = 1354" MOD05_fine_stare_out.cdl
+ncdump -v STARE_index_5km MOD05_fine_stare.nc | sed '1,/^data:/d' > MOD05_fine_5km_out.cdl
+ncdump -v STARE_index_5km MOD05_serial_stare.nc | sed '1,/^data:/d' > MOD05_serial_5km_out.cdl
+diff MOD05_serial_5km_out.cdl MOD05_fine_5km_out.cdl
+
+echo "*** checking the MOD05 sidecar with resolution from the 2-D pixel spacing..."
+../src/mk_stare -w 1 -S -c 8 -t 1 -o MOD05_spacing_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf
+../src/mk_stare -w 1 -S -c 8 -t 4 -o MOD05_spacing_threaded_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf
+same_data MOD05_spacing_stare.nc MOD05_spacing_threaded_stare.nc
+../src/check_sidecar MOD05_spacing_stare.nc
+
+echo "*** checking the MOD05 sidecar with the cover built from the indices..."
+../src/mk_stare -x -c 8 -t 1 -o MOD05_exact_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf
+../src/mk_stare -x -c 8 -t 4 -o MOD05_exact_threaded_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf
+same_data MOD05_exact_stare.nc MOD05_exact_threaded_stare.nc
+grep -q "uint64 STARE_cover_5km(l_5km)" MOD05_exact_stare_out.cdl
+../src/check_sidecar MOD05_exact_stare.nc
+# Streaming builds an exact cover a block at a time, so it needs the
+# cover level up front. Streaming is only for the MOD09 reader, and
+# there is no MOD09 granule here, so check that the arguments are
+# refused for the cover level, and not once it is given.
+if ../src/mk_stare -d MOD09 -m 16M -x -o MOD09_exact_stream_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf 2> MOD09_exact_stream_err.txt; then exit 1; fi
+grep -q "needs a cover level" MOD09_exact_stream_err.txt
+../src/mk_stare -d MOD09 -m 16M -x -c 8 -o MOD09_exact_stream_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf 2> MOD09_exact_stream_err.txt || true
+if grep -q "needs a cover level" MOD09_exact_stream_err.txt; then exit 1; fi
+
+echo "*** checking the MOD05 sidecar with an adaptive perimeter..."
+../src/mk_stare -a 0.01 -o MOD05_adaptive_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf
+ncdump -h MOD05_adaptive_stare.nc > MOD05_adaptive_stare_out.cdl
+grep -q "uint64 STARE_cover_5km(l_5km)" MOD05_adaptive_stare_out.cdl
+../src/check_sidecar MOD05_adaptive_stare.nc
+
+echo "*** checking the MOD05 sidecars with the cover level picked to fit a budget..."
+../src/mk_stare -w 1 -n 500 -o MOD05_budget_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf
+../src/mk_stare -x -n 100 -o MOD05_exact_budget_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf
+for f in MOD05_budget_stare MOD05_exact_budget_stare; do
+    ncdump -h $f.nc > ${f}_out.cdl
+    grep -q "STARE_cover_5km:stare_cover_level = " ${f}_out.cdl
+    ../src/check_sidecar $f.nc
+done
+test `awk '$1 == "l_5km" {print $3}' MOD05_budget_stare_out.cdl` -le 500
+test `awk '$1 == "l_5km" {print $3}' MOD05_exact_budget_stare_out.cdl` -le 100
+if grep -q "stare_cover_level" MOD05_exact_stare_out.cdl; then exit 1; fi
+
+echo "*** checking the MOD05 sidecar with a pyramid of covers..."
+../src/mk_stare -x -c 8 -p 4,6,8,12 -o MOD05_pyramid_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf
+ncdump -h MOD05_pyramid_stare.nc > MOD05_pyramid_stare_out.cdl
+grep -q "uint64 STARE_cover_5km(l_5km)" MOD05_pyramid_stare_out.cdl
+grep -q "uint64 STARE_cover_5km_L6(l_5km_L6)" MOD05_pyramid_stare_out.cdl
+grep -q "uint64 STARE_cover_5km_L4(l_5km_L4)" MOD05_pyramid_stare_out.cdl
+if grep -q "STARE_cover_5km_L8\|STARE_cover_5km_L12" MOD05_pyramid_stare_out.cdl; then exit 1; fi
+../src/check_sidecar MOD05_pyramid_stare.nc
+
+echo "*** checking the MOD05 sidecar chunking and compression layouts..."
+ncdump -hs MOD05_serial_stare.nc > MOD05_layout_default_out.cdl
+grep -q 'STARE_index_5km:_ChunkSizes = 122, 270 ;' MOD05_layout_default_out.cdl
+grep -q 'STARE_index_5km:_DeflateLevel = 3 ;' MOD05_layout_default_out.cdl
+../src/mk_stare -w 1 -z none -y 20 -o MOD05_layout_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf
+ncdump -hs MOD05_layout_stare.nc > MOD05_layout_out.cdl
+grep -q 'Latitude_5km:_ChunkSizes = 20, 270 ;' MOD05_layout_out.cdl
+if grep -q '_DeflateLevel' MOD05_layout_out.cdl; then exit 1; fi
+same_data MOD05_serial_stare.nc MOD05_layout_stare.nc
+if ../src/mk_stare -w 1 -z gzip -o MOD05_layout_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf; then exit 1; fi
+if ../src/mk_stare -w 1 -y 0 -o MOD05_layout_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf; then exit 1; fi
+
+echo "*** checking the MOD05 sidecar with the STARE index packed..."
+../src/mk_stare -w 1 -z stare -o MOD05_packed_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf
+ncdump -h MOD05_packed_stare.nc > MOD05_packed_out.cdl
+grep -q 'ubyte STARE_index_5km(b_5km) ;' MOD05_packed_out.cdl
+grep -q 'STARE_index_5km:stare_codec = "xor_bitpack" ;' MOD05_packed_out.cdl
+grep -q 'uint64 STARE_row_offsets_5km(i_5km) ;' MOD05_packed_out.cdl
+../src/check_sidecar MOD05_packed_stare.nc
+ncdump -v Latitude_5km,Longitude_5km,STARE_cover_5km MOD05_serial_stare.nc | sed '1,/^data:/d' > MOD05_unpacked_data_out.cdl
+ncdump -v Latitude_5km,Longitude_5km,STARE_cover_5km MOD05_packed_stare.nc | sed '1,/^data:/d' > MOD05_packed_data_out.cdl
+diff MOD05_unpacked_data_out.cdl MOD05_packed_data_out.cdl
+if ../src/mk_stare -w 1 -z stare+stare -o MOD05_packed_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf; then exit 1; fi
+
+echo "*** checking that several MOD05 granules are written the same with and without the background writer..."
+rm -rf writer_in && mkdir writer_in
+for g in a b c; do
+    cp data/MOD05_L2.A2005349.2125.061.2017294065400.hdf writer_in/MOD05_$g.hdf
+done
+../src/mk_stare -w 1 writer_in/MOD05_a.hdf writer_in/MOD05_b.hdf writer_in/MOD05_c.hdf
+for g in a b c; do
+    same_data MOD05_serial_stare.nc writer_in/MOD05_${g}_stare.nc
+done
+rm writer_in/*_stare.nc
+../src/mk_stare -w 1 -u 0 writer_in/MOD05_a.hdf writer_in/MOD05_b.hdf writer_in/MOD05_c.hdf
+for g in a b c; do
+    same_data MOD05_serial_stare.nc writer_in/MOD05_${g}_stare.nc
+done
+if ../src/mk_stare -w 1 -o MOD05_writer_stare.nc writer_in/MOD05_a.hdf writer_in/MOD05_b.hdf; then exit 1; fi
+if ../src/mk_stare -w 1 -u -1 writer_in/MOD05_a.hdf; then exit 1; fi
+
+echo "*** checking the MOD05 sidecar with float and quantized lat/lons..."
+../src/mk_stare -w 1 -e float -o MOD05_float_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf
+ncdump -h MOD05_float_stare.nc > MOD05_float_out.cdl
+grep -q 'float Latitude_5km(i_5km, j_5km) ;' MOD05_float_out.cdl
+grep -q 'Longitude_5km:geo_precision = "float" ;' MOD05_float_out.cdl
+ncdump -v STARE_index_5km,STARE_cover_5km MOD05_float_stare.nc | sed '1,/^data:/d' > MOD05_float_data_out.cdl
+ncdump -v STARE_index_5km,STARE_cover_5km MOD05_serial_stare.nc | sed '1,/^data:/d' > MOD05_double_data_out.cdl
+diff MOD05_double_data_out.cdl MOD05_float_data_out.cdl
+test $(wc -c < MOD05_float_stare.nc) -lt $(wc -c < MOD05_serial_stare.nc)
+if nc-config --has-quantize 2>/dev/null | grep -q yes; then
+    ../src/mk_stare -w 1 -e double:5 -o MOD05_quantize_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf
+    ncdump -h MOD05_quantize_stare.nc > MOD05_quantize_out.cdl
+    grep -q 'double Latitude_5km(i_5km, j_5km) ;' MOD05_quantize_out.cdl
+    grep -q 'Latitude_5km:_QuantizeGranularBitRoundNumberOfSignificantDigits = 5 ;' MOD05_quantize_out.cdl
+    grep -q 'Latitude_5km:geo_precision = "double:5" ;' MOD05_quantize_out.cdl
+    ncdump -v STARE_index_5km,STARE_cover_5km MOD05_quantize_stare.nc | sed '1,/^data:/d' > MOD05_quantize_data_out.cdl
+    diff MOD05_double_data_out.cdl MOD05_quantize_data_out.cdl
+    test $(wc -c < MOD05_quantize_stare.nc) -lt $(wc -c < MOD05_serial_stare.nc)
+fi
+if ../src/mk_stare -w 1 -e float:8 -o MOD05_float_stare.nc data/MOD05_L2.A2005349.2125.061.2017294065400.hdf; then exit 1; fi
+
+echo "*** checking that the MOD05 sidecar converts to a flat sidecar and back..."
+../src/convert_sidecar MOD05_serial_stare.nc MOD05_serial_stare.flat
+../src/convert_sidecar MOD05_serial_stare.flat MOD05_flat_stare.nc
+same_data MOD05_serial_stare.nc MOD05_flat_stare.nc
+../src/convert_sidecar MOD05_packed_stare.nc MOD05_packed_stare.flat
+cmp MOD05_serial_stare.flat MOD05_packed_stare.flat
+if ../src/convert_sidecar MOD05_serial_stare_out.cdl MOD05_bad.flat; then exit 1; fi
+
 echo "*** creating sidecar file for MOD05 with cover from GRING..."
 ../src/mk_stare -g data/MOD05_L2.A2005349.2125.061.2017294065400.hdf
 
@@ -0,0 +1,41 @@
+/// @file
+/// A netCDF sidecar of a synthetic swath, for the tests and
+/// benchmarks.
+
+#ifndef SYNTHETIC_SIDECAR_H_ /**< Protect file from double include. */
+#define SYNTHETIC_SIDECAR_H_
+
+#include <string>
+#include <vector>
+#include "GeoGrid.h"
+#include "SidecarFile.h"
+
+/**
+ * Write a netCDF sidecar of one 1 km grid and its cover.
+ *
+ * @param file_name Name of the sidecar file.
+ * @param build_level STARE build level the index was made with.
+ * @param grid The grid, with its lat/lons and STARE index.
+ * @param var_name Name of the variable the grid is the geolocation
+ * of.
+ * @param cover The STARE cover.
+ * @param cover_level STARE level of the cover.
+ * @return 0 for success, error code otherwise.
+ */
+inline int
+write_synthetic_sidecar(const char *file_name, int build_level, const GeoGrid &grid,
+                        const std::string &var_name, std::vector<unsigned long long> &cover,
+                        int cover_level) {
+    SidecarFile sf;
+    int ret;
+
+    if ((ret = sf.createFile(file_name, 0, NULL)))
+        return ret;
+    if ((ret = sf.writeSTAREIndex(0, build_level, grid, std::vector<std::string>(1, var_name), "1km")))
+        return ret;
+    if ((ret = sf.writeSTARECover(0, cover.size(), &cover[0], "1km", cover_level)))
+        return ret;
+    return sf.close_file();
+}
+
+#endif /* SYNTHETIC_SIDECAR_H_ */
@@ -0,0 +1,54 @@
+/// @file
+/// A synthetic swath shaped like a MOD09 1 km granule, for the tests
+/// and benchmarks.
+
+#ifndef SYNTHETIC_SWATH_H_ /**< Protect file from double include. */
+#define SYNTHETIC_SWATH_H_
+
+#include <cstddef>
+#include "GeoGrid.h"
+
+#define SYNTHETIC_SWATH_LON -100.0 /**< Longitude of the middle of the first row. */
+#define SYNTHETIC_SWATH_DATELINE_LON 175.0 /**< The same, for a swath across the antimeridian. */
+
+/**
+ * Fill lat/lons with a swath about 2330 km wide, tilted like a
+ * descending orbit. A swath that starts near 180 degrees crosses the
+ * antimeridian.
+ *
+ * @param num_rows Number of rows.
+ * @param num_cols Number of columns.
+ * @param first_row Row of the orbit the swath starts at, so granules
+ * further along the orbit follow on from the ones before.
+ * @param lon0 Longitude of the middle of the first row of the orbit.
+ * @param lat Gets the latitudes, num_rows by num_cols.
+ * @param lon Gets the longitudes, num_rows by num_cols.
+ */
+inline void
+synthetic_swath(int num_rows, int num_cols, int first_row, double lon0, double *lat, double *lon) {
+    for (int i = 0; i < num_rows; i++) {
+        for (int j = 0; j < num_cols; j++) {
+            size_t k = (size_t) i * num_cols + j;
+            double across = (j - num_cols / 2) * 0.0155;
+            lat[k] = 40.0 - (first_row + i) * 0.009 + across * 0.2;
+            lon[k] = lon0 + across - (first_row + i) * 0.002;
+            if (lon[k] > 180.0)
+                lon[k] -= 360.0;
+        }
+    }
+}
+
+/**
+ * Fill the lat/lons of a grid with a synthetic swath. The STARE
+ * indices are left to the caller.
+ *
+ * @param grid The grid.
+ * @param first_row Row of the orbit the swath starts at.
+ */
+inline void
+synthetic_swath(GeoGrid &grid, int first_row = 0) {
+    synthetic_swath((int) grid.num_i(), (int) grid.num_j(), first_row, SYNTHETIC_SWATH_LON,
+                    grid.lat().data(), grid.lon().data());
+}
+
+#endif /* SYNTHETIC_SWATH_H_ */
@@ -42,8 +42,7 @@ main() {
         return ERR;
 
     // Write the sidecar file.
-    if (sf.writeSTAREIndex(1, 5, gf.geo_num_i[0], gf.geo_num_j[0],
-                           &gf.geo_lat[0][0], &gf.geo_lon[0][0], &gf.geo_index[0][0], gf.var_name[0], "1km"))
+    if (sf.writeSTAREIndex(1, 5, gf.geo_grid[0], gf.var_name[0], "1km"))
         return ERR;
 
     // Close the sidecar file.
@@ -91,5 +90,33 @@ main() {
 
     if (gf_in.close_sidecar_file(ncid))
         return ERR;
+
+    // Write the sidecar file again with the STARE index packed, and
+    // read back the same indices.
+    std::string packedNameOut = "t1_packed_sidecar.nc";
+    SidecarFile sf_packed;
+    SidecarLayout layout;
+    if (layout.set_codec("stare"))
+        return ERR;
+    if (sf_packed.createFile(packedNameOut, 1, NULL))
+        return ERR;
+    sf_packed.setLayout(layout);
+    if (sf_packed.writeSTAREIndex(1, 5, gf.geo_grid[0], gf.var_name[0], "1km"))
+        return ERR;
+    if (sf_packed.close_file())
+        return ERR;
+
+    GeoFile gf_packed;
+    vector<unsigned long long> packed_values;
+    if (gf_packed.read_sidecar_file(packedNameOut, ncid))
+        return ERR;
+    if (gf_packed.d_size_i.size() != 1 || gf_packed.d_size_i.at(0) != 406 ||
+        gf_packed.d_size_j.at(0) != 270)
+        return ERR;
+    if (gf_packed.get_stare_indices(varName, ncid, packed_values))
+        return ERR;
+    if (packed_values != values) return ERR;
+    if (gf_packed.close_sidecar_file(ncid))
+        return ERR;
     return 0;
 }
@@ -4,7 +4,9 @@
 #include <sstream>
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 #include "Modis05L2GeoFile.h"
+#include "Hdf4Granule.h"
 #include "SidecarFile.h"
 
 #define MAX_STR 256
@@ -34,13 +36,41 @@ main() {
         return ERR;
 
     // Write the sidecar file.
-    if (sf.writeSTAREIndex(1, 5, gf.geo_num_i[0], gf.geo_num_j[0],
-                           &gf.geo_lat[0][0], &gf.geo_lon[0][0], &gf.geo_index[0][0], gf.var_name[0], "1km"))
+    if (sf.writeSTAREIndex(1, 5, gf.geo_grid[0], gf.var_name[0], "1km"))
         return ERR;
 
     // Close the sidecar file.
     if (sf.close_file())
 	return ERR;
+
+    // Read the file again, with every step sharing one open granule.
+    {
+        Modis05L2GeoFile gf2;
+        Hdf4Granule granule;
+        float gring_lat[SSC_NUM_GRING], gring_lon[SSC_NUM_GRING];
+        float gring_lat2[SSC_NUM_GRING], gring_lon2[SSC_NUM_GRING];
+
+        if (!granule.open("data/no_such_file.hdf")) return ERR;
+        if (granule.is_open()) return ERR;
+        if (granule.open(fileName)) return ERR;
+        if (!granule.is_swath()) return ERR;
+        if (gf2.determineFormat(granule, &gf_format)) return ERR;
+        if (gf_format != SSC_FORMAT_MODIS_L2) return ERR;
+
+        // The GRing is read from the file once, and is the same as
+        // when the file is opened for it.
+        if (gf2.getGRing(granule, 0, gring_lat, gring_lon)) return ERR;
+        if (gf2.getGRing(fileName, 0, gring_lat2, gring_lon2)) return ERR;
+        for (int i = 0; i < SSC_NUM_GRING; i++)
+            if (gring_lat[i] != gring_lat2[i] || gring_lon[i] != gring_lon2[i]) return ERR;
+
+        if (gf2.readFile(granule, 0, 5, -1, true, 1))
+            return ERR;
+        if (!std::equal(gf2.geo_grid[0].index().begin(), gf2.geo_grid[0].index().end(),
+                        gf.geo_grid[0].index().begin())) return ERR;
+        if (granule.close()) return ERR;
+        if (granule.is_open()) return ERR;
+    }
     
     return 0;
 }
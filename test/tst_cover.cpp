@@ -0,0 +1,112 @@
+/* This is a test file for the STAREmaster project. It builds covers
+ * from per-point STARE indices with CoverBuilder, on a synthetic swath
+ * shaped like a MOD09 1 km granule, at several cover levels, and
+ * checks that each cover holds exactly the trixels of the points, that
+ * adding the points in blocks or with fewer threads gives the same
+ * cover, and that points without geolocation are left out.
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+#include "ssc.h"
+#include "StareBits.h"
+#include "TrixelIndexer.h"
+#include "CoverBuilder.h"
+#include "synthetic_swath.h"
+
+#define ERR 1
+
+#define NUM_ROWS 2030
+#define NUM_COLS 1354
+#define BLOCK_ROWS 20
+#define LEVEL 27
+#define BUILD_LEVEL 5
+#define NUM_THREADS 4
+
+/**
+ * Expand a cover into its trixels at a level.
+ *
+ * @return false if the cover is not well formed.
+ */
+static bool
+expand(const std::vector<unsigned long long> &cover, int level,
+       std::vector<unsigned long long> &trixels) {
+    int shift = stare_digit_shift(level);
+
+    trixels.clear();
+    for (size_t k = 0; k < cover.size(); k++) {
+        unsigned long long first = cover[k], last;
+        if (stare_is_terminator(first) || stare_level(first) > level)
+            return false;
+        if (k + 1 < cover.size() && stare_is_terminator(cover[k + 1]))
+            last = cover[++k];
+        else
+            last = stare_terminator(first);
+        for (unsigned long long t = first >> shift; t <= last >> shift; t++)
+            trixels.push_back((t << shift) | (unsigned long long) level);
+    }
+    return std::is_sorted(trixels.begin(), trixels.end()) &&
+           std::adjacent_find(trixels.begin(), trixels.end()) == trixels.end();
+}
+
+int
+main() {
+    size_t n = (size_t) NUM_ROWS * NUM_COLS;
+    std::vector<double> lat(n), lon(n);
+    std::vector<unsigned long long> index(n);
+    const int levels[] = {6, 8, 10, 12};
+
+    printf("*** Testing building covers from point indices...");
+
+    // A swath about 2330 km wide, tilted like a descending orbit, that
+    // crosses the antimeridian, with a few pixels without geolocation.
+    synthetic_swath(NUM_ROWS, NUM_COLS, 0, SYNTHETIC_SWATH_DATELINE_LON, &lat[0], &lon[0]);
+    for (size_t k = 4321; k < n; k += 54321)
+        lat[k] = lon[k] = SSC_GEO_FILL;
+
+    TrixelIndexer indexer(LEVEL, BUILD_LEVEL);
+    indexer.index(&lat[0], &lon[0], n, LEVEL, &index[0]);
+
+    for (size_t l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+        int level = levels[l];
+        std::vector<unsigned long long> cover, blocked, serial, trixels, want;
+
+        CoverBuilder builder(level, NUM_THREADS);
+        builder.add(&lat[0], &index[0], n);
+        builder.intervals(cover);
+
+        // The same points in blocks of rows, with the level set late,
+        // and with one thread.
+        CoverBuilder blocks(-1, NUM_THREADS);
+        blocks.set_level(level);
+        for (int i = 0; i < NUM_ROWS; i += BLOCK_ROWS) {
+            size_t row = (size_t) i * NUM_COLS;
+            blocks.add(&lat[row], &index[row], (size_t) std::min(BLOCK_ROWS, NUM_ROWS - i) * NUM_COLS);
+        }
+        blocks.intervals(blocked);
+        CoverBuilder one(level, 1);
+        one.add(&lat[0], &index[0], n);
+        one.intervals(serial);
+        if (blocked != cover || serial != cover) {
+            printf("level %d: cover depends on blocks or threads\n", level);
+            return ERR;
+        }
+
+        // The trixels of the valid points, the slow way.
+        for (size_t k = 0; k < n; k++)
+            if (lat[k] != SSC_GEO_FILL)
+                want.push_back(stare_truncate(index[k], level));
+        std::sort(want.begin(), want.end());
+        want.erase(std::unique(want.begin(), want.end()), want.end());
+
+        if (!expand(cover, level, trixels) || trixels != want) {
+            printf("level %d: cover has %zu trixels, wanted %zu\n", level, trixels.size(), want.size());
+            return ERR;
+        }
+    }
+
+    printf("ok!\n");
+    return 0;
+}
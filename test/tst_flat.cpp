@@ -0,0 +1,187 @@
+/* This is a test file for the STAREmaster project. It writes a
+ * synthetic MOD09 1 km granule to a netCDF sidecar, converts it to a
+ * flat sidecar, and checks that the flat sidecar holds what was
+ * written, that it converts back to a netCDF sidecar that holds the
+ * same, and that flat sidecars of another version, or cut short, are
+ * refused.
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <algorithm>
+#include <vector>
+#include <netcdf.h>
+#include "ssc.h"
+#include "GeoGrid.h"
+#include "SidecarFile.h"
+#include "FlatSidecar.h"
+#include "TrixelIndexer.h"
+#include "synthetic_sidecar.h"
+#include "synthetic_swath.h"
+
+#define ERR 1
+
+#define NUM_ROWS 2030
+#define NUM_COLS 1354
+#define SCAN_ROWS 10
+#define LEVEL 27
+#define BUILD_LEVEL 5
+#define COVER_STEP 997
+#define COVER_LEVEL 8
+#define VAR_NAME "1km Surface Reflectance Band 1"
+#define NC_FILE "tst_flat.nc"
+#define FLAT_FILE "tst_flat.flat"
+#define BACK_FILE "tst_flat_back.nc"
+#define BAD_FILE "tst_flat_bad.flat"
+
+/**
+ * Read the index, lat/lons and cover of a netCDF sidecar, and count
+ * the values that are not those written.
+ */
+static size_t
+check_netcdf(const char *file_name, const GeoGrid &grid, const std::vector<unsigned long long> &cover) {
+    std::vector<unsigned long long> index(grid.size()), cover_in(cover.size());
+    std::vector<double> lat(grid.size()), lon(grid.size());
+    int ncid, index_varid, lat_varid, lon_varid, cover_varid, level;
+    size_t num_bad = 0;
+
+    if (nc_open(file_name, NC_NOWRITE, &ncid) ||
+        nc_inq_varid(ncid, "STARE_index_1km", &index_varid) ||
+        nc_inq_varid(ncid, "Latitude_1km", &lat_varid) ||
+        nc_inq_varid(ncid, "Longitude_1km", &lon_varid) ||
+        nc_inq_varid(ncid, "STARE_cover_1km", &cover_varid) ||
+        SidecarFile::readSTAREIndex(ncid, index_varid, 0, NUM_ROWS, &index[0]) ||
+        nc_get_var_double(ncid, lat_varid, &lat[0]) || nc_get_var_double(ncid, lon_varid, &lon[0]) ||
+        nc_get_var_ulonglong(ncid, cover_varid, &cover_in[0]) ||
+        nc_get_att_int(ncid, cover_varid, SSC_COVER_LEVEL_NAME, &level) || nc_close(ncid)) {
+        printf("can't read %s\n", file_name);
+        return 1;
+    }
+    for (size_t k = 0; k < grid.size(); k++)
+        if (index[k] != grid.index()[k] || lat[k] != grid.lat()[k] || lon[k] != grid.lon()[k])
+            num_bad++;
+    if (cover_in != cover || level != COVER_LEVEL)
+        num_bad++;
+
+    return num_bad;
+}
+
+/** Check that a flat sidecar holds the grid and cover. */
+static size_t
+check_flat(const GeoGrid &grid, const std::vector<unsigned long long> &cover) {
+    FlatSidecar flat;
+    size_t num_bad = 0;
+
+    if (flat.open(FLAT_FILE)) {
+        printf("can't open %s\n", FLAT_FILE);
+        return 1;
+    }
+    const FlatArray *index = flat.find_index(VAR_NAME);
+    const FlatArray *lat = flat.find(SSC_FLAT_LATITUDE, "1km");
+    const FlatArray *lon = flat.find(SSC_FLAT_LONGITUDE, "1km");
+    const FlatArray *cover_in = flat.find(SSC_FLAT_COVER, "1km");
+    if (flat.num_arrays() != 4 || !index || !lat || !lon || !cover_in ||
+        index->name != "1km" || index->num_i != NUM_ROWS || index->num_j != NUM_COLS ||
+        index->variables != VAR_NAME || lat->size() != grid.size() || lon->size() != grid.size() ||
+        cover_in->size() != cover.size() || cover_in->level != COVER_LEVEL ||
+        flat.find_index("no such variable")) {
+        printf("flat sidecar arrays are wrong\n");
+        return 1;
+    }
+    for (size_t k = 0; k < flat.num_arrays(); k++)
+        if ((size_t) flat.array(k).data % SSC_FLAT_ALIGN)
+            num_bad++;
+    for (size_t k = 0; k < grid.size(); k++)
+        if (index->values()[k] != grid.index()[k] || lat->geo()[k] != grid.lat()[k] ||
+            lon->geo()[k] != grid.lon()[k])
+            num_bad++;
+    if (memcmp(cover_in->values(), &cover[0], cover.size() * sizeof(unsigned long long)))
+        num_bad++;
+
+    return num_bad;
+}
+
+/** Check that a copy of the flat sidecar, changed, is refused. */
+static size_t
+check_refused(size_t offset, unsigned char byte, size_t size) {
+    std::vector<unsigned char> bytes;
+    FILE *fp = fopen(FLAT_FILE, "rb");
+    int c;
+
+    while (fp && (c = getc(fp)) != EOF)
+        bytes.push_back((unsigned char) c);
+    if (fp)
+        fclose(fp);
+    if (bytes.size() <= offset)
+        return 1;
+    bytes[offset] = byte;
+    bytes.resize(std::min(size, bytes.size()));
+    fp = fopen(BAD_FILE, "wb");
+    if (!fp || fwrite(&bytes[0], 1, bytes.size(), fp) != bytes.size() || fclose(fp))
+        return 1;
+
+    FlatSidecar flat;
+    int ret = flat.open(BAD_FILE);
+    remove(BAD_FILE);
+    if (!ret) {
+        printf("changed flat sidecar accepted, byte %zu, size %zu\n", offset, size);
+        return 1;
+    }
+
+    return 0;
+}
+
+int
+main() {
+    size_t num_bad = 0;
+
+    printf("*** Testing flat sidecar files...");
+
+    // A swath like a MOD09 1 km granule, and a cover of some of its
+    // trixels.
+    GeoGrid grid(NUM_ROWS, NUM_COLS, SCAN_ROWS);
+    synthetic_swath(grid);
+    TrixelIndexer indexer(LEVEL, BUILD_LEVEL);
+    indexer.index(grid.lat().data(), grid.lon().data(), grid.size(), LEVEL, grid.index().data());
+    std::vector<unsigned long long> cover;
+    for (size_t k = 0; k < grid.size(); k += COVER_STEP)
+        cover.push_back(grid.index()[k]);
+
+    if (write_synthetic_sidecar(NC_FILE, BUILD_LEVEL, grid, VAR_NAME, cover, COVER_LEVEL) ||
+        FlatSidecar::fromNetcdf(NC_FILE, FLAT_FILE)) {
+        printf("can't write sidecars\n");
+        return ERR;
+    }
+    num_bad += check_flat(grid, cover);
+
+    // The flat sidecar converts back to a netCDF sidecar of the same
+    // values.
+    if (FlatSidecar::toNetcdf(FLAT_FILE, BACK_FILE, SidecarLayout())) {
+        printf("can't convert back to netCDF\n");
+        num_bad++;
+    } else {
+        num_bad += check_netcdf(BACK_FILE, grid, cover);
+    }
+
+    // Another version, another byte order, or a file cut short is
+    // refused. The version is after the eight byte magic, and the byte
+    // order mark after that.
+    num_bad += check_refused(8, SSC_FLAT_VERSION + 1, (size_t) -1);
+    num_bad += check_refused(12, 0xff, (size_t) -1);
+    num_bad += check_refused(0, 'X', (size_t) -1);
+    num_bad += check_refused(0, 'S', grid.size() * sizeof(unsigned long long));
+    FlatSidecar missing;
+    if (!missing.open("no_such_file.flat"))
+        num_bad++;
+
+    remove(NC_FILE);
+    remove(FLAT_FILE);
+    remove(BACK_FILE);
+    if (num_bad)
+        return ERR;
+
+    printf("ok!\n");
+    return 0;
+}
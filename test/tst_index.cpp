@@ -0,0 +1,213 @@
+/* This is a test file for the STAREmaster project. It checks that the
+ * STARE index of every point, however it is computed, is the one
+ * STARE::ValueFromLatLonDegrees() gives for that point:
+ *
+ * - a synthetic swath across the antimeridian, with TrixelIndexer
+ *   seeded and walking from the root;
+ * - 250 m points between its points, seeded and refined from the
+ *   trixels their neighbors share;
+ * - MOD05 5 km, each point starting from its neighbor's path;
+ * - the same points, each walked from the root;
+ * - MOD05 5 km, starting from a trixel lookup table;
+ * - MOD05 1 km, refined down from the 5 km trixels;
+ * - every grid of a MOD09GA tile.
+ *
+ * Only the location bits are compared, since the readers put an
+ * estimated resolution in the level bits.
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include "Modis05L2GeoFile.h"
+#include "Modis09GAGeoFile.h"
+#include "StarePool.h"
+#include "TrixelIndexer.h"
+#include "synthetic_swath.h"
+
+#define ERR 1
+
+#define LEVEL 27
+#define BUILD_LEVEL 5
+#define LUT_DIR "tst_index_lut"
+#define NUM_ROWS 40
+#define NUM_COLS 1354
+
+/**
+ * Check indices against the library.
+ *
+ * @param what Name of the case, for messages.
+ * @param lat Latitudes.
+ * @param lon Longitudes.
+ * @param index STARE indices of the points.
+ * @param n Number of points.
+ *
+ * @return 0 if all match, ERR otherwise.
+ */
+static int
+check(const char *what, const double *lat, const double *lon, const unsigned long long *index,
+      size_t n) {
+    STARE &stare = StarePool::get(LEVEL, BUILD_LEVEL);
+
+    if (!n) {
+        printf("%s: no points\n", what);
+        return ERR;
+    }
+    for (size_t k = 0; k < n; k++) {
+        unsigned long long expected = stare.ValueFromLatLonDegrees(lat[k], lon[k], LEVEL);
+        if ((index[k] & SSC_STARE_LOCATION_BITS) != (expected & SSC_STARE_LOCATION_BITS)) {
+            printf("%s: point %zu (%.17g, %.17g) is %llx, library gives %llx\n", what, k,
+                   lat[k], lon[k], index[k], expected);
+            return ERR;
+        }
+    }
+    return 0;
+}
+
+/** Check the indices of a grid against the library. */
+static int
+check(const char *what, const GeoGrid &grid) {
+    return check(what, &grid.lat()[0], &grid.lon()[0], &grid.index()[0], grid.size());
+}
+
+/**
+ * Index a synthetic swath shaped like a MOD09 1 km granule, and a
+ * 250 m grid interpolated across track from it, every way
+ * TrixelIndexer can.
+ *
+ * @return 0 if all match the library, ERR otherwise.
+ */
+static int
+check_swath() {
+    STARE &stare = StarePool::get(LEVEL, BUILD_LEVEL);
+    size_t n = (size_t) NUM_ROWS * NUM_COLS;
+    std::vector<double> lat(n), lon(n);
+    std::vector<unsigned long long> seeded_index(n), unseeded_index(n);
+
+    // A swath about 2330 km wide, tilted like a descending orbit, that
+    // crosses the antimeridian.
+    synthetic_swath(NUM_ROWS, NUM_COLS, 0, SYNTHETIC_SWATH_DATELINE_LON, &lat[0], &lon[0]);
+
+    TrixelIndexer seeded(LEVEL, BUILD_LEVEL);
+    TrixelIndexer unseeded(LEVEL, BUILD_LEVEL);
+    unseeded.set_seeded(false);
+    for (size_t row = 0; row < n; row += NUM_COLS) {
+        seeded.index(&lat[row], &lon[row], NUM_COLS, LEVEL, &seeded_index[row]);
+        unseeded.index(&lat[row], &lon[row], NUM_COLS, LEVEL, &unseeded_index[row]);
+    }
+    if (check("swath seeded", &lat[0], &lon[0], &seeded_index[0], n) ||
+        check("swath unseeded", &lat[0], &lon[0], &unseeded_index[0], n))
+        return ERR;
+
+    // Three 250 m points between each pair of 1 km points, like the
+    // MOD09 250 m grid, each hinted with the trixel its 1 km neighbors
+    // share.
+    size_t nf = 3 * n;
+    std::vector<double> fine_lat(nf), fine_lon(nf);
+    std::vector<unsigned long long> hint(nf), fine_seeded(nf), fine_refined(nf);
+    for (size_t k = 0; k < n; k++) {
+        size_t next = k % NUM_COLS == NUM_COLS - 1 ? k - 1 : k + 1;
+        double dlon = lon[next] - lon[k];
+        int common = stare_common_level(seeded_index[k], seeded_index[next]);
+        if (dlon > 180.0)
+            dlon -= 360.0;
+        else if (dlon < -180.0)
+            dlon += 360.0;
+        for (int q = 1; q < 4; q++) {
+            fine_lat[3 * k + q - 1] = lat[k] + q * (lat[next] - lat[k]) / 4.0;
+            fine_lon[3 * k + q - 1] = lon[k] + q * dlon / 4.0;
+            hint[3 * k + q - 1] = common < 0 ? SSC_STARE_NO_TRIXEL :
+                                  stare_truncate(seeded_index[k], common);
+        }
+    }
+
+    TrixelIndexer fine_indexer(LEVEL, BUILD_LEVEL);
+    TrixelIndexer refiner(LEVEL, BUILD_LEVEL);
+    for (size_t row = 0; row < nf; row += 3 * NUM_COLS) {
+        fine_indexer.index(&fine_lat[row], &fine_lon[row], 3 * NUM_COLS, LEVEL, &fine_seeded[row]);
+        refiner.refine(&fine_lat[row], &fine_lon[row], &hint[row], 3 * NUM_COLS, LEVEL,
+                       &fine_refined[row]);
+    }
+    if (check("250 m seeded", &fine_lat[0], &fine_lon[0], &fine_seeded[0], nf) ||
+        check("250 m refined", &fine_lat[0], &fine_lon[0], &fine_refined[0], nf))
+        return ERR;
+
+    // The library gives the level it is asked for.
+    for (size_t k = 0; k < n; k += 97)
+        if (seeded_index[k] != stare.ValueFromLatLonDegrees(lat[k], lon[k], LEVEL))
+            return ERR;
+
+    return 0;
+}
+
+int
+main() {
+    std::string mod05 = "data/MOD05_L2.A2005349.2125.061.2017294065400.hdf";
+    std::string mod09ga = "data/MOD09GA.A2020009.h00v08.006.2020011025435.hdf";
+
+    printf("*** Testing STARE indices of every point against the library...");
+
+    if (check_swath())
+        return ERR;
+
+    // 5 km, seeded from the neighboring point, as the reader does by
+    // default.
+    {
+        Modis05L2GeoFile gf;
+        if (gf.readFile(mod05, 0, BUILD_LEVEL, -1, false, 1))
+            return ERR;
+        if (check("MOD05 5 km", gf.geo_grid[0]))
+            return ERR;
+
+        // The same points, each walked from the root.
+        const GeoGrid &grid = gf.geo_grid[0];
+        std::vector<unsigned long long> unseeded(grid.size());
+        TrixelIndexer indexer(LEVEL, BUILD_LEVEL);
+        indexer.set_seeded(false);
+        indexer.index(&grid.lat()[0], &grid.lon()[0], grid.size(), LEVEL, &unseeded[0]);
+        if (check("MOD05 5 km unseeded", &grid.lat()[0], &grid.lon()[0], &unseeded[0],
+                  grid.size()))
+            return ERR;
+    }
+
+    // 5 km, starting from a lookup table. The table is built the
+    // first time, then used.
+    mkdir(LUT_DIR, 0755);
+    for (int pass = 0; pass < 2; pass++) {
+        Modis05L2GeoFile gf;
+        gf.lut_dir = LUT_DIR;
+        if (gf.readFile(mod05, 0, BUILD_LEVEL, -1, false, 1))
+            return ERR;
+        if (check("MOD05 5 km table", gf.geo_grid[0]))
+            return ERR;
+    }
+
+    // 1 km, refined from the 5 km trixels.
+    {
+        Modis05L2GeoFile gf;
+        gf.fine_grids = true;
+        if (gf.readFile(mod05, 0, BUILD_LEVEL, -1, false, 1))
+            return ERR;
+        if (gf.geo_grid.size() != 2)
+            return ERR;
+        if (check("MOD05 5 km", gf.geo_grid[0]) || check("MOD05 1 km refined", gf.geo_grid[1]))
+            return ERR;
+    }
+
+    // Every grid of a MOD09GA tile.
+    {
+        Modis09GAGeoFile gf;
+        if (gf.readFile(mod09ga, 0, BUILD_LEVEL, -1))
+            return ERR;
+        if (gf.geo_grid.empty())
+            return ERR;
+        for (size_t g = 0; g < gf.geo_grid.size(); g++)
+            if (check("MOD09GA", gf.geo_grid[g]))
+                return ERR;
+    }
+
+    printf("ok!\n");
+    return 0;
+}
@@ -0,0 +1,208 @@
+/* This is a test file for the STAREmaster project. It checks
+ * StareIntervalSet against a bitmap of level 6 trixels: the union,
+ * intersection and difference of random sets, containment of trixels
+ * from level 4 to 8, coarsening to level 4, turning sets into
+ * STARE_SpatialIntervals and back, and packing them into bytes and
+ * back. It also checks that batch containment agrees with one query
+ * at a time.
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include "ssc.h"
+#include "StareBits.h"
+#include "StareIntervalSet.h"
+
+#define ERR 1
+
+#define BITMAP_LEVEL 6
+#define NUM_TRIALS 200
+#define NUM_QUERIES 100000
+#define SEED 12345
+
+/** Number of trixels on the sphere at a level. */
+static unsigned long long
+num_trixels(int level) {
+    return (unsigned long long) SSC_STARE_NUM_FACES << 2 * level;
+}
+
+/** STARE index of trixel t at a level. */
+static unsigned long long
+trixel(unsigned long long t, int level) {
+    return (t << stare_digit_shift(level)) | (unsigned long long) level;
+}
+
+/**
+ * A random set of level 6 trixels, as a bitmap and as
+ * STARE_SpatialIntervals made of runs, coarser trixels and single
+ * trixels, in no particular order.
+ */
+static void
+random_set(std::vector<char> &bits, std::vector<unsigned long long> &values) {
+    unsigned long long n = num_trixels(BITMAP_LEVEL);
+    int num = rand() % 40;
+
+    bits.assign(n, 0);
+    values.clear();
+    for (int r = 0; r < num; r++) {
+        int level = rand() % (BITMAP_LEVEL + 1);
+        unsigned long long t = (unsigned long long) rand() % num_trixels(level);
+        unsigned long long first = t << 2 * (BITMAP_LEVEL - level);
+        unsigned long long last = first + (1ULL << 2 * (BITMAP_LEVEL - level)) - 1;
+
+        if (rand() % 2) {
+            // A run of level 6 trixels.
+            first = (unsigned long long) rand() % n;
+            last = std::min(n - 1, first + (unsigned long long) rand() % 200);
+            values.push_back(trixel(first, BITMAP_LEVEL));
+            values.push_back(stare_terminator(trixel(last, BITMAP_LEVEL)));
+        } else {
+            values.push_back(trixel(t, level));
+        }
+        for (unsigned long long k = first; k <= last; k++)
+            bits[k] = 1;
+    }
+}
+
+/** Do a set and a bitmap hold the same level 6 trixels? */
+static bool
+same(const StareIntervalSet &set, const std::vector<char> &bits) {
+    unsigned long long count = 0;
+
+    for (size_t k = 0; k < bits.size(); k++) {
+        if (set.contains(trixel(k, BITMAP_LEVEL)) != (bits[k] != 0))
+            return false;
+        count += bits[k];
+    }
+    return set.count() == count << 2 * (SSC_STARE_MAX_LEVEL - BITMAP_LEVEL);
+}
+
+int
+main() {
+    size_t num_queries = NUM_QUERIES;
+    size_t num_bad = 0;
+
+    printf("*** Testing STARE interval sets...");
+
+    srand(SEED);
+    for (int trial = 0; trial < NUM_TRIALS; trial++) {
+        std::vector<char> a_bits, b_bits, bits(num_trixels(BITMAP_LEVEL));
+        std::vector<unsigned long long> a_values, b_values, values;
+        std::vector<unsigned char> bytes;
+
+        random_set(a_bits, a_values);
+        random_set(b_bits, b_values);
+        StareIntervalSet a = StareIntervalSet::from_intervals(a_values);
+        StareIntervalSet b = StareIntervalSet::from_intervals(b_values);
+
+        if (!same(a, a_bits) || !same(b, b_bits)) {
+            printf("trial %d: set differs from its values\n", trial);
+            num_bad++;
+        }
+
+        for (size_t k = 0; k < bits.size(); k++)
+            bits[k] = a_bits[k] | b_bits[k];
+        if (!same(a.unite(b), bits) || a.unite(b) != b.unite(a)) {
+            printf("trial %d: bad union\n", trial);
+            num_bad++;
+        }
+        for (size_t k = 0; k < bits.size(); k++)
+            bits[k] = a_bits[k] & b_bits[k];
+        if (!same(a.intersect(b), bits) || a.intersect(b) != b.intersect(a)) {
+            printf("trial %d: bad intersection\n", trial);
+            num_bad++;
+        }
+        for (size_t k = 0; k < bits.size(); k++)
+            bits[k] = a_bits[k] & !b_bits[k];
+        if (!same(a.subtract(b), bits)) {
+            printf("trial %d: bad difference\n", trial);
+            num_bad++;
+        }
+
+        // Coarser and finer trixels are in the set when all of their
+        // level 6 trixels are, and meet it when any are.
+        for (int level = BITMAP_LEVEL - 2; level <= BITMAP_LEVEL + 2; level++) {
+            for (int q = 0; q < 50; q++) {
+                unsigned long long t = (unsigned long long) rand() % num_trixels(level);
+                bool all = true, any = false;
+                if (level <= BITMAP_LEVEL) {
+                    unsigned long long first = t << 2 * (BITMAP_LEVEL - level);
+                    for (unsigned long long k = first; k < first + (1ULL << 2 * (BITMAP_LEVEL - level)); k++) {
+                        all = all && a_bits[k];
+                        any = any || a_bits[k];
+                    }
+                } else {
+                    all = any = a_bits[t >> 2 * (level - BITMAP_LEVEL)] != 0;
+                }
+                if (a.contains(trixel(t, level)) != all || a.intersects(trixel(t, level)) != any) {
+                    printf("trial %d: bad containment at level %d\n", trial, level);
+                    num_bad++;
+                }
+            }
+        }
+
+        // A coarser set holds the trixels that meet the set.
+        const int coarse_level = BITMAP_LEVEL - 2;
+        StareIntervalSet coarse = a.coarsen(coarse_level);
+        for (unsigned long long t = 0; t < num_trixels(coarse_level); t++) {
+            if (coarse.contains(trixel(t, coarse_level)) != a.intersects(trixel(t, coarse_level))) {
+                printf("trial %d: bad coarsening\n", trial);
+                num_bad++;
+                break;
+            }
+        }
+
+        // Round trips through STARE_SpatialIntervals and bytes.
+        StareIntervalSet c;
+        a.intervals(values, BITMAP_LEVEL);
+        a.compress(bytes);
+        if (StareIntervalSet::from_intervals(values) != a || c.decompress(bytes.data(), bytes.size()) || c != a) {
+            printf("trial %d: bad round trip\n", trial);
+            num_bad++;
+        }
+        if (bytes.size() > 1) {
+            if (!c.decompress(bytes.data(), bytes.size() - 1) || !c.empty()) {
+                printf("trial %d: short bytes not rejected\n", trial);
+                num_bad++;
+            }
+            bytes.push_back(0);
+            if (!c.decompress(bytes.data(), bytes.size())) {
+                printf("trial %d: long bytes not rejected\n", trial);
+                num_bad++;
+            }
+        }
+    }
+
+    // Batch containment on a set of many short ranges agrees with
+    // one query at a time.
+    std::vector<unsigned long long> values, queries(num_queries);
+    for (int k = 0; k < 2000; k++) {
+        unsigned long long t = (unsigned long long) rand() % (num_trixels(12) - 64);
+        values.push_back(trixel(t, 12));
+        values.push_back(stare_terminator(trixel(t + rand() % 64, 12)));
+    }
+    StareIntervalSet set = StareIntervalSet::from_intervals(values);
+    for (size_t k = 0; k < num_queries; k++)
+        queries[k] = trixel((unsigned long long) rand() % num_trixels(14), 14);
+
+    std::vector<unsigned char> batch(num_queries);
+    set.contains(queries.data(), num_queries, batch.data());
+    for (size_t k = 0; k < num_queries; k++) {
+        if (batch[k] != set.contains(queries[k])) {
+            printf("batch containment differs\n");
+            num_bad++;
+            break;
+        }
+    }
+
+    if (num_bad) {
+        printf("%zu bad results\n", num_bad);
+        return ERR;
+    }
+
+    printf("ok!\n");
+    return 0;
+}
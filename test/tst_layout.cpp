@@ -0,0 +1,186 @@
+/* This is a test file for the STAREmaster project. It checks that the
+ * sidecar layout options are parsed and printed back the same, and
+ * that a synthetic MOD09 1 km granule written to a sidecar file with
+ * each of several chunking and compression layouts reads back what
+ * was written. The STARE index of a layout such as "stare,scan" is
+ * packed, and read back unpacked. Lat/lons kept as less than exact
+ * doubles are checked to be within their precision.
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <netcdf.h>
+#include "ssc.h"
+#include "GeoGrid.h"
+#include "SidecarFile.h"
+#include "TrixelIndexer.h"
+#include "synthetic_swath.h"
+
+#define ERR 1
+
+#define NUM_ROWS 2030
+#define NUM_COLS 1354
+#define SCAN_ROWS 10
+#define LEVEL 27
+#define BUILD_LEVEL 5
+#define FILE_NAME "tst_layout.nc"
+
+/** Parse a layout, as "compression,chunks[,precision]". */
+static int
+parse_layout(const std::string &spec, SidecarLayout &layout) {
+    size_t comma = spec.find(',');
+
+    if (comma == std::string::npos)
+        return SSC_EINPUT;
+    size_t geo = spec.find(',', comma + 1);
+    if (layout.set_codec(spec.substr(0, comma)) ||
+        layout.set_chunks(spec.substr(comma + 1, geo == std::string::npos ? geo : geo - comma - 1)))
+        return SSC_EINPUT;
+    if (geo != std::string::npos && layout.set_geo(spec.substr(geo + 1)))
+        return SSC_EINPUT;
+    return 0;
+}
+
+/** Is a lat/lon read back within the precision of the layout? */
+static bool
+geo_ok(const SidecarLayout &layout, double read, double written) {
+    double tolerance = 0.0;
+
+    if (layout.geo_type() == NC_FLOAT)
+        tolerance = std::fabs(written) * 1.2e-7;
+    if (layout.geo_digits())
+        tolerance = std::max(tolerance, std::fabs(written) * std::pow(10.0, 1 - layout.geo_digits()));
+    return std::fabs(read - written) <= tolerance;
+}
+
+/**
+ * Write the grid with a layout, then read it back a scan at a time.
+ *
+ * @return the number of values read back wrong, or 1 if the file
+ * can't be written or read.
+ */
+static size_t
+check_layout(const SidecarLayout &layout, const GeoGrid &grid) {
+    SidecarFile sf;
+    std::vector<std::string> var_name(1, "1km Surface Reflectance Band 1");
+    std::vector<unsigned long long> index((size_t) SCAN_ROWS * NUM_COLS);
+    std::vector<double> lat((size_t) SCAN_ROWS * NUM_COLS);
+    size_t num_bad = 0;
+    int ncid, index_varid, lat_varid;
+
+    if (sf.createFile(FILE_NAME, 0, NULL))
+        return 1;
+    sf.setLayout(layout);
+    if (sf.writeSTAREIndex(0, BUILD_LEVEL, grid, var_name, "1km"))
+        return 1;
+    if (sf.close_file())
+        return 1;
+
+    if (nc_open(FILE_NAME, NC_NOWRITE, &ncid) ||
+        nc_inq_varid(ncid, "STARE_index_1km", &index_varid) ||
+        nc_inq_varid(ncid, "Latitude_1km", &lat_varid))
+        return 1;
+    for (int scan = 0; scan < NUM_ROWS / SCAN_ROWS; scan++) {
+        size_t start_row[2] = {(size_t) scan * SCAN_ROWS, 0};
+        size_t count[2] = {SCAN_ROWS, NUM_COLS};
+
+        if (SidecarFile::readSTAREIndex(ncid, index_varid, start_row[0], count[0], &index[0]) ||
+            nc_get_vara_double(ncid, lat_varid, start_row, count, &lat[0]))
+            return 1;
+        size_t first = start_row[0] * NUM_COLS;
+        for (size_t k = 0; k < index.size(); k++)
+            if (index[k] != grid.index()[first + k] || !geo_ok(layout, lat[k], grid.lat()[first + k]))
+                num_bad++;
+    }
+    if (nc_close(ncid))
+        return 1;
+    remove(FILE_NAME);
+
+    if (num_bad)
+        printf("%s: %zu bad values\n", layout.str().c_str(), num_bad);
+    return num_bad;
+}
+
+int
+main() {
+    const char *layouts[] = {"deflate:3,scan", "none,scan", "deflate:1,scan", "deflate:6,scan",
+                             "zstd:3,scan", "zstd:9,scan", "deflate:3,10", "deflate:3,2030",
+                             "stare,scan", "stare+none,scan", "deflate:3,scan,float",
+                             "deflate:3,scan,double:6", "deflate:3,scan,float:5"};
+    size_t num_bad = 0;
+
+    printf("*** Testing sidecar chunking and compression layouts...");
+
+    // The options are printed back as they were given, and bad ones
+    // are refused.
+    SidecarLayout check;
+    const char *bad[] = {"gzip", "deflate:0", "deflate:10", "deflate:", "none:1", "zstd:23",
+                         "stare:1", "stare+", "stare+stare", "stare+gzip"};
+    for (size_t b = 0; b < sizeof(bad) / sizeof(bad[0]); b++) {
+        if (!check.set_codec(bad[b])) {
+            printf("accepted compression %s\n", bad[b]);
+            num_bad++;
+        }
+    }
+    if (!check.set_chunks("0") || !check.set_chunks("10x") || !check.set_chunks("x10") ||
+        check.set_chunks("40x1354") || check.set_codec("deflate:5") || check.str() != "deflate:5,40x1354" ||
+        check.set_codec("stare+none") || check.str() != "stare+none,40x1354" || !check.pack_index()) {
+        printf("chunks or compression parsed wrong, %s\n", check.str().c_str());
+        num_bad++;
+    }
+    const char *bad_geo[] = {"single", "double:0", "double:16", "float:8", "float:", "float5"};
+    for (size_t b = 0; b < sizeof(bad_geo) / sizeof(bad_geo[0]); b++) {
+        if (!check.set_geo(bad_geo[b])) {
+            printf("accepted lat/lon precision %s\n", bad_geo[b]);
+            num_bad++;
+        }
+    }
+    if (check.set_geo("float") || check.str() != "stare+none,40x1354,float" ||
+        check.geo_type() != NC_FLOAT || check.geo_digits() ||
+        check.set_geo("double") || check.str() != "stare+none,40x1354") {
+        printf("lat/lon precision parsed wrong, %s\n", check.str().c_str());
+        num_bad++;
+    }
+
+    // The default chunks are whole scans of at least SSC_CHUNK_BYTES.
+    size_t chunks[2];
+    SidecarLayout().index_chunks(NUM_ROWS, NUM_COLS, SCAN_ROWS, chunks);
+    if (chunks[0] % SCAN_ROWS || chunks[0] * NUM_COLS * sizeof(double) < SSC_CHUNK_BYTES ||
+        (chunks[0] - SCAN_ROWS) * NUM_COLS * sizeof(double) >= SSC_CHUNK_BYTES ||
+        chunks[1] != NUM_COLS) {
+        printf("default chunks %zux%zu\n", chunks[0], chunks[1]);
+        num_bad++;
+    }
+
+    // A swath like a MOD09 1 km granule.
+    GeoGrid grid(NUM_ROWS, NUM_COLS, SCAN_ROWS);
+    synthetic_swath(grid);
+    TrixelIndexer indexer(LEVEL, BUILD_LEVEL);
+    indexer.index(grid.lat().data(), grid.lon().data(), grid.size(), LEVEL, grid.index().data());
+
+    for (size_t s = 0; s < sizeof(layouts) / sizeof(layouts[0]); s++) {
+        std::string spec = layouts[s];
+        SidecarLayout layout;
+        if (parse_layout(spec, layout)) {
+            // Without zstd or quantize in netCDF-C, the layouts that
+            // need them are left out.
+            if (spec.compare(0, 4, "zstd") && spec.find(",double:") == std::string::npos &&
+                spec.find(",float:") == std::string::npos) {
+                printf("bad layout %s\n", spec.c_str());
+                num_bad++;
+            }
+            continue;
+        }
+        num_bad += check_layout(layout, grid);
+    }
+
+    if (num_bad)
+        return ERR;
+
+    printf("ok!\n");
+    return 0;
+}
@@ -0,0 +1,169 @@
+/* This is a test file for the STAREmaster project. It walks the
+ * perimeter of a synthetic swath shaped like a MOD05 5 km granule
+ * with PerimeterWalker, with and without a tolerance, and checks that
+ * without a tolerance the perimeter is the one the readers have always
+ * walked, that adding the rows in blocks gives the same perimeter, and
+ * that every point dropped with a tolerance is within it of the
+ * perimeter kept.
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "STARE.h"
+#include "PerimeterWalker.h"
+
+#define ERR 1
+
+#define NUM_ROWS 406
+#define NUM_COLS 270
+#define BLOCK_ROWS 20
+#define TOLERANCE 0.01
+#define DEG_TO_RAD 1.74532925199432957692e-02
+
+/** Unit vector of a lat/lon. */
+static void
+unit(double lat, double lon, double v[3]) {
+    v[0] = cos(lat * DEG_TO_RAD) * cos(lon * DEG_TO_RAD);
+    v[1] = cos(lat * DEG_TO_RAD) * sin(lon * DEG_TO_RAD);
+    v[2] = sin(lat * DEG_TO_RAD);
+}
+
+/** Angle in degrees from point p to the great circle through a and b. */
+static double
+off_arc(double plat, double plon, double alat, double alon, double blat, double blon) {
+    double p[3], a[3], b[3], n[3];
+    unit(plat, plon, p);
+    unit(alat, alon, a);
+    unit(blat, blon, b);
+    n[0] = a[1] * b[2] - a[2] * b[1];
+    n[1] = a[2] * b[0] - a[0] * b[2];
+    n[2] = a[0] * b[1] - a[1] * b[0];
+    double norm = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    return asin(fabs(p[0] * n[0] + p[1] * n[1] + p[2] * n[2]) / norm) / DEG_TO_RAD;
+}
+
+/**
+ * The perimeter as Modis05L2GeoFile::readFile() walked it before
+ * PerimeterWalker, filled from the end with duplicates and all.
+ */
+static void
+old_walk(const std::vector<double> &lat, const std::vector<double> &lon, int stride,
+         LatLonDegrees64ValueVector &perimeter) {
+    const int A = NUM_ROWS, C = NUM_COLS;
+    int pk = 2 * A + 2 * C - 4 - 1;
+    perimeter.resize(2 * A + 2 * C - 4);
+#define PUT(i, j) do { perimeter[pk].lat = lat[(size_t) (i) * C + (j)]; \
+        perimeter[pk].lon = lon[(size_t) (i) * C + (j)]; --pk; } while (0)
+    for (int j = 0; j < C; j += stride) {
+        PUT(0, j);
+        if (stride > 1 && j + stride >= C) PUT(0, C - 1);
+    }
+    for (int i = 1; i < A; i += stride) {
+        PUT(i, C - 1);
+        if (stride > 1 && i + stride >= A) PUT(A - 1, C - 1);
+    }
+    for (int j = C - 2; j > -1; j -= stride) {
+        PUT(A - 1, j);
+        if (stride > 1 && j - stride < 0) PUT(A - 1, 0);
+    }
+    for (int i = A - 2; i > 0; i -= stride) {
+        PUT(i, 0);
+        if (stride > 1 && i - stride < 0) PUT(0, 0);
+    }
+#undef PUT
+    if (stride > 1) {
+        int i = 0;
+        for (int k = pk + 1; k < 2 * A + 2 * C - 4; ++k)
+            perimeter[i++] = perimeter[k];
+        perimeter.resize(i);
+    }
+}
+
+/** Are two perimeters the same points in the same order? */
+static bool
+same(const LatLonDegrees64ValueVector &a, const LatLonDegrees64ValueVector &b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t k = 0; k < a.size(); k++)
+        if (a[k].lat != b[k].lat || a[k].lon != b[k].lon)
+            return false;
+    return true;
+}
+
+int
+main() {
+    size_t n = (size_t) NUM_ROWS * NUM_COLS;
+    std::vector<double> lat(n), lon(n);
+    const int strides[] = {1, 3, 10};
+
+    printf("*** Testing walking swath perimeters...");
+
+    // A swath that bends along track, with edges that bow out across
+    // track, and crosses the antimeridian.
+    for (int i = 0; i < NUM_ROWS; i++) {
+        for (int j = 0; j < NUM_COLS; j++) {
+            size_t k = (size_t) i * NUM_COLS + j;
+            double across = (j - NUM_COLS / 2) * 0.08;
+            lat[k] = 40.0 - i * 0.045 + across * 0.2 + 0.002 * across * across;
+            lon[k] = 175.0 + across - i * 0.01 + 2.0 * sin(i * 0.01);
+            if (lon[k] > 180.0)
+                lon[k] -= 360.0;
+        }
+    }
+
+    for (size_t s = 0; s < sizeof(strides) / sizeof(strides[0]); s++) {
+        int stride = strides[s];
+        LatLonDegrees64ValueVector old, full, blocked, simple;
+
+        // Without a tolerance, the perimeter the readers always used.
+        old_walk(lat, lon, stride, old);
+        PerimeterWalker walker(NUM_ROWS, NUM_COLS, stride, 0.0);
+        walker.add_rows(&lat[0], &lon[0], 0, NUM_ROWS);
+        walker.perimeter(full);
+        if (!same(full, old)) {
+            printf("stride %d: perimeter of %zu points, wanted %zu\n", stride, full.size(), old.size());
+            return ERR;
+        }
+
+        // The rows a block at a time, with a tolerance.
+        PerimeterWalker adaptive(NUM_ROWS, NUM_COLS, stride, TOLERANCE);
+        PerimeterWalker blocks(NUM_ROWS, NUM_COLS, stride, TOLERANCE);
+        adaptive.add_rows(&lat[0], &lon[0], 0, NUM_ROWS);
+        for (int i = 0; i < NUM_ROWS; i += BLOCK_ROWS) {
+            size_t row = (size_t) i * NUM_COLS;
+            blocks.add_rows(&lat[row], &lon[row], i, std::min(BLOCK_ROWS, NUM_ROWS - i));
+        }
+        adaptive.perimeter(simple);
+        blocks.perimeter(blocked);
+        if (!same(blocked, simple)) {
+            printf("stride %d: perimeter depends on blocks\n", stride);
+            return ERR;
+        }
+
+        // Each point of the full perimeter is within the tolerance of
+        // the side of the simple one it falls between.
+        size_t m = simple.size(), kept = 0;
+        double worst = 0.0;
+        for (size_t k = 0; k < full.size() && m > 1; k++) {
+            if (full[k].lat == simple[kept % m].lat && full[k].lon == simple[kept % m].lon) {
+                kept++;
+                continue;
+            }
+            if (!kept)
+                continue;
+            const LatLonDegrees64 &a = simple[(kept - 1) % m], &b = simple[kept % m];
+            worst = std::max(worst, off_arc(full[k].lat, full[k].lon, a.lat, a.lon, b.lat, b.lon));
+        }
+        if (kept != m || worst > TOLERANCE) {
+            printf("stride %d: %zu of %zu points kept in order, worst %g degrees off\n",
+                   stride, kept, m, worst);
+            return ERR;
+        }
+    }
+
+    printf("ok!\n");
+    return 0;
+}
@@ -0,0 +1,162 @@
+/* This is a test file for the STAREmaster project. It checks the 2-D
+ * resolution estimate on a synthetic swath shaped like a MOD09 1 km
+ * granule: each level must match a direct computation from the great
+ * circle distances to the neighbors, the overlap of scans (the bow
+ * tie) must not make points look finer, only the level bits may
+ * change, points without geolocation must be left alone, and the
+ * result must not depend on the number of threads.
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "ssc.h"
+#include "StareBits.h"
+#include "SpatialResolution.h"
+
+#define ERR 1
+
+#define NUM_ROWS 2030
+#define NUM_COLS 1354
+#define SCAN_ROWS 10
+#define NUM_THREADS 4
+#define PI 3.14159265358979323846
+
+/**
+ * A swath with rows about 1 km apart, columns that spread out toward
+ * the edges of the swath as MODIS pixels do, scans that overlap so
+ * the first row of each is 0.3 km from the last row of the one before,
+ * and a crossing of the antimeridian.
+ */
+static void
+swath_point(int row, int col, double &lat, double &lon) {
+    double scan = row / SCAN_ROWS, r = row % SCAN_ROWS;
+    double x = (col - NUM_COLS / 2) / (double) (NUM_COLS / 2);
+    double across = x * (NUM_COLS / 2) * (1.0 + 0.8 * x * x);
+
+    lat = 50.0 - (scan * (SCAN_ROWS - 0.7) + r) * 0.009;
+    lon = 179.0 + across * 0.009 / std::cos(lat * PI / 180.0);
+    if (lon > 180.0)
+        lon -= 360.0;
+}
+
+/** Angle in radians between two points. */
+static double
+angle(double lat0, double lon0, double lat1, double lon1) {
+    double a0 = lat0 * PI / 180.0, b0 = lon0 * PI / 180.0;
+    double a1 = lat1 * PI / 180.0, b1 = lon1 * PI / 180.0;
+    double x0 = std::cos(a0) * std::cos(b0), y0 = std::cos(a0) * std::sin(b0), z0 = std::sin(a0);
+    double x1 = std::cos(a1) * std::cos(b1), y1 = std::cos(a1) * std::sin(b1), z1 = std::sin(a1);
+    double cx = y0 * z1 - z0 * y1, cy = z0 * x1 - x0 * z1, cz = x0 * y1 - y0 * x1;
+
+    return std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), x0 * x1 + y0 * y1 + z0 * z1);
+}
+
+/**
+ * The level a point should get, from the largest step to a neighbor
+ * in its row or scan, as a real number. Negative if it has none.
+ */
+static double
+want_level(const std::vector<double> &lat, const std::vector<double> &lon, int i, int j) {
+    const int di[4] = {-1, 1, 0, 0}, dj[4] = {0, 0, -1, 1};
+    double step = 0.0;
+
+    for (int n = 0; n < 4; n++) {
+        int i1 = i + di[n], j1 = j + dj[n];
+        if (i1 < 0 || i1 >= NUM_ROWS || j1 < 0 || j1 >= NUM_COLS || i1 / SCAN_ROWS != i / SCAN_ROWS)
+            continue;
+        size_t k0 = (size_t) i * NUM_COLS + j, k1 = (size_t) i1 * NUM_COLS + j1;
+        if (lat[k1] == SSC_GEO_FILL)
+            continue;
+        step = std::max(step, angle(lat[k0], lon[k0], lat[k1], lon[k1]));
+    }
+
+    return step > 0.0 ? std::log2(PI / 2 / step) : -1.0;
+}
+
+int
+main() {
+    size_t n = (size_t) NUM_ROWS * NUM_COLS;
+    std::vector<double> lat(n), lon(n);
+    std::vector<unsigned long long> index(n), serial(n);
+    size_t num_bad = 0;
+    int finest = 0, finest_serial;
+
+    printf("*** Testing the 2-D resolution estimate...");
+
+    for (int i = 0; i < NUM_ROWS; i++)
+        for (int j = 0; j < NUM_COLS; j++)
+            swath_point(i, j, lat[(size_t) i * NUM_COLS + j], lon[(size_t) i * NUM_COLS + j]);
+
+    // A few pixels without geolocation.
+    for (size_t k = 12345; k < n; k += 100003)
+        lat[k] = lon[k] = SSC_GEO_FILL;
+
+    // Any location bits will do, as long as they come back unchanged.
+    std::vector<unsigned long long> input(n);
+    for (size_t k = 0; k < n; k++)
+        input[k] = ((k * 0x9e3779b97f4a7c15ULL) & SSC_STARE_LOCATION_BITS) | SSC_STARE_MAX_LEVEL;
+
+    std::copy(input.begin(), input.end(), index.begin());
+    finest = estimate_resolution(&lat[0], &lon[0], NUM_ROWS, NUM_COLS, SCAN_ROWS, &index[0],
+                                 NUM_THREADS);
+
+    std::copy(input.begin(), input.end(), serial.begin());
+    finest_serial = estimate_resolution(&lat[0], &lon[0], NUM_ROWS, NUM_COLS, SCAN_ROWS,
+                                        &serial[0], 1);
+    if (finest != finest_serial || index != serial) {
+        printf("result depends on the number of threads\n");
+        num_bad++;
+    }
+
+    int want_finest = 0;
+    for (int i = 0; i < NUM_ROWS; i++) {
+        for (int j = 0; j < NUM_COLS; j++) {
+            size_t k = (size_t) i * NUM_COLS + j;
+            int want;
+
+            if ((index[k] & ~SSC_STARE_LEVEL_MASK) != (input[k] & ~SSC_STARE_LEVEL_MASK)) {
+                if (num_bad < 10)
+                    printf("location bits of (%d, %d) changed\n", i, j);
+                num_bad++;
+                continue;
+            }
+            if (lat[k] == SSC_GEO_FILL) {
+                want = SSC_STARE_MAX_LEVEL;
+            } else {
+                double level = want_level(lat, lon, i, j);
+                // Too close to call between two levels.
+                if (std::fabs(level - std::floor(level + 0.5)) < 1e-9)
+                    continue;
+                if (level < 0.0) {
+                    want = SSC_STARE_MAX_LEVEL;
+                } else {
+                    want = std::min(std::max((int) std::floor(level), 0), SSC_STARE_MAX_LEVEL);
+                    want_finest = std::max(want_finest, want);
+                }
+            }
+            if (stare_level(index[k]) != want) {
+                if (num_bad < 10)
+                    printf("point (%d, %d): level %d, wanted %d\n", i, j, stare_level(index[k]), want);
+                num_bad++;
+            }
+        }
+    }
+
+    // Rows 1 km apart, so no point is finer than level 13, however
+    // close the overlapping scans come.
+    if (finest != want_finest || finest != 13) {
+        printf("finest level %d, wanted %d\n", finest, want_finest);
+        num_bad++;
+    }
+
+    if (num_bad) {
+        printf("%zu bad points\n", num_bad);
+        return ERR;
+    }
+
+    printf("ok!\n");
+    return 0;
+}
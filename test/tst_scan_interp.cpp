@@ -0,0 +1,130 @@
+/* This is a test file for the STAREmaster project. It checks
+ * ScanInterpolator on a synthetic swath shaped like a MOD09 1 km
+ * granule, interpolating to 500 m and 250 m, and on one shaped like a
+ * MOD05 5 km granule, interpolating to 1 km: a lat/lon field that is
+ * linear within each scan must come back exactly, the swath crosses
+ * the antimeridian, 5 km points must land unchanged on the 1 km pixels
+ * at their centers, and pixels without geolocation must give fill
+ * values.
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include "ssc.h"
+#include "ScanInterpolator.h"
+
+#define ERR 1
+
+#define NUM_ROWS 2030
+#define NUM_COLS 1354
+#define SCAN_ROWS 10
+#define MOD05_ROWS 406
+#define MOD05_COLS 270
+#define MOD05_SCAN_ROWS 2
+#define TOLERANCE 1e-9
+
+/** A swath that is linear in row and column within each scan, and
+ * crosses the antimeridian. Rows and columns may be fractional. */
+static void
+swath_point(double scan, double row, double col, double &lat, double &lon) {
+    lat = 40.0 - scan * 0.09 - row * 0.011 + col * 0.003;
+    lon = 170.0 + col * 0.0155 - scan * 0.02 - row * 0.001;
+    if (lon > 180.0)
+        lon -= 360.0;
+}
+
+/** Distance in degrees between two longitudes, the short way. */
+static double
+lon_diff(double a, double b) {
+    double d = std::fabs(a - b);
+    return d > 180.0 ? 360.0 - d : d;
+}
+
+/**
+ * Interpolate a whole swath and check it against the analytic field.
+ *
+ * @return number of points that are wrong.
+ */
+static size_t
+check_swath(int rows, int cols, int scan_rows, int factor, int fine_cols, const char *name) {
+    ScanInterpolator interp(rows, cols, scan_rows, factor, fine_cols);
+    int fine_rows = interp.fine_rows();
+    std::vector<double> lat((size_t) rows * cols), lon((size_t) rows * cols);
+    std::vector<double> fine_lat((size_t) fine_rows * fine_cols), fine_lon((size_t) fine_rows * fine_cols);
+    double offset = (factor - 1) / 2.0;
+    size_t num_bad = 0;
+
+    for (int i = 0; i < rows; i++)
+        for (int j = 0; j < cols; j++)
+            swath_point(i / scan_rows, i % scan_rows, j, lat[(size_t) i * cols + j],
+                        lon[(size_t) i * cols + j]);
+
+    interp.interpolate(&lat[0], &lon[0], 0, 0, fine_rows, &fine_lat[0], &fine_lon[0]);
+
+    for (int q = 0; q < fine_rows; q++) {
+        int scan = q / (scan_rows * factor);
+        double row = (q - offset) / factor - scan * scan_rows;
+        for (int p = 0; p < fine_cols; p++) {
+            size_t k = (size_t) q * fine_cols + p;
+            double want_lat, want_lon;
+            swath_point(scan, row, (p - offset) / factor, want_lat, want_lon);
+            if (std::fabs(fine_lat[k] - want_lat) > TOLERANCE ||
+                lon_diff(fine_lon[k], want_lon) > TOLERANCE || std::fabs(fine_lon[k]) > 180.0) {
+                if (num_bad < 10)
+                    printf("%s: bad point (%d, %d): %.12f %.12f, wanted %.12f %.12f\n", name, q, p,
+                           fine_lat[k], fine_lon[k], want_lat, want_lon);
+                num_bad++;
+            }
+        }
+    }
+
+    // Coarse points at the centers of whole fine pixels come through
+    // unchanged.
+    if (factor % 2) {
+        for (int i = 0; i < rows; i++) {
+            for (int j = 0; j < cols; j++) {
+                size_t k = (size_t) (factor * i + (int) offset) * fine_cols + factor * j + (int) offset;
+                if (fine_lat[k] != lat[(size_t) i * cols + j] || fine_lon[k] != lon[(size_t) i * cols + j]) {
+                    if (num_bad < 10)
+                        printf("%s: coarse point (%d, %d) changed\n", name, i, j);
+                    num_bad++;
+                }
+            }
+        }
+    }
+
+    return num_bad;
+}
+
+int
+main() {
+    size_t num_bad = 0;
+
+    printf("*** Testing the scan geometry interpolation...");
+
+    num_bad += check_swath(NUM_ROWS, NUM_COLS, SCAN_ROWS, 2, 2 * NUM_COLS, "1km to 500m");
+    num_bad += check_swath(NUM_ROWS, NUM_COLS, SCAN_ROWS, 4, 4 * NUM_COLS, "1km to 250m");
+    num_bad += check_swath(MOD05_ROWS, MOD05_COLS, MOD05_SCAN_ROWS, 5, 1354, "5km to 1km");
+    if (num_bad)
+        return ERR;
+
+    // A pixel without geolocation spoils only the fine pixels
+    // interpolated from it.
+    {
+        ScanInterpolator interp(SCAN_ROWS, 4, SCAN_ROWS, 4, 16);
+        std::vector<double> lat(SCAN_ROWS * 4), lon(SCAN_ROWS * 4);
+        std::vector<double> fine_lat(40 * 16), fine_lon(40 * 16);
+        for (int k = 0; k < SCAN_ROWS * 4; k++)
+            swath_point(0, k / 4, k % 4, lat[k], lon[k]);
+        lat[0] = lon[0] = SSC_GEO_FILL;
+        interp.interpolate(&lat[0], &lon[0], 0, 0, 40, &fine_lat[0], &fine_lon[0]);
+        if (fine_lat[0] != SSC_GEO_FILL || fine_lon[0] != SSC_GEO_FILL ||
+            fine_lat[39 * 16 + 15] == SSC_GEO_FILL)
+            return ERR;
+    }
+
+    printf("ok!\n");
+    return 0;
+}
@@ -0,0 +1,106 @@
+/* This is a test file for the STAREmaster project. It computes the
+ * geolocation of tiles of the MODIS sinusoidal grid, with one thread
+ * and with several, and checks that each pixel projects back to its
+ * center, that exactly the pixels off the sphere are fill, and that
+ * the tiles fill the bounds in the MODLAND table.
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "ssc.h"
+#include "SinusoidalGrid.h"
+
+#define ERR 1
+
+#define RADIUS 6371007.181
+#define TILE_SIZE 1111950.5196666666
+#define DEG_TO_RAD 1.74532925199432957692e-02
+#define MAX_PIXEL_ERR 1e-6 /**< Pixels a center may project back off by. */
+#define NUM_THREADS 4
+
+/** Check one tile at 1 km. Returns the number of bad pixels. */
+static size_t
+check_tile(int h, int v, int threads) {
+    const size_t n = SSC_SIN_1KM;
+    std::vector<double> lat(n * n), lon(n * n);
+    double bounds[4], found[4] = {180.0, -180.0, 90.0, -90.0};
+    size_t num_bad = 0, num_fill = 0;
+
+    if (sinusoidal_tile_geolocation(h, v, n, &lat[0], &lon[0], threads))
+        return n * n;
+
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = 0; j < n; j++) {
+            size_t k = i * n + j;
+            double x = -20015109.354 + h * TILE_SIZE + (j + 0.5) * TILE_SIZE / n;
+            double y = 10007554.677 - v * TILE_SIZE - (i + 0.5) * TILE_SIZE / n;
+            bool off = std::fabs(x) > M_PI * RADIUS * std::cos(y / RADIUS);
+
+            if (lat[k] == SSC_GEO_FILL || lon[k] == SSC_GEO_FILL) {
+                num_fill++;
+                if (!off || lat[k] != lon[k])
+                    num_bad++;
+                continue;
+            }
+
+            // Project back, and find the pixel.
+            double px = (RADIUS * lon[k] * DEG_TO_RAD * std::cos(lat[k] * DEG_TO_RAD) -
+                         x) / (TILE_SIZE / n);
+            double py = (RADIUS * lat[k] * DEG_TO_RAD - y) / (TILE_SIZE / n);
+            if (off || std::fabs(px) > MAX_PIXEL_ERR || std::fabs(py) > MAX_PIXEL_ERR)
+                num_bad++;
+            found[0] = std::min(found[0], lon[k]);
+            found[1] = std::max(found[1], lon[k]);
+            found[2] = std::min(found[2], lat[k]);
+            found[3] = std::max(found[3], lat[k]);
+        }
+    }
+
+    if (sinusoidal_tile_bounds(h, v, bounds)) {
+        if (num_fill != n * n)
+            num_bad++;
+    } else {
+        // The table bounds are out past the pixel edges by up to about
+        // two 1 km pixels, so the centers are within three of them; a
+        // pixel widens in longitude toward the poles.
+        double pixel = 3 * 10.0 / n;
+        double pixel_lon = pixel / std::cos(std::max(std::fabs(bounds[2]), std::fabs(bounds[3])) *
+                                            DEG_TO_RAD);
+        for (int b = 0; b < 4; b++)
+            if (std::fabs(found[b] - bounds[b]) > (b < 2 ? pixel_lon : pixel))
+                num_bad++;
+    }
+    if (num_bad)
+        printf("h%02dv%02d: %zu bad pixels, %zu fill, lon %g to %g, lat %g to %g\n", h, v, num_bad,
+               num_fill, found[0], found[1], found[2], found[3]);
+
+    return num_bad;
+}
+
+int
+main() {
+    const int tiles[][2] = {{0, 8}, {8, 5}, {17, 8}, {18, 9}, {35, 9}, {29, 3}, {15, 0}, {0, 0}};
+    double bounds[4];
+
+    printf("*** Testing the MODIS sinusoidal grid geolocation...");
+
+    // The table has no tiles outside the grid, or wholly off the sphere.
+    if (sinusoidal_tile_bounds(36, 0, bounds) != SSC_EINPUT ||
+        sinusoidal_tile_bounds(0, 18, bounds) != SSC_EINPUT ||
+        sinusoidal_tile_bounds(0, 0, bounds) != SSC_EINPUT) {
+        printf("bounds of tiles that are not there\n");
+        return ERR;
+    }
+
+    // Each tile with one thread, and with several.
+    for (size_t t = 0; t < sizeof(tiles) / sizeof(tiles[0]); t++)
+        if (check_tile(tiles[t][0], tiles[t][1], 1) ||
+            check_tile(tiles[t][0], tiles[t][1], NUM_THREADS))
+            return ERR;
+
+    printf("ok!\n");
+    return 0;
+}
@@ -0,0 +1,136 @@
+/* This is a test file for the STAREmaster project. It packs the
+ * STARE indices of a synthetic MOD09 1 km granule with the codec of
+ * PackedStareIndex, and checks that the indices, and arrays of every
+ * kind of value the codec treats apart, round trip, that a run of rows
+ * unpacks alone, and that packed rows that are not valid are refused.
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include "ssc.h"
+#include "StareBits.h"
+#include "PackedStareIndex.h"
+#include "TrixelIndexer.h"
+#include "synthetic_swath.h"
+
+#define ERR 1
+
+#define NUM_ROWS 2030
+#define NUM_COLS 1354
+#define LEVEL 27
+#define BUILD_LEVEL 5
+
+/** Pack and unpack an array, and count the values that come back wrong. */
+static size_t
+round_trip(const std::vector<unsigned long long> &index, size_t num_i, size_t num_j,
+           const char *what) {
+    PackedStareIndex packed = PackedStareIndex::pack(index.data(), num_i, num_j);
+    std::vector<unsigned long long> out;
+    size_t num_bad = 0;
+
+    if (packed.num_i() != num_i || packed.num_j() != num_j || packed.unpack(out))
+        num_bad = index.size();
+    else
+        for (size_t k = 0; k < index.size(); k++)
+            if (out[k] != index[k])
+                num_bad++;
+    if (num_bad)
+        printf("%s: %zu bad values\n", what, num_bad);
+
+    return num_bad;
+}
+
+int
+main() {
+    std::vector<unsigned long long> index((size_t) NUM_ROWS * NUM_COLS);
+    std::vector<double> lat(index.size()), lon(index.size());
+    size_t num_bad = 0;
+
+    printf("*** Testing packing STARE indices...");
+
+    // A swath like a MOD09 1 km granule.
+    synthetic_swath(NUM_ROWS, NUM_COLS, 0, SYNTHETIC_SWATH_LON, lat.data(), lon.data());
+    TrixelIndexer indexer(LEVEL, BUILD_LEVEL);
+    indexer.index(lat.data(), lon.data(), index.size(), LEVEL, index.data());
+    num_bad += round_trip(index, NUM_ROWS, NUM_COLS, "swath");
+
+    PackedStareIndex packed = PackedStareIndex::pack(index.data(), NUM_ROWS, NUM_COLS);
+    std::vector<unsigned long long> out(index.size());
+
+    // A run of rows unpacks alone, and rows outside are refused.
+    std::vector<unsigned long long> rows(10 * NUM_COLS);
+    if (packed.unpack_rows(1000, 10, rows.data()) ||
+        !std::equal(rows.begin(), rows.end(), index.begin() + 1000 * NUM_COLS)) {
+        printf("rows 1000 to 1009 unpacked wrong\n");
+        num_bad++;
+    }
+    if (!packed.unpack_rows(NUM_ROWS - 5, 10, rows.data())) {
+        printf("unpacked rows past the end\n");
+        num_bad++;
+    }
+
+    // Rows packed in blocks are the same as rows packed at once.
+    PackedStareIndex blocks(NUM_COLS);
+    for (int i = 0; i < NUM_ROWS; i += 10)
+        blocks.append_rows(&index[(size_t) i * NUM_COLS], 10);
+    if (blocks.bytes() != packed.bytes() || blocks.offsets() != packed.offsets()) {
+        printf("rows packed in blocks differ\n");
+        num_bad++;
+    }
+
+    // Packed rows read back from a file are used as they are.
+    PackedStareIndex copy;
+    if (copy.assign(NUM_COLS, packed.bytes().data(), packed.bytes().size(),
+                    packed.offsets().data(), packed.num_i()) ||
+        copy.unpack(out) || out != index) {
+        printf("assigned rows unpacked wrong\n");
+        num_bad++;
+    }
+
+    // Pixels without geolocation, at the edges and in the middle of
+    // rows, with rows of them alone.
+    std::vector<unsigned long long> holes(index.begin(), index.begin() + 100 * NUM_COLS);
+    for (size_t k = 0; k < holes.size(); k++)
+        if (k % NUM_COLS < 50 || k % NUM_COLS > NUM_COLS - 50 || k % 97 == 0 || k / NUM_COLS == 7)
+            holes[k] = SSC_STARE_NO_TRIXEL;
+    num_bad += round_trip(holes, 100, NUM_COLS, "no trixel");
+
+    // Mixed levels, terminators, and any 64-bit values.
+    std::vector<unsigned long long> mixed(index.begin(), index.begin() + 100 * NUM_COLS);
+    srand(42);
+    for (size_t k = 0; k < mixed.size(); k++) {
+        if (k % 3 == 0)
+            mixed[k] = stare_truncate(mixed[k], rand() % (SSC_STARE_MAX_LEVEL + 1));
+        else if (k % 5 == 0)
+            mixed[k] = stare_terminator(mixed[k]);
+        else if (k % 7 == 0)
+            mixed[k] = (unsigned long long) rand() << 42 ^ (unsigned long long) rand() << 21 ^ rand();
+    }
+    num_bad += round_trip(mixed, 100, NUM_COLS, "mixed");
+    num_bad += round_trip(std::vector<unsigned long long>(), 0, NUM_COLS, "no rows");
+    num_bad += round_trip(std::vector<unsigned long long>(3, 0), 3, 1, "one column");
+
+    // Offsets out of order, and rows cut short, are refused.
+    std::vector<unsigned long long> offsets(packed.offsets());
+    std::swap(offsets[3], offsets[4]);
+    if (!copy.assign(NUM_COLS, packed.bytes().data(), packed.bytes().size(), offsets.data(),
+                     offsets.size()) ||
+        !copy.assign(NUM_COLS, packed.bytes().data(), 10, packed.offsets().data(), 2)) {
+        printf("used offsets that are not valid\n");
+        num_bad++;
+    }
+    if (copy.assign(NUM_COLS, packed.bytes().data(), packed.offsets()[2] - 1, packed.offsets().data(),
+                    2) || copy.unpack_rows(0, 1, rows.data()) || !copy.unpack_rows(1, 1, rows.data())) {
+        printf("unpacked a row that was cut short\n");
+        num_bad++;
+    }
+
+    if (num_bad)
+        return ERR;
+
+    printf("ok!\n");
+    return 0;
+}
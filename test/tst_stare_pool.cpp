@@ -0,0 +1,96 @@
+/* This is a test file for the STAREmaster project. It checks that the
+ * STARE object StarePool hands out is one object shared by all
+ * threads, and that many threads looking points up in it at once get
+ * the same indices and resolution estimates as one thread does.
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <thread>
+#include "STARE.h"
+#include "StarePool.h"
+
+#define ERR 1
+
+#define LEVEL 27
+#define BUILD_LEVEL 5
+#define NUM_THREADS 8
+#define NUM_ROWS 64
+#define NUM_COLS 512
+
+/** Look up every point of rows first, first + step, ... in stare. */
+static void
+lookup(STARE &stare, const std::vector<double> &lat, const std::vector<double> &lon,
+       int first, int step, std::vector<unsigned long long> &index,
+       std::vector<unsigned long long> &adapted) {
+    for (int i = first; i < NUM_ROWS; i += step) {
+        for (int j = 0; j < NUM_COLS; j++) {
+            size_t k = (size_t) i * NUM_COLS + j;
+            index[k] = stare.ValueFromLatLonDegrees(lat[k], lon[k], LEVEL - (j % 4) * 6);
+            adapted[k] = stare.ValueFromLatLonDegrees(lat[k], lon[k], LEVEL);
+        }
+        stare.adaptSpatialResolutionEstimatesInPlace(&adapted[(size_t) i * NUM_COLS], NUM_COLS);
+    }
+}
+
+int
+main() {
+    size_t n = (size_t) NUM_ROWS * NUM_COLS;
+    std::vector<double> lat(n), lon(n);
+    std::vector<unsigned long long> serial_index(n), serial_adapted(n);
+    std::vector<unsigned long long> shared_index(n), shared_adapted(n);
+    std::vector<STARE *> got(NUM_THREADS);
+    std::vector<std::thread> threads;
+
+    printf("*** Testing sharing STARE objects between threads...");
+
+    // Rows from pole to pole, each going once round the globe and
+    // crossing the antimeridian, with points on trixel edges at the
+    // equator and the prime meridian.
+    for (int i = 0; i < NUM_ROWS; i++) {
+        for (int j = 0; j < NUM_COLS; j++) {
+            size_t k = (size_t) i * NUM_COLS + j;
+            lat[k] = -90.0 + 180.0 * i / (NUM_ROWS - 1);
+            lon[k] = -180.0 + 360.0 * j / NUM_COLS + 0.37 * sin(i + j);
+            if (lon[k] > 180.0)
+                lon[k] -= 360.0;
+        }
+    }
+
+    // Every thread asking for the same key gets the same object, and
+    // it is only constructed once.
+    int before = StarePool::num_constructed();
+    for (int t = 0; t < NUM_THREADS; t++)
+        threads.push_back(std::thread([t, &got]() { got[t] = &StarePool::get(LEVEL, BUILD_LEVEL); }));
+    for (int t = 0; t < NUM_THREADS; t++)
+        threads[t].join();
+    threads.clear();
+    for (int t = 1; t < NUM_THREADS; t++)
+        if (got[t] != got[0])
+            return ERR;
+    if (StarePool::num_constructed() != before + 1)
+        return ERR;
+
+    // Look everything up with one thread, then again with all the
+    // threads at once, each taking every NUM_THREADS-th row.
+    STARE &stare = StarePool::get(LEVEL, BUILD_LEVEL);
+    lookup(stare, lat, lon, 0, 1, serial_index, serial_adapted);
+    for (int t = 0; t < NUM_THREADS; t++)
+        threads.push_back(std::thread(lookup, std::ref(stare), std::cref(lat), std::cref(lon), t,
+                                      NUM_THREADS, std::ref(shared_index), std::ref(shared_adapted)));
+    for (int t = 0; t < NUM_THREADS; t++)
+        threads[t].join();
+
+    for (size_t k = 0; k < n; k++) {
+        if (shared_index[k] != serial_index[k] || shared_adapted[k] != serial_adapted[k]) {
+            printf("point %zu: %llx %llx, serially %llx %llx\n", k, shared_index[k],
+                   shared_adapted[k], serial_index[k], serial_adapted[k]);
+            return ERR;
+        }
+    }
+
+    printf("ok!\n");
+    return 0;
+}
@@ -0,0 +1,158 @@
+/* This is a test file for the STAREmaster project. It writes a
+ * synthetic MOD09 1 km granule to a sidecar file, with the STARE index
+ * as it is and packed, and checks that windows, with and without
+ * strides, read back what was written, also through GeoFile, and that
+ * windows outside the index are refused.
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <netcdf.h>
+#include "ssc.h"
+#include "GeoFile.h"
+#include "GeoGrid.h"
+#include "SidecarFile.h"
+#include "TrixelIndexer.h"
+#include "synthetic_swath.h"
+
+#define ERR 1
+
+#define NUM_ROWS 2030
+#define NUM_COLS 1354
+#define SCAN_ROWS 10
+#define LEVEL 27
+#define BUILD_LEVEL 5
+#define VAR_NAME "1km Surface Reflectance Band 1"
+#define FILE_NAME "tst_window.nc"
+
+/** A window of the index: start, count and stride of rows and columns. */
+struct Window {
+    size_t start[2];
+    size_t count[2];
+    ptrdiff_t stride[2];
+};
+
+/** Count the values of a window read that are not those of the grid. */
+static size_t
+check_window(const Window &w, const GeoGrid &grid, const std::vector<unsigned long long> &values) {
+    size_t num_bad = 0;
+
+    for (size_t r = 0; r < w.count[0]; r++)
+        for (size_t c = 0; c < w.count[1]; c++)
+            if (values[r * w.count[1] + c] !=
+                grid.index()[(w.start[0] + r * w.stride[0]) * NUM_COLS + w.start[1] + c * w.stride[1]])
+                num_bad++;
+    return num_bad;
+}
+
+/**
+ * Write the grid with a layout, then read windows of it.
+ *
+ * @return the number of values read back wrong, or 1 if the file
+ * can't be written or read.
+ */
+static size_t
+run_layout(const char *codec, const GeoGrid &grid) {
+    const Window windows[] = {
+        {{0, 0}, {NUM_ROWS, NUM_COLS}, {1, 1}},
+        {{500, 0}, {40, NUM_COLS}, {1, 1}},
+        {{100, 300}, {40, 400}, {1, 1}},
+        {{7, 11}, {50, 60}, {3, 5}},
+        {{0, 0}, {(NUM_ROWS - 1) / 10 + 1, (NUM_COLS - 1) / 10 + 1}, {10, 10}},
+        {{NUM_ROWS - 1, NUM_COLS - 1}, {1, 1}, {1, 1}},
+        {{NUM_ROWS - 1, 0}, {0, 0}, {1, 1}}
+    };
+    const Window bad[] = {
+        {{NUM_ROWS, 0}, {1, 1}, {1, 1}},
+        {{0, NUM_COLS - 10}, {1, 11}, {1, 1}},
+        {{0, 0}, {NUM_ROWS / 2 + 1, 1}, {2, 1}},
+        {{0, 0}, {1, 1}, {0, 1}},
+        {{NUM_ROWS + 1, 0}, {0, 0}, {1, 1}}
+    };
+    SidecarLayout layout;
+    SidecarFile sf;
+    std::vector<unsigned long long> values;
+    size_t num_bad = 0;
+
+    if (layout.set_codec(codec) || sf.createFile(FILE_NAME, 0, NULL))
+        return 1;
+    sf.setLayout(layout);
+    if (sf.writeSTAREIndex(0, BUILD_LEVEL, grid, std::vector<std::string>(1, VAR_NAME), "1km") ||
+        sf.close_file())
+        return 1;
+
+    int ncid, varid;
+    if (nc_open(FILE_NAME, NC_NOWRITE, &ncid) || nc_inq_varid(ncid, "STARE_index_1km", &varid))
+        return 1;
+    for (size_t w = 0; w < sizeof(windows) / sizeof(windows[0]); w++) {
+        values.assign(windows[w].count[0] * windows[w].count[1], 0);
+        if (SidecarFile::readSTAREIndex(ncid, varid, windows[w].start, windows[w].count,
+                                        windows[w].stride, values.data())) {
+            printf("%s: can't read window %zu\n", codec, w);
+            return 1;
+        }
+        num_bad += check_window(windows[w], grid, values);
+    }
+    if (nc_close(ncid))
+        return 1;
+
+    // Each window is also read through GeoFile, by data variable.
+    GeoFile gf;
+    if (gf.read_sidecar_file(FILE_NAME, ncid))
+        return 1;
+    for (size_t w = 0; w < sizeof(windows) / sizeof(windows[0]); w++) {
+        values.assign(windows[w].count[0] * windows[w].count[1], 0);
+        if (gf.get_stare_indices(VAR_NAME, ncid, windows[w].start, windows[w].count,
+                                 windows[w].stride, values.data())) {
+            printf("%s: can't read window %zu through GeoFile\n", codec, w);
+            num_bad++;
+        } else {
+            num_bad += check_window(windows[w], grid, values);
+        }
+    }
+    values.resize(1);
+    if (!gf.get_stare_indices("no such variable", ncid, windows[5].start, windows[5].count, NULL,
+                              values.data())) {
+        printf("%s: read a window of a variable without an index\n", codec);
+        num_bad++;
+    }
+    for (size_t w = 0; w < sizeof(bad) / sizeof(bad[0]); w++) {
+        values.resize(bad[w].count[0] * bad[w].count[1] + 1);
+        if (nc_inq_varid(ncid, "STARE_index_1km", &varid) ||
+            !SidecarFile::readSTAREIndex(ncid, varid, bad[w].start, bad[w].count, bad[w].stride,
+                                         values.data())) {
+            printf("%s: read bad window %zu\n", codec, w);
+            num_bad++;
+        }
+    }
+    gf.close_sidecar_file(ncid);
+    remove(FILE_NAME);
+
+    if (num_bad)
+        printf("%s: %zu bad values\n", codec, num_bad);
+    return num_bad;
+}
+
+int
+main() {
+    size_t num_bad = 0;
+
+    printf("*** Testing reading windows of the STARE index...");
+
+    // A swath like a MOD09 1 km granule.
+    GeoGrid grid(NUM_ROWS, NUM_COLS, SCAN_ROWS);
+    synthetic_swath(grid);
+    TrixelIndexer indexer(LEVEL, BUILD_LEVEL);
+    indexer.index(grid.lat().data(), grid.lon().data(), grid.size(), LEVEL, grid.index().data());
+
+    num_bad += run_layout("deflate:3", grid);
+    num_bad += run_layout("stare", grid);
+    if (num_bad)
+        return ERR;
+
+    printf("ok!\n");
+    return 0;
+}
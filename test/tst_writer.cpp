@@ -0,0 +1,132 @@
+/* This is a test file for the STAREmaster project. It indexes a run
+ * of synthetic MOD09 1 km granules and writes their sidecar files,
+ * first writing each granule before the next is indexed, then with
+ * the background writer, and checks that the sidecars read back what
+ * was indexed, and that a writer that fails drops the granules after
+ * the error.
+*/
+
+#include "config.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <netcdf.h>
+#include "ssc.h"
+#include "GeoFile.h"
+#include "SidecarFile.h"
+#include "SidecarWriter.h"
+#include "TrixelIndexer.h"
+#include "synthetic_swath.h"
+
+#define ERR 1
+
+#define NUM_ROWS 2030
+#define NUM_COLS 1354
+#define SCAN_ROWS 10
+#define LEVEL 27
+#define BUILD_LEVEL 5
+#define NUM_GRANULES 3
+
+/** Name of the sidecar of a granule. */
+static std::string
+sidecar_name(int g) {
+    std::ostringstream name;
+    name << "tst_writer_" << g << "_stare.nc";
+    return name.str();
+}
+
+/** Read and index a synthetic granule, each one a little further along the orbit. */
+static GeoFile *
+index_granule(int g, TrixelIndexer &indexer) {
+    GeoFile *gf = new GeoFile();
+
+    gf->geo_grid.push_back(GeoGrid(NUM_ROWS, NUM_COLS, SCAN_ROWS));
+    GeoGrid &grid = gf->geo_grid[0];
+
+    synthetic_swath(grid, g * NUM_ROWS);
+    indexer.index(grid.lat().data(), grid.lon().data(), grid.size(), LEVEL, grid.index().data());
+
+    gf->d_num_index = 1;
+    gf->var_name[0].push_back("1km Surface Reflectance Band 1");
+    gf->d_stare_index_name.push_back("1km");
+    gf->num_cover = 0;
+
+    return gf;
+}
+
+/** Check that the sidecar of a granule reads back what was indexed. */
+static size_t
+check_granule(int g, TrixelIndexer &indexer) {
+    GeoFile *gf = index_granule(g, indexer);
+    std::vector<unsigned long long> index(gf->geo_grid[0].size());
+    int ncid, varid;
+    size_t num_bad = 0;
+
+    if (nc_open(sidecar_name(g).c_str(), NC_NOWRITE, &ncid) ||
+        nc_inq_varid(ncid, "STARE_index_1km", &varid) ||
+        SidecarFile::readSTAREIndex(ncid, varid, 0, NUM_ROWS, &index[0]) || nc_close(ncid)) {
+        num_bad = index.size();
+    } else {
+        for (size_t k = 0; k < index.size(); k++)
+            if (index[k] != gf->geo_grid[0].index()[k])
+                num_bad++;
+    }
+    if (num_bad)
+        printf("granule %d: %zu bad values\n", g, num_bad);
+    delete gf;
+
+    return num_bad;
+}
+
+/** Index and write the granules, with a writer queue size. */
+static int
+run(int queue_size, TrixelIndexer &indexer) {
+    SidecarWriter writer(SidecarLayout(), 0, BUILD_LEVEL, "", queue_size);
+    int ret = 0;
+
+    for (int g = 0; g < NUM_GRANULES && !ret; g++)
+        ret = writer.submit(index_granule(g, indexer), sidecar_name(g));
+    if (!ret)
+        ret = writer.finish();
+
+    return ret;
+}
+
+int
+main() {
+    TrixelIndexer indexer(LEVEL, BUILD_LEVEL);
+    size_t num_bad = 0;
+
+    printf("*** Testing writing sidecar files in the background...");
+
+    // Each granule written in turn, then with the background writer.
+    for (int queue_size = 0; queue_size < 2; queue_size++) {
+        if (run(queue_size, indexer))
+            return ERR;
+        for (int g = 0; g < NUM_GRANULES; g++) {
+            num_bad += check_granule(g, indexer);
+            remove(sidecar_name(g).c_str());
+        }
+    }
+
+    // A granule that can't be written stops the writer, and the rest
+    // are refused.
+    SidecarWriter writer(SidecarLayout(), 0, BUILD_LEVEL, "", 1);
+    int first = writer.submit(index_granule(0, indexer), "no_such_dir/tst_writer_stare.nc");
+    int second = writer.submit(index_granule(1, indexer), sidecar_name(1));
+    int third = writer.submit(index_granule(2, indexer), sidecar_name(2));
+    FILE *dropped = fopen(sidecar_name(1).c_str(), "r");
+    if (first || !second || !third || !writer.finish() || dropped) {
+        printf("writer went on after an error\n");
+        num_bad++;
+    }
+    if (dropped)
+        fclose(dropped);
+
+    if (num_bad)
+        return ERR;
+
+    printf("ok!\n");
+    return 0;
+}